@@ -146,6 +146,10 @@ Span ScintillaCall::SpanSearchInTarget(std::string_view text) {
 		return Span(posFound, 0);
 }
 
+Position ScintillaCall::SearchAllInTarget(std::string_view text) {
+	return CallString(Message::SearchAllInTarget, text.length(), text.data());
+}
+
 // Generated methods
 
 // ScintillaCall requires automatically generated casts as it is converting
@@ -1447,6 +1451,10 @@ void *ScintillaCall::DirectPointer() {
 	return reinterpret_cast<void *>(Call(Message::GetDirectPointer));
 }
 
+Position ScintillaCall::ExecuteBatch(Position count, void *batch) {
+	return CallPointer(Message::ExecuteBatch, count, batch);
+}
+
 void ScintillaCall::SetOvertype(bool overType) {
 	Call(Message::SetOvertype, overType);
 }
@@ -1539,6 +1547,18 @@ FindOption ScintillaCall::SearchFlags() {
 	return static_cast<Scintilla::FindOption>(Call(Message::GetSearchFlags));
 }
 
+Position ScintillaCall::SearchAllInTarget(Position length, const char *text) {
+	return CallString(Message::SearchAllInTarget, length, text);
+}
+
+Position ScintillaCall::GetSearchAllRanges(Position count, void *ranges) {
+	return CallPointer(Message::GetSearchAllRanges, count, ranges);
+}
+
+void ScintillaCall::IndicatorFillSearchAll() {
+	Call(Message::IndicatorFillSearchAll);
+}
+
 void ScintillaCall::CallTipShow(Position pos, const char *definition) {
 	CallString(Message::CallTipShow, pos, definition);
 }
@@ -1791,6 +1811,10 @@ LineCache ScintillaCall::LayoutCache() {
 	return static_cast<Scintilla::LineCache>(Call(Message::GetLayoutCache));
 }
 
+Position ScintillaCall::LayoutAllocations() {
+	return Call(Message::GetLayoutAllocations);
+}
+
 void ScintillaCall::SetScrollWidth(int pixelWidth) {
 	Call(Message::SetScrollWidth, pixelWidth);
 }
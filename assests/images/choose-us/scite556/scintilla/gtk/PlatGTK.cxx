@@ -1417,6 +1417,8 @@ enum {
 	N_COLUMNS
 };
 
+struct ListBoxModel;
+
 class ListBoxX : public ListBox {
 	WindowID widCached;
 	WindowID frame;
@@ -1425,6 +1427,8 @@ class ListBoxX : public ListBox {
 	GHashTable *pixhash;
 	GtkCellRenderer *pixbuf_renderer;
 	GtkCellRenderer *renderer;
+	GtkListStore *store;
+	ListBoxModel *virtualModel;
 	RGBAImageSet images;
 	int desiredVisibleRows;
 	unsigned int maxItemCharacters;
@@ -1437,7 +1441,7 @@ public:
 
 	ListBoxX() noexcept : widCached(nullptr), frame(nullptr), list(nullptr), scroller(nullptr),
 		pixhash(nullptr), pixbuf_renderer(nullptr),
-		renderer(nullptr),
+		renderer(nullptr), store(nullptr), virtualModel(nullptr),
 		desiredVisibleRows(5), maxItemCharacters(0),
 		aveCharWidth(1),
 		delegate(nullptr) {
@@ -1456,6 +1460,9 @@ public:
 			gtk_widget_destroy(GTK_WIDGET(widCached));
 			wid = widCached = nullptr;
 		}
+		if (virtualModel) {
+			g_object_unref(virtualModel);
+		}
 	}
 	void SetFont(const Font *font) override;
 	void Create(Window &parent, int ctrlID, Point location_, int lineHeight_, bool unicodeMode_, Technology technology_) override;
@@ -1478,6 +1485,7 @@ public:
 	void ClearRegisteredImages() override;
 	void SetDelegate(IListBoxDelegate *lbDelegate) override;
 	void SetList(const char *listText, char separator, char typesep) override;
+	bool SetSource(const IListBoxSource *source) override;
 	void SetOptions(ListOptions options_) override;
 };
 
@@ -1672,8 +1680,7 @@ void ListBoxX::Create(Window &parent, int, Point, int, bool, Technology) {
 	gtk_widget_show(PWidget(scroller));
 
 	/* Tree and its model */
-	GtkListStore *store =
-		gtk_list_store_new(N_COLUMNS, GDK_TYPE_PIXBUF, G_TYPE_STRING);
+	store = gtk_list_store_new(N_COLUMNS, GDK_TYPE_PIXBUF, G_TYPE_STRING);
 
 	list = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
 	g_signal_connect(G_OBJECT(list), "style-set", G_CALLBACK(StyleSet), nullptr);
@@ -1876,8 +1883,11 @@ int ListBoxX::CaretFromEdge() {
 }
 
 void ListBoxX::Clear() noexcept {
-	GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(list));
-	gtk_list_store_clear(GTK_LIST_STORE(model));
+	if (virtualModel && (gtk_tree_view_get_model(GTK_TREE_VIEW(list)) == GTK_TREE_MODEL(virtualModel))) {
+		gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(store));
+		virtualModel->source = nullptr;
+	}
+	gtk_list_store_clear(store);
 	maxItemCharacters = 0;
 }
 
@@ -1899,6 +1909,155 @@ static void init_pixmap(ListImage *list_image) noexcept {
 	}
 }
 
+static void ReserveImageWidth(GtkCellRenderer *pixbuf_renderer, GdkPixbuf *pixbuf) noexcept {
+	const gint pixbuf_width = gdk_pixbuf_get_width(pixbuf);
+	gint renderer_height, renderer_width;
+	gtk_cell_renderer_get_fixed_size(pixbuf_renderer,
+					 &renderer_width, &renderer_height);
+	if (pixbuf_width > renderer_width)
+		gtk_cell_renderer_set_fixed_size(pixbuf_renderer,
+						 pixbuf_width, -1);
+}
+
+// ListBoxModel, a GtkTreeModel that retrieves rows from an IListBoxSource only when
+// they are displayed so that a long list does not have to be copied into a GtkListStore.
+// Rows are identified by their index in user_data.
+struct ListBoxModel {
+	GObject parent;
+	const IListBoxSource *source;
+	GHashTable *pixhash;
+	gint stamp;
+};
+typedef GObjectClass ListBoxModelClass;
+
+static void list_box_model_tree_model_init(GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(ListBoxModel, list_box_model, G_TYPE_OBJECT,
+			G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL, list_box_model_tree_model_init))
+
+static void list_box_model_class_init(ListBoxModelClass *) {}
+
+static void list_box_model_init(ListBoxModel *lbm) {
+	lbm->source = nullptr;
+	lbm->pixhash = nullptr;
+	lbm->stamp = static_cast<gint>(g_random_int());
+}
+
+static ListBoxModel *ListBoxModelFromTree(GtkTreeModel *model) noexcept {
+	return G_TYPE_CHECK_INSTANCE_CAST(model, list_box_model_get_type(), ListBoxModel);
+}
+
+static gint list_box_model_row_count(const ListBoxModel *lbm) noexcept {
+	return lbm->source ? lbm->source->Count() : 0;
+}
+
+static gboolean list_box_model_set_iter(const ListBoxModel *lbm, GtkTreeIter *iter, gint row) noexcept {
+	if ((row < 0) || (row >= list_box_model_row_count(lbm))) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->stamp = lbm->stamp;
+	iter->user_data = GINT_TO_POINTER(row);
+	iter->user_data2 = nullptr;
+	iter->user_data3 = nullptr;
+	return TRUE;
+}
+
+static GtkTreeModelFlags list_box_model_get_flags(GtkTreeModel *) {
+	return static_cast<GtkTreeModelFlags>(GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY);
+}
+
+static gint list_box_model_get_n_columns(GtkTreeModel *) {
+	return N_COLUMNS;
+}
+
+static GType list_box_model_get_column_type(GtkTreeModel *, gint index) {
+	return (index == PIXBUF_COLUMN) ? GDK_TYPE_PIXBUF : G_TYPE_STRING;
+}
+
+static gboolean list_box_model_get_iter(GtkTreeModel *model, GtkTreeIter *iter, GtkTreePath *path) {
+	const gint *indices = gtk_tree_path_get_indices(path);
+	if ((gtk_tree_path_get_depth(path) != 1) || !indices) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return list_box_model_set_iter(ListBoxModelFromTree(model), iter, indices[0]);
+}
+
+static GtkTreePath *list_box_model_get_path(GtkTreeModel *, GtkTreeIter *iter) {
+	return gtk_tree_path_new_from_indices(GPOINTER_TO_INT(iter->user_data), -1);
+}
+
+static void list_box_model_get_value(GtkTreeModel *model, GtkTreeIter *iter, gint column, GValue *value) {
+	const ListBoxModel *lbm = ListBoxModelFromTree(model);
+	const int row = GPOINTER_TO_INT(iter->user_data);
+	if (column == PIXBUF_COLUMN) {
+		g_value_init(value, GDK_TYPE_PIXBUF);
+		const int type = lbm->source->ImageType(row);
+		if ((type >= 0) && lbm->pixhash) {
+			ListImage *list_image = static_cast<ListImage *>(g_hash_table_lookup(lbm->pixhash,
+						      GINT_TO_POINTER(type)));
+			if (list_image) {
+				if (nullptr == list_image->pixbuf)
+					init_pixmap(list_image);
+				g_value_set_object(value, list_image->pixbuf);
+			}
+		}
+	} else {
+		g_value_init(value, G_TYPE_STRING);
+		const std::string_view text = lbm->source->Text(row);
+		g_value_take_string(value, g_strndup(text.data(), text.length()));
+	}
+}
+
+static gboolean list_box_model_iter_next(GtkTreeModel *model, GtkTreeIter *iter) {
+	return list_box_model_set_iter(ListBoxModelFromTree(model), iter, GPOINTER_TO_INT(iter->user_data) + 1);
+}
+
+static gboolean list_box_model_iter_children(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent) {
+	if (parent) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return list_box_model_set_iter(ListBoxModelFromTree(model), iter, 0);
+}
+
+static gboolean list_box_model_iter_has_child(GtkTreeModel *, GtkTreeIter *) {
+	return FALSE;
+}
+
+static gint list_box_model_iter_n_children(GtkTreeModel *model, GtkTreeIter *iter) {
+	return iter ? 0 : list_box_model_row_count(ListBoxModelFromTree(model));
+}
+
+static gboolean list_box_model_iter_nth_child(GtkTreeModel *model, GtkTreeIter *iter, GtkTreeIter *parent, gint n) {
+	if (parent) {
+		iter->stamp = 0;
+		return FALSE;
+	}
+	return list_box_model_set_iter(ListBoxModelFromTree(model), iter, n);
+}
+
+static gboolean list_box_model_iter_parent(GtkTreeModel *, GtkTreeIter *iter, GtkTreeIter *) {
+	iter->stamp = 0;
+	return FALSE;
+}
+
+static void list_box_model_tree_model_init(GtkTreeModelIface *iface) {
+	iface->get_flags = list_box_model_get_flags;
+	iface->get_n_columns = list_box_model_get_n_columns;
+	iface->get_column_type = list_box_model_get_column_type;
+	iface->get_iter = list_box_model_get_iter;
+	iface->get_path = list_box_model_get_path;
+	iface->get_value = list_box_model_get_value;
+	iface->iter_next = list_box_model_iter_next;
+	iface->iter_children = list_box_model_iter_children;
+	iface->iter_has_child = list_box_model_iter_has_child;
+	iface->iter_n_children = list_box_model_iter_n_children;
+	iface->iter_nth_child = list_box_model_iter_nth_child;
+	iface->iter_parent = list_box_model_iter_parent;
+}
+
 #define SPACING 5
 
 void ListBoxX::Append(char *s, int type) {
@@ -1908,8 +2067,6 @@ void ListBoxX::Append(char *s, int type) {
 						      GINT_TO_POINTER(type)));
 	}
 	GtkTreeIter iter {};
-	GtkListStore *store =
-		GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(list)));
 	gtk_list_store_append(GTK_LIST_STORE(store), &iter);
 	if (list_image) {
 		if (nullptr == list_image->pixbuf)
@@ -1918,14 +2075,7 @@ void ListBoxX::Append(char *s, int type) {
 			gtk_list_store_set(GTK_LIST_STORE(store), &iter,
 					   PIXBUF_COLUMN, list_image->pixbuf,
 					   TEXT_COLUMN, s, -1);
-
-			const gint pixbuf_width = gdk_pixbuf_get_width(list_image->pixbuf);
-			gint renderer_height, renderer_width;
-			gtk_cell_renderer_get_fixed_size(pixbuf_renderer,
-							 &renderer_width, &renderer_height);
-			if (pixbuf_width > renderer_width)
-				gtk_cell_renderer_set_fixed_size(pixbuf_renderer,
-								 pixbuf_width, -1);
+			ReserveImageWidth(pixbuf_renderer, list_image->pixbuf);
 		} else {
 			gtk_list_store_set(GTK_LIST_STORE(store), &iter,
 					   TEXT_COLUMN, s, -1);
@@ -2125,6 +2275,41 @@ void ListBoxX::SetList(const char *listText, char separator, char typesep) {
 	}
 }
 
+bool ListBoxX::SetSource(const IListBoxSource *source) {
+	Clear();
+	if (!virtualModel) {
+		virtualModel = static_cast<ListBoxModel *>(g_object_new(list_box_model_get_type(), nullptr));
+	}
+	virtualModel->source = source;
+	virtualModel->pixhash = pixhash;
+	// Invalidate any iterators into the previous list
+	virtualModel->stamp++;
+
+	// Only lengths and image types are examined here: text is copied when a row is displayed
+	const int count = source->Count();
+	int typePrevious = -1;
+	for (int item = 0; item < count; item++) {
+		const unsigned int len = static_cast<unsigned int>(source->Text(item).length());
+		if (maxItemCharacters < len)
+			maxItemCharacters = len;
+		const int type = source->ImageType(item);
+		if ((type >= 0) && (type != typePrevious) && pixhash) {
+			typePrevious = type;
+			ListImage *list_image = static_cast<ListImage *>(g_hash_table_lookup(pixhash,
+						      GINT_TO_POINTER(type)));
+			if (list_image) {
+				if (nullptr == list_image->pixbuf)
+					init_pixmap(list_image);
+				if (list_image->pixbuf)
+					ReserveImageWidth(pixbuf_renderer, list_image->pixbuf);
+			}
+		}
+	}
+
+	gtk_tree_view_set_model(GTK_TREE_VIEW(list), GTK_TREE_MODEL(virtualModel));
+	return true;
+}
+
 void ListBoxX::SetOptions(ListOptions) {
 }
 
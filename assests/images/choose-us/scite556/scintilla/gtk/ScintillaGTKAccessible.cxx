@@ -49,8 +49,6 @@
 // Initially based on GtkTextViewAccessible from GTK 3.20
 // Inspiration for the GTK < 3.2 part comes from Evince 2.24, thanks.
 
-// FIXME: optimize character/byte offset conversion (with a cache?)
-
 #include <cstddef>
 #include <cstdlib>
 #include <cstdint>
@@ -163,15 +161,146 @@ ScintillaGTKAccessible *ScintillaGTKAccessible::FromAccessible(GtkAccessible *ac
 	return SCINTILLA_OBJECT_ACCESSIBLE_GET_PRIVATE(accessible)->pscin;
 }
 
+void CharacterBlockIndex::Invalidate() {
+	if (valid) {
+		bytes.DeleteAll();
+		characters.DeleteAll();
+		valid = false;
+	}
+}
+
+void CharacterBlockIndex::AppendBlock(Sci::Position lengthBytes, Sci::Position lengthCharacters) {
+	Sci::Position block = bytes.Partitions() - 1;
+	if (bytes.Length() > 0) {
+		block++;
+		bytes.InsertPartition(block, bytes.Length());
+		characters.InsertPartition(block, characters.Length());
+	}
+	bytes.InsertText(block, lengthBytes);
+	characters.InsertText(block, lengthCharacters);
+}
+
+void CharacterBlockIndex::SplitBlock(const Document *pdoc, Sci::Position block) {
+	Sci::Position position = bytes.PositionFromPartition(block);
+	Sci::Position characterPosition = characters.PositionFromPartition(block);
+	const Sci::Position end = bytes.PositionFromPartition(block + 1);
+	while (end - position > blockSize * 2) {
+		const Sci::Position split = pdoc->MovePositionOutsideChar(position + blockSize, 1, false);
+		characterPosition += pdoc->CountCharacters(position, split);
+		block++;
+		bytes.InsertPartition(block, split);
+		characters.InsertPartition(block, characterPosition);
+		position = split;
+	}
+}
+
+void CharacterBlockIndex::Validate(const Document *pdoc) {
+	const Sci::Position length = pdoc->Length();
+	if (valid && (bytes.Length() == length)) {
+		return;
+	}
+	bytes.DeleteAll();
+	characters.DeleteAll();
+	Sci::Position position = 0;
+	while (position < length) {
+		const Sci::Position end = (length - position > blockSize) ?
+			pdoc->MovePositionOutsideChar(position + blockSize, 1, false) : length;
+		AppendBlock(end - position, pdoc->CountCharacters(position, end));
+		position = end;
+	}
+	valid = true;
+}
+
+void CharacterBlockIndex::InsertText(const Document *pdoc, Sci::Position position, Sci::Position lengthBytes, Sci::Position lengthCharacters) {
+	// Called after the insertion
+	if (!valid) {
+		return;
+	}
+	const Sci::Position block = bytes.PartitionFromPosition(position);
+	bytes.InsertText(block, lengthBytes);
+	characters.InsertText(block, lengthCharacters);
+	if (bytes.PositionFromPartition(block + 1) - bytes.PositionFromPartition(block) > blockSize * 4) {
+		SplitBlock(pdoc, block);
+	}
+}
+
+// Called after the deletion with the character count measured before it or, when that
+// was not seen, -1 to measure what remains of the block. Returns the characters deleted.
+Sci::Position CharacterBlockIndex::DeleteText(const Document *pdoc, Sci::Position position, Sci::Position lengthBytes, Sci::Position lengthCharacters) {
+	if (!valid || (lengthBytes <= 0)) {
+		return lengthCharacters;
+	}
+	// Merge all the blocks touched by the deletion into the first
+	const Sci::Position first = bytes.PartitionFromPosition(position);
+	const Sci::Position last = bytes.PartitionFromPosition(position + lengthBytes - 1);
+	for (Sci::Position block = first; block < last; block++) {
+		bytes.RemovePartition(first + 1);
+		characters.RemovePartition(first + 1);
+	}
+	bytes.InsertText(first, -lengthBytes);
+	if (lengthCharacters < 0) {
+		const Sci::Position lengthBlockCharacters =
+			characters.PositionFromPartition(first + 1) - characters.PositionFromPartition(first);
+		lengthCharacters = lengthBlockCharacters -
+			pdoc->CountCharacters(bytes.PositionFromPartition(first), bytes.PositionFromPartition(first + 1));
+	}
+	characters.InsertText(first, -lengthCharacters);
+	const Sci::Position lengthBlock = bytes.PositionFromPartition(first + 1) - bytes.PositionFromPartition(first);
+	if (lengthBlock == 0 && bytes.Partitions() > 1) {
+		const Sci::Position boundary = (first > 0) ? first : 1;
+		bytes.RemovePartition(boundary);
+		characters.RemovePartition(boundary);
+	} else if (lengthBlock > blockSize * 4) {
+		SplitBlock(pdoc, first);
+	}
+	return lengthCharacters;
+}
+
+Sci::Position CharacterBlockIndex::CharacterFromByte(const Document *pdoc, Sci::Position byteOffset) {
+	Validate(pdoc);
+	byteOffset = std::clamp<Sci::Position>(byteOffset, 0, bytes.Length());
+	const Sci::Position block = bytes.PartitionFromPosition(byteOffset);
+	const Sci::Position startByte = bytes.PositionFromPartition(block);
+	const Sci::Position startCharacter = characters.PositionFromPartition(block);
+	if (bytes.PositionFromPartition(block + 1) - startByte == characters.PositionFromPartition(block + 1) - startCharacter) {
+		// Every character in the block is a single byte
+		return startCharacter + byteOffset - startByte;
+	}
+	return startCharacter + pdoc->CountCharacters(startByte, byteOffset);
+}
+
+Sci::Position CharacterBlockIndex::ByteFromCharacter(const Document *pdoc, Sci::Position characterOffset) {
+	Validate(pdoc);
+	characterOffset = std::clamp<Sci::Position>(characterOffset, 0, characters.Length());
+	const Sci::Position block = characters.PartitionFromPosition(characterOffset);
+	const Sci::Position startByte = bytes.PositionFromPartition(block);
+	const Sci::Position startCharacter = characters.PositionFromPartition(block);
+	const Sci::Position endByte = bytes.PositionFromPartition(block + 1);
+	if (endByte - startByte == characters.PositionFromPartition(block + 1) - startCharacter) {
+		return startByte + characterOffset - startCharacter;
+	}
+	const Sci::Position position = pdoc->GetRelativePosition(startByte, characterOffset - startCharacter);
+	return (position == INVALID_POSITION) ? endByte : position;
+}
+
 ScintillaGTKAccessible::ScintillaGTKAccessible(GtkAccessible *accessible_, GtkWidget *widget_) :
 		accessible(accessible_),
 		sci(ScintillaGTK::FromWidget(widget_)),
-		old_pos(-1) {
+		old_pos(-1),
+		deletionPosition(0),
+		deletionLength(-1),
+		deletionCharacters(0),
+		idleChangesID(0),
+		resynchronizing(false) {
 	SetAccessibility(true);
 	g_signal_connect(widget_, "sci-notify", G_CALLBACK(SciNotify), this);
 }
 
 ScintillaGTKAccessible::~ScintillaGTKAccessible() {
+	if (idleChangesID) {
+		g_source_remove(idleChangesID);
+		idleChangesID = 0;
+	}
 	if (gtk_accessible_get_widget(accessible)) {
 		g_signal_handlers_disconnect_matched(sci->sci, G_SIGNAL_MATCH_DATA, 0, 0, nullptr, nullptr, this);
 	}
@@ -804,6 +933,9 @@ bool ScintillaGTKAccessible::Enabled() const {
 // Callbacks
 
 void ScintillaGTKAccessible::UpdateCursor() {
+	// Text changes have to be reported before the caret and selection moves they cause
+	EmitTextChanges();
+
 	Sci::Position pos = sci->WndProc(Message::GetCurrentPos, 0, 0);
 	if (old_pos != pos) {
 		int charPosition = CharacterOffsetFromByteOffset(pos);
@@ -841,6 +973,9 @@ void ScintillaGTKAccessible::ChangeDocument(Document *oldDoc, Document *newDoc)
 		return;
 	}
 
+	EmitTextChanges();
+	characterIndex.Invalidate();
+
 	if (oldDoc) {
 		int charLength = oldDoc->CountCharacters(0, oldDoc->Length());
 		g_signal_emit_by_name(accessible, "text-changed::delete", 0, charLength);
@@ -873,32 +1008,135 @@ void ScintillaGTKAccessible::NotifyReadOnly() {
 
 void ScintillaGTKAccessible::SetAccessibility(bool enabled) {
 	// Called by ScintillaGTK when application has enabled or disabled accessibility
-	if (enabled)
-		sci->pdoc->AllocateLineCharacterIndex(LineCharacterIndexType::Utf32);
-	else
-		sci->pdoc->ReleaseLineCharacterIndex(LineCharacterIndexType::Utf32);
+	if (!enabled) {
+		// Modifications are not followed while disabled so the index is rebuilt when next needed
+		characterIndex.Invalidate();
+		pendingChanges.clear();
+		resynchronizing = false;
+		if (idleChangesID) {
+			g_source_remove(idleChangesID);
+			idleChangesID = 0;
+		}
+	}
+}
+
+// Modification notifications deferred by SCI_EXECUTEBATCH arrive after the document has
+// changed further so their positions can not be converted. When the character index no
+// longer matches the document, report the whole text as replaced instead.
+bool ScintillaGTKAccessible::InSync(Sci::Position lengthChange) {
+	if (resynchronizing) {
+		return false;
+	}
+	if (!characterIndex.Valid() || (characterIndex.LengthBytes() + lengthChange == sci->pdoc->Length())) {
+		return true;
+	}
+	QueueTextChange(false, 0, static_cast<int>(characterIndex.LengthCharacters()));
+	characterIndex.Invalidate();
+	resynchronizing = true;
+	return false;
+}
+
+void ScintillaGTKAccessible::QueueTextChange(bool insertion, int startChar, int lengthChar) {
+	if (!idleChangesID) {
+		idleChangesID = gdk_threads_add_idle_full(G_PRIORITY_DEFAULT_IDLE, IdleTextChanges, this, nullptr);
+	}
+	if (lengthChar <= 0) {
+		return;
+	}
+	if (!pendingChanges.empty()) {
+		TextChange &last = pendingChanges.back();
+		if (insertion && last.insertion &&
+			(startChar >= last.startChar) && (startChar <= last.startChar + last.lengthChar)) {
+			// Inserted inside or next to the previous insertion
+			last.lengthChar += lengthChar;
+			return;
+		}
+		if (!insertion && !last.insertion) {
+			if (startChar == last.startChar) {
+				// Deleting forwards
+				last.lengthChar += lengthChar;
+				return;
+			}
+			if (startChar + lengthChar == last.startChar) {
+				// Deleting backwards
+				last.startChar = startChar;
+				last.lengthChar += lengthChar;
+				return;
+			}
+		}
+	}
+	pendingChanges.push_back({insertion, startChar, lengthChar});
+}
+
+void ScintillaGTKAccessible::EmitTextChanges() {
+	if (idleChangesID) {
+		g_source_remove(idleChangesID);
+		idleChangesID = 0;
+	}
+	if (resynchronizing) {
+		// The whole text was reported as deleted so report the current text as inserted
+		resynchronizing = false;
+		pendingChanges.push_back({true, 0, static_cast<int>(CharacterOffsetFromByteOffset(sci->pdoc->Length()))});
+	}
+	// Signal handlers may modify the document so take ownership of the queue first
+	std::vector<TextChange> changes;
+	changes.swap(pendingChanges);
+	for (const TextChange &change : changes) {
+		if (change.lengthChar > 0) {
+			g_signal_emit_by_name(accessible, change.insertion ? "text-changed::insert" : "text-changed::delete",
+				change.startChar, change.lengthChar);
+		}
+	}
+}
+
+gboolean ScintillaGTKAccessible::IdleTextChanges(gpointer data) {
+	ScintillaGTKAccessible *scia = static_cast<ScintillaGTKAccessible *>(data);
+	try {
+		// Returning FALSE removes the source
+		scia->idleChangesID = 0;
+		scia->UpdateCursor();
+	} catch (...) {}
+	return FALSE;
 }
 
 void ScintillaGTKAccessible::Notify(GtkWidget *, gint, NotificationData *nt) {
-	if (!Enabled())
+	if (!Enabled()) {
+		characterIndex.Invalidate();
 		return;
+	}
 	switch (nt->nmhdr.code) {
 		case Notification::Modified: {
 			if (FlagSet(nt->modificationType, ModificationFlags::InsertText)) {
-				int startChar = CharacterOffsetFromByteOffset(nt->position);
-				int lengthChar = sci->pdoc->CountCharacters(nt->position, nt->position + nt->length);
-				g_signal_emit_by_name(accessible, "text-changed::insert", startChar, lengthChar);
-				UpdateCursor();
+				if (InSync(nt->length)) {
+					const Sci::Position lengthChar = sci->pdoc->CountCharacters(nt->position, nt->position + nt->length);
+					characterIndex.InsertText(sci->pdoc, nt->position, nt->length, lengthChar);
+					const int startChar = CharacterOffsetFromByteOffset(nt->position);
+					QueueTextChange(true, startChar, static_cast<int>(lengthChar));
+				}
 			}
 			if (FlagSet(nt->modificationType, ModificationFlags::BeforeDelete)) {
-				int startChar = CharacterOffsetFromByteOffset(nt->position);
-				int lengthChar = sci->pdoc->CountCharacters(nt->position, nt->position + nt->length);
-				g_signal_emit_by_name(accessible, "text-changed::delete", startChar, lengthChar);
+				if (InSync(0)) {
+					const int startChar = CharacterOffsetFromByteOffset(nt->position);
+					deletionPosition = nt->position;
+					deletionLength = nt->length;
+					deletionCharacters = sci->pdoc->CountCharacters(nt->position, nt->position + nt->length);
+					QueueTextChange(false, startChar, static_cast<int>(deletionCharacters));
+				}
 			}
 			if (FlagSet(nt->modificationType, ModificationFlags::DeleteText)) {
-				UpdateCursor();
+				// The container may not ask for BeforeDelete so only trust a count made for this deletion
+				const bool counted = (deletionPosition == nt->position) && (deletionLength == nt->length);
+				deletionLength = -1;
+				if (InSync(-nt->length)) {
+					const Sci::Position lengthChar = characterIndex.DeleteText(sci->pdoc, nt->position, nt->length,
+						counted ? deletionCharacters : -1);
+					if (!counted) {
+						QueueTextChange(false, CharacterOffsetFromByteOffset(nt->position), static_cast<int>(lengthChar));
+					}
+				}
 			}
 			if (FlagSet(nt->modificationType, ModificationFlags::ChangeStyle)) {
+				EmitTextChanges();
 				g_signal_emit_by_name(accessible, "text-attributes-changed");
 			}
 		} break;
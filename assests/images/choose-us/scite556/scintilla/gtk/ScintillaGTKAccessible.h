@@ -12,6 +12,36 @@ namespace Scintilla::Internal {
 # define ATK_CHECK_VERSION(x, y, z) 0
 #endif
 
+// Maps between byte and character offsets of a UTF-8 document.
+// The document is divided into blocks of a few kilobytes that start on character
+// boundaries and the byte and character starts of each block are recorded, so a
+// conversion only counts characters inside one block, and not at all for ASCII
+// blocks. Built when first needed then updated from modification notifications.
+class CharacterBlockIndex {
+	Partitioning<Sci::Position> bytes;
+	Partitioning<Sci::Position> characters;
+	bool valid = false;
+	void AppendBlock(Sci::Position lengthBytes, Sci::Position lengthCharacters);
+	void SplitBlock(const Document *pdoc, Sci::Position block);
+	void Validate(const Document *pdoc);
+public:
+	static constexpr Sci::Position blockSize = 0x1000;
+	bool Valid() const noexcept {
+		return valid;
+	}
+	Sci::Position LengthBytes() const noexcept {
+		return bytes.Length();
+	}
+	Sci::Position LengthCharacters() const noexcept {
+		return characters.Length();
+	}
+	void Invalidate();
+	void InsertText(const Document *pdoc, Sci::Position position, Sci::Position lengthBytes, Sci::Position lengthCharacters);
+	Sci::Position DeleteText(const Document *pdoc, Sci::Position position, Sci::Position lengthBytes, Sci::Position lengthCharacters);
+	Sci::Position CharacterFromByte(const Document *pdoc, Sci::Position byteOffset);
+	Sci::Position ByteFromCharacter(const Document *pdoc, Sci::Position characterOffset);
+};
+
 class ScintillaGTKAccessible {
 private:
 	// weak references to related objects
@@ -22,8 +52,29 @@ private:
 	Sci::Position old_pos;
 	std::vector<SelectionRange> old_sels;
 
+	CharacterBlockIndex characterIndex;
+	// deletion seen in BeforeDelete, applied to characterIndex in DeleteText
+	Sci::Position deletionPosition;
+	Sci::Position deletionLength;
+	Sci::Position deletionCharacters;
+
+	// text-changed signals are coalesced and emitted once per idle cycle
+	struct TextChange {
+		bool insertion;
+		int startChar;
+		int lengthChar;
+	};
+	std::vector<TextChange> pendingChanges;
+	guint idleChangesID;
+	// set when notifications no longer match the document so the whole text is reported again
+	bool resynchronizing;
+
 	bool Enabled() const;
 	void UpdateCursor();
+	bool InSync(Sci::Position lengthChange);
+	void QueueTextChange(bool insertion, int startChar, int lengthChar);
+	void EmitTextChanges();
+	static gboolean IdleTextChanges(gpointer data);
 	void Notify(GtkWidget *widget, gint code, Scintilla::NotificationData *nt);
 	static void SciNotify(GtkWidget *widget, gint code, Scintilla::NotificationData *nt, gpointer data) {
 		try {
@@ -32,29 +83,15 @@ private:
 	}
 
 	Sci::Position ByteOffsetFromCharacterOffset(Sci::Position startByte, int characterOffset) {
-		if (!FlagSet(sci->pdoc->LineCharacterIndex(), Scintilla::LineCharacterIndexType::Utf32)) {
+		if (sci->pdoc->dbcsCodePage != CpUtf8) {
 			return startByte + characterOffset;
 		}
-		if (characterOffset > 0) {
-			// Try and reduce the range by reverse-looking into the character offset cache
-			Sci::Line lineStart = sci->pdoc->LineFromPosition(startByte);
-			Sci::Position posStart = sci->pdoc->IndexLineStart(lineStart, Scintilla::LineCharacterIndexType::Utf32);
-			Sci::Line line = sci->pdoc->LineFromPositionIndex(posStart + characterOffset, Scintilla::LineCharacterIndexType::Utf32);
-			if (line != lineStart) {
-				startByte += sci->pdoc->LineStart(line) - sci->pdoc->LineStart(lineStart);
-				characterOffset -= sci->pdoc->IndexLineStart(line, Scintilla::LineCharacterIndexType::Utf32) - posStart;
-			}
-		}
-		Sci::Position pos = sci->pdoc->GetRelativePosition(startByte, characterOffset);
-		if (pos == INVALID_POSITION) {
-			// clamp invalid positions inside the document
-			if (characterOffset > 0) {
-				return sci->pdoc->Length();
-			} else {
-				return 0;
-			}
+		const Sci::Position characterPosition = characterIndex.CharacterFromByte(sci->pdoc, startByte) + characterOffset;
+		// clamp invalid positions inside the document
+		if (characterPosition <= 0) {
+			return 0;
 		}
-		return pos;
+		return characterIndex.ByteFromCharacter(sci->pdoc, characterPosition);
 	}
 
 	Sci::Position ByteOffsetFromCharacterOffset(Sci::Position characterOffset) {
@@ -62,12 +99,10 @@ private:
 	}
 
 	Sci::Position CharacterOffsetFromByteOffset(Sci::Position byteOffset) {
-		if (!FlagSet(sci->pdoc->LineCharacterIndex(), Scintilla::LineCharacterIndexType::Utf32)) {
+		if (sci->pdoc->dbcsCodePage != CpUtf8) {
 			return byteOffset;
 		}
-		const Sci::Line line = sci->pdoc->LineFromPosition(byteOffset);
-		const Sci::Position lineStart = sci->pdoc->LineStart(line);
-		return sci->pdoc->IndexLineStart(line, Scintilla::LineCharacterIndexType::Utf32) + sci->pdoc->CountCharacters(lineStart, byteOffset);
+		return characterIndex.CharacterFromByte(sci->pdoc, byteOffset);
 	}
 
 	void CharacterRangeFromByteRange(Sci::Position startByte, Sci::Position endByte, int *startChar, int *endChar) {
@@ -423,6 +423,8 @@ RESearch.o: \
 	../src/RESearch.cxx \
 	../src/Position.h \
 	../src/CharClassify.h \
+	../src/UniConversion.h \
+	../src/CaseConvert.h \
 	../src/RESearch.h
 RunStyles.o: \
 	../src/RunStyles.cxx \
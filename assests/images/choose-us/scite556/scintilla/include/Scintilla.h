@@ -461,6 +461,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SC_AUTOCOMPLETE_NORMAL 0
 #define SC_AUTOCOMPLETE_FIXED_SIZE 1
 #define SC_AUTOCOMPLETE_SELECT_FIRST_ITEM 2
+#define SC_AUTOCOMPLETE_FUZZY_MATCH 4
 #define SCI_AUTOCSETOPTIONS 2638
 #define SCI_AUTOCGETOPTIONS 2639
 #define SCI_AUTOCSETDROPRESTOFWORD 2270
@@ -522,6 +523,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCFIND_REGEXP 0x00200000
 #define SCFIND_POSIX 0x00400000
 #define SCFIND_CXX11REGEX 0x00800000
+#define SCFIND_MULTILINE 0x01000000
 #define SCI_FINDTEXT 2150
 #define SCI_FINDTEXTFULL 2196
 #define SCI_FORMATRANGE 2151
@@ -577,6 +579,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_GETDIRECTFUNCTION 2184
 #define SCI_GETDIRECTSTATUSFUNCTION 2772
 #define SCI_GETDIRECTPOINTER 2185
+#define SCI_EXECUTEBATCH 2815
 #define SCI_SETOVERTYPE 2186
 #define SCI_GETOVERTYPE 2187
 #define SCI_SETCARETWIDTH 2188
@@ -599,6 +602,9 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_SEARCHINTARGET 2197
 #define SCI_SETSEARCHFLAGS 2198
 #define SCI_GETSEARCHFLAGS 2199
+#define SCI_SEARCHALLINTARGET 2816
+#define SCI_GETSEARCHALLRANGES 2817
+#define SCI_INDICATORFILLSEARCHALL 2818
 #define SCI_CALLTIPSHOW 2200
 #define SCI_CALLTIPCANCEL 2201
 #define SCI_CALLTIPACTIVE 2202
@@ -708,6 +714,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SC_CACHE_DOCUMENT 3
 #define SCI_SETLAYOUTCACHE 2272
 #define SCI_GETLAYOUTCACHE 2273
+#define SCI_GETLAYOUTALLOCATIONS 2819
 #define SCI_SETSCROLLWIDTH 2274
 #define SCI_GETSCROLLWIDTH 2275
 #define SCI_SETSCROLLWIDTHTRACKING 2516
@@ -1371,6 +1378,20 @@ struct Sci_TextToFindFull {
 	struct Sci_CharacterRangeFull chrgText;
 };
 
+/* Used with SCI_EXECUTEBATCH to perform many messages with one call. */
+
+struct Sci_BatchMessage {
+	unsigned int message;
+	uptr_t wParam;
+	sptr_t lParam;
+};
+
+struct Sci_MessageBatch {
+	const struct Sci_BatchMessage *messages;
+	sptr_t *results;
+	sptr_t executed;
+};
+
 typedef void *Sci_SurfaceID;
 
 struct Sci_Rectangle {
@@ -81,6 +81,7 @@ public:
 	Position ReplaceTargetMinimal(std::string_view text);
 	Position SearchInTarget(std::string_view text);
 	Span SpanSearchInTarget(std::string_view text);
+	Position SearchAllInTarget(std::string_view text);
 
 	// Generated APIs
 //++Autogenerated -- start of section automatically generated from Scintilla.iface
@@ -407,6 +408,7 @@ public:
 	void *DirectFunction();
 	void *DirectStatusFunction();
 	void *DirectPointer();
+	Position ExecuteBatch(Position count, void *batch);
 	void SetOvertype(bool overType);
 	bool Overtype();
 	void SetCaretWidth(int pixelWidth);
@@ -430,6 +432,9 @@ public:
 	Position SearchInTarget(Position length, const char *text);
 	void SetSearchFlags(Scintilla::FindOption searchFlags);
 	Scintilla::FindOption SearchFlags();
+	Position SearchAllInTarget(Position length, const char *text);
+	Position GetSearchAllRanges(Position count, void *ranges);
+	void IndicatorFillSearchAll();
 	void CallTipShow(Position pos, const char *definition);
 	void CallTipCancel();
 	bool CallTipActive();
@@ -493,6 +498,7 @@ public:
 	Scintilla::WrapIndentMode WrapIndentMode();
 	void SetLayoutCache(Scintilla::LineCache cacheMode);
 	Scintilla::LineCache LayoutCache();
+	Position LayoutAllocations();
 	void SetScrollWidth(int pixelWidth);
 	int ScrollWidth();
 	void SetScrollWidthTracking(bool tracking);
@@ -328,6 +328,7 @@ enum class Message {
 	GetDirectFunction = 2184,
 	GetDirectStatusFunction = 2772,
 	GetDirectPointer = 2185,
+	ExecuteBatch = 2815,
 	SetOvertype = 2186,
 	GetOvertype = 2187,
 	SetCaretWidth = 2188,
@@ -350,6 +351,9 @@ enum class Message {
 	SearchInTarget = 2197,
 	SetSearchFlags = 2198,
 	GetSearchFlags = 2199,
+	SearchAllInTarget = 2816,
+	GetSearchAllRanges = 2817,
+	IndicatorFillSearchAll = 2818,
 	CallTipShow = 2200,
 	CallTipCancel = 2201,
 	CallTipActive = 2202,
@@ -412,6 +416,7 @@ enum class Message {
 	GetWrapIndentMode = 2473,
 	SetLayoutCache = 2272,
 	GetLayoutCache = 2273,
+	GetLayoutAllocations = 2819,
 	SetScrollWidth = 2274,
 	GetScrollWidth = 2275,
 	SetScrollWidthTracking = 2516,
@@ -46,6 +46,18 @@ struct TextToFindFull {
 	CharacterRangeFull chrgText;
 };
 
+struct BatchMessage {
+	unsigned int message;
+	uptr_t wParam;
+	sptr_t lParam;
+};
+
+struct MessageBatch {
+	const BatchMessage *messages;
+	sptr_t *results;
+	sptr_t executed;
+};
+
 using SurfaceID = void *;
 
 struct Rectangle {
@@ -264,6 +264,7 @@ enum class AutoCompleteOption {
 	Normal = 0,
 	FixedSize = 1,
 	SelectFirstItem = 2,
+	FuzzyMatch = 4,
 };
 
 enum class IndentView {
@@ -290,6 +291,7 @@ enum class FindOption {
 	RegExp = 0x00200000,
 	Posix = 0x00400000,
 	Cxx11RegEx = 0x00800000,
+	Multiline = 0x01000000,
 };
 
 enum class ChangeHistoryOption {
@@ -19,6 +19,8 @@
 #include <optional>
 #include <algorithm>
 #include <memory>
+#include <thread>
+#include <future>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -38,6 +40,9 @@ AutoComplete::AutoComplete() :
 	active(false),
 	separator(' '),
 	typesep('?'),
+	keysFolded(false),
+	matchStart(0),
+	matchEnd(0),
 	ignoreCase(false),
 	chooseSingle(false),
 	options(AutoCompleteOption::Normal),
@@ -170,21 +175,217 @@ void FillSortMatrix(std::vector<int> &sortMatrix, int itemCount) {
 	}
 }
 
+std::string FoldKey(std::string_view text) {
+	std::string folded(text);
+	for (char &ch : folded) {
+		ch = MakeUpperCase(ch);
+	}
+	return folded;
+}
+
+std::string_view ItemText(const std::string &text, const std::vector<int> &starts, int item) noexcept {
+	return std::string_view(text).substr(starts[item], starts[item + 1] - starts[item]);
+}
+
+// Compare the start of an item's key with key in the same way as strncmp or, when folded,
+// CompareNCaseInsensitive so the order is the same as that used by Sorter.
+int ComparePrefix(std::string_view itemKey, std::string_view key, bool folded) noexcept {
+	const size_t len = std::min(itemKey.length(), key.length());
+	if (folded) {
+		for (size_t i = 0; i < len; i++) {
+			if (itemKey[i] != key[i])
+				return itemKey[i] - key[i];
+		}
+	} else {
+		const int cmp = itemKey.substr(0, len).compare(key.substr(0, len));
+		if (cmp != 0)
+			return cmp;
+	}
+	// An item shorter than the key sorts before it
+	return (itemKey.length() < key.length()) ? -1 : 0;
+}
+
+bool StartsWith(std::string_view text, std::string_view prefix) noexcept {
+	return (text.length() >= prefix.length()) && (text.substr(0, prefix.length()) == prefix);
+}
+
+bool IsSubWordStart(std::string_view word, size_t position) noexcept {
+	const unsigned char ch = word[position];
+	const unsigned char chPrev = word[position - 1];
+	return (!IsAlphaNumeric(chPrev) && IsAlphaNumeric(ch)) || (IsLowerCase(chPrev) && IsUpperCase(ch));
+}
+
+// Score key as a subsequence of an item: -1 if it does not occur, otherwise higher for
+// characters matched at the start of the item, consecutively, or at the start of a
+// sub-word like the 'B' in "fooBar" or "foo_bar". Shorter items win ties.
+int FuzzyScore(std::string_view itemKey, std::string_view word, std::string_view key) noexcept {
+	int score = 0;
+	size_t position = 0;
+	size_t previous = std::string_view::npos;
+	for (const char ch : key) {
+		position = itemKey.find(ch, position);
+		if (position == std::string_view::npos)
+			return -1;
+		score += 1;
+		if (position == 0) {
+			score += 8;
+		} else if (position == previous + 1) {
+			score += 6;
+		} else if (IsSubWordStart(word, position)) {
+			score += 4;
+		}
+		previous = position;
+		position++;
+	}
+	constexpr int lengthLimit = 1024;
+	return score * lengthLimit + lengthLimit - 1 - std::min(static_cast<int>(itemKey.length()), lengthLimit - 1);
+}
+
+struct FuzzyCandidate {
+	int score = -1;
+	int position = -1;
+	// Higher scores are better and earlier positions break ties
+	bool Better(const FuzzyCandidate &other) const noexcept {
+		return (score > other.score) || ((score == other.score) && (score >= 0) && (position < other.position));
+	}
+};
+
+// Below this number of items, ranking is performed on the calling thread
+constexpr int itemsPerFuzzyThread = 20000;
+
+}
+
+void AutoComplete::SetWords(const char *list) {
+	// Split the list in the same way as the ListBox implementations with the item text
+	// ending at the last type separator.
+	words.clear();
+	wordStarts.clear();
+	imageTypes.clear();
+	const std::string_view listView(list);
+	size_t start = 0;
+	while (true) {
+		const size_t end = std::min(listView.find(separator, start), listView.length());
+		const std::string_view item = listView.substr(start, end - start);
+		const size_t typePosition = item.rfind(typesep);
+		wordStarts.push_back(static_cast<int>(words.length()));
+		words.append(item.substr(0, typePosition));
+		int imageType = -1;
+		if (typePosition != std::string_view::npos) {
+			imageType = 0;
+			for (const char ch : item.substr(typePosition + 1)) {
+				if (!IsADigit(ch))
+					break;
+				imageType = imageType * 10 + ch - '0';
+			}
+		}
+		imageTypes.push_back(imageType);
+		if (end == listView.length())
+			break;
+		start = end + 1;
+	}
+	wordStarts.push_back(static_cast<int>(words.length()));
+	keys = ignoreCase ? FoldKey(words) : std::string();
+	keysFolded = ignoreCase;
+}
+
+void AutoComplete::ShowItems(const char *list) {
+	if (!lb->SetSource(this)) {
+		lb->SetList(list, separator, typesep);
+	}
+	ResetMatches();
+}
+
+void AutoComplete::ResetMatches() noexcept {
+	previousKey.clear();
+	matchStart = 0;
+	matchEnd = static_cast<int>(sortMatrix.size());
+}
+
+void AutoComplete::FindMatches(const std::string &key) {
+	if (keysFolded != ignoreCase) {
+		// Case sensitivity changed so start again
+		keys = ignoreCase ? FoldKey(words) : std::string();
+		keysFolded = ignoreCase;
+		ResetMatches();
+	}
+	if (!StartsWith(key, previousKey)) {
+		ResetMatches();
+	}
+	const std::string &text = keysFolded ? keys : words;
+	const std::string_view keyView(key);
+	const bool folded = keysFolded;
+	const auto first = sortMatrix.begin() + matchStart;
+	const auto last = sortMatrix.begin() + matchEnd;
+	const auto itStart = std::partition_point(first, last, [&](int item) noexcept {
+		return ComparePrefix(ItemText(text, wordStarts, item), keyView, folded) < 0;
+	});
+	const auto itEnd = std::partition_point(itStart, last, [&](int item) noexcept {
+		return ComparePrefix(ItemText(text, wordStarts, item), keyView, folded) == 0;
+	});
+	matchStart = static_cast<int>(itStart - sortMatrix.begin());
+	matchEnd = static_cast<int>(itEnd - sortMatrix.begin());
+	previousKey = key;
+}
+
+int AutoComplete::FuzzyMatch(const std::string &key) const {
+	if (key.empty())
+		return -1;
+	const std::string &text = keysFolded ? keys : words;
+	const int length = static_cast<int>(sortMatrix.size());
+	auto rankRange = [&](int rangeStart, int rangeEnd) noexcept {
+		FuzzyCandidate best;
+		for (int position = rangeStart; position < rangeEnd; position++) {
+			const int item = sortMatrix[position];
+			const FuzzyCandidate candidate {
+				FuzzyScore(ItemText(text, wordStarts, item), ItemText(words, wordStarts, item), key),
+				position
+			};
+			if (candidate.Better(best))
+				best = candidate;
+		}
+		return best;
+	};
+
+	// Large lists are divided between worker threads which each find their best candidate
+	const int threads = std::clamp(length / itemsPerFuzzyThread,
+		1, static_cast<int>(std::max(1U, std::thread::hardware_concurrency())));
+	if (threads == 1) {
+		return rankRange(0, length).position;
+	}
+	const int rangeLength = (length + threads - 1) / threads;
+	std::vector<std::future<FuzzyCandidate>> futures;
+	for (int th = 0; th < threads; th++) {
+		const int rangeStart = th * rangeLength;
+		const int rangeEnd = std::min(rangeStart + rangeLength, length);
+		futures.push_back(std::async(std::launch::async, rankRange, rangeStart, rangeEnd));
+	}
+	FuzzyCandidate best;
+	for (std::future<FuzzyCandidate> &f : futures) {
+		const FuzzyCandidate candidate = f.get();
+		if (candidate.Better(best))
+			best = candidate;
+	}
+	return best.position;
 }
 
 void AutoComplete::SetList(const char *list) {
 	if (autoSort == Ordering::PreSorted) {
-		lb->SetList(list, separator, typesep);
-		FillSortMatrix(sortMatrix, lb->Length());
+		SetWords(list);
+		FillSortMatrix(sortMatrix, Count());
+		ShowItems(list);
 		return;
 	}
 
 	const Sorter IndexSort(this, list);
 	FillSortMatrix(sortMatrix, static_cast<int>(IndexSort.indices.size() / 2));
-	std::sort(sortMatrix.begin(), sortMatrix.end(), IndexSort);
+	// Compare through a reference as std::sort copies its comparator and Sorter holds a vector
+	std::sort(sortMatrix.begin(), sortMatrix.end(), [&IndexSort](int a, int b) noexcept {
+		return IndexSort(a, b);
+	});
 	if (autoSort == Ordering::Custom || sortMatrix.size() < 2) {
-		lb->SetList(list, separator, typesep);
-		PLATFORM_ASSERT(lb->Length() == static_cast<int>(sortMatrix.size()));
+		SetWords(list);
+		PLATFORM_ASSERT(Count() == static_cast<int>(sortMatrix.size()));
+		ShowItems(list);
 		return;
 	}
 
@@ -208,7 +409,20 @@ void AutoComplete::SetList(const char *list) {
 			}
 		}
 	}
-	lb->SetList(sortedList.c_str(), separator, typesep);
+	SetWords(sortedList.c_str());
+	ShowItems(sortedList.c_str());
+}
+
+int AutoComplete::Count() const noexcept {
+	return static_cast<int>(imageTypes.size());
+}
+
+std::string_view AutoComplete::Text(int item) const noexcept {
+	return ItemText(words, wordStarts, item);
+}
+
+int AutoComplete::ImageType(int item) const noexcept {
+	return imageTypes[item];
 }
 
 int AutoComplete::GetSelection() const {
@@ -216,6 +430,9 @@ int AutoComplete::GetSelection() const {
 }
 
 std::string AutoComplete::GetValue(int item) const {
+	if (item >= 0 && item < Count()) {
+		return std::string(Text(item));
+	}
 	return lb->GetValue(item);
 }
 
@@ -231,6 +448,7 @@ void AutoComplete::Cancel() noexcept {
 		lb->Destroy();
 		active = false;
 	}
+	ResetMatches();
 }
 
 
@@ -246,49 +464,30 @@ void AutoComplete::Move(int delta) {
 }
 
 void AutoComplete::Select(const char *word) {
-	const size_t lenWord = strlen(word);
+	const std::string_view wordView(word);
+	FindMatches(ignoreCase ? FoldKey(wordView) : std::string(wordView));
 	int location = -1;
-	int start = 0; // lower bound of the api array block to search
-	int end = lb->Length() - 1; // upper bound of the api array block to search
-	while ((start <= end) && (location == -1)) { // Binary searching loop
-		int pivot = (start + end) / 2;
-		std::string item = GetValue(sortMatrix[pivot]);
-		int cond;
-		if (ignoreCase)
-			cond = CompareNCaseInsensitive(word, item.c_str(), lenWord);
-		else
-			cond = strncmp(word, item.c_str(), lenWord);
-		if (!cond) {
-			// Find first match
-			while (pivot > start) {
-				item = lb->GetValue(sortMatrix[pivot-1]);
-				if (ignoreCase)
-					cond = CompareNCaseInsensitive(word, item.c_str(), lenWord);
-				else
-					cond = strncmp(word, item.c_str(), lenWord);
-				if (0 != cond)
+	if (matchStart < matchEnd) {
+		location = matchStart;
+		if (ignoreCase
+			&& ignoreCaseBehaviour == CaseInsensitiveBehaviour::RespectCase) {
+			// Check for exact-case match
+			for (int pivot = matchStart; pivot < matchEnd; pivot++) {
+				if (StartsWith(ItemText(words, wordStarts, sortMatrix[pivot]), wordView)) {
+					location = pivot;
 					break;
-				--pivot;
-			}
-			location = pivot;
-			if (ignoreCase
-				&& ignoreCaseBehaviour == CaseInsensitiveBehaviour::RespectCase) {
-				// Check for exact-case match
-				for (; pivot <= end; pivot++) {
-					item = lb->GetValue(sortMatrix[pivot]);
-					if (!strncmp(word, item.c_str(), lenWord)) {
-						location = pivot;
-						break;
-					}
-					if (CompareNCaseInsensitive(word, item.c_str(), lenWord))
-						break;
 				}
 			}
-		} else if (cond < 0) {
-			end = pivot - 1;
-		} else { // cond > 0
-			start = pivot + 1;
 		}
+		if (autoSort == Ordering::Custom) {
+			// Check for a logically earlier match
+			for (int i = location + 1; i < matchEnd; ++i) {
+				if (sortMatrix[i] < sortMatrix[location] && StartsWith(ItemText(words, wordStarts, sortMatrix[i]), wordView))
+					location = i;
+			}
+		}
+	} else if (FlagSet(options, AutoCompleteOption::FuzzyMatch)) {
+		location = FuzzyMatch(previousKey);
 	}
 	if (location == -1) {
 		if (autoHide)
@@ -296,17 +495,6 @@ void AutoComplete::Select(const char *word) {
 		else
 			lb->Select(-1);
 	} else {
-		if (autoSort == Ordering::Custom) {
-			// Check for a logically earlier match
-			for (int i = location + 1; i <= end; ++i) {
-				const std::string item = lb->GetValue(sortMatrix[i]);
-				if (CompareNCaseInsensitive(word, item.c_str(), lenWord))
-					break;
-				if (sortMatrix[i] < sortMatrix[location] && !strncmp(word, item.c_str(), lenWord))
-					location = i;
-			}
-		}
 		lb->Select(sortMatrix[location]);
 	}
 }
-
@@ -12,13 +12,32 @@ namespace Scintilla::Internal {
 
 /**
  */
-class AutoComplete {
+class AutoComplete : public IListBoxSource {
 	bool active;
 	std::string stopChars;
 	std::string fillUpChars;
 	char separator;
 	char typesep; // Type separator
 	std::vector<int> sortMatrix;
+	// Text of each item, in list box order, with the start of each item in
+	// wordStarts so Select does not have to retrieve items from the list box.
+	// keys holds the same text folded to upper case when ignoring case.
+	std::string words;
+	std::string keys;
+	std::vector<int> wordStarts;
+	std::vector<int> imageTypes;
+	bool keysFolded;
+	// Range of sortMatrix that matched the previous key. When more characters
+	// are typed, only this range is searched.
+	std::string previousKey;
+	int matchStart;
+	int matchEnd;
+
+	void SetWords(const char *list);
+	void ShowItems(const char *list);
+	void ResetMatches() noexcept;
+	void FindMatches(const std::string &key);
+	int FuzzyMatch(const std::string &key) const;
 
 public:
 
@@ -82,6 +101,11 @@ public:
 	/// Return the value of an item in the list
 	std::string GetValue(int item) const;
 
+	/// Items are provided to the list box through IListBoxSource
+	int Count() const noexcept override;
+	std::string_view Text(int item) const noexcept override;
+	int ImageType(int item) const noexcept override;
+
 	void Show(bool show);
 	void Cancel() noexcept;
 
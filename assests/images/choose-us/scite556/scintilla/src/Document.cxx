@@ -133,6 +133,232 @@ size_t ActionDuration::ActionsInAllowedTime(double secondsAllowed) const noexcep
 	return std::lround(secondsAllowed / Duration());
 }
 
+MinimumTree::MinimumTree() : levels(1) {
+}
+
+void MinimumTree::Update(size_t index) {
+	// Recalculate the ancestors of index and trim each level to cover the level below
+	size_t level = 1;
+	for (; levels[level - 1].size() > 1; level++) {
+		if (levels.size() <= level) {
+			levels.emplace_back();
+		}
+		const std::vector<int> &below = levels[level - 1];
+		std::vector<int> &above = levels[level];
+		const size_t parent = index / 2;
+		int value = below[parent * 2];
+		if (parent * 2 + 1 < below.size()) {
+			value = std::min(value, below[parent * 2 + 1]);
+		}
+		above.resize((below.size() + 1) / 2);
+		above[parent] = value;
+		index = parent;
+	}
+	levels.resize(level);
+}
+
+size_t MinimumTree::Length() const noexcept {
+	return levels[0].size();
+}
+
+int MinimumTree::ValueAt(size_t index) const noexcept {
+	return levels[0][index];
+}
+
+void MinimumTree::Push(int value) {
+	levels[0].push_back(value);
+	Update(levels[0].size() - 1);
+}
+
+void MinimumTree::Truncate(size_t length) noexcept {
+	if (length < levels[0].size()) {
+		levels[0].resize(length);
+		if (length == 0) {
+			levels.resize(1);
+		} else {
+			// Only shrinks vectors so does not throw
+			Update(length - 1);
+		}
+	}
+}
+
+// Return the index of the first value at or after start that is less than threshold, or -1.
+ptrdiff_t MinimumTree::FirstBelow(size_t start, int threshold) const noexcept {
+	size_t level = 0;
+	size_t index = start;
+	for (;;) {
+		if (index >= levels[level].size()) {
+			return -1;
+		}
+		if (levels[level][index] < threshold) {
+			break;
+		}
+		index++;
+		// A left child starts a larger range that can be skipped at once
+		while (((index % 2) == 0) && (level + 1 < levels.size())) {
+			index /= 2;
+			level++;
+		}
+	}
+	while (level > 0) {
+		level--;
+		index *= 2;
+		if (levels[level][index] >= threshold) {
+			index++;
+		}
+	}
+	return index;
+}
+
+// Return the index of the last value before end that is not more than threshold, or -1.
+ptrdiff_t MinimumTree::LastAtMost(size_t end, int threshold) const noexcept {
+	if (end == 0) {
+		return -1;
+	}
+	size_t level = 0;
+	size_t index = std::min(end, levels[0].size()) - 1;
+	for (;;) {
+		if (levels[level][index] <= threshold) {
+			break;
+		}
+		if (index == 0) {
+			return -1;
+		}
+		index--;
+		// A right child ends a larger range that can be skipped at once
+		while (((index % 2) == 1) && (level + 1 < levels.size())) {
+			index /= 2;
+			level++;
+		}
+	}
+	while (level > 0) {
+		level--;
+		index = index * 2 + 1;
+		if ((index >= levels[level].size()) || (levels[level][index] > threshold)) {
+			index--;
+		}
+	}
+	return index;
+}
+
+namespace {
+
+// Opening braces are even and closing braces odd with the pair of each type adjacent
+constexpr int BraceKind(char ch) noexcept {
+	switch (ch) {
+	case '(':
+		return 0;
+	case ')':
+		return 1;
+	case '[':
+		return 2;
+	case ']':
+		return 3;
+	case '{':
+		return 4;
+	case '}':
+		return 5;
+	case '<':
+		return 6;
+	case '>':
+		return 7;
+	default:
+		return -1;
+	}
+}
+
+constexpr int BraceKey(int kind, int style) noexcept {
+	return (kind / 2) * 0x100 + style;
+}
+
+}
+
+Sci::Position BraceIndex::End() const noexcept {
+	return end;
+}
+
+void BraceIndex::Truncate(Sci::Position position) noexcept {
+	if (position < end) {
+		for (std::pair<const int, Braces> &group : braces) {
+			std::vector<Sci::Position> &positions = group.second.positions;
+			const std::vector<Sci::Position>::iterator it = std::lower_bound(positions.begin(), positions.end(), position);
+			const size_t length = it - positions.begin();
+			positions.resize(length);
+			group.second.depths.Truncate(length);
+		}
+		end = position;
+	}
+}
+
+void BraceIndex::Extend(const Document *pdoc, Sci::Position position) {
+	constexpr Sci::Position blockSize = 0x10000;
+	std::vector<char> chars;
+	std::vector<unsigned char> styles;
+	int keyLast = -1;
+	Braces *group = nullptr;
+	while (end < position) {
+		const Sci::Position lengthBlock = std::min(blockSize, position - end);
+		chars.resize(lengthBlock);
+		styles.resize(lengthBlock);
+		pdoc->GetCharRange(chars.data(), end, lengthBlock);
+		pdoc->GetStyleRange(styles.data(), end, lengthBlock);
+		for (Sci::Position i = 0; i < lengthBlock; i++) {
+			const int kind = BraceKind(chars[i]);
+			if (kind >= 0) {
+				const int key = BraceKey(kind, styles[i]);
+				if (key != keyLast) {
+					group = &braces[key];
+					keyLast = key;
+				}
+				const int depthBefore = group->positions.empty() ? 0 : group->depths.ValueAt(group->depths.Length() - 1);
+				group->positions.push_back(end + i);
+				group->depths.Push(depthBefore + (((kind % 2) == 0) ? 1 : -1));
+			}
+		}
+		end += lengthBlock;
+	}
+}
+
+// Find the brace matching the brace at position, returning -1 when there is none.
+// When the match may be after the index, returns no value and sets positionScan and depth to
+// continue scanning forward from the end of the index.
+std::optional<Sci::Position> BraceIndex::Match(Sci::Position position, char chBrace, int style,
+	Sci::Position &positionScan, int &depth) const noexcept {
+	const int kind = BraceKind(chBrace);
+	const std::map<int, Braces>::const_iterator it = braces.find(BraceKey(kind, style));
+	if ((kind < 0) || (it == braces.end())) {
+		return {};
+	}
+	const std::vector<Sci::Position> &positions = it->second.positions;
+	const MinimumTree &depths = it->second.depths;
+	const std::vector<Sci::Position>::const_iterator itBrace = std::lower_bound(positions.begin(), positions.end(), position);
+	if ((itBrace == positions.end()) || (*itBrace != position)) {
+		return {};
+	}
+	const size_t index = itBrace - positions.begin();
+	const int depthBrace = depths.ValueAt(index);
+	if ((kind % 2) == 0) {
+		// Opening brace matches the first later brace that returns to the depth before it
+		const ptrdiff_t closing = depths.FirstBelow(index + 1, depthBrace);
+		if (closing >= 0) {
+			return positions[closing];
+		}
+		positionScan = end;
+		depth = depths.ValueAt(depths.Length() - 1) - depthBrace + 1;
+		return {};
+	}
+	// Closing brace matches the brace after the last earlier brace at the depth after it
+	const ptrdiff_t before = depths.LastAtMost(index, depthBrace);
+	if (before >= 0) {
+		return positions[before + 1];
+	}
+	if (depthBrace >= 0) {
+		// Matches the first brace as the depth before the document start is 0
+		return positions[0];
+	}
+	return -1;
+}
+
 const CharacterExtracted characterEmpty(unicodeReplacementChar, 0);
 const CharacterExtracted characterBadByte(unicodeReplacementChar, 1);
 
@@ -268,6 +494,7 @@ bool Document::SetDBCSCodePage(int dbcsCodePage_) {
 	if (dbcsCodePage != dbcsCodePage_) {
 		dbcsCodePage = dbcsCodePage_;
 		SetCaseFolder(nullptr);
+		wordClassRuns.Clear();
 		cb.SetLineEndTypes(lineEndBitSet & LineEndTypesSupported());
 		cb.SetUTF8Substance(CpUtf8 == dbcsCodePage);
 		ModifiedAt(0);	// Need to restyle whole document
@@ -283,6 +510,8 @@ bool Document::SetLineEndTypesAllowed(LineEndType lineEndBitSet_) {
 		const LineEndType lineEndBitSetActive = lineEndBitSet & LineEndTypesSupported();
 		if (lineEndBitSetActive != cb.GetLineEndTypes()) {
 			ModifiedAt(0);
+			// Lines are split differently so cached runs would apply to the wrong line
+			wordClassRuns.Clear();
 			cb.SetLineEndTypes(lineEndBitSetActive);
 			return true;
 		} else {
@@ -1414,6 +1643,8 @@ EncodingFamily Document::CodePageFamily() const noexcept {
 void Document::ModifiedAt(Sci::Position pos) noexcept {
 	if (endStyled > pos)
 		endStyled = pos;
+	if (braceIndex)
+		braceIndex->Truncate(endStyled);
 }
 
 void Document::CheckReadOnly() {
@@ -2052,6 +2283,135 @@ CharacterClass Document::WordCharacterClass(unsigned int ch) const {
 	return charClass.GetClass(static_cast<unsigned char>(ch));
 }
 
+void WordClassRuns::Clear() noexcept {
+	line = -1;
+	starts.clear();
+	classes.clear();
+}
+
+size_t WordClassRuns::RunFromPosition(Sci::Position pos) const noexcept {
+	// Last element of starts is the line end so is never the start of a run
+	const auto it = std::upper_bound(starts.begin(), starts.end() - 1, pos);
+	return std::max<ptrdiff_t>(it - starts.begin() - 1, 0);
+}
+
+CharacterClass WordClassRuns::ClassAt(Sci::Position pos) const noexcept {
+	return classes[RunFromPosition(pos)];
+}
+
+/**
+ * Move over the run of ccSkip characters after pos (delta >= 0) or before pos (delta < 0)
+ * stopping at the ends of the line.
+ */
+Sci::Position WordClassRuns::Skip(Sci::Position pos, int delta, CharacterClass ccSkip) const noexcept {
+	if (delta < 0) {
+		if (pos <= starts.front())
+			return pos;
+		const size_t run = RunFromPosition(pos - 1);
+		return (classes[run] == ccSkip) ? starts[run] : pos;
+	}
+	if (pos >= starts.back())
+		return pos;
+	const size_t run = RunFromPosition(pos);
+	return (classes[run] == ccSkip) ? starts[run + 1] : pos;
+}
+
+namespace {
+
+// Lines shorter than this are quick to classify character by character so are not cached
+constexpr Sci::Position lengthWordClassRuns = 1000;
+
+}
+
+/**
+ * Return the character class runs of a line if they are cached. When build is true, they are
+ * calculated for long lines that are not currently cached.
+ */
+const WordClassRuns *Document::WordClassesOfLine(Sci::Line line, bool build) const {
+	if (wordClassRuns.line == line)
+		return &wordClassRuns;
+	if (!build)
+		return nullptr;
+	const Sci::Position lineStart = LineStart(line);
+	const Sci::Position lineEnd = LineStart(line + 1);
+	if (lineEnd - lineStart < lengthWordClassRuns)
+		return nullptr;
+	wordClassRuns.Clear();
+	Sci::Position pos = lineStart;
+	while (pos < lineEnd) {
+		const CharacterExtracted ce = CharacterAfter(pos);
+		const CharacterClass cc = WordCharacterClass(ce.character);
+		if (wordClassRuns.classes.empty() || (wordClassRuns.classes.back() != cc)) {
+			wordClassRuns.starts.push_back(pos);
+			wordClassRuns.classes.push_back(cc);
+		}
+		pos += ce.widthBytes;
+	}
+	wordClassRuns.starts.push_back(lineEnd);
+	wordClassRuns.line = line;
+	return &wordClassRuns;
+}
+
+CharacterClass Document::WordClassAfter(Sci::Position pos) const {
+	const WordClassRuns *runs = WordClassesOfLine(SciLineFromPosition(pos), false);
+	if (runs)
+		return runs->ClassAt(pos);
+	return WordCharacterClass(CharacterAfter(pos).character);
+}
+
+CharacterClass Document::WordClassBefore(Sci::Position pos) const {
+	const WordClassRuns *runs = WordClassesOfLine(SciLineFromPosition(pos - 1), false);
+	if (runs)
+		return runs->ClassAt(pos - 1);
+	return WordCharacterClass(CharacterBefore(pos).character);
+}
+
+/**
+ * Move over characters of class ccSkip forwards (delta >= 0) or backwards (delta < 0).
+ * Long lines are traversed a run at a time.
+ */
+Sci::Position Document::SkipWordClass(Sci::Position pos, int delta, CharacterClass ccSkip) const {
+	if (delta < 0) {
+		while (pos > 0) {
+			const Sci::Line line = SciLineFromPosition(pos - 1);
+			const Sci::Position lineStart = LineStart(line);
+			const WordClassRuns *runs = WordClassesOfLine(line, true);
+			if (runs) {
+				pos = runs->Skip(pos, delta, ccSkip);
+			} else {
+				while (pos > lineStart) {
+					const CharacterExtracted ce = CharacterBefore(pos);
+					if (WordCharacterClass(ce.character) != ccSkip)
+						break;
+					pos -= ce.widthBytes;
+				}
+			}
+			if (pos > lineStart)
+				break;
+		}
+	} else {
+		const Sci::Position length = LengthNoExcept();
+		while (pos < length) {
+			const Sci::Line line = SciLineFromPosition(pos);
+			const Sci::Position lineEnd = LineStart(line + 1);
+			const WordClassRuns *runs = WordClassesOfLine(line, true);
+			if (runs) {
+				pos = runs->Skip(pos, delta, ccSkip);
+			} else {
+				while (pos < lineEnd) {
+					const CharacterExtracted ce = CharacterAfter(pos);
+					if (WordCharacterClass(ce.character) != ccSkip)
+						break;
+					pos += ce.widthBytes;
+				}
+			}
+			if (pos < lineEnd)
+				break;
+		}
+	}
+	return pos;
+}
+
 /**
  * Used by commands that want to select whole words.
  * Finds the start of word at pos when delta < 0 or the end of the word when delta >= 0.
@@ -2059,28 +2419,15 @@ CharacterClass Document::WordCharacterClass(unsigned int ch) const {
 Sci::Position Document::ExtendWordSelect(Sci::Position pos, int delta, bool onlyWordCharacters) const {
 	CharacterClass ccStart = CharacterClass::word;
 	if (delta < 0) {
-		if (!onlyWordCharacters) {
-			const CharacterExtracted ce = CharacterBefore(pos);
-			ccStart = WordCharacterClass(ce.character);
-		}
-		while (pos > 0) {
-			const CharacterExtracted ce = CharacterBefore(pos);
-			if (WordCharacterClass(ce.character) != ccStart)
-				break;
-			pos -= ce.widthBytes;
+		if (!onlyWordCharacters && pos > 0) {
+			ccStart = WordClassBefore(pos);
 		}
 	} else {
 		if (!onlyWordCharacters && pos < LengthNoExcept()) {
-			const CharacterExtracted ce = CharacterAfter(pos);
-			ccStart = WordCharacterClass(ce.character);
-		}
-		while (pos < LengthNoExcept()) {
-			const CharacterExtracted ce = CharacterAfter(pos);
-			if (WordCharacterClass(ce.character) != ccStart)
-				break;
-			pos += ce.widthBytes;
+			ccStart = WordClassAfter(pos);
 		}
 	}
+	pos = SkipWordClass(pos, delta, ccStart);
 	return MovePositionOutsideChar(pos, delta, true);
 }
 
@@ -2093,37 +2440,15 @@ Sci::Position Document::ExtendWordSelect(Sci::Position pos, int delta, bool only
  */
 Sci::Position Document::NextWordStart(Sci::Position pos, int delta) const {
 	if (delta < 0) {
-		while (pos > 0) {
-			const CharacterExtracted ce = CharacterBefore(pos);
-			if (WordCharacterClass(ce.character) != CharacterClass::space)
-				break;
-			pos -= ce.widthBytes;
-		}
+		pos = SkipWordClass(pos, delta, CharacterClass::space);
 		if (pos > 0) {
-			CharacterExtracted ce = CharacterBefore(pos);
-			const CharacterClass ccStart = WordCharacterClass(ce.character);
-			while (pos > 0) {
-				ce = CharacterBefore(pos);
-				if (WordCharacterClass(ce.character) != ccStart)
-					break;
-				pos -= ce.widthBytes;
-			}
+			pos = SkipWordClass(pos, delta, WordClassBefore(pos));
 		}
 	} else {
-		CharacterExtracted ce = CharacterAfter(pos);
-		const CharacterClass ccStart = WordCharacterClass(ce.character);
-		while (pos < LengthNoExcept()) {
-			ce = CharacterAfter(pos);
-			if (WordCharacterClass(ce.character) != ccStart)
-				break;
-			pos += ce.widthBytes;
-		}
-		while (pos < LengthNoExcept()) {
-			ce = CharacterAfter(pos);
-			if (WordCharacterClass(ce.character) != CharacterClass::space)
-				break;
-			pos += ce.widthBytes;
+		if (pos < LengthNoExcept()) {
+			pos = SkipWordClass(pos, delta, WordClassAfter(pos));
 		}
+		pos = SkipWordClass(pos, delta, CharacterClass::space);
 	}
 	return pos;
 }
@@ -2138,39 +2463,16 @@ Sci::Position Document::NextWordStart(Sci::Position pos, int delta) const {
 Sci::Position Document::NextWordEnd(Sci::Position pos, int delta) const {
 	if (delta < 0) {
 		if (pos > 0) {
-			CharacterExtracted ce = CharacterBefore(pos);
-			const CharacterClass ccStart = WordCharacterClass(ce.character);
+			const CharacterClass ccStart = WordClassBefore(pos);
 			if (ccStart != CharacterClass::space) {
-				while (pos > 0) {
-					ce = CharacterBefore(pos);
-					if (WordCharacterClass(ce.character) != ccStart)
-						break;
-					pos -= ce.widthBytes;
-				}
-			}
-			while (pos > 0) {
-				ce = CharacterBefore(pos);
-				if (WordCharacterClass(ce.character) != CharacterClass::space)
-					break;
-				pos -= ce.widthBytes;
+				pos = SkipWordClass(pos, delta, ccStart);
 			}
+			pos = SkipWordClass(pos, delta, CharacterClass::space);
 		}
 	} else {
-		while (pos < LengthNoExcept()) {
-			const CharacterExtracted ce = CharacterAfter(pos);
-			if (WordCharacterClass(ce.character) != CharacterClass::space)
-				break;
-			pos += ce.widthBytes;
-		}
+		pos = SkipWordClass(pos, delta, CharacterClass::space);
 		if (pos < LengthNoExcept()) {
-			CharacterExtracted ce = CharacterAfter(pos);
-			const CharacterClass ccStart = WordCharacterClass(ce.character);
-			while (pos < LengthNoExcept()) {
-				ce = CharacterAfter(pos);
-				if (WordCharacterClass(ce.character) != ccStart)
-					break;
-				pos += ce.widthBytes;
-			}
+			pos = SkipWordClass(pos, delta, WordClassAfter(pos));
 		}
 	}
 	return pos;
@@ -2193,11 +2495,9 @@ bool Document::IsWordStartAt(Sci::Position pos) const {
 	if (pos >= LengthNoExcept())
 		return false;
 	if (pos >= 0) {
-		const CharacterExtracted cePos = CharacterAfter(pos);
 		// At start of document, treat as if space before so can be word start
-		const CharacterExtracted cePrev = (pos > 0) ?
-			CharacterBefore(pos) : CharacterExtracted(' ', 1);
-		return IsWordEdge(WordCharacterClass(cePos.character), WordCharacterClass(cePrev.character));
+		const CharacterClass ccPrev = (pos > 0) ? WordClassBefore(pos) : CharacterClass::space;
+		return IsWordEdge(WordClassAfter(pos), ccPrev);
 	}
 	return true;
 }
@@ -2211,10 +2511,8 @@ bool Document::IsWordEndAt(Sci::Position pos) const {
 		return false;
 	if (pos <= LengthNoExcept()) {
 		// At end of document, treat as if space after so can be word end
-		const CharacterExtracted cePos = (pos < LengthNoExcept()) ?
-			CharacterAfter(pos) : CharacterExtracted(' ', 1);
-		const CharacterExtracted cePrev = CharacterBefore(pos);
-		return IsWordEdge(WordCharacterClass(cePrev.character), WordCharacterClass(cePos.character));
+		const CharacterClass ccPos = (pos < LengthNoExcept()) ? WordClassAfter(pos) : CharacterClass::space;
+		return IsWordEdge(WordClassBefore(pos), ccPos);
 	}
 	return true;
 }
@@ -2288,6 +2586,37 @@ bool SplitMatch(const SplitView &view, size_t start, std::string_view text) noex
 
 }
 
+/**
+ * Find all matches of text from the start of the range to its end in one call.
+ * Regular expressions are only compiled once.
+ */
+std::vector<Range> Document::FindAll(Sci::Position minPos, Sci::Position maxPos, const char *search,
+                        FindOption flags, Sci::Position length) {
+	std::vector<Range> matches;
+	if (length <= 0)
+		return matches;
+	const Sci::Position startPos = std::min(minPos, maxPos);
+	const Sci::Position endPos = std::max(minPos, maxPos);
+	if (FlagSet(flags, FindOption::RegExp)) {
+		if (!regex)
+			regex = std::unique_ptr<RegexSearchBase>(CreateRegexSearch(&charClass));
+		regex->FindAll(this, startPos, endPos, search, FlagSet(flags, FindOption::MatchCase),
+			FlagSet(flags, FindOption::WholeWord), FlagSet(flags, FindOption::WordStart), flags, length, matches);
+	} else {
+		Sci::Position pos = startPos;
+		while (pos < endPos) {
+			Sci::Position lengthFound = length;
+			const Sci::Position found = FindText(pos, endPos, search, flags, &lengthFound);
+			if (found < 0) {
+				break;
+			}
+			matches.emplace_back(found, found + lengthFound);
+			pos = found + lengthFound;
+		}
+	}
+	return matches;
+}
+
 /**
  * Find text in document, supporting both forward and backward
  * searches (just pass minPos > maxPos to do a backward search)
@@ -2540,10 +2869,12 @@ void Document::AllocateLines(Sci::Line lines) {
 
 void Document::SetDefaultCharClasses(bool includeWordClass) {
 	charClass.SetDefaultCharClasses(includeWordClass);
+	wordClassRuns.Clear();
 }
 
 void Document::SetCharClasses(const unsigned char *chars, CharacterClass newCharClass) {
 	charClass.SetCharClasses(chars, newCharClass);
+	wordClassRuns.Clear();
 }
 
 int Document::GetCharsOfClass(CharacterClass characterClass, unsigned char *buffer) const {
@@ -2560,6 +2891,8 @@ int Document::CharacterCategoryOptimization() const noexcept {
 
 void SCI_METHOD Document::StartStyling(Sci_Position position) {
 	endStyled = position;
+	if (braceIndex)
+		braceIndex->Truncate(endStyled);
 }
 
 bool SCI_METHOD Document::SetStyleFor(Sci_Position length, char style) {
@@ -2822,6 +3155,31 @@ void SCI_METHOD Document::DecorationFillRange(Sci_Position position, int value,
 	}
 }
 
+// Fill many ranges with only one notification covering all the changes
+void Document::DecorationFillRanges(const std::vector<Range> &ranges, int value) {
+	Range changed(Sci::invalidPosition);
+	for (const Range &range : ranges) {
+		if (range.end > LengthNoExcept()) {
+			break;
+		}
+		const FillResult<Sci::Position> fr = decorations->FillRange(
+			range.start, value, range.Length());
+		if (fr.changed) {
+			if (!changed.Valid()) {
+				changed = Range(fr.position, fr.position + fr.fillLength);
+			} else {
+				changed.start = std::min(changed.start, fr.position);
+				changed.end = std::max(changed.end, fr.position + fr.fillLength);
+			}
+		}
+	}
+	if (changed.Valid()) {
+		const DocModification mh(ModificationFlags::ChangeIndicator | ModificationFlags::User,
+							changed.start, changed.Length());
+		NotifyModified(mh);
+	}
+}
+
 bool Document::AddWatcher(DocWatcher *watcher, void *userData) {
 	const WatcherWithUserData wwud(watcher, userData);
 	std::vector<WatcherWithUserData>::iterator it =
@@ -2869,8 +3227,10 @@ void Document::NotifyGroupCompleted() noexcept {
 void Document::NotifyModified(DocModification mh) {
 	if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
 		decorations->InsertSpace(mh.position, mh.length);
+		wordClassRuns.Clear();
 	} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
 		decorations->DeleteRange(mh.position, mh.length);
+		wordClassRuns.Clear();
 	}
 	for (const WatcherWithUserData &watcher : watchers) {
 		watcher.watcher->NotifyModified(this, mh, watcher.userData);
@@ -2986,6 +3346,9 @@ Sci::Position Document::ExtendStyleRange(Sci::Position pos, int delta, bool sing
 
 namespace {
 
+// Scans longer than this create a BraceIndex for the document
+constexpr Sci::Position lengthBraceScanForIndex = 0x10000;
+
 constexpr char BraceOpposite(char ch) noexcept {
 	switch (ch) {
 	case '(':
@@ -3022,6 +3385,7 @@ Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position /*maxRe
 	if (chBrace == '(' || chBrace == '[' || chBrace == '{' || chBrace == '<')
 		direction = 1;
 	int depth = 1;
+	const Sci::Position positionBrace = position;
 	position = useStartPos ? startPos : position + direction;
 
 	// Avoid using MovePositionOutsideChar to check DBCS trail byte
@@ -3030,19 +3394,72 @@ Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position /*maxRe
 		maxSafeChar = DBCSMinTrailByte() - 1;
 	}
 
+	// The index is only for single byte braces starting from the brace itself
+	const bool indexable = !useStartPos && (maxSafeChar == 0xff);
+	if (braceIndex && indexable) {
+		try {
+			// Matching backwards only needs the braces up to the brace
+			braceIndex->Extend(this, (direction > 0) ? endStyled : std::min(endStyled, positionBrace + 1));
+			if (positionBrace < braceIndex->End()) {
+				const std::optional<Sci::Position> match = braceIndex->Match(positionBrace, chBrace, styBrace, position, depth);
+				if (match) {
+					return *match;
+				}
+			}
+		} catch (...) {
+			// Failed to allocate so scan without the index
+			braceIndex.reset();
+		}
+	}
+
+	const Sci::Position positionScanStart = position;
+	Sci::Position match = -1;
 	while ((position >= 0) && (position < LengthNoExcept())) {
 		const unsigned char chAtPos = CharAt(position);
 		if (chAtPos == chBrace || chAtPos == chSeek) {
 			if (((position > GetEndStyled()) || (StyleIndexAt(position) == styBrace)) &&
 				(chAtPos <= maxSafeChar || position == MovePositionOutsideChar(position, direction, false))) {
 				depth += (chAtPos == chBrace) ? 1 : -1;
-				if (depth == 0)
-					return position;
+				if (depth == 0) {
+					match = position;
+					break;
+				}
 			}
 		}
 		position += direction;
 	}
-	return -1;
+
+	if (!braceIndex && indexable && (std::abs(position - positionScanStart) > lengthBraceScanForIndex)) {
+		// Long scans are likely to be repeated as the caret moves so index the braces for next time
+		try {
+			braceIndex = std::make_unique<BraceIndex>();
+		} catch (...) {
+			// Continue to scan without the index
+		}
+	}
+	return match;
+}
+
+void RegexSearchBase::FindAll(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+                        bool caseSensitive, bool word, bool wordStart, FindOption flags, Sci::Position length,
+                        std::vector<Range> &matches) {
+	Sci::Position pos = minPos;
+	for (;;) {
+		Sci::Position lengthFound = length;
+		const Sci::Position found = FindText(doc, pos, maxPos, s, caseSensitive, word, wordStart, flags, &lengthFound);
+		if (found < 0) {
+			break;
+		}
+		matches.emplace_back(found, found + lengthFound);
+		pos = found + lengthFound;
+		if (lengthFound == 0) {
+			// Empty match so move on to avoid finding it again
+			if (pos >= maxPos) {
+				break;
+			}
+			pos = doc->NextPosition(pos, 1);
+		}
+	}
 }
 
 /**
@@ -3058,6 +3475,10 @@ public:
 
 	const char *SubstituteByPosition(Document *doc, const char *text, Sci::Position *length) override;
 
+	void FindAll(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+                        bool caseSensitive, bool word, bool wordStart, FindOption flags, Sci::Position length,
+                        std::vector<Range> &matches) override;
+
 private:
 	RESearch search;
 	std::string substituted;
@@ -3135,14 +3556,15 @@ public:
 	using pointer = char*;
 	using reference = char&;
 
-	const Document *doc;
+	// Read directly from the two halves of the buffer to avoid calls through Document
+	SplitView view;
 	Sci::Position position;
 
 	explicit ByteIterator(const Document *doc_=nullptr, Sci::Position position_=0) noexcept :
-		doc(doc_), position(position_) {
+		view(doc_ ? doc_->AllView() : SplitView()), position(position_) {
 	}
 	char operator*() const noexcept {
-		return doc->CharAt(position);
+		return view.CharAt(position);
 	}
 	ByteIterator &operator++() noexcept {
 		position++;
@@ -3158,10 +3580,10 @@ public:
 		return *this;
 	}
 	bool operator==(const ByteIterator &other) const noexcept {
-		return doc == other.doc && position == other.position;
+		return view.segment1 == other.view.segment1 && position == other.position;
 	}
 	bool operator!=(const ByteIterator &other) const noexcept {
-		return doc != other.doc || position != other.position;
+		return view.segment1 != other.view.segment1 || position != other.position;
 	}
 	[[nodiscard]] Sci::Position Pos() const noexcept {
 		return position;
@@ -3399,20 +3821,137 @@ bool MatchOnLines(const Document *doc, const Regex &regexp, const RESearchRange
 	return matched;
 }
 
-Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
-	bool caseSensitive, Sci::Position *length, RESearch &search) {
-	const RESearchRange resr(doc, minPos, maxPos);
-	try {
-		//ElapsedPeriod ep;
-		std::regex::flag_type flagsRe = std::regex::ECMAScript;
-		// Flags that appear to have no effect:
-		// | std::regex::collate | std::regex::extended;
-		if (!caseSensitive)
-			flagsRe = flagsRe | std::regex::icase;
+// MSVC treats all regular expressions as multiline and libstdc++ implements std::regex::multiline
+// so ^ and $ match at line ends inside a range. libc++ only matches them at the ends of the range.
+#if defined(_MSC_VER) || (defined(_GLIBCXX_RELEASE) && (_GLIBCXX_RELEASE >= 12))
+#define REGEX_LINE_ANCHORS 1
+#else
+#define REGEX_LINE_ANCHORS 0
+#endif
+
+// Positions between CR and LF can not start or end a match but ^ and $ treat CR
+// and LF as separate line ends.
+bool InsideCrLf(const Document *doc, Sci::Position position) noexcept {
+	return (position > 0) && doc->IsCrLf(position - 1);
+}
+
+template<typename Iterator, typename Regex>
+bool MatchAcrossLines(const Document *doc, const Regex &regexp, const RESearchRange &resr, RESearch &search) {
+	// Scan the whole range at once so matches may span lines and there is no per-line setup.
+	const Sci::Position rangeStart = std::min(resr.startPos, resr.endPos);
+	const Sci::Position rangeEnd = std::max(resr.startPos, resr.endPos);
+	const Sci::Position lineStartPos = doc->LineStart(doc->SciLineFromPosition(rangeStart));
+	const Sci::Position lineEndPos = doc->LineEnd(doc->SciLineFromPosition(rangeEnd));
+	const Iterator itStart(doc, rangeStart);
+	const Iterator itEnd(doc, rangeEnd);
+	const std::regex_constants::match_flag_type flagsMatch = MatchFlags(doc, rangeStart, rangeEnd, lineStartPos, lineEndPos);
+	std::match_results<Iterator> match;
+	bool matched = false;
+	std::regex_iterator<Iterator> it(itStart, itEnd, regexp, flagsMatch);
+	for (const std::regex_iterator<Iterator> last; it != last; ++it) {
+		const std::sub_match<Iterator> &whole = (*it)[0];
+		if (InsideCrLf(doc, whole.first.Pos()) || InsideCrLf(doc, whole.second.PosRoundUp())) {
+			continue;
+		}
+		match = *it;
+		matched = true;
+		if (resr.increment > 0) {
+			break;
+		}
+	}
+	if (matched) {
+		for (size_t co = 0; co < match.size() && co < RESearch::MAXTAG; co++) {
+			search.bopat[co] = match[co].first.Pos();
+			search.eopat[co] = match[co].second.PosRoundUp();
+		}
+	}
+	return matched;
+}
+
+// Without multiline support, patterns with anchors are only correct line by line
+bool SearchAcrossLines(bool multiLine, [[maybe_unused]] const char *s) noexcept {
+#if REGEX_LINE_ANCHORS
+	return multiLine;
+#else
+	return multiLine && std::string_view(s).find_first_of("^$") == std::string_view::npos;
+#endif
+}
+
+std::regex::flag_type RegexFlags(bool caseSensitive, [[maybe_unused]] bool multiLine) noexcept {
+	std::regex::flag_type flagsRe = std::regex::ECMAScript;
+	// Flags that appear to have no effect:
+	// | std::regex::collate | std::regex::extended;
+	if (!caseSensitive)
+		flagsRe = flagsRe | std::regex::icase;
 
 #if defined(REGEX_MULTILINE) && !defined(_MSC_VER)
+	flagsRe = flagsRe | std::regex::multiline;
+#elif REGEX_LINE_ANCHORS && !defined(_MSC_VER)
+	if (multiLine) {
 		flagsRe = flagsRe | std::regex::multiline;
+	}
 #endif
+	return flagsRe;
+}
+
+template<typename Iterator, typename Regex>
+void AllMatches(const Document *doc, const Regex &regexp, const RESearchRange &resr, bool multiLine, std::vector<Range> &matches) {
+	const auto addMatches = [doc, &regexp, &matches](Range range, Sci::Position lineStartPos, Sci::Position lineEndPos) {
+		const Iterator itStart(doc, range.start);
+		const Iterator itEnd(doc, range.end);
+		const std::regex_constants::match_flag_type flagsMatch = MatchFlags(doc, range.start, range.end, lineStartPos, lineEndPos);
+		std::regex_iterator<Iterator> it(itStart, itEnd, regexp, flagsMatch);
+		for (const std::regex_iterator<Iterator> last; it != last; ++it) {
+			const std::sub_match<Iterator> &whole = (*it)[0];
+			const Range found(whole.first.Pos(), whole.second.PosRoundUp());
+			if (!InsideCrLf(doc, found.start) && !InsideCrLf(doc, found.end)) {
+				matches.push_back(found);
+			}
+		}
+	};
+	if (multiLine) {
+		const Range range(resr.startPos, resr.endPos);
+		addMatches(range, doc->LineStart(resr.lineRangeStart), doc->LineEnd(resr.lineRangeEnd));
+	} else {
+		for (Sci::Line line = resr.lineRangeStart; line != resr.lineRangeBreak; line += resr.increment) {
+			const Sci::Position lineStartPos = doc->LineStart(line);
+			const Sci::Position lineEndPos = doc->LineEnd(line);
+			addMatches(resr.LineRange(line, lineStartPos, lineEndPos), lineStartPos, lineEndPos);
+		}
+	}
+}
+
+void Cxx11RegexFindAll(const Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+	bool caseSensitive, bool multiLine, std::vector<Range> &matches) {
+	const RESearchRange resr(doc, minPos, maxPos);
+	try {
+		const bool acrossLines = SearchAcrossLines(multiLine, s);
+		const std::regex::flag_type flagsRe = RegexFlags(caseSensitive, acrossLines);
+		if (CpUtf8 == doc->dbcsCodePage) {
+			const std::wstring ws = WStringFromUTF8(s);
+			std::wregex regexp;
+			regexp.assign(ws, flagsRe);
+			AllMatches<UTF8Iterator>(doc, regexp, resr, acrossLines, matches);
+		} else {
+			std::regex regexp;
+			regexp.assign(s, flagsRe);
+			AllMatches<ByteIterator>(doc, regexp, resr, acrossLines, matches);
+		}
+	} catch (std::regex_error &) {
+		// Failed to create regular expression
+		throw RegexError();
+	} catch (...) {
+		// Failed in some other way
+	}
+}
+
+Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+	bool caseSensitive, bool multiLine, Sci::Position *length, RESearch &search) {
+	const RESearchRange resr(doc, minPos, maxPos);
+	try {
+		//ElapsedPeriod ep;
+		multiLine = SearchAcrossLines(multiLine, s);
+		const std::regex::flag_type flagsRe = RegexFlags(caseSensitive, multiLine);
 
 		// Clear the RESearch so can fill in matches
 		search.Clear();
@@ -3422,11 +3961,15 @@ Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci:
 			const std::wstring ws = WStringFromUTF8(s);
 			std::wregex regexp;
 			regexp.assign(ws, flagsRe);
-			matched = MatchOnLines<UTF8Iterator>(doc, regexp, resr, search);
+			matched = multiLine ?
+				MatchAcrossLines<UTF8Iterator>(doc, regexp, resr, search) :
+				MatchOnLines<UTF8Iterator>(doc, regexp, resr, search);
 		} else {
 			std::regex regexp;
 			regexp.assign(s, flagsRe);
-			matched = MatchOnLines<ByteIterator>(doc, regexp, resr, search);
+			matched = multiLine ?
+				MatchAcrossLines<ByteIterator>(doc, regexp, resr, search) :
+				MatchOnLines<ByteIterator>(doc, regexp, resr, search);
 		}
 
 		Sci::Position posMatch = -1;
@@ -3453,6 +3996,53 @@ Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci:
 
 }
 
+void BuiltinRegex::FindAll(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+                        bool caseSensitive, bool, bool, FindOption flags, Sci::Position length,
+                        std::vector<Range> &matches) {
+
+#ifndef NO_CXX11_REGEX
+	if (FlagSet(flags, FindOption::Cxx11RegEx)) {
+		Cxx11RegexFindAll(doc, minPos, maxPos, s, caseSensitive, FlagSet(flags, FindOption::Multiline), matches);
+		return;
+	}
+#endif
+
+	const bool posix = FlagSet(flags, FindOption::Posix);
+	const char *errmsg = search.Compile(s, length, caseSensitive, posix, CpUtf8 == doc->dbcsCodePage);
+	if (errmsg) {
+		return;
+	}
+
+	// Compiled once then executed repeatedly along each line
+	const RESearchRange resr(doc, minPos, maxPos);
+	for (Sci::Line line = resr.lineRangeStart; line != resr.lineRangeBreak; line += resr.increment) {
+		const Sci::Position lineStartPos = doc->LineStart(line);
+		const Sci::Position lineEndPos = doc->LineEnd(line);
+		const Range lineRange = resr.LineRange(line, lineStartPos, lineEndPos);
+		const DocumentIndexer di(doc, lineRange.end);
+		search.SetLineRange(lineStartPos, lineEndPos);
+		Sci::Position pos = lineRange.start;
+		bool emptyAtEnd = false;
+		while (pos <= lineRange.end && search.Execute(di, pos, lineRange.end)) {
+			const Range found(search.bopat[0], search.eopat[0]);
+			matches.push_back(found);
+			if (found.end > found.start) {
+				pos = found.end;
+			} else if (found.end < lineRange.end) {
+				// Empty match so move on to avoid finding it again
+				pos = doc->NextPosition(found.end, 1);
+			} else {
+				emptyAtEnd = true;
+				break;
+			}
+		}
+		// Execute does not start matches at the end of the range so try for an empty match there
+		if (!emptyAtEnd && (pos <= lineRange.end) && search.ExecuteAt(di, lineRange.end, lineRange.end)) {
+			matches.push_back(Range(lineRange.end));
+		}
+	}
+}
+
 Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
                         bool caseSensitive, bool, bool, FindOption flags,
                         Sci::Position *length) {
@@ -3460,7 +4050,7 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 #ifndef NO_CXX11_REGEX
 	if (FlagSet(flags, FindOption::Cxx11RegEx)) {
 			return Cxx11RegexFindText(doc, minPos, maxPos, s,
-			caseSensitive, length, search);
+			caseSensitive, FlagSet(flags, FindOption::Multiline), length, search);
 	}
 #endif
 
@@ -3468,7 +4058,7 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 
 	const bool posix = FlagSet(flags, FindOption::Posix);
 
-	const char *errmsg = search.Compile(s, *length, caseSensitive, posix);
+	const char *errmsg = search.Compile(s, *length, caseSensitive, posix, CpUtf8 == doc->dbcsCodePage);
 	if (errmsg) {
 		return -1;
 	}
@@ -105,6 +105,12 @@ public:
 
 	///@return String with the substitutions, must remain valid until the next call or destruction
 	virtual const char *SubstituteByPosition(Document *doc, const char *text, Sci::Position *length) = 0;
+
+	/// Append every match from minPos up to maxPos to matches.
+	/// The default calls FindText repeatedly; implementations can override to compile only once.
+	virtual void FindAll(Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
+                        bool caseSensitive, bool word, bool wordStart, Scintilla::FindOption flags, Sci::Position length,
+                        std::vector<Range> &matches);
 };
 
 /// Factory function for RegexSearchBase
@@ -250,6 +256,45 @@ public:
 	size_t ActionsInAllowedTime(double secondsAllowed) const noexcept;
 };
 
+/**
+ * A sequence of values with the minimum of each pair, each pair of pairs, and so on, held in
+ * successive levels so that the first or last value past a threshold is found in logarithmic time.
+ */
+class MinimumTree {
+	std::vector<std::vector<int>> levels;
+	void Update(size_t index);
+public:
+	MinimumTree();
+	size_t Length() const noexcept;
+	int ValueAt(size_t index) const noexcept;
+	void Push(int value);
+	void Truncate(size_t length) noexcept;
+	ptrdiff_t FirstBelow(size_t start, int threshold) const noexcept;
+	ptrdiff_t LastAtMost(size_t end, int threshold) const noexcept;
+};
+
+/**
+ * The braces at the start of a document, up to a position that is never after the end of styling,
+ * so that a matching brace can be found without scanning the text in between.
+ * Braces are divided by type and style as only braces with the same type and style match.
+ * Each brace records the depth of nesting after it so a match is a search for a depth.
+ * Modifications and restyling invalidate the index from their position onwards.
+ */
+class BraceIndex {
+	struct Braces {
+		std::vector<Sci::Position> positions;
+		MinimumTree depths;
+	};
+	std::map<int, Braces> braces;
+	Sci::Position end = 0;
+public:
+	Sci::Position End() const noexcept;
+	void Truncate(Sci::Position position) noexcept;
+	void Extend(const Document *pdoc, Sci::Position position);
+	std::optional<Sci::Position> Match(Sci::Position position, char chBrace, int style,
+		Sci::Position &positionScan, int &depth) const noexcept;
+};
+
 /**
  * A whole character (code point) with a value and width in bytes.
  * For UTF-8, the value is the code point value.
@@ -275,6 +320,22 @@ struct CharacterExtracted {
 
 bool DiscardLastCombinedCharacter(std::string_view &text) noexcept;
 
+/**
+ * Character classes of one line held as runs so that word movement over long lines does not
+ * have to decode and classify every character each time.
+ * starts holds the start of each run followed by the end of the line.
+ */
+class WordClassRuns {
+public:
+	Sci::Line line = -1;
+	std::vector<Sci::Position> starts;
+	std::vector<CharacterClass> classes;
+	void Clear() noexcept;
+	size_t RunFromPosition(Sci::Position pos) const noexcept;
+	CharacterClass ClassAt(Sci::Position pos) const noexcept;
+	Sci::Position Skip(Sci::Position pos, int delta, CharacterClass ccSkip) const noexcept;
+};
+
 /**
  */
 class Document : PerLine, public Scintilla::IDocument, public Scintilla::ILoader, public Scintilla::IDocumentEditable {
@@ -297,6 +358,7 @@ private:
 	CellBuffer cb;
 	CharClassify charClass;
 	CharacterCategoryMap charMap;
+	mutable WordClassRuns wordClassRuns;
 	std::unique_ptr<CaseFolder> pcf;
 	Sci::Position endStyled;
 	int styleClock;
@@ -321,9 +383,15 @@ private:
 
 	std::unique_ptr<RegexSearchBase> regex;
 	std::unique_ptr<LexInterface> pli;
+	std::unique_ptr<BraceIndex> braceIndex;
 
 	std::map<void *, ViewStateShared>viewData;
 
+	const WordClassRuns *WordClassesOfLine(Sci::Line line, bool build) const;
+	CharacterClass WordClassAfter(Sci::Position pos) const;
+	CharacterClass WordClassBefore(Sci::Position pos) const;
+	Sci::Position SkipWordClass(Sci::Position pos, int delta, CharacterClass ccSkip) const;
+
 public:
 
 	Scintilla::EndOfLine eolMode;
@@ -452,6 +520,7 @@ public:
 	const char *SCI_METHOD BufferPointer() override { return cb.BufferPointer(); }
 	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept { return cb.RangePointer(position, rangeLength); }
 	Sci::Position GapPosition() const noexcept { return cb.GapPosition(); }
+	SplitView AllView() const noexcept { return cb.AllView(); }
 
 	int SCI_METHOD GetLineIndentation(Sci_Position line) override;
 	Sci::Position SetLineIndentation(Sci::Line line, Sci::Position indent);
@@ -530,6 +599,7 @@ public:
 	bool HasCaseFolder() const noexcept;
 	void SetCaseFolder(std::unique_ptr<CaseFolder> pcf_) noexcept;
 	Sci::Position FindText(Sci::Position minPos, Sci::Position maxPos, const char *search, Scintilla::FindOption flags, Sci::Position *length);
+	std::vector<Range> FindAll(Sci::Position minPos, Sci::Position maxPos, const char *search, Scintilla::FindOption flags, Sci::Position length);
 	const char *SubstituteByPosition(const char *text, Sci::Position *length);
 	Scintilla::LineCharacterIndexType LineCharacterIndex() const noexcept;
 	void AllocateLineCharacterIndex(Scintilla::LineCharacterIndexType lineCharacterIndex);
@@ -552,6 +622,7 @@ public:
 	void IncrementStyleClock() noexcept;
 	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) override;
 	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override;
+	void DecorationFillRanges(const std::vector<Range> &ranges, int value);
 	LexInterface *GetLexInterface() const noexcept;
 	void SetLexInterface(std::unique_ptr<LexInterface> pLexInterface) noexcept;
 
@@ -332,6 +332,16 @@ inline char CaseForce(Style::CaseForce caseForce, char chDoc, char chPrevious) n
 	}
 }
 
+// The end of the chunk of a very long line starting at start, with any line end in the last chunk.
+int ChunkEnd(const Document *pdoc, Sci::Position posLineStart, const LineLayout *ll, int start) {
+	const int end = start + EditView::lengthLayoutChunk;
+	if (end >= ll->numCharsBeforeEOL) {
+		return ll->numCharsInLine;
+	}
+	const int endChar = static_cast<int>(pdoc->MovePositionOutsideChar(posLineStart + end, 1) - posLineStart);
+	return (endChar >= ll->numCharsBeforeEOL) ? ll->numCharsInLine : endChar;
+}
+
 void LayoutSegments(IPositionCache *pCache,
 	Surface *surface,
 	const ViewStyle &vstyle,
@@ -390,17 +400,120 @@ void LayoutSegments(IPositionCache *pCache,
 
 }
 
+/**
+* Fill in the LineLayout data for a range of the line.
+* Copy the range of the line and its styles from the document into local arrays.
+* Also determine the x position at which each character starts.
+* The range must be within the window held and its start position must already be set.
+* Returns whether the final segment is italic text that may overhang the end of the range.
+*/
+bool EditView::LayoutRange(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, Range range, bool callerMultiThreaded) {
+	const Sci::Line line = ll->LineNumber();
+	const Sci::Position posLineStart = model.pdoc->LineStart(line);
+	const int start = static_cast<int>(range.start);
+	const int end = static_cast<int>(range.end);
+
+	model.pdoc->GetCharRange(&ll->chars[start], posLineStart + start, end - start);
+	model.pdoc->GetStyleRange(&ll->styles[start], posLineStart + start, end - start);
+	unsigned char styleByteLast = (end > 0) ? ll->styles[end - 1] : 0;
+	const Sci::Position posLineEnd = model.pdoc->LineStart(line + 1);
+	if ((posLineStart + end >= model.pdoc->LineEnd(line)) && (posLineEnd > posLineStart)) {
+		// At the end of the line use the style of the line end characters
+		styleByteLast = static_cast<unsigned char>(model.pdoc->StyleIndexAt(posLineEnd - 1));
+	}
+	if (vstyle.someStylesForceCase) {
+		char chPrevious = (start > 0) ? model.pdoc->CharAt(posLineStart + start - 1) : 0;
+		for (int charInLine = start; charInLine < end; charInLine++) {
+			const char chDoc = ll->chars[charInLine];
+			ll->chars[charInLine] = CaseForce(vstyle.styles[ll->styles[charInLine]].caseForce, chDoc, chPrevious);
+			chPrevious = chDoc;
+		}
+	}
+	// Extra element at the end of the range to hold end x position and act as
+	ll->chars[end] = 0;   // Also triggers processing in the loops as this is a control character
+	ll->styles[end] = styleByteLast;	// For eolFilled
+
+	// Layout the range, determining the position of each character,
+	// with an extra element at the end for the end of the range.
+	std::vector<TextSegment> segments;
+	BreakFinder bfLayout(ll, nullptr, range, posLineStart, 0, BreakFinder::BreakFor::Text, model.pdoc, model.reprs.get(), nullptr);
+	while (bfLayout.More()) {
+		segments.push_back(bfLayout.Next());
+	}
+
+	ll->ClearPositions(range);
+
+	if (!segments.empty()) {
+
+		const size_t threadsForLength = std::max(1, (end - start) / bytesPerLayoutThread);
+		size_t threads = std::min<size_t>({ segments.size(), threadsForLength, maxLayoutThreads });
+		if (!surface->SupportsFeature(Supports::ThreadSafeMeasureWidths) || callerMultiThreaded) {
+			threads = 1;
+		}
+
+		std::atomic<uint32_t> nextIndex = 0;
+
+		const bool textUnicode = CpUtf8 == model.pdoc->dbcsCodePage;
+		const bool multiThreaded = threads > 1;
+		const bool multiThreadedContext = multiThreaded || callerMultiThreaded;
+		IPositionCache *pCache = posCache.get();
+
+		// If only 1 thread needed then use the main thread, else spin up multiple
+		const std::launch policy = (multiThreaded) ? std::launch::async : std::launch::deferred;
+
+		std::vector<std::future<void>> futures;
+		for (size_t th = 0; th < threads; th++) {
+			// Find relative positions of everything except for tabs
+			std::future<void> fut = std::async(policy,
+				[pCache, surface, &vstyle, &ll, &segments, &nextIndex, textUnicode, multiThreadedContext]() {
+				LayoutSegments(pCache, surface, vstyle, ll, segments, nextIndex, textUnicode, multiThreadedContext);
+			});
+			futures.push_back(std::move(fut));
+		}
+		for (const std::future<void> &f : futures) {
+			f.wait();
+		}
+	}
+
+	// Accumulate absolute positions from relative positions within segments and expand tabs
+	XYPOSITION xPosition = ll->positions[start];
+	size_t iByte = start + 1;
+	for (const TextSegment &ts : segments) {
+		if (vstyle.styles[ll->styles[ts.start]].visible &&
+			ts.representation &&
+			(ll->chars[ts.start] == '\t')) {
+			// Simple visible tab, go to next tab stop
+			const XYPOSITION startTab = ll->positions[ts.start];
+			const XYPOSITION nextTab = NextTabstopPos(line, startTab, vstyle.tabWidth);
+			xPosition += nextTab - startTab;
+		}
+		const XYPOSITION xBeginSegment = xPosition;
+		for (int i = 0; i < ts.length; i++) {
+			xPosition = ll->positions[iByte] + xBeginSegment;
+			ll->positions[iByte++] = xPosition;
+		}
+	}
+
+	if (!segments.empty()) {
+		// Not quite the same as before which would effectively ignore trailing invisible segments
+		const TextSegment &ts = segments.back();
+		return (!ts.representation) && ((ll->chars[ts.end() - 1] != ' ') && vstyle.styles[ll->styles[ts.start]].italic);
+	}
+	return false;
+}
+
 /**
 * Fill in the LineLayout data for the given line.
 * Copy the given @a line and its styles from the document into local arrays.
 * Also determine the x position at which each character starts.
+* Very long lines are divided into chunks at checkpoints and only the chunks needed are
+* laid out by LayoutWindow as the view scrolls or positions are queried.
 */
 void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width, bool callerMultiThreaded) {
 	if (!ll)
 		return;
 	const Sci::Line line = ll->LineNumber();
 	PLATFORM_ASSERT(line < model.pdoc->LinesTotal());
-	PLATFORM_ASSERT(ll->chars);
 	const Sci::Position posLineStart = model.pdoc->LineStart(line);
 	Sci::Position posLineEnd = model.pdoc->LineStart(line + 1);
 	// If the line is very long, limit the treatment to a length that should fit in the viewport
@@ -410,6 +523,10 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 	// Hard to cope when too narrow, so just assume there is space
 	width = std::max(width, 20);
 
+	if (ll->Windowed() && (ll->validity == LineLayout::ValidLevel::checkTextAndStyle)) {
+		// Only a window of the text and styles is held so they can not be checked
+		ll->validity = LineLayout::ValidLevel::invalid;
+	}
 	if (ll->validity == LineLayout::ValidLevel::checkTextAndStyle) {
 		Sci::Position lineLength = posLineEnd - posLineStart;
 		if (!vstyle.viewEOL) {
@@ -454,110 +571,54 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 			ll->edgeColumn = -1;
 		}
 
-		// Fill base line layout
 		const int lineLength = static_cast<int>(posLineEnd - posLineStart);
-		model.pdoc->GetCharRange(ll->chars.get(), posLineStart, lineLength);
-		model.pdoc->GetStyleRange(ll->styles.get(), posLineStart, lineLength);
 		const int numCharsBeforeEOL = static_cast<int>(model.pdoc->LineEnd(line) - posLineStart);
 		const int numCharsInLine = (vstyle.viewEOL) ? lineLength : numCharsBeforeEOL;
-		const unsigned char styleByteLast = (lineLength > 0) ? ll->styles[lineLength - 1] : 0;
-		if (vstyle.someStylesForceCase) {
-			char chPrevious = 0;
-			for (int charInLine = 0; charInLine<lineLength; charInLine++) {
-				const char chDoc = ll->chars[charInLine];
-				ll->chars[charInLine] = CaseForce(vstyle.styles[ll->styles[charInLine]].caseForce, chDoc, chPrevious);
-				chPrevious = chDoc;
-			}
-		}
 		ll->xHighlightGuide = 0;
-		// Extra element at the end of the line to hold end x position and act as
-		ll->chars[numCharsInLine] = 0;   // Also triggers processing in the loops as this is a control character
-		ll->styles[numCharsInLine] = styleByteLast;	// For eolFilled
-
-		// Layout the line, determining the position of each character,
-		// with an extra element at the end for the end of the line.
-		ll->positions[0] = 0;
-		bool lastSegItalics = false;
-
-		std::vector<TextSegment> segments;
-		BreakFinder bfLayout(ll, nullptr, Range(0, numCharsInLine), posLineStart, 0, BreakFinder::BreakFor::Text, model.pdoc, model.reprs.get(), nullptr);
-		while (bfLayout.More()) {
-			segments.push_back(bfLayout.Next());
-		}
-
-		ll->ClearPositions();
-
-		if (!segments.empty()) {
-
-			const size_t threadsForLength = std::max(1, numCharsInLine / bytesPerLayoutThread);
-			size_t threads = std::min<size_t>({ segments.size(), threadsForLength, maxLayoutThreads });
-			if (!surface->SupportsFeature(Supports::ThreadSafeMeasureWidths) || callerMultiThreaded) {
-				threads = 1;
-			}
-
-			std::atomic<uint32_t> nextIndex = 0;
-
-			const bool textUnicode = CpUtf8 == model.pdoc->dbcsCodePage;
-			const bool multiThreaded = threads > 1;
-			const bool multiThreadedContext = multiThreaded || callerMultiThreaded;
-			IPositionCache *pCache = posCache.get();
-
-			// If only 1 thread needed then use the main thread, else spin up multiple
-			const std::launch policy = (multiThreaded) ? std::launch::async : std::launch::deferred;
-
-			std::vector<std::future<void>> futures;
-			for (size_t th = 0; th < threads; th++) {
-				// Find relative positions of everything except for tabs
-				std::future<void> fut = std::async(policy,
-					[pCache, surface, &vstyle, &ll, &segments, &nextIndex, textUnicode, multiThreadedContext]() {
-					LayoutSegments(pCache, surface, vstyle, ll, segments, nextIndex, textUnicode, multiThreadedContext);
+		ll->numCharsInLine = numCharsInLine;
+		ll->numCharsBeforeEOL = numCharsBeforeEOL;
+		if ((numCharsInLine > lengthPartialLayout) && !model.BidirectionalEnabled()) {
+			// Checkpoints start with an estimated x that is corrected as chunks are laid out
+			std::vector<LayoutCheckpoint> checkpoints;
+			int start = 0;
+			XYPOSITION x = 0;
+			while (start < numCharsInLine) {
+				checkpoints.push_back({ start, x });
+				const int end = ChunkEnd(model.pdoc, posLineStart, ll, start);
+				x += (end - start) * vstyle.aveCharWidth;
+				start = end;
+			}
+			checkpoints.push_back({ numCharsInLine, x });
+			const bool sameChunks = std::equal(checkpoints.begin(), checkpoints.end(),
+				ll->checkpoints.begin(), ll->checkpoints.end(),
+				[](const LayoutCheckpoint &a, const LayoutCheckpoint &b) noexcept {
+					return a.position == b.position;
 				});
-				futures.push_back(std::move(fut));
-			}
-			for (const std::future<void> &f : futures) {
-				f.wait();
-			}
-		}
-
-		// Accumulate absolute positions from relative positions within segments and expand tabs
-		XYPOSITION xPosition = 0.0;
-		size_t iByte = 0;
-		ll->positions[iByte++] = xPosition;
-		for (const TextSegment &ts : segments) {
-			if (vstyle.styles[ll->styles[ts.start]].visible &&
-				ts.representation &&
-				(ll->chars[ts.start] == '\t')) {
-				// Simple visible tab, go to next tab stop
-				const XYPOSITION startTab = ll->positions[ts.start];
-				const XYPOSITION nextTab = NextTabstopPos(line, startTab, vstyle.tabWidth);
-				xPosition += nextTab - startTab;
-			}
-			const XYPOSITION xBeginSegment = xPosition;
-			for (int i = 0; i < ts.length; i++) {
-				xPosition = ll->positions[iByte] + xBeginSegment;
-				ll->positions[iByte++] = xPosition;
+			if (!sameChunks) {
+				// Retain corrected x when the line is changed within chunks so that the view does not jump
+				ll->checkpoints = std::move(checkpoints);
+			}
+			ll->SetWindow(Range(0, 0));
+			ll->positions[0] = 0;
+			ll->chars[0] = 0;
+			ll->styles[0] = 0;
+		} else {
+			ll->checkpoints.clear();
+			ll->SetWindow(Range(0, numCharsInLine));
+			ll->positions[0] = 0;
+			const bool lastSegItalics = LayoutRange(model, surface, vstyle, ll, Range(0, numCharsInLine), callerMultiThreaded);
+			// Small hack to make lines that end with italics not cut off the edge of the last character
+			if (lastSegItalics) {
+				ll->positions[numCharsInLine] += vstyle.lastSegItalicsOffset;
 			}
 		}
-
-		if (!segments.empty()) {
-			// Not quite the same as before which would effectively ignore trailing invisible segments
-			const TextSegment &ts = segments.back();
-			lastSegItalics = (!ts.representation) && ((ll->chars[ts.end() - 1] != ' ') && vstyle.styles[ll->styles[ts.start]].italic);
-		}
-
-		// Small hack to make lines that end with italics not cut off the edge of the last character
-		if (lastSegItalics) {
-			ll->positions[numCharsInLine] += vstyle.lastSegItalicsOffset;
-		}
-		ll->numCharsInLine = numCharsInLine;
-		ll->numCharsBeforeEOL = numCharsBeforeEOL;
 		ll->validity = LineLayout::ValidLevel::positions;
 	}
 	if ((ll->validity == LineLayout::ValidLevel::positions) || (ll->widthLine != width)) {
 		ll->widthLine = width;
 		if (width == LineLayout::wrapWidthInfinite) {
 			ll->lines = 1;
-		} else if (width > ll->positions[ll->numCharsInLine]) {
+		} else if (!ll->Windowed() && (width > ll->positions[ll->numCharsInLine])) {
 			// Simple common case where line does not need wrapping.
 			ll->lines = 1;
 		} else {
@@ -580,7 +641,9 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 			}
 			ll->wrapIndent = wrapAddIndent;
 			if (vstyle.wrap.indentMode != WrapIndentMode::Fixed) {
-				for (int i = 0; i < ll->numCharsInLine; i++) {
+				// The indent of a very long line is found in its first chunk
+				LayoutWindow(model, surface, vstyle, ll, Range(0, 1));
+				for (int i = 0; i < ll->endWindow; i++) {
 					if (!IsSpaceOrTab(ll->chars[i])) {
 						ll->wrapIndent += ll->positions[i]; // Add line indent
 						break;
@@ -593,12 +656,123 @@ void EditView::LayoutLine(const EditModel &model, Surface *surface, const ViewSt
 			// Check for wrapIndent minimum
 			if ((FlagSet(vstyle.wrap.visualFlags, WrapVisualFlag::Start)) && (ll->wrapIndent < vstyle.aveCharWidth))
 				ll->wrapIndent = vstyle.aveCharWidth; // Indent to show start visual
-			ll->WrapLine(model.pdoc, posLineStart, vstyle.wrap.state, width);
+			if (ll->Windowed()) {
+				WrapChunks(model, surface, vstyle, ll, width, callerMultiThreaded);
+			} else {
+				ll->WrapLine(model.pdoc, posLineStart, vstyle.wrap.state, width);
+			}
 		}
 		ll->validity = LineLayout::ValidLevel::lines;
 	}
 }
 
+/**
+* Wrap a very long line a chunk at a time so that only one chunk is held.
+* Each chunk after the first starts at a subline start so any subline can be laid out
+* again directly from its checkpoint.
+*/
+void EditView::WrapChunks(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width, bool callerMultiThreaded) {
+	const Sci::Position posLineStart = model.pdoc->LineStart(ll->LineNumber());
+	std::vector<LayoutCheckpoint> checkpoints;
+	ll->lines = 0;
+	int start = 0;
+	XYPOSITION x = 0;
+	while (start < ll->numCharsInLine) {
+		const int end = ChunkEnd(model.pdoc, posLineStart, ll, start);
+		checkpoints.push_back({ start, x });
+		ll->SetWindow(Range(start, end));
+		ll->positions[start] = x;
+		const bool lastSegItalics = LayoutRange(model, surface, vstyle, ll, Range(start, end), callerMultiThreaded);
+		if (end == ll->numCharsInLine) {
+			// Small hack to make lines that end with italics not cut off the edge of the last character
+			if (lastSegItalics) {
+				ll->positions[end] += vstyle.lastSegItalicsOffset;
+			}
+			ll->WrapRange(model.pdoc, posLineStart, vstyle.wrap.state, width, end);
+			checkpoints.push_back({ end, ll->positions[end] });
+			break;
+		}
+		int last = ll->WrapRange(model.pdoc, posLineStart, vstyle.wrap.state, width, end);
+		if (last == start) {
+			// No break found in the chunk so break at its end
+			ll->AddLineStart(end);
+			last = end;
+		}
+		x = ll->positions[last];
+		start = last;
+	}
+	ll->lines++;
+	ll->checkpoints = std::move(checkpoints);
+}
+
+/**
+* Lay out the chunks of a very long line that hold @a range, from their checkpoints so that
+* distant chunks are reached directly. Only the chunks laid out are held, unless they continue
+* the window already held. The estimated x of later checkpoints is corrected by each chunk.
+*/
+void EditView::LayoutWindow(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, Range range) {
+	if (!ll || !ll->Windowed()) {
+		return;
+	}
+	const Sci::Position start = std::clamp<Sci::Position>(range.start, 0, ll->numCharsInLine);
+	const Sci::Position end = std::clamp<Sci::Position>(range.end, start, ll->numCharsInLine);
+	if ((ll->endWindow > ll->startWindow) && (start >= ll->startWindow) && (end <= ll->endWindow)) {
+		return;
+	}
+	std::vector<LayoutCheckpoint> &checkpoints = ll->checkpoints;
+	const size_t first = ll->ChunkFromPosition(start);
+	const size_t last = ll->ChunkFromPosition(std::max(start, end - 1));
+	size_t chunk = first;
+	if ((ll->endWindow > ll->startWindow) && (checkpoints[first].position == ll->startWindow)) {
+		chunk = ll->ChunkFromPosition(ll->endWindow);
+		ll->ExtendWindow(checkpoints[last + 1].position);
+	} else {
+		ll->SetWindow(Range(checkpoints[first].position, checkpoints[last + 1].position));
+	}
+	for (; chunk <= last; chunk++) {
+		const int startChunk = checkpoints[chunk].position;
+		const int endChunk = checkpoints[chunk + 1].position;
+		ll->positions[startChunk] = checkpoints[chunk].x;
+		const bool lastSegItalics = LayoutRange(model, surface, vstyle, ll, Range(startChunk, endChunk), false);
+		if (lastSegItalics && (endChunk == ll->numCharsInLine)) {
+			ll->positions[endChunk] += vstyle.lastSegItalicsOffset;
+		}
+		const XYPOSITION shift = ll->positions[endChunk] - checkpoints[chunk + 1].x;
+		if (shift != 0) {
+			for (size_t later = chunk + 1; later < checkpoints.size(); later++) {
+				checkpoints[later].x += shift;
+			}
+		}
+	}
+}
+
+/**
+* Lay out the part of a very long line that may be seen on sublines @a subLineFirst to
+* @a subLineLast between @a xLeft and @a xRight.
+*/
+void EditView::LayoutWindowVisible(const EditModel &model, Surface *surface, const ViewStyle &vstyle, LineLayout *ll,
+	int subLineFirst, int subLineLast, XYPOSITION xLeft, XYPOSITION xRight) {
+	if (!ll || !ll->Windowed()) {
+		return;
+	}
+	if (ll->lines > 1) {
+		LayoutWindow(model, surface, vstyle, ll, Range(ll->LineStart(subLineFirst), ll->LineStart(subLineLast + 1)));
+		return;
+	}
+	// Chunks found from estimated x may move as they are laid out so repeat until the view is covered
+	for (size_t attempt = 0; attempt < ll->checkpoints.size(); attempt++) {
+		const size_t first = ll->ChunkFromX(xLeft);
+		const size_t last = std::max(first, ll->ChunkFromX(xRight));
+		LayoutWindow(model, surface, vstyle, ll,
+			Range(ll->checkpoints[first].position, ll->checkpoints[last + 1].position));
+		const bool coversLeft = (ll->startWindow == 0) || (ll->positions[ll->startWindow] <= xLeft);
+		const bool coversRight = (ll->endWindow == ll->numCharsInLine) || (ll->positions[ll->endWindow] >= xRight);
+		if (coversLeft && coversRight) {
+			break;
+		}
+	}
+}
+
 // Fill the LineLayout bidirectional data fields according to each char style
 
 void EditView::UpdateBidiData(const EditModel &model, const ViewStyle &vstyle, LineLayout *ll) {
@@ -647,6 +821,7 @@ Point EditView::LocationFromPosition(Surface *surface, const EditModel &model, S
 	if (surface && ll) {
 		LayoutLine(model, surface, vs, ll.get(), model.wrapWidth);
 		const int posInLine = static_cast<int>(pos.Position() - posLineStart);
+		LayoutWindow(model, surface, vs, ll.get(), Range(std::max(posInLine - 1, 0), posInLine));
 		pt = ll->PointFromPosition(posInLine, vs.lineHeight, pe);
 		pt.x += vs.textStart - model.xOffset;
 
@@ -720,8 +895,9 @@ SelectionPosition EditView::SPositionFromLocation(Surface *surface, const EditMo
 		const Sci::Line lineStartSet = model.pcs->DisplayFromDoc(lineDoc);
 		const int subLine = static_cast<int>(visibleLine - lineStartSet);
 		if (subLine < ll->lines) {
+			LayoutWindowVisible(model, surface, vs, ll.get(), subLine, subLine, pt.x, pt.x);
 			const Range rangeSubLine = ll->SubLineRange(subLine, LineLayout::Scope::visibleOnly);
-			const XYPOSITION subLineStart = ll->positions[rangeSubLine.start];
+			const XYPOSITION subLineStart = ll->XSubLineStart(subLine);
 			if (subLine > 0)	// Wrapped
 				pt.x -= ll->wrapIndent;
 			Sci::Position positionInLine = 0;
@@ -743,10 +919,10 @@ SelectionPosition EditView::SPositionFromLocation(Surface *surface, const EditMo
 			if (virtualSpace) {
 				const XYPOSITION spaceWidth = vs.styles[ll->EndLineStyle()].spaceWidth;
 				const int spaceOffset = static_cast<int>(
-					(pt.x + subLineStart - ll->positions[rangeSubLine.end] + spaceWidth / 2) / spaceWidth);
+					(pt.x + subLineStart - ll->XInLine(rangeSubLine.end) + spaceWidth / 2) / spaceWidth);
 				return SelectionPosition(rangeSubLine.end + posLineStart, spaceOffset);
 			} else if (canReturnInvalid) {
-				if (pt.x < (ll->positions[rangeSubLine.end] - subLineStart)) {
+				if (pt.x < (ll->XInLine(rangeSubLine.end) - subLineStart)) {
 					return SelectionPosition(model.pdoc->MovePositionOutsideChar(rangeSubLine.end + posLineStart, 1));
 				}
 			} else {
@@ -769,15 +945,16 @@ SelectionPosition EditView::SPositionFromLineX(Surface *surface, const EditModel
 	if (surface && ll) {
 		const Sci::Position posLineStart = model.pdoc->LineStart(lineDoc);
 		LayoutLine(model, surface, vs, ll.get(), model.wrapWidth);
+		LayoutWindowVisible(model, surface, vs, ll.get(), 0, 0, x, x);
 		const Range rangeSubLine = ll->SubLineRange(0, LineLayout::Scope::visibleOnly);
-		const XYPOSITION subLineStart = ll->positions[rangeSubLine.start];
+		const XYPOSITION subLineStart = ll->XSubLineStart(0);
 		const Sci::Position positionInLine = ll->FindPositionFromX(x + subLineStart, rangeSubLine, false);
 		if (positionInLine < rangeSubLine.end) {
 			return SelectionPosition(model.pdoc->MovePositionOutsideChar(positionInLine + posLineStart, 1));
 		}
 		const XYPOSITION spaceWidth = vs.styles[ll->EndLineStyle()].spaceWidth;
 		const int spaceOffset = static_cast<int>(
-			(x + subLineStart - ll->positions[rangeSubLine.end] + spaceWidth / 2) / spaceWidth);
+			(x + subLineStart - ll->XInLine(rangeSubLine.end) + spaceWidth / 2) / spaceWidth);
 		return SelectionPosition(rangeSubLine.end + posLineStart, spaceOffset);
 	}
 	return SelectionPosition(0);
@@ -935,8 +1112,8 @@ void FillLineRemainder(Surface *surface, const EditModel &model, const ViewStyle
 		const ColourOptional background = vsDraw.Background(model.GetMark(line), model.caret.active, ll->containsCaret);
 		if (background) {
 			surface->FillRectangleAligned(rcArea, Fill(*background));
-		} else if (vsDraw.styles[ll->styles[ll->numCharsInLine]].eolFilled) {
-			surface->FillRectangleAligned(rcArea, Fill(vsDraw.styles[ll->styles[ll->numCharsInLine]].back));
+		} else if (vsDraw.styles[ll->StyleAtLineEnd()].eolFilled) {
+			surface->FillRectangleAligned(rcArea, Fill(vsDraw.styles[ll->StyleAtLineEnd()].back));
 		} else {
 			surface->FillRectangleAligned(rcArea, Fill(vsDraw.styles[StyleDefault].back));
 		}
@@ -951,22 +1128,27 @@ void FillLineRemainder(Surface *surface, const EditModel &model, const ViewStyle
 void EditView::DrawEOL(Surface *surface, const EditModel &model, const ViewStyle &vsDraw, const LineLayout *ll,
 	Sci::Line line, int xStart, PRectangle rcLine, int subLine, Sci::Position lineEnd, XYPOSITION subLineStart, ColourOptional background) {
 
+	const bool lastSubLine = subLine == (ll->lines - 1);
+	if ((ll->startWindow > lineEnd) || (ll->endWindow < (lastSubLine ? ll->numCharsInLine : lineEnd))) {
+		// End of a very long line is not laid out as it is out of view
+		return;
+	}
+
 	const Sci::Position posLineStart = model.pdoc->LineStart(line);
 	PRectangle rcSegment = rcLine;
 
-	const bool lastSubLine = subLine == (ll->lines - 1);
 	XYPOSITION virtualSpace = 0;
 	if (lastSubLine) {
 		const XYPOSITION spaceWidth = vsDraw.styles[ll->EndLineStyle()].spaceWidth;
 		virtualSpace = model.sel.VirtualSpaceFor(model.pdoc->LineEnd(line)) * spaceWidth;
 	}
-	const XYPOSITION xEol = ll->positions[lineEnd] - subLineStart;
+	const XYPOSITION xEol = ll->XInLine(lineEnd) - subLineStart;
 
 	// Fill the virtual space and show selections within it
 	if (virtualSpace > 0.0f) {
 		rcSegment.left = xEol + xStart;
 		rcSegment.right = xEol + xStart + virtualSpace;
-		const ColourRGBA backgroundFill = background.value_or(vsDraw.styles[ll->styles[ll->numCharsInLine]].back);
+		const ColourRGBA backgroundFill = background.value_or(vsDraw.styles[ll->StyleAtLineEnd()].back);
 		surface->FillRectangleAligned(rcSegment, backgroundFill);
 		if (vsDraw.selection.visible && (vsDraw.selection.layer == Layer::Base)) {
 			const SelectionSegment virtualSpaceRange(SelectionPosition(model.pdoc->LineEnd(line)),
@@ -1072,9 +1254,9 @@ void EditView::DrawEOL(Surface *surface, const EditModel &model, const ViewStyle
 		if (background) {
 			surface->FillRectangleAligned(rcSegment, Fill(*background));
 		} else if (line < model.pdoc->LinesTotal() - 1) {
-			surface->FillRectangleAligned(rcSegment, Fill(vsDraw.styles[ll->styles[ll->numCharsInLine]].back));
-		} else if (vsDraw.styles[ll->styles[ll->numCharsInLine]].eolFilled) {
-			surface->FillRectangleAligned(rcSegment, Fill(vsDraw.styles[ll->styles[ll->numCharsInLine]].back));
+			surface->FillRectangleAligned(rcSegment, Fill(vsDraw.styles[ll->StyleAtLineEnd()].back));
+		} else if (vsDraw.styles[ll->StyleAtLineEnd()].eolFilled) {
+			surface->FillRectangleAligned(rcSegment, Fill(vsDraw.styles[ll->StyleAtLineEnd()].back));
 		} else {
 			surface->FillRectangleAligned(rcSegment, Fill(vsDraw.styles[StyleDefault].back));
 		}
@@ -1131,7 +1313,7 @@ void EditView::DrawEOL(Surface *surface, const EditModel &model, const ViewStyle
 void EditView::DrawFoldDisplayText(Surface *surface, const EditModel &model, const ViewStyle &vsDraw, const LineLayout *ll,
 							  Sci::Line line, int xStart, PRectangle rcLine, int subLine, XYPOSITION subLineStart, DrawPhase phase) {
 	const bool lastSubLine = subLine == (ll->lines - 1);
-	if (!lastSubLine)
+	if (!lastSubLine || (ll->endWindow < ll->numCharsInLine))
 		return;
 
 	const char *text = model.GetFoldDisplayText(line);
@@ -1151,7 +1333,7 @@ void EditView::DrawFoldDisplayText(Surface *surface, const EditModel &model, con
 	const XYPOSITION spaceWidth = vsDraw.styles[ll->EndLineStyle()].spaceWidth;
 	const XYPOSITION virtualSpace = model.sel.VirtualSpaceFor(
 		model.pdoc->LineEnd(line)) * spaceWidth;
-	rcSegment.left = xStart + ll->positions[ll->numCharsInLine] - subLineStart + virtualSpace + vsDraw.aveCharWidth;
+	rcSegment.left = xStart + ll->XInLine(ll->numCharsInLine) - subLineStart + virtualSpace + vsDraw.aveCharWidth;
 	rcSegment.right = rcSegment.left + static_cast<XYPOSITION>(widthFoldDisplayText);
 
 	const ColourOptional background = vsDraw.Background(model.GetMark(line), model.caret.active, ll->containsCaret);
@@ -1211,7 +1393,7 @@ void EditView::DrawEOLAnnotationText(Surface *surface, const EditModel &model, c
 	Sci::Line line, int xStart, PRectangle rcLine, int subLine, XYPOSITION subLineStart, DrawPhase phase) {
 
 	const bool lastSubLine = subLine == (ll->lines - 1);
-	if (!lastSubLine)
+	if (!lastSubLine || (ll->endWindow < ll->numCharsInLine))
 		return;
 
 	if (vsDraw.eolAnnotationVisible == EOLAnnotationVisible::Hidden) {
@@ -1270,7 +1452,7 @@ void EditView::DrawEOLAnnotationText(Surface *surface, const EditModel &model, c
 	const XYPOSITION virtualSpace = model.sel.VirtualSpaceFor(
 		model.pdoc->LineEnd(line)) * spaceWidth;
 	rcSegment.left = xStart +
-		ll->positions[ll->numCharsInLine] - subLineStart
+		ll->XInLine(ll->numCharsInLine) - subLineStart
 		+ virtualSpace + vsDraw.aveCharWidth;
 
 	const char *textFoldDisplay = model.GetFoldDisplayText(line);
@@ -1442,8 +1624,8 @@ void DrawBlockCaret(Surface *surface, const EditModel &model, const ViewStyle &v
 	// glyph / combining character. If so we'll need to draw that too.
 	Sci::Position offsetFirstChar = offset;
 	Sci::Position offsetLastChar = offset + (posAfter - posCaret);
-	while ((posBefore > 0) && ((offsetLastChar - numCharsToDraw) >= lineStart)) {
-		if ((ll->positions[offsetLastChar] - ll->positions[offsetLastChar - numCharsToDraw]) > 0) {
+	while ((posBefore > 0) && ((offsetLastChar - numCharsToDraw) >= std::max<Sci::Position>(lineStart, ll->startWindow))) {
+		if ((ll->XInLine(offsetLastChar) - ll->XInLine(offsetLastChar - numCharsToDraw)) > 0) {
 			// The char does not share horizontal space
 			break;
 		}
@@ -1456,17 +1638,17 @@ void DrawBlockCaret(Surface *surface, const EditModel &model, const ViewStyle &v
 
 	// See if the next character shares horizontal space, if so we'll
 	// need to draw that too.
-	if (offsetFirstChar < 0)
-		offsetFirstChar = 0;
+	if (offsetFirstChar < ll->startWindow)
+		offsetFirstChar = ll->startWindow;
 	numCharsToDraw = offsetLastChar - offsetFirstChar;
-	while ((offsetLastChar < ll->LineStart(subLine + 1)) && (offsetLastChar <= ll->numCharsInLine)) {
+	while ((offsetLastChar < ll->LineStart(subLine + 1)) && (offsetLastChar <= ll->endWindow)) {
 		// Update posAfter to point to the 2nd next char, this is where
 		// the next character ends, and 2nd next begins. We'll need
 		// to compare these two
 		posBefore = posAfter;
 		posAfter = model.pdoc->MovePositionOutsideChar(posAfter + 1, 1);
 		offsetLastChar = offset + (posAfter - posCaret);
-		if ((ll->positions[offsetLastChar] - ll->positions[offsetLastChar - (posAfter - posBefore)]) > 0) {
+		if ((ll->XInLine(offsetLastChar) - ll->XInLine(offsetLastChar - (posAfter - posBefore))) > 0) {
 			// The char does not share horizontal space
 			break;
 		}
@@ -1475,8 +1657,8 @@ void DrawBlockCaret(Surface *surface, const EditModel &model, const ViewStyle &v
 	}
 
 	// We now know what to draw, update the caret drawing rectangle
-	rcCaret.left = ll->positions[offsetFirstChar] - ll->positions[lineStart] + xStart;
-	rcCaret.right = ll->positions[offsetFirstChar + numCharsToDraw] - ll->positions[lineStart] + xStart;
+	rcCaret.left = ll->positions[offsetFirstChar] - ll->XSubLineStart(subLine) + xStart;
+	rcCaret.right = ll->XInLine(offsetFirstChar + numCharsToDraw) - ll->XSubLineStart(subLine) + xStart;
 
 	// Adjust caret position to take into account any word wrapping symbols.
 	if ((ll->wrapIndent != 0) && (lineStart != 0)) {
@@ -1519,8 +1701,9 @@ void EditView::DrawCarets(Surface *surface, const EditModel &model, const ViewSt
 		const int offset = static_cast<int>(posCaret.Position() - posLineStart);
 		const XYPOSITION spaceWidth = vsDraw.styles[ll->EndLineStyle()].spaceWidth;
 		const XYPOSITION virtualOffset = posCaret.VirtualSpace() * spaceWidth;
-		if (ll->InLine(offset, subLine) && offset <= ll->numCharsBeforeEOL) {
-			XYPOSITION xposCaret = ll->positions[offset] + virtualOffset - ll->positions[ll->LineStart(subLine)];
+		if (ll->InLine(offset, subLine) && offset <= ll->numCharsBeforeEOL &&
+			(offset >= ll->startWindow) && (offset <= ll->endWindow)) {
+			XYPOSITION xposCaret = ll->positions[offset] + virtualOffset - ll->XSubLineStart(subLine);
 			if (model.BidirectionalEnabled() && (posCaret.VirtualSpace() == 0)) {
 				// Get caret point
 				const ScreenLine screenLine(ll, subLine, vsDraw, rcLine.right, tabWidthMinimumPixels);
@@ -1556,7 +1739,7 @@ void EditView::DrawCarets(Surface *surface, const EditModel &model, const ViewSt
 					widthOverstrikeCaret = vsDraw.aveCharWidth;
 				} else {
 					const int widthChar = model.pdoc->LenChar(posCaret.Position());
-					widthOverstrikeCaret = ll->positions[offset + widthChar] - ll->positions[offset];
+					widthOverstrikeCaret = ll->XInLine(offset + widthChar) - ll->positions[offset];
 				}
 				if (widthOverstrikeCaret < 3)	// Make sure its visible
 					widthOverstrikeCaret = 3;
@@ -1660,7 +1843,7 @@ void DrawBackground(Surface *surface, const EditModel &model, const ViewStyle &v
 
 	const bool selBackDrawn = vsDraw.SelectionBackgroundDrawn();
 	bool inIndentation = subLine == 0;	// Do not handle indentation except on first subline.
-	const XYPOSITION subLineStart = ll->positions[lineRange.start];
+	const XYPOSITION subLineStart = ll->XSubLineStart(subLine);
 	const XYPOSITION horizontalOffset = xStart - subLineStart;
 	// Does not take margin into account but not significant
 	const XYPOSITION xStartVisible = subLineStart - xStart;
@@ -1768,7 +1951,7 @@ void DrawTranslucentSelection(Surface *surface, const EditModel &model, const Vi
 	Sci::Line line, int xStart, PRectangle rcLine, int subLine, Range lineRange, int tabWidthMinimumPixels, Layer layer) {
 	if (vsDraw.selection.layer == layer) {
 		const Sci::Position posLineStart = model.pdoc->LineStart(line);
-		const XYPOSITION subLineStart = ll->positions[lineRange.start];
+		const XYPOSITION subLineStart = ll->XSubLineStart(subLine);
 		const XYPOSITION horizontalOffset = xStart - subLineStart;
 		// For each selection draw
 		Sci::Position virtualSpaces = 0;
@@ -1802,7 +1985,7 @@ void DrawTranslucentSelection(Surface *surface, const EditModel &model, const Vi
 					}
 
 					if (portion.end.VirtualSpace()) {
-						const XYPOSITION xStartVirtual = ll->positions[lineRange.end] + horizontalOffset;
+						const XYPOSITION xStartVirtual = ll->XInLine(lineRange.end) + horizontalOffset;
 						const PRectangle rcSegment = rcLine.WithHorizontalBounds(intervalVirtual.Offset(xStartVirtual));
 						surface->FillRectangleAligned(rcSegment, selectionBack);
 					}
@@ -1929,7 +2112,7 @@ void DrawIndicator(int indicNum, Sci::Position startPos, Sci::Position endPos, S
 	const LineLayout *ll, int xStart, PRectangle rcLine, Sci::Position secondCharacter, int subLine, Indicator::State state,
 	int value, bool bidiEnabled, int tabWidthMinimumPixels) {
 
-	const XYPOSITION subLineStart = ll->positions[ll->LineStart(subLine)];
+	const XYPOSITION subLineStart = ll->XSubLineStart(subLine);
 	const XYPOSITION horizontalOffset = xStart - subLineStart;
 
 	std::vector<PRectangle> rectangles;
@@ -1974,8 +2157,9 @@ void DrawIndicators(Surface *surface, const EditModel &model, const ViewStyle &v
 	Sci::Line line, int xStart, PRectangle rcLine, int subLine, Sci::Position lineEnd, bool under, int tabWidthMinimumPixels) {
 	// Draw decorators
 	const Sci::Position posLineStart = model.pdoc->LineStart(line);
-	const Sci::Position lineStart = ll->LineStart(subLine);
-	const Sci::Position posLineEnd = posLineStart + lineEnd;
+	// Only the window held of a very long line can be seen
+	const Sci::Position lineStart = std::max(ll->LineStart(subLine), ll->startWindow);
+	const Sci::Position posLineEnd = posLineStart + std::min<Sci::Position>(lineEnd, ll->endWindow);
 
 	for (const IDecoration *deco : model.pdoc->decorations->View()) {
 		if (under == vsDraw.indicators[deco->Indicator()].under) {
@@ -2121,7 +2305,7 @@ void EditView::DrawForeground(Surface *surface, const EditModel &model, const Vi
 	const bool drawWhitespaceBackground = vsDraw.WhitespaceBackgroundDrawn() && !background;
 	bool inIndentation = subLine == 0;	// Do not handle indentation except on first subline.
 
-	const XYPOSITION subLineStart = ll->positions[lineRange.start];
+	const XYPOSITION subLineStart = ll->XSubLineStart(subLine);
 	const XYPOSITION horizontalOffset = xStart - subLineStart;
 	const XYPOSITION indentWidth = model.pdoc->IndentSize() * vsDraw.spaceWidth;
 
@@ -2330,7 +2514,7 @@ void EditView::DrawIndentGuidesOverEmpty(Surface *surface, const EditModel &mode
 		&& (subLine == 0)) {
 		const Sci::Position posLineStart = model.pdoc->LineStart(line);
 		int indentSpace = model.pdoc->GetLineIndentation(line);
-		int xStartText = static_cast<int>(ll->positions[model.pdoc->GetLineIndentPosition(line) - posLineStart]);
+		int xStartText = static_cast<int>(ll->XInLine(model.pdoc->GetLineIndentPosition(line) - posLineStart));
 
 		// Find the most recent line with some text
 
@@ -2398,7 +2582,7 @@ void EditView::DrawLine(Surface *surface, const EditModel &model, const ViewStyl
 
 	const Range lineRange = ll->SubLineRange(subLine, LineLayout::Scope::visibleOnly);
 	const Range lineRangeIncludingEnd = ll->SubLineRange(subLine, LineLayout::Scope::includeEnd);
-	const XYPOSITION subLineStart = ll->positions[lineRange.start];
+	const XYPOSITION subLineStart = ll->XSubLineStart(subLine);
 
 	if ((ll->wrapIndent != 0) && (subLine > 0)) {
 		if (FlagSet(phase, DrawPhase::back)) {
@@ -2554,6 +2738,10 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, const V
 				if (lineDoc != lineDocPrevious) {
 					ll = RetrieveLineLayout(lineDoc, model);
 					LayoutLine(model, surface, vsDraw, ll.get(), model.wrapWidth);
+					// Only the part of a very long line that may be seen is laid out
+					const int subLineLast = subLine + (static_cast<int>(rcArea.bottom) - yposScreen) / vsDraw.lineHeight;
+					LayoutWindowVisible(model, surface, vsDraw, ll.get(), subLine, subLineLast,
+						model.xOffset, model.xOffset + rcClient.Width());
 					lineDocPrevious = lineDoc;
 					if (ll && model.BidirectionalEnabled()) {
 						// Fill the line bidi data
@@ -2611,7 +2799,7 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, const V
 					}
 
 					lineWidthMaxSeen = std::max(
-						lineWidthMaxSeen, static_cast<int>(ll->positions[ll->numCharsInLine]));
+						lineWidthMaxSeen, static_cast<int>(ll->XLineEnd()));
 #if defined(TIME_PAINTING)
 					durCopy += ep.Duration(true);
 #endif
@@ -2839,6 +3027,7 @@ Sci::Position EditView::FormatRange(bool draw, CharacterRangeFull chrg, Rectangl
 					if (draw) {
 						rcLine.top = static_cast<XYPOSITION>(ypos);
 						rcLine.bottom = static_cast<XYPOSITION>(ypos + vsPrint.lineHeight);
+						LayoutWindowVisible(model, surfaceMeasure, vsPrint, &ll, iwl, iwl, 0, rc.right - rc.left);
 						DrawLine(surface, model, vsPrint, &ll, lineDoc, visibleLine, xStart, rcLine, iwl, DrawPhase::all);
 					}
 					ypos += vsPrint.lineHeight;
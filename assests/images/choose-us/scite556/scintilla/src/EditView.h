@@ -83,6 +83,10 @@ public:
 
 	unsigned int maxLayoutThreads;
 	static constexpr int bytesPerLayoutThread = 1000;
+	// Lines longer than lengthPartialLayout are divided into chunks of about lengthLayoutChunk
+	// bytes and only the chunks needed for the view or a query are laid out.
+	static constexpr int lengthPartialLayout = 0x40000;
+	static constexpr int lengthLayoutChunk = 0x10000;
 
 	int tabArrowHeight; // draw arrow heads this many pixels above/below line midpoint
 	/** Some platforms, notably PLAT_CURSES, do not support Scintilla's native
@@ -120,6 +124,10 @@ public:
 	std::shared_ptr<LineLayout> RetrieveLineLayout(Sci::Line lineNumber, const EditModel &model);
 	void LayoutLine(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
 		LineLayout *ll, int width, bool callerMultiThreaded=false);
+	void LayoutWindow(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, Range range);
+	void LayoutWindowVisible(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, int subLineFirst, int subLineLast, XYPOSITION xLeft, XYPOSITION xRight);
 
 	static void UpdateBidiData(const EditModel &model, const ViewStyle &vstyle, LineLayout *ll);
 
@@ -133,6 +141,10 @@ public:
 	Sci::Position StartEndDisplayLine(Surface *surface, const EditModel &model, Sci::Position pos, bool start, const ViewStyle &vs);
 
 private:
+	bool LayoutRange(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, Range range, bool callerMultiThreaded);
+	void WrapChunks(const EditModel &model, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, int width, bool callerMultiThreaded);
 	void DrawEOL(Surface *surface, const EditModel &model, const ViewStyle &vsDraw, const LineLayout *ll,
 		Sci::Line line, int xStart, PRectangle rcLine, int subLine, Sci::Position lineEnd, XYPOSITION subLineStart, ColourOptional background);
 	void DrawFoldDisplayText(Surface *surface, const EditModel &model, const ViewStyle &vsDraw, const LineLayout *ll,
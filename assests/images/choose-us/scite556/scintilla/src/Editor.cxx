@@ -106,6 +106,10 @@ constexpr bool IsLastStep(const DocModification &mh) noexcept {
 	    && ((mh.modificationType & finalMask) == finalMask);
 }
 
+// Notifications sent before the document changes that the container may act on while they are handled
+constexpr ModificationFlags modifiedBeforeChange =
+	ModificationFlags::InsertCheck | ModificationFlags::BeforeInsert | ModificationFlags::BeforeDelete;
+
 constexpr bool IsAllSpacesOrTabs(std::string_view sv) noexcept {
 	for (const char ch : sv) {
 		// This is safe because IsSpaceOrTab() will return false for null terminators
@@ -428,6 +432,10 @@ bool Editor::AbandonPaint() {
 
 void Editor::RedrawRect(PRectangle rc) {
 	//Platform::DebugPrintf("Redraw %0d,%0d - %0d,%0d\n", rc.left, rc.top, rc.right, rc.bottom);
+	if (batchDepth > 0) {
+		redrawPendingBatch = true;
+		return;
+	}
 
 	// Clip the redraw rectangle into the client area
 	const PRectangle rcClient = GetClientRectangle();
@@ -450,6 +458,10 @@ void Editor::DiscardOverdraw() {
 }
 
 void Editor::Redraw() {
+	if (batchDepth > 0) {
+		redrawPendingBatch = true;
+		return;
+	}
 	if (redrawPendingText) {
 		return;
 	}
@@ -464,6 +476,10 @@ void Editor::Redraw() {
 }
 
 void Editor::RedrawSelMargin(Sci::Line line, bool allAfter) {
+	if (batchDepth > 0) {
+		redrawPendingBatch = true;
+		return;
+	}
 	const bool markersInText = vs.maskInLine || vs.maskDrawInText;
 	if (!HasMarginWindow() || markersInText) {	// May affect text area so may need to abandon and retry
 		if (AbandonPaint()) {
@@ -752,22 +768,28 @@ void Editor::MultipleSelectAdd(AddNumber addNumber) {
 		}
 
 		for (const Range range : searchRanges) {
-			Sci::Position searchStart = range.start;
-			const Sci::Position searchEnd = range.end;
-			for (;;) {
+			if (addNumber == AddNumber::one) {
 				Sci::Position lengthFound = selectedText.length();
-				const Sci::Position pos = pdoc->FindText(searchStart, searchEnd,
+				const Sci::Position pos = pdoc->FindText(range.start, range.end,
 					selectedText.c_str(), searchFlags, &lengthFound);
 				if (pos >= 0) {
 					sel.AddSelection(SelectionRange(pos + lengthFound, pos));
 					ContainerNeedsUpdate(Update::Selection);
 					ScrollRange(sel.RangeMain());
 					Redraw();
-					if (addNumber == AddNumber::one)
-						return;
-					searchStart = pos + lengthFound;
-				} else {
-					break;
+					return;
+				}
+			} else {
+				// Find every match in one pass then update the view once
+				const std::vector<Range> matches = pdoc->FindAll(range.start, range.end,
+					selectedText.c_str(), searchFlags, selectedText.length());
+				for (const Range &found : matches) {
+					sel.AddSelection(SelectionRange(found.end, found.start));
+				}
+				if (!matches.empty()) {
+					ContainerNeedsUpdate(Update::Selection);
+					ScrollRange(sel.RangeMain());
+					Redraw();
 				}
 			}
 		}
@@ -1575,7 +1597,7 @@ bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToW
 		std::future<void> fut = std::async(policy,
 			[=, &surface, &nextIndex, &linesAfterWrap, &mutexRetrieve]() {
 			// llTemporary is reused for non-significant lines, avoiding allocation costs.
-			std::shared_ptr<LineLayout> llTemporary = std::make_shared<LineLayout>(-1, 200);
+			std::shared_ptr<LineLayout> llTemporary = view.llc.Create(-1, 200);
 			while (true) {
 				const size_t i = nextIndex.fetch_add(1, std::memory_order_acq_rel);
 				if (i >= linesBeingWrapped) {
@@ -1612,7 +1634,7 @@ bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToW
 	// Wrap all the long lines in the main thread.
 	// LayoutLine may then multi-thread over segments in each line.
 
-	std::shared_ptr<LineLayout> llLarge = std::make_shared<LineLayout>(-1, 200);
+	std::shared_ptr<LineLayout> llLarge = view.llc.Create(-1, 200);
 	for (size_t indexLarge = 0; indexLarge < linesBeingWrapped; indexLarge++) {
 		const Sci::Line lineNumber = lineToWrap + indexLarge;
 		const Range rangeLine = pdoc->LineRange(lineNumber);
@@ -2549,7 +2571,7 @@ void Editor::NotifySavePoint(bool isSavePoint) {
 	} else {
 		scn.nmhdr.code = Notification::SavePointLeft;
 	}
-	NotifyParent(scn);
+	NotifyParentAfterBatch(scn);
 }
 
 void Editor::NotifyModifyAttempt() {
@@ -2818,6 +2840,10 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 			braces[0] = MovePositionForDeletion(braces[0], mh.position, mh.length);
 			braces[1] = MovePositionForDeletion(braces[1], mh.position, mh.length);
 		}
+		if (FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText)) {
+			// Matches are only valid for the text that was searched
+			searchAllMatches.clear();
+		}
 		if (FlagSet(mh.modificationType, ModificationFlags::BeforeInsert | ModificationFlags::BeforeDelete) && pcs->HiddenLines()) {
 			// Some lines are hidden so may need shown.
 			const Sci::Line lineOfPos = pdoc->SciLineFromPosition(mh.position);
@@ -2941,7 +2967,7 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 		scn.foldLevelPrev = mh.foldLevelPrev;
 		scn.token = static_cast<int>(mh.token);
 		scn.annotationLinesAdded = mh.annotationLinesAdded;
-		NotifyParent(scn);
+		NotifyParentAfterBatch(scn);
 	}
 }
 
@@ -3083,6 +3109,141 @@ void Editor::NotifyMacroRecord(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	NotifyParent(scn);
 }
 
+// Modification and save point notifications are queued while a batch runs. The text of
+// a modification is only valid during the notification so it is copied.
+// Notifications before a change are sent immediately as SCI_CHANGEINSERTION is only valid
+// while handling SC_MOD_INSERTCHECK.
+void Editor::NotifyParentAfterBatch(const NotificationData &scn) {
+	if ((batchDepth > 0) &&
+		!((scn.nmhdr.code == Notification::Modified) && FlagSet(scn.modificationType, modifiedBeforeChange))) {
+		if (!deferredNotifications.empty() && MergeDeferred(deferredNotifications.back(), scn)) {
+			return;
+		}
+		DeferredNotification deferred{ scn, {} };
+		if (scn.text && (scn.length > 0)) {
+			deferred.text.assign(scn.text, scn.length);
+		}
+		deferredNotifications.push_back(std::move(deferred));
+	} else {
+		NotifyParent(scn);
+	}
+}
+
+// Adjacent changes of the same kind are queued as one so that a batch of small edits or
+// styling calls sends a single notification. Insertions and deletions keep their text.
+bool Editor::MergeDeferred(DeferredNotification &deferred, const NotificationData &scn) {
+	NotificationData &queued = deferred.scn;
+	if ((queued.nmhdr.code != Notification::Modified) || (scn.nmhdr.code != Notification::Modified)) {
+		return false;
+	}
+	const ModificationFlags mergeable = ModificationFlags::InsertText | ModificationFlags::DeleteText |
+		ModificationFlags::ChangeStyle | ModificationFlags::ChangeIndicator;
+	const ModificationFlags kind = static_cast<ModificationFlags>(
+		static_cast<int>(scn.modificationType) & ~static_cast<int>(ModificationFlags::StartAction));
+	const ModificationFlags kindQueued = static_cast<ModificationFlags>(
+		static_cast<int>(queued.modificationType) & ~static_cast<int>(ModificationFlags::StartAction));
+	if ((kind != kindQueued) || (scn.token != queued.token)) {
+		return false;
+	}
+	const ModificationFlags change = kind & mergeable;
+	if (change == ModificationFlags::InsertText) {
+		if (scn.position != queued.position + queued.length) {
+			return false;
+		}
+		if (scn.text) {
+			deferred.text.append(scn.text, scn.length);
+		}
+	} else if (change == ModificationFlags::DeleteText) {
+		if (scn.position == queued.position) {
+			// Deleting forward
+			if (scn.text) {
+				deferred.text.append(scn.text, scn.length);
+			}
+		} else if (scn.position + scn.length == queued.position) {
+			// Deleting backward
+			if (scn.text) {
+				deferred.text.insert(0, scn.text, scn.length);
+			}
+			queued.position = scn.position;
+		} else {
+			return false;
+		}
+	} else if ((change == ModificationFlags::ChangeStyle) || (change == ModificationFlags::ChangeIndicator)) {
+		const Sci::Position start = std::min(queued.position, scn.position);
+		const Sci::Position end = std::max(queued.position + queued.length, scn.position + scn.length);
+		if (end - start > queued.length + scn.length) {
+			// Not touching
+			return false;
+		}
+		queued.position = start;
+		queued.length = end - start;
+		return true;
+	} else {
+		return false;
+	}
+	queued.length += scn.length;
+	queued.linesAdded += scn.linesAdded;
+	return true;
+}
+
+// Send the notifications queued during a batch in order.
+void Editor::FlushBatchNotifications() {
+	// Notification handlers may execute another batch so take ownership of the queue first
+	std::vector<DeferredNotification> notifications;
+	notifications.swap(deferredNotifications);
+	for (DeferredNotification &deferred : notifications) {
+		if (!deferred.text.empty()) {
+			deferred.scn.text = deferred.text.c_str();
+		}
+		NotifyParent(deferred.scn);
+	}
+}
+
+Sci::Position Editor::ExecuteBatch(Sci::Position count, MessageBatch *batch) {
+	if (!batch) {
+		return 0;
+	}
+	batch->executed = 0;
+	if (!batch->messages || (count <= 0)) {
+		return 0;
+	}
+	const bool failedBefore = (errorStatus > Status::Ok) && (errorStatus < Status::WarnStart);
+	Sci::Position executed = 0;
+	batchDepth++;
+	try {
+		while (executed < count) {
+			const BatchMessage &bm = batch->messages[executed];
+			// Call through the virtual WndProc so platform layer messages are also available
+			const sptr_t result = WndProc(static_cast<Message>(bm.message), bm.wParam, bm.lParam);
+			if (batch->results) {
+				batch->results[executed] = result;
+			}
+			executed++;
+			batch->executed = executed;
+			if (!failedBefore && (errorStatus > Status::Ok) && (errorStatus < Status::WarnStart)) {
+				break;
+			}
+		}
+	} catch (...) {
+		EndBatch();
+		throw;
+	}
+	EndBatch();
+	return executed;
+}
+
+void Editor::EndBatch() {
+	batchDepth--;
+	if (batchDepth > 0) {
+		return;
+	}
+	if (redrawPendingBatch) {
+		redrawPendingBatch = false;
+		Redraw();
+	}
+	FlushBatchNotifications();
+}
+
 // Something has changed that the container should know about
 void Editor::ContainerNeedsUpdate(Update flags) noexcept {
 	needUpdateUI = needUpdateUI | flags;
@@ -4392,6 +4553,31 @@ Sci::Position Editor::SearchInTarget(const char *text, Sci::Position length) {
 	}
 }
 
+Sci::Position Editor::SearchAllInTarget(const char *text, Sci::Position length) {
+	searchAllMatches.clear();
+	if (!pdoc->HasCaseFolder())
+		pdoc->SetCaseFolder(CaseFolderForEncoding());
+	try {
+		searchAllMatches = pdoc->FindAll(targetRange.start.Position(), targetRange.end.Position(), text,
+				searchFlags, length);
+		return searchAllMatches.size();
+	} catch (RegexError &) {
+		errorStatus = Status::RegEx;
+		return 0;
+	}
+}
+
+Sci::Position Editor::GetSearchAllRanges(Sci::Position count, Sci::Position *ranges) const noexcept {
+	const Sci::Position retrieved = std::min<Sci::Position>(count, searchAllMatches.size());
+	if (ranges) {
+		for (Sci::Position i = 0; i < retrieved; i++) {
+			ranges[i * 2] = searchAllMatches[i].start;
+			ranges[i * 2 + 1] = searchAllMatches[i].Length();
+		}
+	}
+	return retrieved;
+}
+
 void Editor::GoToLine(Sci::Line lineNo) {
 	if (lineNo > pdoc->LinesTotal())
 		lineNo = pdoc->LinesTotal();
@@ -6540,6 +6726,17 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		PLATFORM_ASSERT(lParam);
 		return SearchInTarget(ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
 
+	case Message::SearchAllInTarget:
+		PLATFORM_ASSERT(lParam);
+		return SearchAllInTarget(ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
+
+	case Message::GetSearchAllRanges:
+		return GetSearchAllRanges(PositionFromUPtr(wParam), static_cast<Sci::Position *>(PtrFromSPtr(lParam)));
+
+	case Message::IndicatorFillSearchAll:
+		pdoc->DecorationFillRanges(searchAllMatches, pdoc->decorations->GetCurrentValue());
+		break;
+
 	case Message::SetSearchFlags:
 		searchFlags = static_cast<FindOption>(wParam);
 		break;
@@ -7261,6 +7458,9 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetLayoutCache:
 		return static_cast<sptr_t>(view.llc.GetLevel());
 
+	case Message::GetLayoutAllocations:
+		return static_cast<sptr_t>(view.llc.Allocations());
+
 	case Message::SetPositionCache:
 		view.posCache->SetSize(wParam);
 		break;
@@ -8694,6 +8894,9 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetGapPosition:
 		return pdoc->GapPosition();
 
+	case Message::ExecuteBatch:
+		return ExecuteBatch(PositionFromUPtr(wParam), static_cast<MessageBatch *>(PtrFromSPtr(lParam)));
+
 	case Message::SetChangeHistory:
 		changeHistoryOption = static_cast<ChangeHistoryOption>(wParam);
 		pdoc->ChangeHistorySet(wParam & 1);
@@ -192,6 +192,15 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool redrawPendingText = false;
 	bool redrawPendingMargin = false;
 
+	// While executing a batch of messages, redraws and modification notifications are deferred
+	struct DeferredNotification {
+		Scintilla::NotificationData scn;
+		std::string text;
+	};
+	int batchDepth = 0;
+	bool redrawPendingBatch = false;
+	std::vector<DeferredNotification> deferredNotifications;
+
 	/** Style resources may be expensive to allocate so are cached between uses.
 	 * When a style attribute is changed, this cache is flushed. */
 	bool stylesValid;
@@ -250,6 +259,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	Sci::Position wordSelectInitialCaretPos;
 	SelectionSegment targetRange;
 	Scintilla::FindOption searchFlags;
+	std::vector<Range> searchAllMatches;
 	Sci::Line topLine;
 	Sci::Position posTopLine;
 	Sci::Position lengthForEncode;
@@ -484,6 +494,11 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void NotifyErrorOccurred(Document *doc, void *userData, Scintilla::Status status) override;
 	void NotifyGroupCompleted(Document *, void *) noexcept override;
 	void NotifyMacroRecord(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam);
+	void NotifyParentAfterBatch(const Scintilla::NotificationData &scn);
+	static bool MergeDeferred(DeferredNotification &deferred, const Scintilla::NotificationData &scn);
+	void FlushBatchNotifications();
+	Sci::Position ExecuteBatch(Sci::Position count, Scintilla::MessageBatch *batch);
+	void EndBatch();
 
 	void ContainerNeedsUpdate(Scintilla::Update flags) noexcept;
 	void PageMove(int direction, Selection::SelTypes selt=Selection::SelTypes::none, bool stuttered = false);
@@ -521,6 +536,8 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void SearchAnchor() noexcept;
 	Sci::Position SearchText(Scintilla::Message iMessage, Scintilla::uptr_t wParam, Scintilla::sptr_t lParam);
 	Sci::Position SearchInTarget(const char *text, Sci::Position length);
+	Sci::Position SearchAllInTarget(const char *text, Sci::Position length);
+	Sci::Position GetSearchAllRanges(Sci::Position count, Sci::Position *ranges) const noexcept;
 	void GoToLine(Sci::Line lineNo);
 
 	virtual void CopyToClipboard(const SelectionText &selectedText) = 0;
@@ -311,6 +311,15 @@ public:
 	virtual void ListNotify(ListBoxEvent *plbe)=0;
 };
 
+// AutoComplete implements IListBoxSource so a ListBox can retrieve items as they are displayed
+
+class IListBoxSource {
+public:
+	virtual int Count() const noexcept=0;
+	virtual std::string_view Text(int item) const noexcept=0;
+	virtual int ImageType(int item) const noexcept=0;
+};
+
 struct ListOptions {
 	std::optional<ColourRGBA> fore;
 	std::optional<ColourRGBA> back;
@@ -344,6 +353,9 @@ public:
 	virtual void ClearRegisteredImages()=0;
 	virtual void SetDelegate(IListBoxDelegate *lbDelegate)=0;
 	virtual void SetList(const char* list, char separator, char typesep)=0;
+	/// Show the items of source, which must remain valid until the list is cleared or set again.
+	/// Returns false when the platform does not support this so SetList should be called instead.
+	virtual bool SetSource(const IListBoxSource *) { return false; }
 	virtual void SetOptions(ListOptions options_)=0;
 };
 
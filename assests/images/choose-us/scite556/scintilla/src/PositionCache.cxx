@@ -22,6 +22,7 @@
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <tuple>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -63,12 +64,138 @@ void BidiData::Resize(size_t maxLineLength_) {
 	widthReprs.resize(maxLineLength_ + 1);
 }
 
-LineLayout::LineLayout(Sci::Line lineNumber_, int maxLineLength_) :
+namespace Scintilla::Internal {
+
+/**
+ * Keeps the arrays released by LineLayouts in power of two size classes so that laying out
+ * lines of varying lengths reuses memory instead of repeatedly freeing and allocating it.
+ * Shared by the threads wrapping lines so access is serialized.
+ */
+class LineLayoutArena {
+	// The smallest class holds 2^classMinimum elements.
+	// Longer arrays are not kept so are allocated at their exact length.
+	static constexpr size_t classMinimum = 6;
+	static constexpr size_t classLargestKept = 14;
+	// Bound the memory held for lines no longer laid out
+	static constexpr size_t blocksPerClass = 16;
+	template <typename T>
+	struct Pool {
+		std::vector<std::unique_ptr<T[]>> blocks[classLargestKept + 1];
+		Pool() {
+			// Reserved so that returning a block never allocates
+			for (std::vector<std::unique_ptr<T[]>> &blocksClass : blocks) {
+				blocksClass.reserve(blocksPerClass);
+			}
+		}
+	};
+	std::tuple<Pool<char>, Pool<unsigned char>, Pool<XYPOSITION>, Pool<int>> pools;
+	mutable std::mutex mutex;
+	size_t allocations = 0;
+
+	static size_t SizeClass(size_t length) noexcept {
+		size_t sizeClass = 0;
+		while ((static_cast<size_t>(1) << (sizeClass + classMinimum)) < length) {
+			sizeClass++;
+		}
+		return sizeClass;
+	}
+public:
+	// Lengths that may be kept are rounded up to their size class.
+	static size_t RoundedLength(size_t length) noexcept {
+		const size_t sizeClass = SizeClass(length);
+		if (sizeClass > classLargestKept) {
+			return length;
+		}
+		return static_cast<size_t>(1) << (sizeClass + classMinimum);
+	}
+
+	size_t Allocations() const noexcept {
+		std::lock_guard<std::mutex> guard(mutex);
+		return allocations;
+	}
+
+	// length must be a RoundedLength.
+	// Blocks are not cleared as the layout writes each element before it is read.
+	template <typename T>
+	std::unique_ptr<T[]> Take(size_t length) {
+		const size_t sizeClass = SizeClass(length);
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			if (sizeClass <= classLargestKept) {
+				std::vector<std::unique_ptr<T[]>> &blocks = std::get<Pool<T>>(pools).blocks[sizeClass];
+				if (!blocks.empty()) {
+					std::unique_ptr<T[]> block = std::move(blocks.back());
+					blocks.pop_back();
+					return block;
+				}
+			}
+			allocations++;
+		}
+		return std::unique_ptr<T[]>(new T[length]);
+	}
+
+	template <typename T>
+	void Give(std::unique_ptr<T[]> &block, size_t length) noexcept {
+		const size_t sizeClass = SizeClass(length);
+		if (block && (sizeClass <= classLargestKept)) {
+			try {
+				std::lock_guard<std::mutex> guard(mutex);
+				std::vector<std::unique_ptr<T[]>> &blocks = std::get<Pool<T>>(pools).blocks[sizeClass];
+				if (blocks.size() < blocksPerClass) {
+					blocks.push_back(std::move(block));
+				}
+			} catch (...) {
+				// Failed to lock so just free the block
+			}
+		}
+		block.reset();
+	}
+};
+
+}
+
+namespace {
+
+size_t ArrayLength(const LineLayoutArena *arena, size_t length) noexcept {
+	return arena ? LineLayoutArena::RoundedLength(length) : length;
+}
+
+template <typename T>
+std::unique_ptr<T[]> TakeArray(LineLayoutArena *arena, size_t length) {
+	if (arena) {
+		return arena->Take<T>(length);
+	}
+	return std::unique_ptr<T[]>(new T[length]);
+}
+
+template <typename T>
+void ReleaseArray(LineLayoutArena *arena, std::unique_ptr<T[]> &array, size_t length) noexcept {
+	if (arena) {
+		arena->Give(array, length);
+	}
+	array.reset();
+}
+
+template <typename T>
+void GrowArray(LineLayoutArena *arena, std::unique_ptr<T[]> &array, size_t length, size_t lengthNew, size_t lengthHeld) {
+	std::unique_ptr<T[]> arrayNew = TakeArray<T>(arena, lengthNew);
+	std::copy(array.get(), array.get() + lengthHeld, arrayNew.get());
+	ReleaseArray(arena, array, length);
+	array = std::move(arrayNew);
+}
+
+}
+
+LineLayout::LineLayout(Sci::Line lineNumber_, int maxLineLength_, std::shared_ptr<LineLayoutArena> arena_) :
 	lenLineStarts(0),
 	lineNumber(lineNumber_),
+	arena(std::move(arena_)),
+	lengthAllocated(0),
 	maxLineLength(-1),
 	numCharsInLine(0),
 	numCharsBeforeEOL(0),
+	startWindow(0),
+	endWindow(0),
 	validity(ValidLevel::invalid),
 	xHighlightGuide(0),
 	highlightColumn(false),
@@ -85,19 +212,12 @@ LineLayout::~LineLayout() {
 	Free();
 }
 
+// The arrays are allocated by SetWindow for the part of the line laid out.
 void LineLayout::Resize(int maxLineLength_) {
 	if (maxLineLength_ > maxLineLength) {
-		Free();
-		const size_t lineAllocation = maxLineLength_ + 1;
-		chars = std::make_unique<char[]>(lineAllocation);
-		styles = std::make_unique<unsigned char []>(lineAllocation);
-		// Extra position allocated as sometimes the Windows
-		// GetTextExtentExPoint API writes an extra element.
-		positions = std::make_unique<XYPOSITION []>(lineAllocation + 1);
 		if (bidiData) {
 			bidiData->Resize(maxLineLength_);
 		}
-
 		maxLineLength = maxLineLength_;
 	}
 }
@@ -117,16 +237,86 @@ void LineLayout::EnsureBidiData() {
 }
 
 void LineLayout::Free() noexcept {
-	chars.reset();
-	styles.reset();
-	positions.reset();
-	lineStarts.reset();
+	ReleaseArray(arena.get(), chars.data, lengthAllocated);
+	ReleaseArray(arena.get(), styles.data, lengthAllocated);
+	ReleaseArray(arena.get(), positions.data, lengthAllocated);
+	lengthAllocated = 0;
+	startWindow = 0;
+	endWindow = 0;
+	checkpoints.clear();
+	ReleaseArray(arena.get(), lineStarts, lenLineStarts);
 	lenLineStarts = 0;
 	bidiData.reset();
 }
 
-void LineLayout::ClearPositions() {
-	std::fill(&positions[0], &positions[maxLineLength + 2], 0.0f);
+// Hold the layout of the window of the line, discarding any previous layout.
+void LineLayout::SetWindow(Range window) {
+	// Extra position allocated as sometimes the Windows
+	// GetTextExtentExPoint API writes an extra element.
+	const size_t lengthWindow = window.Length() + 2;
+	if (lengthWindow > lengthAllocated) {
+		ReleaseArray(arena.get(), chars.data, lengthAllocated);
+		ReleaseArray(arena.get(), styles.data, lengthAllocated);
+		ReleaseArray(arena.get(), positions.data, lengthAllocated);
+		// Arrays share a length so they are in the same size class of the arena.
+		const size_t lengthArrays = ArrayLength(arena.get(), lengthWindow);
+		chars.data = TakeArray<char>(arena.get(), lengthArrays);
+		styles.data = TakeArray<unsigned char>(arena.get(), lengthArrays);
+		positions.data = TakeArray<XYPOSITION>(arena.get(), lengthArrays);
+		lengthAllocated = lengthArrays;
+	}
+	startWindow = static_cast<int>(window.start);
+	endWindow = static_cast<int>(window.end);
+	chars.start = startWindow;
+	styles.start = startWindow;
+	positions.start = startWindow;
+}
+
+// Extend the window to end, keeping the layout already held.
+void LineLayout::ExtendWindow(int end) {
+	const size_t lengthWindow = end - startWindow + 2;
+	if (lengthWindow > lengthAllocated) {
+		const size_t lengthArrays = ArrayLength(arena.get(), lengthWindow);
+		const size_t lengthHeld = endWindow - startWindow + 1;
+		GrowArray(arena.get(), chars.data, lengthAllocated, lengthArrays, lengthHeld);
+		GrowArray(arena.get(), styles.data, lengthAllocated, lengthArrays, lengthHeld);
+		GrowArray(arena.get(), positions.data, lengthAllocated, lengthArrays, lengthHeld);
+		lengthAllocated = lengthArrays;
+	}
+	endWindow = end;
+}
+
+bool LineLayout::Windowed() const noexcept {
+	return !checkpoints.empty();
+}
+
+Range LineLayout::ClipToWindow(Range range) const noexcept {
+	return Range(std::clamp<Sci::Position>(range.start, startWindow, endWindow),
+		std::clamp<Sci::Position>(range.end, startWindow, endWindow));
+}
+
+// The index of the chunk of a windowed line that holds position.
+size_t LineLayout::ChunkFromPosition(Sci::Position position) const noexcept {
+	const std::vector<LayoutCheckpoint>::const_iterator it = std::upper_bound(
+		checkpoints.begin() + 1, checkpoints.end() - 1, position,
+		[](Sci::Position pos, const LayoutCheckpoint &checkpoint) noexcept {
+			return pos < checkpoint.position;
+		});
+	return it - checkpoints.begin() - 1;
+}
+
+// The index of the chunk of a windowed line that holds x.
+size_t LineLayout::ChunkFromX(XYPOSITION x) const noexcept {
+	const std::vector<LayoutCheckpoint>::const_iterator it = std::upper_bound(
+		checkpoints.begin() + 1, checkpoints.end() - 1, x,
+		[](XYPOSITION xPos, const LayoutCheckpoint &checkpoint) noexcept {
+			return xPos < checkpoint.x;
+		});
+	return it - checkpoints.begin() - 1;
+}
+
+void LineLayout::ClearPositions(Range range) {
+	std::fill(&positions[range.start + 1], &positions[range.end + 1], 0.0f);
 }
 
 void LineLayout::Invalidate(ValidLevel validity_) noexcept {
@@ -203,11 +393,14 @@ int LineLayout::SubLineFromPosition(int posInLine, PointEnd pe) const noexcept {
 void LineLayout::AddLineStart(Sci::Position start) {
 	lines++;
 	if (lines >= lenLineStarts) {
-		const int newMaxLines = lines + 20;
-		std::unique_ptr<int[]> newLineStarts = std::make_unique<int[]>(newMaxLines);
+		const int newMaxLines = static_cast<int>(ArrayLength(arena.get(), lines + 20));
+		std::unique_ptr<int[]> newLineStarts = TakeArray<int>(arena.get(), newMaxLines);
 		if (lenLineStarts) {
 			std::copy(lineStarts.get(), lineStarts.get() + lenLineStarts, newLineStarts.get());
 		}
+		// Arrays from the arena may hold values from an earlier line
+		std::fill(newLineStarts.get() + lenLineStarts, newLineStarts.get() + newMaxLines, 0);
+		ReleaseArray(arena.get(), lineStarts, lenLineStarts);
 		lineStarts = std::move(newLineStarts);
 		lenLineStarts = newMaxLines;
 	}
@@ -218,14 +411,14 @@ void LineLayout::SetBracesHighlight(Range rangeLine, const Sci::Position braces[
                                     char bracesMatchStyle, int xHighlight, bool ignoreStyle) {
 	if (!ignoreStyle && rangeLine.ContainsCharacter(braces[0])) {
 		const Sci::Position braceOffset = braces[0] - rangeLine.start;
-		if (braceOffset < numCharsInLine) {
+		if ((braceOffset >= startWindow) && (braceOffset < endWindow)) {
 			bracePreviousStyles[0] = styles[braceOffset];
 			styles[braceOffset] = bracesMatchStyle;
 		}
 	}
 	if (!ignoreStyle && rangeLine.ContainsCharacter(braces[1])) {
 		const Sci::Position braceOffset = braces[1] - rangeLine.start;
-		if (braceOffset < numCharsInLine) {
+		if ((braceOffset >= startWindow) && (braceOffset < endWindow)) {
 			bracePreviousStyles[1] = styles[braceOffset];
 			styles[braceOffset] = bracesMatchStyle;
 		}
@@ -239,13 +432,13 @@ void LineLayout::SetBracesHighlight(Range rangeLine, const Sci::Position braces[
 void LineLayout::RestoreBracesHighlight(Range rangeLine, const Sci::Position braces[], bool ignoreStyle) {
 	if (!ignoreStyle && rangeLine.ContainsCharacter(braces[0])) {
 		const Sci::Position braceOffset = braces[0] - rangeLine.start;
-		if (braceOffset < numCharsInLine) {
+		if ((braceOffset >= startWindow) && (braceOffset < endWindow)) {
 			styles[braceOffset] = bracePreviousStyles[0];
 		}
 	}
 	if (!ignoreStyle && rangeLine.ContainsCharacter(braces[1])) {
 		const Sci::Position braceOffset = braces[1] - rangeLine.start;
-		if (braceOffset < numCharsInLine) {
+		if ((braceOffset >= startWindow) && (braceOffset < endWindow)) {
 			styles[braceOffset] = bracePreviousStyles[1];
 		}
 	}
@@ -253,6 +446,7 @@ void LineLayout::RestoreBracesHighlight(Range rangeLine, const Sci::Position bra
 }
 
 int LineLayout::FindBefore(XYPOSITION x, Range range) const noexcept {
+	range = ClipToWindow(range);
 	Sci::Position lower = range.start;
 	Sci::Position upper = range.end;
 	do {
@@ -269,6 +463,7 @@ int LineLayout::FindBefore(XYPOSITION x, Range range) const noexcept {
 
 
 int LineLayout::FindPositionFromX(XYPOSITION x, Range range, bool charPosition) const noexcept {
+	range = ClipToWindow(range);
 	int pos = FindBefore(x, range);
 	while (pos < range.end) {
 		if (charPosition) {
@@ -289,7 +484,7 @@ Point LineLayout::PointFromPosition(int posInLine, int lineHeight, PointEnd pe)
 	Point pt;
 	// In case of very long line put x at arbitrary large position
 	if (posInLine > maxLineLength) {
-		pt.x = positions[maxLineLength] - positions[LineStart(lines)];
+		pt.x = XInLine(maxLineLength) - XInLine(LineStart(lines));
 	}
 
 	for (int subLine = 0; subLine < lines; subLine++) {
@@ -297,13 +492,13 @@ Point LineLayout::PointFromPosition(int posInLine, int lineHeight, PointEnd pe)
 		if (posInLine >= rangeSubLine.start) {
 			pt.y = static_cast<XYPOSITION>(subLine*lineHeight);
 			if (posInLine <= rangeSubLine.end) {
-				pt.x = positions[posInLine] - positions[rangeSubLine.start];
+				pt.x = XInLine(posInLine) - XSubLineStart(subLine);
 				if (rangeSubLine.start != 0)	// Wrapped lines may be indented
 					pt.x += wrapIndent;
 				if (FlagSet(pe, PointEnd::subLineEnd))	// Return end of first subline not start of next
 					break;
 			} else if (FlagSet(pe, PointEnd::lineEnd) && (subLine == (lines-1))) {
-				pt.x = positions[numCharsInLine] - positions[rangeSubLine.start];
+				pt.x = XInLine(numCharsInLine) - XSubLineStart(subLine);
 				if (rangeSubLine.start != 0)	// Wrapped lines may be indented
 					pt.x += wrapIndent;
 			}
@@ -316,14 +511,34 @@ Point LineLayout::PointFromPosition(int posInLine, int lineHeight, PointEnd pe)
 
 XYPOSITION LineLayout::XInLine(Sci::Position index) const noexcept {
 	// For positions inside line return value from positions
-	// For positions after line return last position + 1.0
-	if (index <= numCharsInLine) {
+	// For positions before the window held return first position - 1.0
+	// For positions after line or window return last position + 1.0
+	if (index < startWindow) {
+		return positions[startWindow] - 1.0;
+	}
+	if (index <= endWindow) {
 		return positions[index];
 	}
-	return positions[numCharsInLine] + 1.0;
+	return positions[endWindow] + 1.0;
+}
+
+// The first subline starts at 0 even when the window held starts later.
+XYPOSITION LineLayout::XSubLineStart(int subLine) const noexcept {
+	const int start = LineStart(subLine);
+	return (start == 0) ? 0.0 : XInLine(start);
+}
+
+XYPOSITION LineLayout::XLineEnd() const noexcept {
+	if (Windowed()) {
+		return checkpoints.back().x;
+	}
+	return positions[numCharsInLine];
 }
 
 Interval LineLayout::Span(int start, int end) const noexcept {
+	if (Windowed()) {
+		return { XInLine(start), XInLine(end) };
+	}
 	return { positions[start], positions[end] };
 }
 
@@ -331,26 +546,47 @@ Interval LineLayout::SpanByte(int index) const noexcept {
 	return Span(index, index+1);
 }
 
+// When the end of the line is not held this is the style at the end of the window.
 int LineLayout::EndLineStyle() const noexcept {
-	return styles[numCharsBeforeEOL > 0 ? numCharsBeforeEOL-1 : 0];
+	const int end = std::min(numCharsBeforeEOL, endWindow);
+	return styles[end > startWindow ? end-1 : startWindow];
+}
+
+// The style after the text of the line used to fill past its end, taken from the end of
+// the window when the line end is not held.
+int LineLayout::StyleAtLineEnd() const noexcept {
+	return styles[std::min(numCharsInLine, endWindow)];
 }
 
 void LineLayout::WrapLine(const Document *pdoc, Sci::Position posLineStart, Wrap wrapState, XYPOSITION wrapWidth) {
+	lines = 0;
+	WrapRange(pdoc, posLineStart, wrapState, wrapWidth, numCharsInLine);
+	lines++;
+}
+
+/**
+* Calculate line start positions based upon width for the text up to @a end, continuing
+* from the last line start added. Returns the start of the last subline which may continue after @a end.
+*/
+int LineLayout::WrapRange(const Document *pdoc, Sci::Position posLineStart, Wrap wrapState, XYPOSITION wrapWidth, int end) {
 	// Document wants document positions but simpler to work in line positions
 	// so take care of adding and subtracting line start in a lambda.
 	auto CharacterBoundary = [=](Sci::Position i, Sci::Position moveDir) noexcept -> Sci::Position {
 		return pdoc->MovePositionOutsideChar(i + posLineStart, moveDir) - posLineStart;
 	};
-	lines = 0;
-	// Calculate line start positions based upon width.
 	Sci::Position lastLineStart = 0;
 	XYPOSITION startOffset = wrapWidth;
 	Sci::Position p = 0;
-	while (p < numCharsInLine) {
-		while (p < numCharsInLine && positions[p + 1] < startOffset) {
+	if (lines > 0) {
+		lastLineStart = lineStarts[lines];
+		startOffset = positions[lastLineStart] + wrapWidth - wrapIndent;
+		p = lastLineStart + 1;
+	}
+	while (p < end) {
+		while (p < end && positions[p + 1] < startOffset) {
 			p++;
 		}
-		if (p < numCharsInLine) {
+		if (p < end) {
 			// backtrack to find lastGoodBreak
 			Sci::Position lastGoodBreak = p;
 			if (p > 0) {
@@ -402,7 +638,7 @@ void LineLayout::WrapLine(const Document *pdoc, Sci::Position posLineStart, Wrap
 			p = lastLineStart + 1;
 		}
 	}
-	lines++;
+	return static_cast<int>(lastLineStart);
 }
 
 ScreenLine::ScreenLine(
@@ -482,6 +718,7 @@ bool SignificantLines::LineMayCache(Sci::Line line) const noexcept {
 
 LineLayoutCache::LineLayoutCache() :
 	level(LineCache::None),
+	arena(std::make_shared<LineLayoutArena>()),
 	maxValidity(LineLayout::ValidLevel::invalid), styleClock(-1) {
 }
 
@@ -638,7 +875,7 @@ std::shared_ptr<LineLayout> LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci:
 			cache[pos].reset();
 		}
 		if (!cache[pos]) {
-			cache[pos] = std::make_shared<LineLayout>(lineNumber, maxChars);
+			cache[pos] = Create(lineNumber, maxChars);
 		}
 #ifdef CHECK_LLC
 		// Expensive check that there is only one entry for any line number
@@ -654,7 +891,17 @@ std::shared_ptr<LineLayout> LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci:
 	}
 
 	// Only reach here for level == Cache::none
-	return std::make_shared<LineLayout>(lineNumber, maxChars);
+	return Create(lineNumber, maxChars);
+}
+
+// Layouts are created with the arena so lines reuse the memory of earlier layouts.
+std::shared_ptr<LineLayout> LineLayoutCache::Create(Sci::Line lineNumber, int maxChars) const {
+	return std::make_shared<LineLayout>(lineNumber, maxChars, arena);
+}
+
+// The number of arrays that could not be reused from the arena.
+size_t LineLayoutCache::Allocations() const noexcept {
+	return arena->Allocations();
 }
 
 namespace {
@@ -711,7 +958,10 @@ void Hexits(char *hexits, int ch) noexcept {
 void SpecialRepresentations::SetRepresentation(std::string_view charBytes, std::string_view value) {
 	if ((charBytes.length() <= 4) && (value.length() <= Representation::maxLength)) {
 		const unsigned int key = KeyFromString(charBytes);
-		const bool inserted = mapReprs.insert_or_assign(key, Representation(value)).second;
+		const auto [it, inserted] = mapReprs.insert_or_assign(key, Representation(value));
+		if (charBytes.length() == 1) {
+			reprsByte[static_cast<unsigned char>(charBytes[0])] = &it->second;
+		}
 		if (inserted) {
 			// New entry so increment for first byte
 			const unsigned char ucStart = charBytes.empty() ? 0 : charBytes[0];
@@ -757,6 +1007,9 @@ void SpecialRepresentations::ClearRepresentation(std::string_view charBytes) {
 		const MapRepresentation::iterator it = mapReprs.find(key);
 		if (it != mapReprs.end()) {
 			mapReprs.erase(it);
+			if (charBytes.length() == 1) {
+				reprsByte[static_cast<unsigned char>(charBytes[0])] = nullptr;
+			}
 			const unsigned char ucStart = charBytes.empty() ? 0 : charBytes[0];
 			startByteHasReprs[ucStart]--;
 			if (key == maxKey && startByteHasReprs[ucStart] == 0) {
@@ -770,6 +1023,9 @@ void SpecialRepresentations::ClearRepresentation(std::string_view charBytes) {
 }
 
 const Representation *SpecialRepresentations::GetRepresentation(std::string_view charBytes) const {
+	if (charBytes.length() == 1) {
+		return reprsByte[static_cast<unsigned char>(charBytes[0])];
+	}
 	const unsigned int key = KeyFromString(charBytes);
 	if (key > maxKey) {
 		return nullptr;
@@ -793,6 +1049,7 @@ const Representation *SpecialRepresentations::RepresentationFromCharacter(std::s
 
 void SpecialRepresentations::Clear() {
 	mapReprs.clear();
+	std::fill(reprsByte, std::end(reprsByte), nullptr);
 	constexpr unsigned short none = 0;
 	std::fill(startByteHasReprs, std::end(startByteHasReprs), none);
 	maxKey = 0;
@@ -848,8 +1105,8 @@ void BreakFinder::Insert(Sci::Position val) {
 BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lineRange_, Sci::Position posLineStart,
 	XYPOSITION xStart, BreakFor breakFor, const Document *pdoc_, const SpecialRepresentations *preprs_, const ViewStyle *pvsDraw) :
 	ll(ll_),
-	lineRange(lineRange_),
-	nextBreak(static_cast<int>(lineRange_.start)),
+	lineRange(ll_->ClipToWindow(lineRange_)),
+	nextBreak(static_cast<int>(lineRange.start)),
 	saeCurrentPos(0),
 	saeNext(0),
 	subBreak(-1),
@@ -913,7 +1170,24 @@ TextSegment BreakFinder::Next() {
 	if (subBreak < 0) {
 		const int prev = nextBreak;
 		const Representation *repr = nullptr;
+		const bool eightBit = encodingFamily == EncodingFamily::eightBit;
 		while (nextBreak < lineRange.end) {
+			// Sweep over bytes that are whole characters without representations in the
+			// style of the previous byte as they can not start a new segment.
+			const Sci::Position endPlain = (saeNext >= nextBreak) ? std::min<Sci::Position>(saeNext, lineRange.end) : lineRange.end;
+			if (nextBreak > ll->startWindow) {
+				const unsigned char styleRun = ll->styles[nextBreak - 1];
+				while ((nextBreak < endPlain) && (ll->styles[nextBreak] == styleRun)) {
+					const unsigned char ch = ll->chars[nextBreak];
+					if (preprs->MayContain(ch) || !(UTF8IsAscii(ch) || eightBit)) {
+						break;
+					}
+					nextBreak++;
+				}
+				if (nextBreak >= lineRange.end) {
+					break;
+				}
+			}
 			int charWidth = 1;
 			const char * const chars = &ll->chars[nextBreak];
 			const unsigned char ch = chars[0];
@@ -948,7 +1222,7 @@ TextSegment BreakFinder::Next() {
 				}
 				repr = preprs->GetRepresentation(std::string_view(chars, charWidth));
 			}
-			if (((nextBreak > 0) && (ll->styles[nextBreak] != ll->styles[nextBreak - 1])) ||
+			if (((nextBreak > ll->startWindow) && (ll->styles[nextBreak] != ll->styles[nextBreak - 1])) ||
 					repr ||
 					(nextBreak == saeNext)) {
 				while ((nextBreak >= saeNext) && (saeNext < lineRange.end)) {
@@ -44,6 +44,30 @@ public:
 	void Resize(size_t maxLineLength_);
 };
 
+class LineLayoutArena;
+
+/**
+ * An array of the layout of a line indexed by position in the line.
+ * Only the elements from start are held so it can hold a window of a very long line.
+ */
+template <typename T>
+struct LayoutArray {
+	std::unique_ptr<T[]> data;
+	int start = 0;
+	T &operator[](Sci::Position index) const noexcept {
+		return data[index - start];
+	}
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(data);
+	}
+};
+
+/// The position and x of the start of a chunk of a very long line.
+struct LayoutCheckpoint {
+	int position;
+	XYPOSITION x;
+};
+
 /**
  */
 class LineLayout {
@@ -52,20 +76,28 @@ private:
 	int lenLineStarts;
 	/// Drawing is only performed for @a maxLineLength characters on each line.
 	Sci::Line lineNumber;
+	/// Arrays are taken from and returned to the arena when there is one.
+	std::shared_ptr<LineLayoutArena> arena;
+	size_t lengthAllocated;
 public:
 	enum { wrapWidthInfinite = 0x7ffffff };
 
 	int maxLineLength;
 	int numCharsInLine;
 	int numCharsBeforeEOL;
+	/// Very long lines hold only a window of their layout from startWindow to endWindow.
+	/// The chunks they are laid out in start at checkpoints which end with the end of the line.
+	int startWindow;
+	int endWindow;
+	std::vector<LayoutCheckpoint> checkpoints;
 	enum class ValidLevel { invalid, checkTextAndStyle, positions, lines } validity;
 	int xHighlightGuide;
 	bool highlightColumn;
 	bool containsCaret;
 	int edgeColumn;
-	std::unique_ptr<char[]> chars;
-	std::unique_ptr<unsigned char[]> styles;
-	std::unique_ptr<XYPOSITION[]> positions;
+	LayoutArray<char> chars;
+	LayoutArray<unsigned char> styles;
+	LayoutArray<XYPOSITION> positions;
 	unsigned char bracePreviousStyles[2];
 
 	std::unique_ptr<BidiData> bidiData;
@@ -75,7 +107,7 @@ public:
 	int lines;
 	XYPOSITION wrapIndent; // In pixels
 
-	LineLayout(Sci::Line lineNumber_, int maxLineLength_);
+	LineLayout(Sci::Line lineNumber_, int maxLineLength_, std::shared_ptr<LineLayoutArena> arena_={});
 	// Deleted so LineLayout objects can not be copied.
 	LineLayout(const LineLayout &) = delete;
 	LineLayout(LineLayout &&) = delete;
@@ -86,7 +118,13 @@ public:
 	void ReSet(Sci::Line lineNumber_, Sci::Position maxLineLength_);
 	void EnsureBidiData();
 	void Free() noexcept;
-	void ClearPositions();
+	void SetWindow(Range window);
+	void ExtendWindow(int end);
+	bool Windowed() const noexcept;
+	Range ClipToWindow(Range range) const noexcept;
+	size_t ChunkFromPosition(Sci::Position position) const noexcept;
+	size_t ChunkFromX(XYPOSITION x) const noexcept;
+	void ClearPositions(Range range);
 	void Invalidate(ValidLevel validity_) noexcept;
 	Sci::Line LineNumber() const noexcept;
 	bool CanHold(Sci::Line lineDoc, int lineLength_) const noexcept;
@@ -105,10 +143,14 @@ public:
 	int FindPositionFromX(XYPOSITION x, Range range, bool charPosition) const noexcept;
 	Point PointFromPosition(int posInLine, int lineHeight, PointEnd pe) const noexcept;
 	XYPOSITION XInLine(Sci::Position index) const noexcept;
+	XYPOSITION XSubLineStart(int subLine) const noexcept;
+	XYPOSITION XLineEnd() const noexcept;
 	Interval Span(int start, int end) const noexcept;
 	Interval SpanByte(int index) const noexcept;
 	int EndLineStyle() const noexcept;
+	int StyleAtLineEnd() const noexcept;
 	void WrapLine(const Document *pdoc, Sci::Position posLineStart, Wrap wrapState, XYPOSITION wrapWidth);
+	int WrapRange(const Document *pdoc, Sci::Position posLineStart, Wrap wrapState, XYPOSITION wrapWidth, int end);
 };
 
 struct ScreenLine : public IScreenLine {
@@ -156,6 +198,7 @@ public:
 private:
 	Scintilla::LineCache level;
 	std::vector<std::shared_ptr<LineLayout>>cache;
+	std::shared_ptr<LineLayoutArena> arena;
 	LineLayout::ValidLevel maxValidity;
 	int styleClock;
 	size_t EntryForLine(Sci::Line line) const noexcept;
@@ -174,6 +217,8 @@ public:
 	Scintilla::LineCache GetLevel() const noexcept { return level; }
 	std::shared_ptr<LineLayout> Retrieve(Sci::Line lineNumber, Sci::Line lineCaret, int maxChars, int styleClock_,
 		Sci::Line linesOnScreen, Sci::Line linesInDoc);
+	std::shared_ptr<LineLayout> Create(Sci::Line lineNumber, int maxChars) const;
+	size_t Allocations() const noexcept;
 };
 
 class Representation {
@@ -194,10 +239,19 @@ void Hexits(char *hexits, int ch) noexcept;
 
 class SpecialRepresentations {
 	MapRepresentation mapReprs;
+	// Single byte representations found without searching mapReprs
+	const Representation *reprsByte[0x100] {};
 	unsigned short startByteHasReprs[0x100] {};
 	unsigned int maxKey = 0;
 	bool crlf = false;
 public:
+	SpecialRepresentations() = default;
+	// Deleted so SpecialRepresentations objects can not be copied as reprsByte points into mapReprs.
+	SpecialRepresentations(const SpecialRepresentations &) = delete;
+	SpecialRepresentations(SpecialRepresentations &&) = delete;
+	void operator=(const SpecialRepresentations &) = delete;
+	void operator=(SpecialRepresentations &&) = delete;
+	~SpecialRepresentations() = default;
 	void SetRepresentation(std::string_view charBytes, std::string_view value);
 	void SetRepresentationAppearance(std::string_view charBytes, RepresentationAppearance appearance);
 	void SetRepresentationColour(std::string_view charBytes, ColourRGBA colour);
@@ -35,11 +35,12 @@
  *  RESearch::Compile:      compile a regular expression into a NFA.
  *
  *          const char *RESearch::Compile(const char *pattern, int length,
- *                                        bool caseSensitive, bool posix)
+ *                                        bool caseSensitive, bool posix,
+ *                                        bool unicode)
  *
  * Returns a short error string if they fail.
  *
- *  RESearch::Execute:      execute the NFA to match a pattern.
+ *  RESearch::Execute:      execute the program to match a pattern.
  *
  *          int RESearch::Execute(characterIndexer &ci, int lp, int endp)
  *
@@ -53,7 +54,8 @@
  *                      character (metachar): . \ [ ] * + ? ^ $
  *                      and ( ) if posix option.
  *
- *      [2]     .       matches any character.
+ *      [2]     .       matches any character. In unicode mode this is
+ *                      a whole UTF-8 character.
  *
  *      [3]     \       matches the character following it, except:
  *                      - \a, \b, \f, \n, \r, \t, \v match the corresponding C
@@ -97,6 +99,9 @@
  *
  *                              [a-zA-Z] any alpha
  *
+ *                      In unicode mode, sets and ranges may contain any
+ *                      UTF-8 character and a set matches a whole character.
+ *
  *      [5]     *       any regular expression form [1] to [4]
  *                      (except [8], [9] and [10] forms of [3]),
  *                      followed by closure char (*)
@@ -141,7 +146,8 @@
  *      [12]    \xHH    a backslash followed by x and two hexa digits,
  *                      becomes the character whose ASCII code is equal
  *                      to these digits. If not followed by two digits,
- *                      it is 'x' char itself.
+ *                      it is 'x' char itself. In unicode mode, this is the
+ *                      character with that code point.
  *
  *      [13]            a composite regular expression xy where x and y
  *                      are in the form [1] to [12] matches the longest
@@ -171,32 +177,47 @@
  *
  * Notes:
  *
- *  This implementation uses a bit-set representation for character
- *  classes for speed and compactness. Each character is represented
- *  by one bit in a 256-bit block. Thus, CCL always takes a
- *	constant 32 bytes in the internal nfa, and RESearch::Execute does a single
- *  bit comparison to locate the character in the set.
+ *  The pattern is compiled into a sequence of nodes, each either a
+ *  character, any character, a character class, an assertion (^ $ \< \>),
+ *  the start or end of a tag or a back reference. Closures apply to the
+ *  single preceding character, any or class node so they are recorded as a
+ *  repeat count on that node.
+ *
+ *  Character classes use a bit-set representation for bytes, so
+ *  RESearch::Execute does a single bit comparison to locate a byte in
+ *  the set. In unicode mode, code points beyond ASCII are held as ranges.
+ *
+ *  Patterns without back references are run by a Pike VM which advances
+ *  all the possible matches together one character at a time, so the time
+ *  taken is proportional to the length of the text times the length of the
+ *  pattern. Threads are kept in priority order so the result is the same
+ *  as the backtracking search: leftmost, with greedy closures as long as
+ *  possible and lazy closures as short as possible. Back references can not
+ *  be matched this way so those patterns use the backtracking PMatch.
+ *
+ *  When every match has to start with one of a known set of bytes, the
+ *  search skips directly to the next of those bytes.
  *
  * Examples:
  *
  *  pattern:    foo*.*
- *  compile:    CHR f CHR o CLO CHR o END CLO ANY END END
+ *  compile:    CHR f, CHR o, CHR o*, ANY*
  *  matches:    fo foo fooo foobar fobar foxx ...
  *
  *  pattern:    fo[ob]a[rz]
- *  compile:    CHR f CHR o CCL bitset CHR a CCL bitset END
+ *  compile:    CHR f, CHR o, CCL set, CHR a, CCL set
  *  matches:    fobar fooar fobaz fooaz
  *
  *  pattern:    foo\\+
- *  compile:    CHR f CHR o CHR o CHR \ CLO CHR \ END END
+ *  compile:    CHR f, CHR o, CHR o, CHR \, CHR \*
  *  matches:    foo\ foo\\ foo\\\  ...
  *
  *  pattern:    \(foo\)[1-3]\1  (same as foo[1-3]foo)
- *  compile:    BOT 1 CHR f CHR o CHR o EOT 1 CCL bitset REF 1 END
+ *  compile:    BOT 1, CHR f, CHR o, CHR o, EOT 1, CCL set, REF 1
  *  matches:    foo1foo foo2foo foo3foo
  *
  *  pattern:    \(fo.*\)-\1
- *  compile:    BOT 1 CHR f CHR o CLO ANY END EOT 1 CHR - REF 1 END
+ *  compile:    BOT 1, CHR f, CHR o, ANY*, EOT 1, CHR -, REF 1
  *  matches:    foo-foo fo-fo fob-fob foobar-foobar ...
  */
 
@@ -205,12 +226,16 @@
 
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <array>
 #include <algorithm>
 #include <iterator>
 
 #include "Position.h"
 #include "CharClassify.h"
+#include "UniConversion.h"
+#include "CaseConvert.h"
 #include "RESearch.h"
 
 using namespace Scintilla::Internal;
@@ -218,29 +243,67 @@ using namespace Scintilla::Internal;
 #define OKP     1
 #define NOP     0
 
-#define CHR     1
-#define ANY     2
-#define CCL     3
-#define BOL     4
-#define EOL     5
-#define BOT     6
-#define EOT     7
-#define BOW     8
-#define EOW     9
-#define REF     10
-#define CLO     11
-#define CLQ     12 /* 0 to 1 closure */
-#define LCLO    13 /* lazy closure */
-
-#define END     0
-
 /*
  * The following defines are not meant to be changeable.
  * They are for readability only.
  */
 #define BITIND  07
 
-#define badpat(x)	(*nfa = END, x)
+#define badpat(x)	(program.clear(), x)
+
+namespace {
+
+// Invalid bytes in unicode mode are treated as characters beyond the Unicode range
+constexpr int invalidByteBase = 0x110000;
+
+constexpr int isinset(const unsigned char *ap, unsigned char c) noexcept {
+	return ap[c >> 3] & (1 << (c & BITIND));
+}
+
+constexpr void setinset(unsigned char *ap, unsigned char c) noexcept {
+	ap[c >> 3] |= 1 << (c & BITIND);
+}
+
+bool InRanges(const std::vector<std::pair<int, int>> &ranges, int ch) noexcept {
+	return std::any_of(ranges.begin(), ranges.end(), [ch](const std::pair<int, int> &range) noexcept {
+		return (ch >= range.first) && (ch <= range.second);
+	});
+}
+
+// The code point of a simple case conversion or -1 when there is none
+int CaseVariant(int ch, CaseConversion conversion) {
+	const char *converted = CaseConvert(ch, conversion);
+	if (!converted || !*converted) {
+		return -1;
+	}
+	const unsigned char *us = reinterpret_cast<const unsigned char *>(converted);
+	const size_t len = std::char_traits<char>::length(converted);
+	const int utf8Status = UTF8Classify(us, len);
+	if ((utf8Status & UTF8MaskInvalid) || (static_cast<size_t>(utf8Status & UTF8MaskWidth) != len)) {
+		// Expands to several characters
+		return -1;
+	}
+	return UnicodeFromUTF8(us);
+}
+
+constexpr CaseConversion caseConversions[] = { CaseConversion::fold, CaseConversion::lower, CaseConversion::upper };
+
+bool HasCaseVariant(int ch) {
+	return std::any_of(std::begin(caseConversions), std::end(caseConversions), [ch](CaseConversion conversion) {
+		return CaseVariant(ch, conversion) >= 0;
+	});
+}
+
+unsigned char LeadByte(int ch) noexcept {
+	if (ch >= invalidByteBase) {
+		return static_cast<unsigned char>(ch - invalidByteBase);
+	}
+	char utf8[UTF8MaxBytes + 1] {};
+	UTF8FromUTF32Character(ch, utf8);
+	return utf8[0];
+}
+
+}
 
 /*
  * Character classification table for word boundary operators BOW
@@ -250,12 +313,15 @@ using namespace Scintilla::Internal;
  */
 
 RESearch::RESearch(CharClassify *charClassTable) {
-	failure = 0;
 	charClass = charClassTable;
 	sta = NOP;                  /* status of lastpat */
 	lineStartPos = 0;
 	lineEndPos = 0;
-	nfa[0] = END;
+	prefilter = false;
+	unicode = false;
+	backtrack = false;
+	tagCount = 0;
+	generation = 0;
 	Clear();
 }
 
@@ -265,7 +331,7 @@ void RESearch::Clear() {
 }
 
 void RESearch::ChSet(unsigned char c) noexcept {
-	bittab[c >> 3] |= 1 << (c & BITIND);
+	setinset(pending.bits.data(), c);
 }
 
 void RESearch::ChSetWithCase(unsigned char c, bool caseSensitive) noexcept {
@@ -279,6 +345,30 @@ void RESearch::ChSetWithCase(unsigned char c, bool caseSensitive) noexcept {
 	}
 }
 
+void RESearch::AddCharacter(int c, bool caseSensitive) {
+	AddRange(c, c, caseSensitive);
+}
+
+void RESearch::AddRange(int first, int last, bool caseSensitive) {
+	const int lastByte = unicode ? 0x7F : MAXCHR - 1;
+	for (int c = first; (c <= last) && (c <= lastByte); c++) {
+		ChSetWithCase(static_cast<unsigned char>(c), caseSensitive);
+	}
+	if (unicode && (last > lastByte)) {
+		pending.ranges.emplace_back(std::max(first, lastByte + 1), last);
+		if (!caseSensitive) {
+			pending.caseSensitive = false;
+		}
+	}
+}
+
+void RESearch::EmitClass(bool negated) {
+	pending.negated = negated;
+	program.push_back({ Op::Class, Repeat::One, static_cast<int>(classes.size()) });
+	classes.push_back(std::move(pending));
+	pending = CharacterClass();
+}
+
 namespace {
 
 constexpr unsigned char escapeValue(unsigned char ch) noexcept {
@@ -318,10 +408,6 @@ constexpr int GetHexaChar(unsigned char hd1, unsigned char hd2) noexcept {
 	return hexValue;
 }
 
-constexpr int isinset(const char *ap, unsigned char c) noexcept {
-	return ap[c >> 3] & (1 << (c & BITIND));
-}
-
 }
 
 /**
@@ -330,7 +416,7 @@ constexpr int isinset(const char *ap, unsigned char c) noexcept {
  * @param pattern : pointer on the char after the backslash.
  * @param incr : (out) number of chars to skip after expression evaluation.
  * @return the char if it resolves to a simple char,
- * or -1 for a char class. In this case, bittab is changed.
+ * or -1 for a char class. In this case, the pending class is changed.
  */
 int RESearch::GetBackslashExpression(const char *pattern, int &incr) noexcept {
 	// Since error reporting is primitive and messages are not used anyway,
@@ -414,7 +500,26 @@ int RESearch::GetBackslashExpression(const char *pattern, int &incr) noexcept {
 	return result;
 }
 
-const char *RESearch::Compile(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) {
+/**
+ * Read a character from the pattern: a byte or, in unicode mode, a UTF-8 character.
+ * @param incr : (out) number of extra bytes used by the character.
+ */
+int RESearch::PatternCharacter(const char *pattern, size_t length, int &incr) const noexcept {
+	incr = 0;
+	const unsigned char lead = *pattern;
+	if (!unicode || UTF8IsAscii(lead) || !length) {
+		return lead;
+	}
+	const unsigned char *us = reinterpret_cast<const unsigned char *>(pattern);
+	const int utf8Status = UTF8Classify(us, length);
+	if (utf8Status & UTF8MaskInvalid) {
+		return invalidByteBase + lead;
+	}
+	incr = (utf8Status & UTF8MaskWidth) - 1;
+	return UnicodeFromUTF8(us);
+}
+
+const char *RESearch::Compile(const char *pattern, Sci::Position length, bool caseSensitive, bool posix, bool unicode_) {
 	if (!pattern || !length) {
 		if (sta)
 			return nullptr;
@@ -422,12 +527,16 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 			return badpat("No previous regular expression");
 	}
 
-	bittab.fill(0);
-	nfa[0] = END;
+	// Work on a terminated copy so looking ahead never runs past the pattern
+	const std::string patternTerminated(pattern, length);
+	pattern = patternTerminated.c_str();
+
+	unicode = unicode_;
+	program.clear();
+	classes.clear();
+	pending = CharacterClass();
 
-	char *mp=nfa;          /* nfa pointer       */
-	char *sp=nfa;          /* another saved pointer */
-	const char * const mpMax = mp + MAXNFA - BITBLK - 10;
+	int lastItem = -1;     /* index of the previous item */
 
 	int tagstk[MAXTAG]{};  /* subpat tag stack */
 	int tagi = 0;          /* tag stack index   */
@@ -437,40 +546,38 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 
 	const char *p=pattern;     /* pattern pointer   */
 	for (int i=0; i<length; i++, p++) {
-		if (mp > mpMax)
+		if (program.size() >= MAXPROGRAM)
 			return badpat("Pattern too long");
-		char *lp = mp;			/* saved pointer     */
+		const int item = static_cast<int>(program.size());
 		switch (*p) {
 
 		case '.':               /* match any char  */
-			*mp++ = ANY;
+			program.push_back({ Op::Any, Repeat::One, 0 });
 			break;
 
 		case '^':               /* match beginning */
 			if (p == pattern) {
-				*mp++ = BOL;
+				program.push_back({ Op::Bol, Repeat::One, 0 });
 			} else {
-				*mp++ = CHR;
-				*mp++ = *p;
+				program.push_back({ Op::Char, Repeat::One, '^' });
 			}
 			break;
 
 		case '$':               /* match endofline */
 			if (!p[1]) {
-				*mp++ = EOL;
+				program.push_back({ Op::Eol, Repeat::One, 0 });
 			} else {
-				*mp++ = CHR;
-				*mp++ = *p;
+				program.push_back({ Op::Char, Repeat::One, '$' });
 			}
 			break;
 
 		case '[': {               /* match char class */
 			int prevChar = 0;
-			char mask = 0;      /* xor mask -CCL/NCL */
+			bool negated = false;
 
 			i++;
 			if (*++p == '^') {
-				mask = '\377';
+				negated = true;
 				i++;
 				p++;
 			}
@@ -493,25 +600,27 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 						ChSet(*p);
 					} else if (p[1]) {
 						if (p[1] != ']') {
-							int c1 = prevChar + 1;
+							const int c1 = prevChar + 1;
 							i++;
-							int c2 = static_cast<unsigned char>(*++p);
+							int incr = 0;
+							int c2 = PatternCharacter(++p, length - i, incr);
+							i += incr;
+							p += incr;
 							if (c2 == '\\') {
 								if (!p[1]) {	// End of RE
 									return badpat("Missing ]");
 								} else {
 									i++;
 									p++;
-									int incr = 0;
 									c2 = GetBackslashExpression(p, incr);
 									i += incr;
 									p += incr;
 									if (c2 >= 0) {
 										// Convention: \c (c is any char) is case sensitive, whatever the option
-										ChSet(static_cast<unsigned char>(c2));
+										AddCharacter(c2, true);
 										prevChar = c2;
 									} else {
-										// bittab is already changed
+										// pending class is already changed
 										prevChar = -1;
 									}
 								}
@@ -522,9 +631,7 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 								ChSet('-');
 							} else {
 								// Put all chars between c1 and c2 included in the char set
-								while (c1 <= c2) {
-									ChSetWithCase(static_cast<unsigned char>(c1++), caseSensitive);
-								}
+								AddRange(c1, c2, caseSensitive);
 							}
 						} else {
 							// Dash before the ], take it literally
@@ -543,15 +650,18 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 					p += incr;
 					if (c >= 0) {
 						// Convention: \c (c is any char) is case sensitive, whatever the option
-						ChSet(static_cast<unsigned char>(c));
+						AddCharacter(c, true);
 						prevChar = c;
 					} else {
-						// bittab is already changed
+						// pending class is already changed
 						prevChar = -1;
 					}
 				} else {
-					prevChar = static_cast<unsigned char>(*p);
-					ChSetWithCase(*p, caseSensitive);
+					int incr = 0;
+					prevChar = PatternCharacter(p, length - i, incr);
+					i += incr;
+					p += incr;
+					AddCharacter(prevChar, caseSensitive);
 				}
 				i++;
 				p++;
@@ -559,11 +669,7 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 			if (!*p)
 				return badpat("Missing ]");
 
-			*mp++ = CCL;
-			for (const unsigned char byte : bittab) {
-				*mp++ = mask ^ byte;
-			}
-			bittab.fill(0);
+			EmitClass(negated);
 		} break;
 
 		case '*':               /* match 0 or more... */
@@ -571,49 +677,44 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 		case '?':
 			if (p == pattern)
 				return badpat("Empty closure");
-			lp = sp;		/* previous opcode */
-			if (*lp == CLO || *lp == LCLO)		/* equivalence... */
+			if (lastItem < 0)
+				return badpat("Illegal closure");
+			if (program[lastItem].repeat != Repeat::One)		/* equivalence... */
 				break;
-			switch (*lp) {
-
-			case BOL:
-			case BOT:
-			case EOT:
-			case BOW:
-			case EOW:
-			case REF:
+			switch (program[lastItem].op) {
+
+			case Op::Bol:
+			case Op::Eol:
+			case Op::Bot:
+			case Op::Eot:
+			case Op::Bow:
+			case Op::Eow:
+			case Op::Ref:
 				return badpat("Illegal closure");
 			default:
 				break;
 			}
 
-			if (*p == '+')
-				for (sp = mp; lp < sp; lp++)
-					*mp++ = *lp;
-
-			*mp++ = END;
-			*mp++ = END;
-			sp = mp;
+			if (*p == '+') {
+				program.push_back(program[lastItem]);
+				lastItem = static_cast<int>(program.size()) - 1;
+			}
 
-			while (--mp > lp)
-				*mp = mp[-1];
-			if (*p == '?')          *mp = CLQ;
-			else if (p[1] == '?') *mp = LCLO;
-			else                    *mp = CLO;
-
-			mp = sp;
-			break;
+			if (*p == '?')          program[lastItem].repeat = Repeat::Optional;
+			else if (p[1] == '?')   program[lastItem].repeat = Repeat::LazyStar;
+			else                    program[lastItem].repeat = Repeat::Star;
+			continue;
 
 		case '\\':              /* tags, backrefs... */
 			i++;
 			switch (*++p) {
 			case '<':
-				*mp++ = BOW;
+				program.push_back({ Op::Bow, Repeat::One, 0 });
 				break;
 			case '>':
-				if (*sp == BOW)
+				if ((lastItem >= 0) && (program[lastItem].op == Op::Bow))
 					return badpat("Null pattern inside \\<\\>");
-				*mp++ = EOW;
+				program.push_back({ Op::Eow, Repeat::One, 0 });
 				break;
 			case '1':
 			case '2':
@@ -628,8 +729,7 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 				if (tagi > 0 && tagstk[tagi] == n)
 					return badpat("Cyclical reference");
 				if (tagc > n) {
-					*mp++ = REF;
-					*mp++ = static_cast<char>(n);
+					program.push_back({ Op::Ref, Repeat::One, n });
 				} else {
 					return badpat("Undetermined reference");
 				}
@@ -638,17 +738,15 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 				if (!posix && *p == '(') {
 					if (tagc < MAXTAG) {
 						tagstk[++tagi] = tagc;
-						*mp++ = BOT;
-						*mp++ = static_cast<char>(tagc++);
+						program.push_back({ Op::Bot, Repeat::One, tagc++ });
 					} else {
 						return badpat("Too many \\(\\) pairs");
 					}
 				} else if (!posix && *p == ')') {
-					if (*sp == BOT)
+					if ((lastItem >= 0) && (program[lastItem].op == Op::Bot))
 						return badpat("Null pattern inside \\(\\)");
 					if (tagi > 0) {
-						*mp++ = EOT;
-						*mp++ = static_cast<char>(tagstk[tagi--]);
+						program.push_back({ Op::Eot, Repeat::One, tagstk[tagi--] });
 					} else {
 						return badpat("Unmatched \\)");
 					}
@@ -658,14 +756,9 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 					i += incr;
 					p += incr;
 					if (c >= 0) {
-						*mp++ = CHR;
-						*mp++ = static_cast<unsigned char>(c);
+						program.push_back({ Op::Char, Repeat::One, c });
 					} else {
-						*mp++ = CCL;
-						for (const unsigned char byte : bittab) {
-							*mp++ = byte;
-						}
-						bittab.fill(0);
+						EmitClass(false);
 					}
 				}
 			}
@@ -675,60 +768,211 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 			if (posix && *p == '(') {
 				if (tagc < MAXTAG) {
 					tagstk[++tagi] = tagc;
-					*mp++ = BOT;
-					*mp++ = static_cast<char>(tagc++);
+					program.push_back({ Op::Bot, Repeat::One, tagc++ });
 				} else {
 					return badpat("Too many () pairs");
 				}
 			} else if (posix && *p == ')') {
-				if (*sp == BOT)
+				if ((lastItem >= 0) && (program[lastItem].op == Op::Bot))
 					return badpat("Null pattern inside ()");
 				if (tagi > 0) {
-					*mp++ = EOT;
-					*mp++ = static_cast<char>(tagstk[tagi--]);
+					program.push_back({ Op::Eot, Repeat::One, tagstk[tagi--] });
 				} else {
 					return badpat("Unmatched )");
 				}
 			} else {
-				unsigned char c = *p;
+				int incr = 0;
+				int c = PatternCharacter(p, length - i, incr);
+				i += incr;
+				p += incr;
 				if (!c)	// End of RE
 					c = '\\';	// We take it as raw backslash
-				if (caseSensitive || !iswordc(c)) {
-					*mp++ = CHR;
-					*mp++ = c;
-				} else {
-					ChSetWithCase(c, false);
-					*mp++ = CCL;
-					for (const unsigned char byte : bittab) {
-						*mp++ = byte;
+				if (c < 0x80 || !unicode) {
+					if (caseSensitive || !iswordc(static_cast<unsigned char>(c))) {
+						program.push_back({ Op::Char, Repeat::One, c });
+					} else {
+						ChSetWithCase(static_cast<unsigned char>(c), false);
+						EmitClass(false);
 					}
-					bittab.fill(0);
+				} else if (caseSensitive || (c >= invalidByteBase) || !HasCaseVariant(c)) {
+					program.push_back({ Op::Char, Repeat::One, c });
+				} else {
+					AddCharacter(c, false);
+					EmitClass(false);
 				}
 			}
 			break;
 		}
-		sp = lp;
+		lastItem = item;
 	}
 	if (tagi > 0)
 		return badpat((posix ? "Unmatched (" : "Unmatched \\("));
-	*mp = END;
+
+	tagCount = tagc - 1;
+	backtrack = std::any_of(program.begin(), program.end(), [](const Node &node) noexcept {
+		return node.op == Op::Ref;
+	});
+	visited.assign(program.size() + 1, 0);
+	generation = 0;
+	FindFirstBytes();
 	sta = OKP;
 	return nullptr;
 }
 
+/*
+ * FindFirstBytes: when every match must start by consuming one of
+ * a set of bytes, remember them so the search can skip other bytes.
+ */
+void RESearch::FindFirstBytes() {
+	prefilter = false;
+	firstBytes.fill(0);
+	for (const Node &node : program) {
+		switch (node.op) {
+		case Op::Bot:
+		case Op::Eot:
+		case Op::Bow:
+		case Op::Eow:
+		case Op::Eol:
+			// Zero width so the next node decides
+			continue;
+		case Op::Char:
+			if (unicode) {
+				setinset(firstBytes.data(), (node.value < 0x80) ? static_cast<unsigned char>(node.value) : LeadByte(node.value));
+			} else {
+				setinset(firstBytes.data(), static_cast<unsigned char>(node.value));
+			}
+			break;
+		case Op::Class: {
+				const CharacterClass &cc = classes[node.value];
+				const int lastByte = unicode ? 0x7F : MAXCHR - 1;
+				for (int c = 0; c <= lastByte; c++) {
+					if ((isinset(cc.bits.data(), static_cast<unsigned char>(c)) != 0) != cc.negated) {
+						setinset(firstBytes.data(), static_cast<unsigned char>(c));
+					}
+				}
+				if (unicode) {
+					for (int c = 0x80; c < MAXCHR; c++) {
+						if (cc.negated || isinset(cc.bits.data(), static_cast<unsigned char>(c))) {
+							setinset(firstBytes.data(), static_cast<unsigned char>(c));
+						}
+					}
+					for (const std::pair<int, int> &range : cc.ranges) {
+						if (!cc.caseSensitive) {
+							// Case variants may have any lead byte
+							for (int c = 0x80; c < MAXCHR; c++) {
+								setinset(firstBytes.data(), static_cast<unsigned char>(c));
+							}
+						} else if (range.first >= invalidByteBase) {
+							setinset(firstBytes.data(), LeadByte(range.first));
+						} else {
+							const int last = std::min(range.second, invalidByteBase - 1);
+							for (int c = LeadByte(range.first); c <= LeadByte(last); c++) {
+								setinset(firstBytes.data(), static_cast<unsigned char>(c));
+							}
+						}
+					}
+				}
+			}
+			break;
+		default:
+			// Any byte may start a match or the pattern is anchored
+			return;
+		}
+		if (node.repeat == Repeat::One) {
+			prefilter = true;
+			return;
+		}
+	}
+}
+
+/*
+ * CharacterAt: the character starting at lp and its width in bytes.
+ * In unicode mode, invalid bytes are single byte characters.
+ */
+int RESearch::CharacterAt(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, int &width) const {
+	width = 1;
+	const unsigned char lead = ci.CharAt(lp);
+	if (!unicode || UTF8IsAscii(lead)) {
+		return lead;
+	}
+	unsigned char bytes[UTF8MaxBytes] { lead };
+	const Sci::Position widthLead = std::min<Sci::Position>(UTF8BytesOfLead[lead], endp - lp);
+	for (Sci::Position b = 1; b < widthLead; b++) {
+		bytes[b] = ci.CharAt(lp + b);
+	}
+	const int utf8Status = UTF8Classify(bytes, std::max<Sci::Position>(widthLead, 1));
+	if (utf8Status & UTF8MaskInvalid) {
+		return invalidByteBase + lead;
+	}
+	width = utf8Status & UTF8MaskWidth;
+	return UnicodeFromUTF8(bytes);
+}
+
+bool RESearch::InClass(const CharacterClass &cc, int ch, unsigned char lead) const {
+	bool member = false;
+	if (!unicode || (ch < 0x80)) {
+		member = isinset(cc.bits.data(), static_cast<unsigned char>(ch));
+	} else {
+		member = isinset(cc.bits.data(), lead) || InRanges(cc.ranges, ch);
+		if (!member && !cc.caseSensitive && (ch < invalidByteBase)) {
+			member = std::any_of(std::begin(caseConversions), std::end(caseConversions), [&cc, ch](CaseConversion conversion) {
+				const int variant = CaseVariant(ch, conversion);
+				return (variant >= 0) && InRanges(cc.ranges, variant);
+			});
+		}
+	}
+	return member != cc.negated;
+}
+
+/*
+ * MatchWidth: the number of bytes matched by a character, any or class
+ * node at lp or 0 when it does not match.
+ */
+int RESearch::MatchWidth(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, const Node &node) const {
+	if (lp >= endp) {
+		return 0;
+	}
+	int width = 1;
+	const int ch = CharacterAt(ci, lp, endp, width);
+	switch (node.op) {
+	case Op::Char:
+		return (ch == node.value) ? width : 0;
+	case Op::Any:
+		return width;
+	case Op::Class:
+		return InClass(classes[node.value], ch, ci.CharAt(lp)) ? width : 0;
+	default:
+		return 0;
+	}
+}
+
+bool RESearch::AssertionHolds(const CharacterIndexer &ci, Sci::Position lp, Op op) const {
+	switch (op) {
+	case Op::Bol:
+		return lp == lineStartPos;
+	case Op::Eol:
+		return lp >= lineEndPos;
+	case Op::Bow:
+		return !((lp!=lineStartPos && iswordc(ci.CharAt(lp-1))) || !iswordc(ci.CharAt(lp)));
+	case Op::Eow:
+		return !(lp==lineStartPos || !iswordc(ci.CharAt(lp-1)) || iswordc(ci.CharAt(lp)));
+	default:
+		return false;
+	}
+}
+
 /*
  * RESearch::Execute:
- *   execute nfa to find a match.
+ *   execute the program to find a match.
  *
- *  special cases: (nfa[0])
+ *  special cases: (program[0])
  *      BOL
  *          Match only once, starting from the
  *          beginning.
- *      CHR
- *          First locate the character without
- *          calling PMatch, and if found, call
- *          PMatch for the remaining string.
- *      END
+ *      EOL
+ *          The pattern is just $ so match at the
+ *          end of the line.
+ *      empty
  *          RESearch::Compile failed, poor luser did not
  *          check for it. Fail fast.
  *
@@ -739,36 +983,33 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
  */
 int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp) {
 	Sci::Position ep = NOTFOUND;
-	const char * const ap = nfa;
-
-	failure = 0;
 
 	Clear();
 
-	switch (*ap) {
+	if (program.empty()) {
+		/* munged automaton. fail always */
+		return 0;
+	}
 
-	case BOL:			/* anchored: match from BOL only */
-		ep = PMatch(ci, lp, endp, ap);
-		break;
-	case EOL:			/* just searching for end of line normal path doesn't work */
-		if (endp == lineEndPos && ap[1] == END) {
+	const Op first = program.front().op;
+	if (first == Op::Eol) {
+		/* just searching for end of line normal path doesn't work */
+		if (endp == lineEndPos && program.size() == 1) {
 			lp = endp;
 			ep = lp;
-			break;
 		} else {
 			return 0;
 		}
-	case CHR: {			/* ordinary char: locate it fast */
-		const unsigned char c = ap[1];
-		while ((lp < endp) && (static_cast<unsigned char>(ci.CharAt(lp)) != c))
-			lp++;
-		if (lp >= endp)	/* if EOS, fail, else fall through. */
-			return 0;
-	}
-	[[fallthrough]];
-	default:			/* regular matching all the way. */
+	} else if (!backtrack) {
+		ep = PikeMatch(ci, lp, endp, first == Op::Bol);
+		if (ep != NOTFOUND) {
+			lp = bopat[0];
+		}
+	} else if (first == Op::Bol) {	/* anchored: match from BOL only */
+		ep = PMatch(ci, lp, endp, 0);
+	} else {			/* regular matching all the way. */
 		while (lp < endp) {
-			ep = PMatch(ci, lp, endp, ap);
+			ep = PMatch(ci, lp, endp, 0);
 			if (ep != NOTFOUND) {
 				// fix match started from middle of character like DBCS trailing ASCII byte
 				const Sci::Position pos = ci.MovePositionOutsideChar(lp, -1);
@@ -780,14 +1021,12 @@ int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Positio
 			}
 			lp++;
 		}
-		break;
-	case END:			/* munged automaton. fail always */
-		return 0;
 	}
 	if (ep == NOTFOUND) {
 		/* similar to EOL, match EOW at line end */
-		if (endp == lineEndPos && *ap == EOW) {
-			if ((ap[1] == END || ((ap[1] == EOL && ap[2] == END))) && iswordc(ci.CharAt(lp - 1))) {
+		if (endp == lineEndPos && first == Op::Eow) {
+			const bool onlyEndOfWord = (program.size() == 1) || ((program.size() == 2) && (program[1].op == Op::Eol));
+			if (onlyEndOfWord && iswordc(ci.CharAt(endp - 1))) {
 				lp = endp;
 				ep = lp;
 			} else {
@@ -804,6 +1043,204 @@ int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Positio
 	return 1;
 }
 
+/*
+ * RESearch::ExecuteAt:
+ *   execute the program to find a match starting at lp.
+ *   Execute does not start matches at endp so this finds an empty match
+ *   at the end of a range when lp == endp.
+ */
+int RESearch::ExecuteAt(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp) {
+	Clear();
+
+	if (program.empty() || (lp != ci.MovePositionOutsideChar(lp, -1))) {
+		return 0;
+	}
+
+	const Sci::Position ep = backtrack ? PMatch(ci, lp, endp, 0) : PikeMatch(ci, lp, endp, true);
+	if (ep == NOTFOUND) {
+		return 0;
+	}
+
+	bopat[0] = lp;
+	eopat[0] = ci.MovePositionOutsideChar(ep, 1);
+	return 1;
+}
+
+/*
+ * AddThread: add a thread at node to list, first following all the
+ * nodes that do not consume characters. Captures holds the start of
+ * the match followed by the start and end of each tag.
+ * Each node is only added once per list and the first thread to reach
+ * it has the highest priority so later threads are dropped.
+ */
+void RESearch::AddThread(const CharacterIndexer &ci, ThreadList &list, size_t node, Sci::Position lp, const Sci::Position *captures) {
+	if (visited[node] == list.generation) {
+		return;
+	}
+	visited[node] = list.generation;
+	const size_t stride = 1 + 2 * tagCount;
+	const auto push = [&list, captures, stride](size_t target) {
+		list.threads.push_back({ target, list.captures.size() });
+		list.captures.insert(list.captures.end(), captures, captures + stride);
+	};
+	if (node == program.size()) {
+		push(node);
+		return;
+	}
+	const Node &n = program[node];
+	switch (n.op) {
+	case Op::Bol:
+	case Op::Eol:
+	case Op::Bow:
+	case Op::Eow:
+		if (AssertionHolds(ci, lp, n.op)) {
+			AddThread(ci, list, node + 1, lp, captures);
+		}
+		break;
+	case Op::Bot:
+	case Op::Eot: {
+			std::array<Sci::Position, 1 + 2 * MAXTAG> tagged {};
+			std::copy(captures, captures + stride, tagged.begin());
+			if (n.op == Op::Bot) {
+				if (lp != ci.MovePositionOutsideChar(lp, -1)) {
+					break;
+				}
+				tagged[2 * n.value - 1] = lp;
+			} else {
+				tagged[2 * n.value] = ci.MovePositionOutsideChar(lp, 1);
+			}
+			AddThread(ci, list, node + 1, lp, tagged.data());
+		}
+		break;
+	default:
+		switch (n.repeat) {
+		case Repeat::One:
+			push(node);
+			break;
+		case Repeat::Star:
+		case Repeat::Optional:
+			push(node);
+			AddThread(ci, list, node + 1, lp, captures);
+			break;
+		case Repeat::LazyStar:
+			AddThread(ci, list, node + 1, lp, captures);
+			push(node);
+			break;
+		}
+		break;
+	}
+}
+
+/*
+ * PikeMatch: find the leftmost match starting at lp or later by running
+ * every possible match together, one character at a time.
+ * Returns the end of the match and sets bopat and eopat or returns NOTFOUND.
+ */
+Sci::Position RESearch::PikeMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, bool anchored) {
+	const size_t stride = 1 + 2 * tagCount;
+	std::array<Sci::Position, 1 + 2 * MAXTAG> start {};
+	std::array<Sci::Position, 1 + 2 * MAXTAG> matched {};
+	Sci::Position matchEnd = NOTFOUND;
+
+	const auto startList = [this](ThreadList &list) {
+		list.threads.clear();
+		list.captures.clear();
+		if (++generation == 0) {
+			std::fill(visited.begin(), visited.end(), 0);
+			generation = 1;
+		}
+		list.generation = generation;
+	};
+
+	startList(current);
+	Sci::Position pos = lp;
+	for (;;) {
+		if (matchEnd == NOTFOUND) {
+			if (prefilter && !anchored && current.threads.empty()) {
+				// Nothing in progress so skip to the next byte that can start a match
+				while ((pos < endp) && !isinset(firstBytes.data(), ci.CharAt(pos)))
+					pos++;
+				if (unicode && (pos < endp) && UTF8IsTrailByte(ci.CharAt(pos)) &&
+					(pos != ci.MovePositionOutsideChar(pos, -1))) {
+					pos++;
+					continue;
+				}
+			}
+			if (anchored ? (pos == lp) : (pos < endp)) {
+				// Byte positions inside DBCS characters can not start a match
+				if (unicode || (pos == ci.MovePositionOutsideChar(pos, -1))) {
+					if (current.threads.empty()) {
+						startList(current);
+					}
+					start.fill(NOTFOUND);
+					start[0] = pos;
+					AddThread(ci, current, 0, pos, start.data());
+				}
+			}
+		}
+
+		int width = 1;
+		int ch = 0;
+		if (pos < endp) {
+			ch = CharacterAt(ci, pos, endp, width);
+		}
+		if (current.threads.empty()) {
+			if ((matchEnd != NOTFOUND) || anchored || (pos >= endp))
+				break;
+			pos += width;
+			continue;
+		}
+
+		startList(next);
+		const unsigned char lead = (pos < endp) ? ci.CharAt(pos) : 0;
+		for (const Thread &thread : current.threads) {
+			const Sci::Position *captures = &current.captures[thread.captures];
+			if (thread.node == program.size()) {
+				// Lower priority threads can not give a better match
+				matchEnd = pos;
+				std::copy(captures, captures + stride, matched.begin());
+				break;
+			}
+			if (pos >= endp) {
+				continue;
+			}
+			const Node &node = program[thread.node];
+			bool matches = false;
+			switch (node.op) {
+			case Op::Char:
+				matches = ch == node.value;
+				break;
+			case Op::Any:
+				matches = true;
+				break;
+			case Op::Class:
+				matches = InClass(classes[node.value], ch, lead);
+				break;
+			default:
+				break;
+			}
+			if (matches) {
+				const bool repeats = (node.repeat == Repeat::Star) || (node.repeat == Repeat::LazyStar);
+				AddThread(ci, next, repeats ? thread.node : thread.node + 1, pos + width, captures);
+			}
+		}
+		if (pos >= endp)
+			break;
+		std::swap(current, next);
+		pos += width;
+	}
+
+	if (matchEnd == NOTFOUND) {
+		return NOTFOUND;
+	}
+	bopat[0] = matched[0];
+	for (int tag = 1; tag <= tagCount; tag++) {
+		bopat[tag] = matched[2 * tag - 1];
+		eopat[tag] = matched[2 * tag];
+	}
+	return matchEnd;
+}
+
 /*
  * PMatch: internal routine for the hard part
  *
@@ -811,149 +1248,83 @@ int RESearch::Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Positio
  *  David Conroy. The backref and tag stuff, and various other
  *  innovations are by oz.
  *
- *  special case optimizations: (nfa[n], nfa[n+1])
- *      CLO ANY
- *          We KNOW .* will match everything up to the
- *          end of line. Thus, directly go to the end of
- *          line, without recursive PMatch calls. As in
- *          the other closure cases, the remaining pattern
- *          must be matched by moving backwards on the
- *          string recursively, to find a match for xy
- *          (x is ".*" and y is the remaining pattern)
- *          where the match satisfies the LONGEST match for
- *          x followed by a match for y.
- *      CLO CHR
- *          We can again scan the string forward for the
- *          single char and at the point of failure, we
- *          execute the remaining nfa recursively, same as
- *          above.
+ *  It backtracks so it is only used for patterns with back
+ *  references which the Pike VM can not match.
  *
  *  At the end of a successful match, bopat[n] and eopat[n]
  *  are set to the beginning and end of subpatterns matched
  *  by tagged expressions (n = 1 to 9).
  */
 
-//extern void re_fail(char *,char);
-
-/*
- * skip values for CLO XXX to skip past the closure
- */
-
-#define ANYSKIP 2 	/* [CLO] ANY END          */
-#define CHRSKIP 3	/* [CLO] CHR chr END      */
-#define CCLSKIP 34	/* [CLO] CCL 32 bytes END */
-
-Sci::Position RESearch::PMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, const char *ap) {
-	unsigned char op = 0;
-
-	while ((op = *ap++) != END)
-		switch (op) {
+Sci::Position RESearch::PMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, size_t node) {
+	while (node < program.size()) {
+		const Node &n = program[node++];
+		switch (n.op) {
 
-		case CHR:
-			if (ci.CharAt(lp++) != *ap++)
-				return NOTFOUND;
-			break;
-		case ANY:
-			if (lp++ >= endp)
-				return NOTFOUND;
-			break;
-		case CCL:
-			if (lp >= endp)
-				return NOTFOUND;
-			if (!isinset(ap, ci.CharAt(lp++)))
-				return NOTFOUND;
-			ap += BITBLK;
-			break;
-		case BOL:
-			if (lp != lineStartPos)
+		case Op::Char:
+		case Op::Any:
+		case Op::Class:
+			if (n.repeat == Repeat::One) {
+				const int width = MatchWidth(ci, lp, endp, n);
+				if (!width)
+					return NOTFOUND;
+				lp += width;
+			} else {
+				// Positions after each repetition, then try the rest of the pattern
+				// from the longest for greedy closures or the shortest for lazy.
+				std::vector<Sci::Position> positions { lp };
+				while (n.repeat != Repeat::Optional || positions.size() < 2) {
+					const int width = MatchWidth(ci, positions.back(), endp, n);
+					if (!width)
+						break;
+					positions.push_back(positions.back() + width);
+				}
+				if (n.repeat == Repeat::LazyStar) {
+					for (const Sci::Position llp : positions) {
+						const Sci::Position q = PMatch(ci, llp, endp, node);
+						if (q != NOTFOUND)
+							return q;
+					}
+				} else {
+					for (auto it = positions.rbegin(); it != positions.rend(); ++it) {
+						const Sci::Position q = PMatch(ci, *it, endp, node);
+						if (q != NOTFOUND)
+							return q;
+					}
+				}
 				return NOTFOUND;
+			}
 			break;
-		case EOL:
-			if (lp < lineEndPos)
+		case Op::Bol:
+		case Op::Eol:
+		case Op::Bow:
+		case Op::Eow:
+			if (!AssertionHolds(ci, lp, n.op))
 				return NOTFOUND;
 			break;
-		case BOT:
+		case Op::Bot:
 			if (lp != ci.MovePositionOutsideChar(lp, -1)) {
 				return NOTFOUND;
 			}
-			bopat[static_cast<unsigned char>(*ap++)] = lp;
+			bopat[n.value] = lp;
 			break;
-		case EOT:
+		case Op::Eot:
 			lp = ci.MovePositionOutsideChar(lp, 1);
-			eopat[static_cast<unsigned char>(*ap++)] = lp;
-			break;
-		case BOW:
-			if ((lp!=lineStartPos && iswordc(ci.CharAt(lp-1))) || !iswordc(ci.CharAt(lp)))
-				return NOTFOUND;
+			eopat[n.value] = lp;
 			break;
-		case EOW:
-			if (lp==lineStartPos || !iswordc(ci.CharAt(lp-1)) || iswordc(ci.CharAt(lp)))
-				return NOTFOUND;
-			break;
-		case REF: {
-			const int n = static_cast<unsigned char>(*ap++);
-			Sci::Position bp = bopat[n];		/* beginning of subpat... */
-			const Sci::Position ep = eopat[n];	/* ending of subpat...    */
-			while (bp < ep)
+		case Op::Ref: {
+			Sci::Position bp = bopat[n.value];		/* beginning of subpat... */
+			const Sci::Position ep = eopat[n.value];	/* ending of subpat...    */
+			while (bp < ep) {
+				if (lp >= endp)
+					return NOTFOUND;
 				if (ci.CharAt(bp++) != ci.CharAt(lp++))
 					return NOTFOUND;
-		} break;
-		case LCLO:
-		case CLQ:
-		case CLO: {
-			int n = 0;
-			const Sci::Position are = lp;	/* to save the line ptr.  */
-			switch (*ap) {
-
-			case ANY:
-				if (op == CLO || op == LCLO)
-					while (lp < endp)
-						lp++;
-				else if (lp < endp)
-					lp++;
-
-				n = ANYSKIP;
-				break;
-			case CHR: {
-				const char c = ap[1];
-				if (op == CLO || op == LCLO)
-					while ((lp < endp) && (c == ci.CharAt(lp)))
-						lp++;
-				else if ((lp < endp) && (c == ci.CharAt(lp)))
-					lp++;
-				n = CHRSKIP;
-			} break;
-			case CCL:
-				while ((lp < endp) && isinset(ap+1, ci.CharAt(lp)))
-					lp++;
-				n = CCLSKIP;
-				break;
-			default:
-				failure = true;
-				//re_fail("closure: bad nfa.", *ap);
-				return NOTFOUND;
-			}
-			ap += n;
-
-			Sci::Position llp = lp;		/* lazy lp for LCLO       */
-			Sci::Position e = NOTFOUND; /* extra pointer for CLO  */
-			while (llp >= are) {
-				const Sci::Position q = PMatch(ci, llp, endp, ap);
-				if (q != NOTFOUND) {
-					e = q;
-					lp = llp;
-					if (op != LCLO) return e;
-				}
-				if (*ap == END) return e;
-				--llp;
 			}
-			if (*ap == EOT)
-				PMatch(ci, lp, endp, ap);
-			return e;
-		}
+		} break;
 		default:
-			//re_fail("RESearch::Execute: bad nfa.", static_cast<char>(op));
 			return NOTFOUND;
 		}
+	}
 	return lp;
 }
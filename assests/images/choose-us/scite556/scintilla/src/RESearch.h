@@ -21,10 +21,10 @@ class RESearch {
 
 public:
 	explicit RESearch(CharClassify *charClassTable);
-	// No dynamic allocation so default copy constructor and assignment operator are OK.
 	void Clear();
-	const char *Compile(const char *pattern, Sci::Position length, bool caseSensitive, bool posix);
+	const char *Compile(const char *pattern, Sci::Position length, bool caseSensitive, bool posix, bool unicode=false);
 	int Execute(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp);
+	int ExecuteAt(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp);
 	void SetLineRange(Sci::Position startPos, Sci::Position endPos) noexcept {
 		lineStartPos = startPos;
 		lineEndPos = endPos;
@@ -39,26 +39,78 @@ public:
 
 private:
 
-	static constexpr int MAXNFA = 4096;
+	static constexpr size_t MAXPROGRAM = 2048;
 	// The following constants are not meant to be changeable.
 	// They are for readability only.
 	static constexpr int MAXCHR = 256;
 	static constexpr int CHRBIT = 8;
 	static constexpr int BITBLK = MAXCHR / CHRBIT;
 
+	enum class Op : unsigned char { Char, Any, Class, Bol, Eol, Bot, Eot, Bow, Eow, Ref };
+	enum class Repeat : unsigned char { One, Star, LazyStar, Optional };
+
+	// One element of the compiled pattern. value is a character, an index
+	// into classes or a tag number depending on op.
+	struct Node {
+		Op op;
+		Repeat repeat;
+		int value;
+	};
+
+	// Bytes are in bits. In unicode mode, bits for ASCII are characters and bits
+	// for other bytes stand for all the characters with that lead byte while
+	// ranges holds other code points.
+	struct CharacterClass {
+		std::array<unsigned char, BITBLK> bits {};
+		std::vector<std::pair<int, int>> ranges;
+		bool negated = false;
+		bool caseSensitive = true;
+	};
+
+	// Pike VM thread: a node to match next and an index into the capture positions
+	struct Thread {
+		size_t node;
+		size_t captures;
+	};
+	struct ThreadList {
+		std::vector<Thread> threads;
+		std::vector<Sci::Position> captures;
+		unsigned int generation = 0;
+	};
+
 	void ChSet(unsigned char c) noexcept;
 	void ChSetWithCase(unsigned char c, bool caseSensitive) noexcept;
+	void AddCharacter(int c, bool caseSensitive);
+	void AddRange(int first, int last, bool caseSensitive);
 	int GetBackslashExpression(const char *pattern, int &incr) noexcept;
+	int PatternCharacter(const char *pattern, size_t length, int &incr) const noexcept;
+	void EmitClass(bool negated);
+	void FindFirstBytes();
 
-	Sci::Position PMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, const char *ap);
+	int CharacterAt(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, int &width) const;
+	bool InClass(const CharacterClass &cc, int ch, unsigned char lead) const;
+	int MatchWidth(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, const Node &node) const;
+	bool AssertionHolds(const CharacterIndexer &ci, Sci::Position lp, Op op) const;
+	void AddThread(const CharacterIndexer &ci, ThreadList &list, size_t node, Sci::Position lp, const Sci::Position *captures);
+	Sci::Position PikeMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, bool anchored);
+	Sci::Position PMatch(const CharacterIndexer &ci, Sci::Position lp, Sci::Position endp, size_t node);
 
 	// positions to match line start and line end
 	Sci::Position lineStartPos;
 	Sci::Position lineEndPos;
-	char nfa[MAXNFA];    /* automaton */
+	std::vector<Node> program;	/* automaton */
+	std::vector<CharacterClass> classes;
+	CharacterClass pending;	/* class being built */
+	std::array<unsigned char, BITBLK> firstBytes {};	/* bytes that may start a match */
+	bool prefilter;
+	bool unicode;
+	bool backtrack;	/* back references need the backtracking matcher */
+	int tagCount;
 	int sta;
-	int failure;
-	std::array<unsigned char, BITBLK> bittab {}; /* bit table for CCL pre-set bits */
+	ThreadList current;
+	ThreadList next;
+	std::vector<unsigned int> visited;	/* generation that last added each node */
+	unsigned int generation;
 	CharClassify *charClass;
 	bool iswordc(unsigned char x) const noexcept {
 		return charClass->IsWord(x);
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <memory>
 #include <numeric>
+#include <mutex>
 
 #include "ScintillaTypes.h"
 
@@ -49,6 +50,72 @@ constexpr unsigned int mid = 0x80U;
 constexpr unsigned int half = 0x7fU;
 constexpr unsigned int quarter = 0x3fU;
 
+int SizeZoomed(int size, int zoomLevel) noexcept {
+	const int sizeZoomed = size + zoomLevel * FontSizeMultiplier;
+	if (sizeZoomed <= FontSizeMultiplier)	// May fail if sizeZoomed < 1
+		return FontSizeMultiplier;
+	return sizeZoomed;
+}
+
+// Identifies a realised font independently of the ViewStyle that requested it.
+// The font name is copied since FontSpecification::fontName is owned by a ViewStyle.
+struct FontKey {
+	std::string fontName;
+	FontSpecification fs;
+	int sizeZoomed;
+	float deviceHeight;
+	Technology technology;
+	std::string localeName;
+	bool operator<(const FontKey &other) const noexcept {
+		if (fontName != other.fontName)
+			return fontName < other.fontName;
+		if (!(fs == other.fs))
+			return fs < other.fs;
+		if (sizeZoomed != other.sizeZoomed)
+			return sizeZoomed < other.sizeZoomed;
+		if (deviceHeight != other.deviceHeight)
+			return deviceHeight < other.deviceHeight;
+		if (technology != other.technology)
+			return technology < other.technology;
+		return localeName < other.localeName;
+	}
+};
+
+// Realised fonts are shared by all the ViewStyles in the process so that fonts used by several
+// instances or set again with the same attributes are only allocated and measured once.
+// Only weak references are held so each font is released when no ViewStyle uses it.
+std::mutex mutexFontCache;
+std::map<FontKey, std::weak_ptr<FontRealised>> fontCache;
+
+std::shared_ptr<FontRealised> SharedFont(Surface &surface, int zoomLevel, Technology technology, const FontSpecification &fs, const char *localeName) {
+	PLATFORM_ASSERT(fs.fontName);
+	const int sizeZoomed = SizeZoomed(fs.size, zoomLevel);
+	FontKey key{ fs.fontName, fs, sizeZoomed, static_cast<float>(surface.DeviceHeightFont(sizeZoomed)),
+		technology, localeName ? localeName : "" };
+	key.fs.fontName = nullptr;
+
+	std::lock_guard<std::mutex> guard(mutexFontCache);
+	const std::map<FontKey, std::weak_ptr<FontRealised>>::iterator itFound = fontCache.find(key);
+	if (itFound != fontCache.end()) {
+		std::shared_ptr<FontRealised> font = itFound->second.lock();
+		if (font) {
+			return font;
+		}
+	}
+	// Forget fonts that have been released before adding another
+	for (auto it = fontCache.begin(); it != fontCache.end();) {
+		if (it->second.expired()) {
+			it = fontCache.erase(it);
+		} else {
+			++it;
+		}
+	}
+	std::shared_ptr<FontRealised> font = std::make_shared<FontRealised>();
+	font->Realise(surface, zoomLevel, technology, fs, localeName);
+	fontCache[std::move(key)] = font;
+	return font;
+}
+
 }
 
 MarginStyle::MarginStyle(MarginType style_, int width_, int mask_) noexcept :
@@ -61,9 +128,7 @@ bool MarginStyle::ShowsFolding() const noexcept {
 
 void FontRealised::Realise(Surface &surface, int zoomLevel, Technology technology, const FontSpecification &fs, const char *localeName) {
 	PLATFORM_ASSERT(fs.fontName);
-	measurements.sizeZoomed = fs.size + zoomLevel * FontSizeMultiplier;
-	if (measurements.sizeZoomed <= FontSizeMultiplier)	// May fail if sizeZoomed < 1
-		measurements.sizeZoomed = FontSizeMultiplier;
+	measurements.sizeZoomed = SizeZoomed(fs.size, zoomLevel);
 
 	const float deviceHeight = static_cast<float>(surface.DeviceHeightFont(measurements.sizeZoomed));
 	const FontParameters fp(fs.fontName, deviceHeight / FontSizeMultiplier, fs.weight,
@@ -373,7 +438,9 @@ void ViewStyle::CalculateMarginWidthAndMask() noexcept {
 }
 
 void ViewStyle::Refresh(Surface &surface, int tabInChars) {
-	fonts.clear();
+	// Hold the current fonts until the new set is found so unchanged fonts are reused
+	FontMap fontsPrevious;
+	fonts.swap(fontsPrevious);
 
 	selbar = Platform::Chrome();
 	selbarlight = Platform::ChromeHighlight();
@@ -389,10 +456,11 @@ void ViewStyle::Refresh(Surface &surface, int tabInChars) {
 		CreateAndAddFont(style);
 	}
 
-	// Ask platform to allocate each unique font.
-	for (const std::pair<const FontSpecification, std::unique_ptr<FontRealised>> &font : fonts) {
-		font.second->Realise(surface, zoomLevel, technology, font.first, localeName.c_str());
+	// Find each unique font in the shared cache or ask platform to allocate it.
+	for (std::pair<const FontSpecification, std::shared_ptr<FontRealised>> &font : fonts) {
+		font.second = SharedFont(surface, zoomLevel, technology, font.first, localeName.c_str());
 	}
+	fontsPrevious.clear();
 
 	// Set the platform font handle and measurements for each style.
 	for (Style &style : styles) {
@@ -777,7 +845,7 @@ void ViewStyle::CreateAndAddFont(const FontSpecification &fs) {
 	if (fs.fontName) {
 		const FontMap::iterator it = fonts.find(fs);
 		if (it == fonts.end()) {
-			fonts[fs] = std::make_unique<FontRealised>();
+			fonts[fs] = nullptr;
 		}
 	}
 }
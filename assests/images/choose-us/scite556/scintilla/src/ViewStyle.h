@@ -35,7 +35,7 @@ public:
 	void Realise(Surface &surface, int zoomLevel, Scintilla::Technology technology, const FontSpecification &fs, const char *localeName);
 };
 
-typedef std::map<FontSpecification, std::unique_ptr<FontRealised>> FontMap;
+typedef std::map<FontSpecification, std::shared_ptr<FontRealised>> FontMap;
 
 using ColourOptional = std::optional<ColourRGBA>;
 
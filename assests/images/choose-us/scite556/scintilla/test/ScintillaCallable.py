@@ -4,7 +4,7 @@ from __future__ import unicode_literals
 
 import ctypes
 
-from ctypes import c_int, c_char_p, c_long, c_ssize_t
+from ctypes import c_int, c_uint, c_char_p, c_long, c_ssize_t, c_size_t
 
 def IsEnumeration(t):
 	return t[:1].isupper()
@@ -46,6 +46,20 @@ class FINDTEXTFULL(ctypes.Structure):
 		('cpMaxText', c_ssize_t),
 	)
 
+class BATCHMESSAGE(ctypes.Structure):
+	_fields_= (\
+		('message', c_uint),
+		('wParam', c_size_t),
+		('lParam', c_ssize_t),
+	)
+
+class MESSAGEBATCH(ctypes.Structure):
+	_fields_= (\
+		('messages', ctypes.POINTER(BATCHMESSAGE)),
+		('results', ctypes.POINTER(c_ssize_t)),
+		('executed', c_ssize_t),
+	)
+
 class SciCall:
 	def __init__(self, fn, ptr, msg, stringResult=False):
 		self._fn = fn
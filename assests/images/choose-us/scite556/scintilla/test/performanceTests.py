@@ -5,7 +5,7 @@
 from __future__ import with_statement
 from __future__ import unicode_literals
 
-import string, time, unittest
+import ctypes, string, time, unittest
 
 try:
 	start = time.perf_counter()
@@ -167,5 +167,146 @@ class TestPerformance(unittest.TestCase):
 		print("%6.3f testShiftJISSearches" % duration)
 		self.xite.DoEvents()
 
+	def testRegexPathological(self):
+		self.ed.SetCodePage(65001)
+		oneLine = ("a" * 2000 + "\n").encode('utf-8')
+		manyLines = oneLine * 100
+		self.ed.AddText(len(manyLines), manyLines)
+		# Nested closures that take exponential time when backtracking
+		searchString = b"a*a*a*a*a*a*a*a*a*a*b"
+		start = timer()
+		self.ed.TargetStart = 0
+		self.ed.TargetEnd = self.ed.Length
+		self.ed.SearchFlags = self.ed.SCFIND_REGEXP
+		pos = self.ed.SearchInTarget(len(searchString), searchString)
+		self.assertEqual(pos, -1)
+		end = timer()
+		duration = end - start
+		print("%6.3f testRegexPathological" % duration)
+		self.xite.DoEvents()
+
+	def testRegexUTF8Class(self):
+		self.ed.SetCodePage(65001)
+		oneLine = "Fold Margin=折りたたみ表示用の余白(&F)\n".encode('utf-8')
+		manyLines = oneLine * 100000
+		manyLines = manyLines + "φω\n".encode('utf-8')
+		self.ed.AddText(len(manyLines), manyLines)
+		searchString = "[α-ω]+".encode('utf-8')
+		start = timer()
+		for i in range(20):
+			self.ed.TargetStart = 0
+			self.ed.TargetEnd = self.ed.Length-1
+			self.ed.SearchFlags = self.ed.SCFIND_REGEXP
+			pos = self.ed.SearchInTarget(len(searchString), searchString)
+			self.assertTrue(pos > 0)
+			self.assertEqual(self.ed.TargetEnd - pos, 4)
+		end = timer()
+		duration = end - start
+		print("%6.3f testRegexUTF8Class" % duration)
+		self.xite.DoEvents()
+
+	def testRegexLinesAndMultiline(self):
+		oneLine = b"Fold Margin=NagasakiOsakaHiroshimaHanedaKyoto(&F)\n"
+		manyLines = oneLine * 100000
+		manyLines = manyLines + b"Sapporo\n"
+		self.ed.AddText(len(manyLines), manyLines)
+		searchString = b"Sap+oro"
+		baseFlags = self.ed.SCFIND_REGEXP | self.ed.SCFIND_CXX11REGEX
+		for name, flags in (("lines", baseFlags), ("multiline", baseFlags | self.ed.SCFIND_MULTILINE)):
+			start = timer()
+			for i in range(5):
+				self.ed.TargetStart = 0
+				self.ed.TargetEnd = self.ed.Length
+				self.ed.SearchFlags = flags
+				pos = self.ed.SearchInTarget(len(searchString), searchString)
+				self.assertEqual(pos, len(oneLine) * 100000)
+			end = timer()
+			duration = end - start
+			print("%6.3f testRegexLinesAndMultiline %s" % (duration, name))
+		self.xite.DoEvents()
+
+	def testBatchMarkers(self):
+		data = (string.ascii_letters + string.digits + "\n").encode('utf-8')
+		lines = 100000
+		self.ed.AddText(len(data) * lines, data * lines)
+		self.ed.MarkerDeleteAll(-1)
+		start = timer()
+		for line in range(lines):
+			self.ed.MarkerAdd(line, 1)
+		end = timer()
+		durationCalls = end - start
+		self.ed.MarkerDeleteAll(-1)
+		markerAdd = self.ed.getvalue("MarkerAdd")
+		messages = (Xite.ScintillaCallable.BATCHMESSAGE * lines)()
+		for line in range(lines):
+			messages[line].message = markerAdd
+			messages[line].wParam = line
+			messages[line].lParam = 1
+		results = (ctypes.c_ssize_t * lines)()
+		batch = Xite.ScintillaCallable.MESSAGEBATCH(messages, results)
+		start = timer()
+		executed = self.ed.ExecuteBatch(lines, ctypes.addressof(batch))
+		end = timer()
+		durationBatch = end - start
+		self.assertEqual(executed, lines)
+		self.assertEqual(batch.executed, lines)
+		self.assertEqual(self.ed.MarkerNext(0, 2), 0)
+		self.assertEqual(self.ed.MarkerPrevious(lines - 1, 2), lines - 1)
+		print("%6.3f testBatchMarkers calls %9.0f calls/s" % (durationCalls, lines / durationCalls))
+		print("%6.3f testBatchMarkers batch %9.0f calls/s" % (durationBatch, lines / durationBatch))
+		self.xite.DoEvents()
+
+	def testLayoutAllocations(self):
+		# Lines of varying lengths so layouts move between size classes while scrolling
+		lines = 20000
+		data = b"".join((b"x" * ((line * 37) % 300)) + b"\n" for line in range(lines))
+		self.ed.AddText(len(data), data)
+		self.ed.LayoutCache = self.ed.SC_CACHE_PAGE
+		self.ed.WrapMode = self.ed.SC_WRAP_WORD
+		self.xite.DoEvents()
+		allocationsStart = self.ed.LayoutAllocations
+		start = timer()
+		for step in range(lines // 50):
+			self.ed.LineScroll(0, 50)
+			self.xite.DoEvents()
+		end = timer()
+		duration = end - start
+		allocations = self.ed.LayoutAllocations - allocationsStart
+		self.ed.WrapMode = self.ed.SC_WRAP_NONE
+		self.ed.LayoutCache = self.ed.SC_CACHE_CARET
+		print("%6.3f testLayoutAllocations %d allocations" % (duration, allocations))
+		self.xite.DoEvents()
+
+	def testAutoCompleteSelect(self):
+		items = 200000
+		words = [b"item%d%s" % ((i * 7919) % items, b"Name" if i % 3 == 0 else b"_value") for i in range(items)]
+		self.ed.AutoCSetOrder(self.ed.SC_ORDER_PERFORMSORT)
+		self.ed.AutoCSetIgnoreCase(1)
+		start = timer()
+		self.ed.AutoCShow(0, b" ".join(words))
+		end = timer()
+		durationShow = end - start
+		typed = [b"i", b"it", b"ite", b"item", b"item1", b"item12", b"item123", b"item1234"]
+		start = timer()
+		for prefix in typed:
+			self.ed.AutoCSelect(0, prefix)
+		end = timer()
+		durationSelect = (end - start) / len(typed)
+		self.assertEqual(self.ed.AutoCActive(), 1)
+		self.ed.AutoCSetOptions(self.ed.SC_AUTOCOMPLETE_FUZZY_MATCH, 0)
+		start = timer()
+		self.ed.AutoCSelect(0, b"itm9n")
+		end = timer()
+		durationFuzzy = end - start
+		self.assertEqual(self.ed.AutoCActive(), 1)
+		self.ed.AutoCCancel()
+		self.ed.AutoCSetOptions(self.ed.SC_AUTOCOMPLETE_NORMAL, 0)
+		self.ed.AutoCSetIgnoreCase(0)
+		self.ed.AutoCSetOrder(self.ed.SC_ORDER_PRESORTED)
+		print("%6.3f testAutoCompleteSelect show" % durationShow)
+		print("%6.3f testAutoCompleteSelect select per character" % durationSelect)
+		print("%6.3f testAutoCompleteSelect fuzzy" % durationFuzzy)
+		self.xite.DoEvents()
+
 if __name__ == '__main__':
 	Xite.main("performanceTests")
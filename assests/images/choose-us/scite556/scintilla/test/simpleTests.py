@@ -880,6 +880,27 @@ class TestSimple(unittest.TestCase):
 		self.assertEqual(self.ed.SelectionFromPoint(xEnd+2, 1), 2)
 		self.assertEqual(self.ed.SelectionFromPoint(100, 0), -1)
 
+	def testPositionsOnVeryLongLine(self):
+		# Very long lines are laid out in chunks so check positions far beyond the first chunk
+		lengthLine = 0x50000
+		self.ed.SetContents(b"x" * lengthLine + b"\n" + b"x" * lengthLine)
+		posFar = lengthLine - 100
+		xStart = self.ed.PointXFromPosition(0, 0)
+		xFar = self.ed.PointXFromPosition(0, posFar)
+		xEnd = self.ed.PointXFromPosition(0, lengthLine)
+		self.assertLess(xStart, xFar)
+		self.assertLess(xFar, xEnd)
+		self.assertEqual(self.ed.PositionFromPoint(xFar + 1, 1), posFar)
+		# Extending a rectangular selection down finds the position from x on the next line
+		self.ed.SetSelection(posFar, posFar)
+		self.ed.LineDownRectExtend()
+		self.assertEqual(self.ed.RectangularSelectionCaret, lengthLine + 1 + posFar)
+		self.ed.WrapMode = self.ed.SC_WRAP_CHAR
+		self.assertGreater(self.ed.WrapCount(0), 1)
+		self.assertEqual(self.ed.WrapCount(0), self.ed.WrapCount(1))
+		self.ed.WrapMode = self.ed.SC_WRAP_NONE
+		self.assertEqual(self.ed.WrapCount(0), 1)
+
 	def testLinePositions(self):
 		text = b"ab\ncd\nef"
 		nl = b"\n"
@@ -1634,6 +1655,34 @@ class TestSearch(unittest.TestCase):
 		self.assertEqual(10, self.ed.FindBytes(0, self.ed.Length, b"\t$", flags))
 		self.assertEqual(0, self.ed.FindBytes(0, self.ed.Length, b"([a]).*\0", flags))
 
+	def testCxx11REMultiline(self):
+		self.ed.InsertText(self.ed.Length, b"\r\nship")
+		flags = self.ed.SCFIND_REGEXP | self.ed.SCFIND_CXX11REGEX
+		self.assertEqual(-1, self.ed.FindBytes(0, self.ed.Length, rb"boat\s+ship", flags))
+		flags = flags | self.ed.SCFIND_MULTILINE
+		self.assertEqual(6, self.ed.FindBytes(0, self.ed.Length, rb"boat\s+ship", flags))
+		self.assertEqual(13, self.ed.FindBytes(0, self.ed.Length, b"^ship", flags))
+		self.assertEqual(10, self.ed.FindBytes(0, self.ed.Length, b"\t$", flags))
+
+	def testSearchAll(self):
+		self.ed.TargetWholeDocument()
+		self.ed.SearchFlags = 0
+		searchString = b"b"
+		self.assertEqual(2, self.ed.SearchAllInTarget(len(searchString), searchString))
+		# Target not moved
+		self.assertEqual(0, self.ed.TargetStart)
+		self.assertEqual(self.ed.Length, self.ed.TargetEnd)
+		self.ed.SearchFlags = self.ed.SCFIND_REGEXP
+		searchString = b"b[a-z]*"
+		self.assertEqual(2, self.ed.SearchAllInTarget(len(searchString), searchString))
+		self.ed.IndicatorCurrent = 3
+		self.ed.IndicatorValue = 1
+		self.ed.IndicatorFillSearchAll()
+		self.assertEqual(self.ed.IndicatorStart(3, 3), 2)
+		self.assertEqual(self.ed.IndicatorEnd(3, 3), 5)
+		self.assertEqual(self.ed.IndicatorStart(3, 7), 6)
+		self.assertEqual(self.ed.IndicatorEnd(3, 7), 10)
+
 	def testCxx11RETooMany(self):
 		# For bug #2281
 		self.ed.InsertText(0, b"3ringsForTheElvenKing")
@@ -3280,6 +3329,20 @@ class TestAutoComplete(unittest.TestCase):
 
 		self.assertEqual(self.ed.AutoCActive(), 0)
 
+	def testAutoFuzzyMatch(self):
+		self.assertEqual(self.ed.AutoCActive(), 0)
+		self.ed.SetSel(0, 0)
+
+		self.ed.AutoCSetOptions(self.ed.SC_AUTOCOMPLETE_FUZZY_MATCH, 0)
+		self.ed.AutoCShow(0, b"GetLength GetTextLength SetText")
+		# no item starts with GTL so select the item containing it as a subsequence
+		self.ed.AutoCSelect(0, b"GTL")
+		self.ed.AutoCComplete()
+		self.assertEqual(self.ed.Contents(), b"GetTextLengthxxx\n")
+
+		self.ed.AutoCSetOptions(self.ed.SC_AUTOCOMPLETE_NORMAL, 0)
+		self.assertEqual(self.ed.AutoCActive(), 0)
+
 	def testAutoCustomSort(self):
 		# Checks bug #2294 where SC_ORDER_CUSTOM with an empty list asserts
 		# https://sourceforge.net/p/scintilla/bugs/2294/
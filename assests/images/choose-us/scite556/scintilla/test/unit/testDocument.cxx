@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <cstring>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
 #include <map>
@@ -675,6 +676,82 @@ TEST_CASE("Document") {
 		#endif
 	}
 
+	SECTION("RegexMultiline") {
+		#ifndef NO_CXX11_REGEX
+		DocPlus doc("ab cd\r\nef gh\nij", CpUtf8);
+		const Sci::Position docLength = doc.document.Length();
+		constexpr FindOption reMultiline = reCxx11 | FindOption::Multiline;
+		Match match;
+
+		// Only matches over a line end with Multiline
+		constexpr std::string_view spanning = "cd\\s+ef";
+		match = doc.FindString(0, docLength, spanning, reCxx11);
+		REQUIRE(match.location == -1);
+		match = doc.FindString(0, docLength, spanning, reMultiline);
+		REQUIRE(match == Match(3, 6));
+
+		constexpr std::string_view words = "[a-z]+ [a-z]+";
+		match = doc.FindString(0, docLength, words, reMultiline);
+		REQUIRE(match == Match(0, 5));
+		match = doc.FindString(docLength, 0, words, reMultiline);
+		REQUIRE(match == Match(7, 5));
+
+		// ^ and $ match at line ends but not between CR and LF
+		constexpr std::string_view findingBOL = "^";
+		match = doc.FindString(1, docLength, findingBOL, reMultiline);
+		REQUIRE(match == Match(7));
+		constexpr std::string_view findingEOL = "$";
+		match = doc.FindString(0, docLength, findingEOL, reMultiline);
+		REQUIRE(match == Match(5));
+		match = doc.FindString(6, docLength, findingEOL, reMultiline);
+		REQUIRE(match == Match(12));
+		constexpr std::string_view lineEnding = "h$";
+		match = doc.FindString(0, docLength, lineEnding, reMultiline);
+		REQUIRE(match == Match(11, 1));
+		#endif
+	}
+
+	SECTION("FindAll") {
+		DocPlus doc("ab cab\nAB ab", CpUtf8);
+		const Sci::Position docLength = doc.document.Length();
+		constexpr std::string_view finding = "ab";
+		const std::vector<Range> expected { Range(0, 2), Range(4, 6), Range(7, 9), Range(10, 12) };
+		std::vector<Range> matches = doc.document.FindAll(0, docLength, finding.data(), FindOption::None, finding.length());
+		REQUIRE(matches == expected);
+		matches = doc.document.FindAll(docLength, 0, finding.data(), FindOption::None, finding.length());
+		REQUIRE(matches == expected);
+		matches = doc.document.FindAll(0, docLength, finding.data(), FindOption::MatchCase | FindOption::WholeWord, finding.length());
+		REQUIRE(matches == std::vector<Range> { Range(0, 2), Range(10, 12) });
+		matches = doc.document.FindAll(0, docLength, finding.data(), rePosix, finding.length());
+		REQUIRE(matches == expected);
+
+		// Empty matches
+		constexpr std::string_view endOfLine = "$";
+		matches = doc.document.FindAll(0, docLength, endOfLine.data(), rePosix, endOfLine.length());
+		REQUIRE(matches == std::vector<Range> { Range(6), Range(12) });
+		constexpr std::string_view optional = "x*";
+		matches = doc.document.FindAll(0, 3, optional.data(), rePosix, optional.length());
+		REQUIRE(matches == std::vector<Range> { Range(0), Range(1), Range(2), Range(3) });
+		// Empty match at the end of the range after a match that ends there
+		constexpr std::string_view optionalB = "b*";
+		matches = doc.document.FindAll(0, 2, optionalB.data(), rePosix, optionalB.length());
+		REQUIRE(matches == std::vector<Range> { Range(0), Range(1, 2), Range(2) });
+		// Back references use the backtracking matcher
+		constexpr std::string_view optionalRef = "\\(x*\\)\\1";
+		matches = doc.document.FindAll(4, 6, optionalRef.data(), FindOption::RegExp, optionalRef.length());
+		REQUIRE(matches == std::vector<Range> { Range(4), Range(5), Range(6) });
+
+		#ifndef NO_CXX11_REGEX
+		matches = doc.document.FindAll(0, docLength, finding.data(), reCxx11, finding.length());
+		REQUIRE(matches == expected);
+		constexpr std::string_view spanning = "b\\s+A";
+		matches = doc.document.FindAll(0, docLength, spanning.data(), reCxx11 | FindOption::MatchCase, spanning.length());
+		REQUIRE(matches.empty());
+		matches = doc.document.FindAll(0, docLength, spanning.data(), reCxx11 | FindOption::MatchCase | FindOption::Multiline, spanning.length());
+		REQUIRE(matches == std::vector<Range> { Range(5, 8) });
+		#endif
+	}
+
 	SECTION("RESearchMovePositionOutsideCharUTF8") {
 		DocPlus doc(" a\xCE\x93\xCE\x93z ", CpUtf8);// a gamma gamma z
 		const Sci::Position docLength = doc.document.Length();
@@ -763,6 +840,60 @@ TEST_CASE("Document") {
 		REQUIRE(pos == 0);
 	}
 
+	SECTION("BraceMatch Index") {
+		// Long scans create an index so check matches against scanning each time
+		std::string text;
+		for (int i = 0; i < 100000; i++) {
+			text += "({[<>]})x({)y\n"[(i * 7 + i / 13) % 15];
+		}
+		DocPlus doc(text, CpUtf8);
+		const auto checkAll = [&doc](Sci::Position step) {
+			const std::string contents = doc.Contents();
+			const Sci::Position length = doc.document.Length();
+			const Sci::Position endStyled = doc.document.GetEndStyled();
+			for (Sci::Position position = 0; position < length; position += step) {
+				const char chBrace = contents[position];
+				const size_t kind = std::string_view("()[]{}<>").find(chBrace);
+				if (kind == std::string_view::npos)
+					continue;
+				const char chSeek = "()[]{}<>"[kind ^ 1];
+				const int styBrace = doc.document.StyleIndexAt(position);
+				const int direction = (kind % 2 == 0) ? 1 : -1;
+				Sci::Position match = -1;
+				int depth = 1;
+				for (Sci::Position pos = position + direction; pos >= 0 && pos < length; pos += direction) {
+					if ((contents[pos] == chBrace || contents[pos] == chSeek) &&
+						((pos > endStyled) || (doc.document.StyleIndexAt(pos) == styBrace))) {
+						depth += (contents[pos] == chBrace) ? 1 : -1;
+						if (depth == 0) {
+							match = pos;
+							break;
+						}
+					}
+				}
+				REQUIRE(doc.document.BraceMatch(position, 0, 0, false) == match);
+			}
+		};
+		// Style in runs of 3 styles with the end of the document unstyled
+		doc.document.StartStyling(0);
+		for (int run = 0; run < 700; run++) {
+			doc.document.SetStyleFor(100, static_cast<char>(run % 3));
+		}
+		// Unmatched brace at start scans the document and creates the index
+		doc.document.InsertString(0, "(", 1);
+		doc.document.StartStyling(0);
+		doc.document.SetStyleFor(70000, 1);
+		checkAll(101);
+		// Modifications invalidate the index after the change
+		doc.document.InsertString(50000, "{(((", 4);
+		checkAll(103);
+		doc.document.StartStyling(50000);
+		doc.document.SetStyleFor(30000, 2);
+		checkAll(107);
+		doc.document.DeleteChars(10, 20000);
+		checkAll(109);
+	}
+
 }
 
 TEST_CASE("DocumentUndo") {
@@ -868,6 +999,61 @@ TEST_CASE("Words") {
 		REQUIRE(!docEndSpace.document.IsWordAt(0, 2));
 		REQUIRE(!docEndSpace.document.IsWordAt(3, 5));
 	}
+
+	SECTION("WordMovement") {
+		// Short lines are classified character by character while long lines use cached runs
+		for (const Sci::Position n : { 10, 1200 }) {
+			const std::string text = std::string(n, ' ') + "abc  def.. ghi\n  jk";
+			DocPlus doc(text, 0);
+			Document &document = doc.document;
+			REQUIRE(document.ExtendWordSelect(n + 1, -1) == n);
+			REQUIRE(document.ExtendWordSelect(n + 1, 1) == n + 3);
+			REQUIRE(document.ExtendWordSelect(n + 6, 1) == n + 8);
+			REQUIRE(document.ExtendWordSelect(n + 3, 1, true) == n + 3);
+			REQUIRE(document.NextWordStart(n, 1) == n + 5);
+			REQUIRE(document.NextWordStart(n + 5, 1) == n + 8);
+			REQUIRE(document.NextWordStart(n + 11, 1) == n + 14);
+			REQUIRE(document.NextWordStart(n + 14, 1) == n + 17);
+			REQUIRE(document.NextWordStart(n + 17, -1) == n + 14);
+			REQUIRE(document.NextWordStart(n + 5, -1) == n);
+			REQUIRE(document.NextWordStart(n, -1) == 0);
+			REQUIRE(document.NextWordEnd(n, 1) == n + 3);
+			REQUIRE(document.NextWordEnd(n + 3, 1) == n + 8);
+			REQUIRE(document.NextWordEnd(n + 8, -1) == n + 3);
+			REQUIRE(document.IsWordStartAt(n + 5));
+			REQUIRE(!document.IsWordStartAt(n + 6));
+			REQUIRE(document.IsWordEndAt(n + 8));
+			REQUIRE(document.IsWordAt(n + 8, n + 10));
+			Sci::Position length = 3;
+			REQUIRE(doc.FindNeedle("def", FindOption::WholeWord, &length) == n + 5);
+			length = 2;
+			REQUIRE(doc.FindNeedle("de", FindOption::WholeWord, &length) == -1);
+
+			// Edits and changes to character classes discard cached runs
+			document.InsertString(n + 6, "-");
+			REQUIRE(document.ExtendWordSelect(n + 5, 1) == n + 6);
+			REQUIRE(document.NextWordStart(n + 5, 1) == n + 6);
+			REQUIRE(document.ExtendWordSelect(n + 7, 1) == n + 9);
+			document.SetCharClasses(reinterpret_cast<const unsigned char *>("."), CharacterClass::word);
+			REQUIRE(document.ExtendWordSelect(n + 7, 1) == n + 11);
+			REQUIRE(!document.IsWordEndAt(n + 9));
+		}
+	}
+
+	SECTION("WordMovementUTF8") {
+		for (const Sci::Position n : { 10, 1200 }) {
+			const std::string text = std::string(n, ' ') + "caf\xc3\xa9 \xe2\x80\x94 x";
+			const DocPlus doc(text, CpUtf8);
+			const Document &document = doc.document;
+			REQUIRE(document.ExtendWordSelect(n, 1) == n + 5);
+			REQUIRE(document.ExtendWordSelect(n + 5, -1) == n);
+			REQUIRE(document.NextWordStart(n, 1) == n + 6);
+			REQUIRE(document.NextWordStart(n + 6, 1) == n + 10);
+			REQUIRE(document.NextWordEnd(n + 9, -1) == n + 5);
+			REQUIRE(document.IsWordStartAt(n + 6));
+			REQUIRE(document.IsWordEndAt(n + 5));
+		}
+	}
 }
 
 TEST_CASE("SafeSegment") {
@@ -95,4 +95,89 @@ TEST_CASE("RESearch") {
 		REQUIRE(pat == "cintilla");
 	}
 
+	SECTION("Lazy") {
+		RESearch re(&cc);
+		constexpr std::string_view lazy = "a+?";
+		re.Compile(lazy.data(), lazy.length(), true, false);
+		const StringCI sci("xaaa");
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 1);
+		REQUIRE(re.eopat[0] == 2);
+	}
+
+	SECTION("Optional") {
+		RESearch re(&cc);
+		constexpr std::string_view optional = "colou?r";
+		re.Compile(optional.data(), optional.length(), false, false);
+		const StringCI sci("COLOUUR Colour");
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 8);
+		REQUIRE(re.eopat[0] == 14);
+	}
+
+	SECTION("Tags") {
+		RESearch re(&cc);
+		constexpr std::string_view tagged = "(a*)(b+)c";
+		re.Compile(tagged.data(), tagged.length(), true, true);
+		const StringCI sci("xaabbc");
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 1);
+		REQUIRE(re.eopat[0] == 6);
+		REQUIRE(re.bopat[1] == 1);
+		REQUIRE(re.eopat[1] == 3);
+		REQUIRE(re.bopat[2] == 3);
+		REQUIRE(re.eopat[2] == 5);
+	}
+
+	SECTION("BackReference") {
+		RESearch re(&cc);
+		constexpr std::string_view repeated = "([a-z]+) \\1";
+		re.Compile(repeated.data(), repeated.length(), true, true);
+		const StringCI sci("is the the end");
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 3);
+		REQUIRE(re.eopat[0] == 10);
+	}
+
+	SECTION("Pathological") {
+		// Takes exponential time with a backtracking matcher
+		RESearch re(&cc);
+		constexpr std::string_view stars = "a*a*a*a*a*a*a*a*a*a*b";
+		re.Compile(stars.data(), stars.length(), true, false);
+		const StringCI sci(std::string(5000, 'a'));
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 0);
+	}
+
+	SECTION("Unicode") {
+		RESearch re(&cc);
+		// '.' and classes match whole characters
+		constexpr std::string_view anyThenZ = ".z";
+		re.Compile(anyThenZ.data(), anyThenZ.length(), true, false, true);
+		const StringCI sci("x\xC3\xA9z");	// x e-acute z
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 1);
+		REQUIRE(re.eopat[0] == 4);
+
+		constexpr std::string_view range = "[\xC3\xA0-\xC3\xAF]+";	// a-grave to i-diaeresis
+		re.Compile(range.data(), range.length(), true, false, true);
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 1);
+		REQUIRE(re.eopat[0] == 3);
+
+		constexpr std::string_view negated = "[^x]";
+		re.Compile(negated.data(), negated.length(), true, false, true);
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 1);
+		REQUIRE(re.eopat[0] == 3);
+
+		// Case insensitive E-acute matches e-acute
+		constexpr std::string_view upper = "\xC3\x89";
+		re.Compile(upper.data(), upper.length(), false, false, true);
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 1);
+		REQUIRE(re.bopat[0] == 1);
+		REQUIRE(re.eopat[0] == 3);
+		re.Compile(upper.data(), upper.length(), true, false, true);
+		REQUIRE(re.Execute(sci, 0, sci.Length()) == 0);
+	}
+
 }
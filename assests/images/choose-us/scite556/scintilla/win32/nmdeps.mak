@@ -424,6 +424,8 @@ $(DIR_O)/RESearch.obj: \
 	../src/RESearch.cxx \
 	../src/Position.h \
 	../src/CharClassify.h \
+	../src/UniConversion.h \
+	../src/CaseConvert.h \
 	../src/RESearch.h
 $(DIR_O)/RunStyles.obj: \
 	../src/RunStyles.cxx \
@@ -81,6 +81,7 @@
 #include "Cookie.h"
 #include "Worker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
 #include "DirectorExtension.h"
@@ -70,6 +70,7 @@
 #include "Cookie.h"
 #include "Worker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
 #include "StripDefinition.h"
@@ -20,6 +20,7 @@ DirectorExtension.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	DirectorExtension.h
@@ -56,6 +57,7 @@ SciTEGTK.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	../src/StripDefinition.h \
@@ -83,6 +85,9 @@ Widget.o: \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	Widget.h
+Compressor.o: \
+	../src/Compressor.cxx \
+	../src/Compressor.h
 Cookie.o: \
 	../src/Cookie.cxx \
 	../src/GUI.h \
@@ -108,6 +113,7 @@ Credits.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 EditorConfig.o: \
@@ -115,6 +121,7 @@ EditorConfig.o: \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h \
 	../src/EditorConfig.h
 ExportHTML.o: \
@@ -137,6 +144,7 @@ ExportHTML.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportPDF.o: \
@@ -159,6 +167,7 @@ ExportPDF.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportRTF.o: \
@@ -181,6 +190,7 @@ ExportRTF.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportTEX.o: \
@@ -203,6 +213,7 @@ ExportTEX.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportXML.o: \
@@ -225,6 +236,7 @@ ExportXML.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 FilePath.o: \
@@ -237,8 +249,10 @@ FileWorker.o: \
 	../../scintilla/include/ILoader.h \
 	../../scintilla/include/Sci_Position.h \
 	../src/GUI.h \
+	../src/StringHelpers.h \
 	../src/FilePath.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h
@@ -260,6 +274,7 @@ LuaExtension.o: \
 	../../scintilla/include/ScintillaTypes.h \
 	../../scintilla/include/ScintillaMessages.h \
 	../../scintilla/include/ScintillaCall.h \
+	../../scintilla/include/ScintillaStructures.h \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
@@ -290,12 +305,23 @@ PathMatch.o: \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h
+PatternMatch.o: \
+	../src/PatternMatch.cxx \
+	../src/GUI.h \
+	../src/StringHelpers.h \
+	../src/PatternMatch.h
+PreprocessorIndex.o: \
+	../src/PreprocessorIndex.cxx \
+	../../scintilla/include/ScintillaTypes.h \
+	../src/PreprocessorIndex.h
 PropSetFile.o: \
 	../src/PropSetFile.cxx \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h \
 	../src/PropSetFile.h \
 	../src/EditorConfig.h
@@ -329,10 +355,12 @@ SciTEBase.o: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/EditorConfig.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
@@ -355,10 +383,12 @@ SciTEBuffers.o: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 SciTEIO.o: \
@@ -379,10 +409,12 @@ SciTEIO.o: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 SciTEProps.o: \
@@ -410,6 +442,7 @@ SciTEProps.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/EditorConfig.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
@@ -0,0 +1,205 @@
+// SciTE - Scintilla based Text Editor
+/** @file Compressor.cxx
+ ** Compress the text of buffers that are not being displayed.
+ **/
+// Copyright 2026 by the Tidy-touch contributors
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstdint>
+#include <cstring>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+#include "Compressor.h"
+
+// Compressed blocks are a series of sequences each of which is a token byte, a run of literal
+// bytes and then a match which repeats earlier text. The token holds the number of literal bytes
+// in its high 4 bits and the match length less minMatch in its low 4 bits. A value of 15 in either
+// is extended by following bytes which are added until a byte less than 255 is found. The match
+// is a 2 byte little-endian offset back from the current position then any length extension.
+// The final sequence has no match.
+
+namespace {
+
+constexpr size_t minMatch = 4;
+constexpr size_t maxOffset = 0xFFFF;
+constexpr size_t tokenMax = 15;
+constexpr int hashBits = 14;
+
+uint32_t Read32(const char *p) noexcept {
+	uint32_t value = 0;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+size_t Hash(uint32_t value) noexcept {
+	return (value * 2654435761U) >> (32 - hashBits);
+}
+
+void AppendLength(std::string &out, size_t length) {
+	while (length >= 0xFF) {
+		out.push_back('\xFF');
+		length -= 0xFF;
+	}
+	out.push_back(static_cast<char>(length));
+}
+
+void AppendSequence(std::string &out, std::string_view literals, size_t offset, size_t matchLength) {
+	const size_t literalCode = std::min(literals.size(), tokenMax);
+	const size_t matchCode = matchLength ? std::min(matchLength - minMatch, tokenMax) : 0;
+	out.push_back(static_cast<char>((literalCode << 4) | matchCode));
+	if (literalCode == tokenMax) {
+		AppendLength(out, literals.size() - tokenMax);
+	}
+	out.append(literals);
+	if (matchLength) {
+		out.push_back(static_cast<char>(offset & 0xFF));
+		out.push_back(static_cast<char>(offset >> 8));
+		if (matchCode == tokenMax) {
+			AppendLength(out, matchLength - minMatch - tokenMax);
+		}
+	}
+}
+
+bool ReadLength(std::string_view compressed, size_t &position, size_t &length) noexcept {
+	for (;;) {
+		if (position >= compressed.size()) {
+			return false;
+		}
+		const unsigned char extra = compressed[position++];
+		length += extra;
+		if (extra != 0xFF) {
+			return true;
+		}
+	}
+}
+
+}
+
+std::string CompressBlock(std::string_view text) {
+	std::string out;
+	out.reserve(text.size() / 2);
+	std::vector<uint32_t> table(1 << hashBits);
+	size_t anchor = 0;
+	size_t position = 0;
+	// Skip ahead faster through text that does not match
+	size_t misses = 0;
+	while (position + minMatch <= text.size()) {
+		const uint32_t value = Read32(text.data() + position);
+		const size_t hash = Hash(value);
+		const size_t candidate = table[hash];
+		table[hash] = static_cast<uint32_t>(position);
+		if ((candidate < position) && (position - candidate <= maxOffset) &&
+			(Read32(text.data() + candidate) == value)) {
+			size_t length = minMatch;
+			while ((position + length < text.size()) && (text[candidate + length] == text[position + length])) {
+				length++;
+			}
+			AppendSequence(out, text.substr(anchor, position - anchor), position - candidate, length);
+			position += length;
+			anchor = position;
+			misses = 0;
+		} else {
+			position += 1 + (misses++ >> 6);
+		}
+	}
+	AppendSequence(out, text.substr(anchor), 0, 0);
+	return out;
+}
+
+bool ExpandBlock(std::string_view compressed, char *text, size_t lengthText) noexcept {
+	size_t position = 0;
+	size_t written = 0;
+	while (position < compressed.size()) {
+		const unsigned char token = compressed[position++];
+		size_t literals = token >> 4;
+		if ((literals == tokenMax) && !ReadLength(compressed, position, literals)) {
+			return false;
+		}
+		if ((literals > compressed.size() - position) || (literals > lengthText - written)) {
+			return false;
+		}
+		memcpy(text + written, compressed.data() + position, literals);
+		position += literals;
+		written += literals;
+		if (position == compressed.size()) {
+			// Final sequence has no match
+			break;
+		}
+		if (compressed.size() - position < 2) {
+			return false;
+		}
+		const size_t offset = static_cast<unsigned char>(compressed[position]) |
+			(static_cast<unsigned char>(compressed[position + 1]) << 8);
+		position += 2;
+		size_t matchLength = token & 0xF;
+		if ((matchLength == tokenMax) && !ReadLength(compressed, position, matchLength)) {
+			return false;
+		}
+		matchLength += minMatch;
+		if ((offset == 0) || (offset > written) || (matchLength > lengthText - written)) {
+			return false;
+		}
+		// Matches may overlap the text they produce so copy forwards a byte at a time
+		const char *source = text + written - offset;
+		for (size_t i = 0; i < matchLength; i++) {
+			text[written + i] = source[i];
+		}
+		written += matchLength;
+	}
+	return written == lengthText;
+}
+
+void CompressedText::Append(std::string_view text) {
+	std::string compressed = CompressBlock(text);
+	// Store incompressible text as is which is recognized by the sizes being equal
+	const std::string_view stored = (compressed.size() < text.size()) ? std::string_view(compressed) : text;
+	blocks.push_back({data.size(), stored.size(), text.size()});
+	data.append(stored);
+	lengthText += text.size();
+}
+
+// Release memory reserved for further blocks once all have been added
+void CompressedText::Compact() {
+	data.shrink_to_fit();
+	blocks.shrink_to_fit();
+}
+
+void CompressedText::Clear() noexcept {
+	blocks = std::vector<Block>();
+	data = std::string();
+	lengthText = 0;
+}
+
+bool CompressedText::Empty() const noexcept {
+	return blocks.empty();
+}
+
+size_t CompressedText::Length() const noexcept {
+	return lengthText;
+}
+
+size_t CompressedText::Size() const noexcept {
+	return data.capacity() + blocks.capacity() * sizeof(Block);
+}
+
+size_t CompressedText::Blocks() const noexcept {
+	return blocks.size();
+}
+
+size_t CompressedText::BlockLength(size_t block) const noexcept {
+	return blocks[block].lengthText;
+}
+
+bool CompressedText::Expand(size_t block, char *text) const noexcept {
+	const Block &b = blocks[block];
+	const std::string_view stored = std::string_view(data).substr(b.start, b.size);
+	if (b.size == b.lengthText) {
+		memcpy(text, stored.data(), b.size);
+		return true;
+	}
+	return ExpandBlock(stored, text, b.lengthText);
+}
@@ -0,0 +1,43 @@
+// SciTE - Scintilla based Text Editor
+/** @file Compressor.h
+ ** Compress the text of buffers that are not being displayed.
+ **/
+// Copyright 2026 by the Tidy-touch contributors
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+std::string CompressBlock(std::string_view text);
+bool ExpandBlock(std::string_view compressed, char *text, size_t lengthText) noexcept;
+
+/**
+ * Text held as a sequence of blocks each compressed independently with a simple LZ77 scheme
+ * so that blocks can be compressed as the text is read and expanded into a Scintilla loader.
+ * Blocks that do not compress are stored as they are.
+ */
+class CompressedText {
+	struct Block {
+		size_t start;
+		size_t size;
+		size_t lengthText;
+	};
+	std::vector<Block> blocks;
+	std::string data;
+	size_t lengthText = 0;
+public:
+	static constexpr size_t blockSize = 256 * 1024;
+
+	void Append(std::string_view text);
+	void Compact();
+	void Clear() noexcept;
+	bool Empty() const noexcept;
+	// Length of the text and the number of bytes used to hold it compressed
+	size_t Length() const noexcept;
+	size_t Size() const noexcept;
+	size_t Blocks() const noexcept;
+	size_t BlockLength(size_t block) const noexcept;
+	bool Expand(size_t block, char *text) const noexcept;
+};
+
+#endif
@@ -1,11 +1,12 @@
 // SciTE - Scintilla based Text Editor
 /** @file Cookie.cxx
- ** Examine start of files for coding cookies and type information.
+ ** Examine files for coding cookies, line ends, indentation and type information.
  **/
 // Copyright 2011 by Neil Hodgson <neilh@scintilla.org>
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstdlib>
+#include <cstdint>
 #include <cstring>
 
 #include <tuple>
@@ -89,3 +90,134 @@ UniMode CodingCookieValue(std::string_view sv) noexcept {
 	return unicodeMode;
 }
 
+
+namespace {
+
+constexpr uint64_t onesBytes = UINT64_MAX / 255;
+constexpr uint64_t highBits = onesBytes * 0x80;
+
+// Line ends, tabs and other controls below this are examined byte by byte
+constexpr uint64_t minPlain = '\r' + 1;
+
+// Can a group of 8 bytes be skipped as it contains no line ends and only ASCII?
+constexpr bool PlainWord(uint64_t x) noexcept {
+	const uint64_t below = (x - onesBytes * minPlain) & ~x & highBits;
+	return ((x & highBits) | below) == 0;
+}
+
+}
+
+void TextAnalysis::AnalyseByte(unsigned char ch) noexcept {
+	if (chPrev == '\r') {
+		if (ch == '\n')
+			linesCRLF++;
+		else
+			linesCR++;
+	} else if (ch == '\n') {
+		linesLF++;
+	}
+	chPrev = ch;
+
+	if (ch == '\r' || ch == '\n') {
+		indent = 0;
+		lineStart = true;
+	} else if (lineStart && ch == ' ') {
+		indent++;
+	} else if (lineStart) {
+		if (indent) {
+			if (indent == prevIndent && prevTabSize != -1) {
+				tabSizes[prevTabSize]++;
+			} else if (indent > prevIndent && prevIndent != -1) {
+				if (indent - prevIndent <= 8) {
+					prevTabSize = indent - prevIndent;
+					tabSizes[prevTabSize]++;
+				} else {
+					prevTabSize = -1;
+				}
+			}
+			prevIndent = indent;
+		} else if (ch == '\t') {
+			tabSizes[0]++;
+			prevIndent = -1;
+		} else {
+			prevIndent = 0;
+		}
+		lineStart = false;
+	}
+
+	if (trailBytes) {
+		if (ch >= trailMin && ch <= trailMax) {
+			trailBytes--;
+			trailMin = 0x80;
+			trailMax = 0xBF;
+			return;
+		}
+		validUTF8 = false;
+		trailBytes = 0;
+	}
+	if (ch >= 0x80) {
+		nonASCII = true;
+		if (ch < 0xC2 || ch > 0xF4) {
+			validUTF8 = false;
+		} else if (ch < 0xE0) {
+			trailBytes = 1;
+		} else if (ch < 0xF0) {
+			// Exclude overlong forms and surrogates
+			trailBytes = 2;
+			if (ch == 0xE0)
+				trailMin = 0xA0;
+			else if (ch == 0xED)
+				trailMax = 0x9F;
+		} else {
+			// Exclude overlong forms and values beyond U+10FFFF
+			trailBytes = 3;
+			if (ch == 0xF0)
+				trailMin = 0x90;
+			else if (ch == 0xF4)
+				trailMax = 0x8F;
+		}
+	}
+}
+
+void TextAnalysis::Analyse(std::string_view sv) noexcept {
+	constexpr size_t wordSize = sizeof(uint64_t);
+	size_t i = 0;
+	while (i < sv.length()) {
+		// Most of the text is inside lines and ASCII so check 8 bytes at a time
+		if (!lineStart && !trailBytes && (chPrev != '\r')) {
+			while (i + wordSize <= sv.length()) {
+				uint64_t x = 0;
+				memcpy(&x, sv.data() + i, wordSize);
+				if (!PlainWord(x))
+					break;
+				i += wordSize;
+				chPrev = sv[i - 1];
+			}
+			if (i >= sv.length())
+				break;
+		}
+		AnalyseByte(static_cast<unsigned char>(sv[i]));
+		i++;
+	}
+}
+
+void TextAnalysis::Finish() noexcept {
+	if (chPrev == '\r')
+		linesCR++;
+	chPrev = '\0';
+	if (trailBytes)
+		validUTF8 = false;
+	trailBytes = 0;
+	complete = true;
+}
+
+// Most common indentation step: 0 for tabs, the number of spaces, or -1 if unknown.
+int TextAnalysis::IndentStep() const noexcept {
+	int topTabSize = -1;
+	for (int j = 0; j <= 8; j++) {
+		if (tabSizes[j] && (topTabSize == -1 || tabSizes[j] > tabSizes[topTabSize])) {
+			topTabSize = j;
+		}
+	}
+	return topTabSize;
+}
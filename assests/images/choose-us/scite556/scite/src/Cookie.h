@@ -1,6 +1,6 @@
 // SciTE - Scintilla based Text Editor
 /** @file Cookie.h
- ** Examine start of files for coding cookies and type information.
+ ** Examine files for coding cookies, line ends, indentation and type information.
  **/
 // Copyright 2011 by Neil Hodgson <neilh@scintilla.org>
 // The License.txt file describes the conditions under which this software may be distributed.
@@ -17,4 +17,31 @@ enum class UniMode {
 std::string_view ExtractLine(std::string_view sv) noexcept;
 UniMode CodingCookieValue(std::string_view sv) noexcept;
 
+/**
+ * Examine text in blocks as a file is read, counting line ends, gathering a histogram of
+ * indentation steps and checking whether the text is valid UTF-8.
+ */
+class TextAnalysis {
+	char chPrev = '\0';
+	bool lineStart = true;
+	int indent = 0;
+	int prevIndent = 0;
+	int prevTabSize = -1;
+	int trailBytes = 0;
+	unsigned char trailMin = 0x80;
+	unsigned char trailMax = 0xBF;
+	void AnalyseByte(unsigned char ch) noexcept;
+public:
+	size_t linesCR = 0;
+	size_t linesLF = 0;
+	size_t linesCRLF = 0;
+	size_t tabSizes[9] {};	// Number of lines with each indentation step (index 0 - tab)
+	bool validUTF8 = true;
+	bool nonASCII = false;
+	bool complete = false;
+	void Analyse(std::string_view sv) noexcept;
+	void Finish() noexcept;
+	[[nodiscard]] int IndentStep() const noexcept;
+};
+
 #endif
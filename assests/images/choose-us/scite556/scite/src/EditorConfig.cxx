@@ -6,7 +6,9 @@
 // Copyright 2018 by Neil Hodgson <neilh@scintilla.org>
 // The License.txt file describes the conditions under which this software may be distributed.
 
+#include <cstdint>
 #include <cassert>
+#include <ctime>
 
 #include <compare>
 #include <tuple>
@@ -23,21 +25,47 @@
 
 #include "StringHelpers.h"
 #include "FilePath.h"
+#include "PatternMatch.h"
 #include "PathMatch.h"
 #include "EditorConfig.h"
 
 namespace {
 
+struct ECSection {
+	CompiledPattern pattern;	// Compiled once for matching many paths
+	std::vector<std::pair<std::string, std::string>> settings;
+};
+
 struct ECForDirectory {
 	bool isRoot;
 	std::string directory;
-	std::vector<std::string> lines;
+	// Modification times only change each second so the length also detects rewrites
+	time_t modified;
+	long long length;
+	std::vector<ECSection> sections;
 	ECForDirectory();
 	void ReadOneDirectory(const FilePath &dir);
 };
 
+using ECLevels = std::vector<std::shared_ptr<const ECForDirectory>>;
+
+// Settings found for a file and the configuration files used to find them
+struct ECResolution {
+	ECLevels levels;
+	std::map<std::string, std::string> settings;
+};
+
 class EditorConfig : public IEditorConfig {
-	std::vector<ECForDirectory> config;
+	// Bound the caches for sessions that visit many directories and files
+	static constexpr size_t maxCachedDirectories = 256;
+	static constexpr size_t maxResolutions = 1024;
+	ECLevels config;
+	// Parsed .editorconfig files by directory, reused while their modification time and length are unchanged
+	std::map<std::string, std::shared_ptr<const ECForDirectory>> cache;
+	// Settings by absolute path, valid while the same configuration files apply
+	mutable std::map<std::string, ECResolution> resolutions;
+	std::shared_ptr<const ECForDirectory> ForDirectory(const FilePath &dir);
+	std::map<std::string, std::string> Resolve(const std::string &fullPath) const;
 public:
 	void ReadFromDirectory(const FilePath &dirStart) override;
 	std::map<std::string, std::string> MapFromAbsolutePath(const FilePath &absolutePath) const override;
@@ -48,14 +76,16 @@ const GUI::gui_char editorConfigName[] = GUI_TEXT(".editorconfig");
 
 }
 
-ECForDirectory::ECForDirectory() : isRoot(false) {
+ECForDirectory::ECForDirectory() : isRoot(false), modified(0), length(0) {
 }
 
 void ECForDirectory::ReadOneDirectory(const FilePath &dir) {
 	directory = dir.AsUTF8();
 	directory.append("/");
 	FilePath fpec(dir, editorConfigName);
-	std::string configString = fpec.Read();
+	modified = fpec.ModifiedTime();
+	length = modified ? fpec.GetFileLength() : 0;
+	std::string configString = modified ? fpec.Read() : std::string();
 	if (configString.size() > 0) {
 		const std::string_view svUtf8BOM(UTF8BOM);
 		if (configString.starts_with(svUtf8BOM)) {
@@ -69,29 +99,54 @@ void ECForDirectory::ReadOneDirectory(const FilePath &dir) {
 				// Drop comments
 			} else if (line.starts_with("[")) {
 				// Pattern
-				lines.push_back(line);
+				// CompiledPattern only works with literal filenames, '?', '*', '**', '[]', '[!]', '{,}', '{..}', '\x'.
+				ECSection section;
+				section.pattern = CompiledPattern(PreparePattern(line.substr(1, line.size() - 2)));
+				sections.push_back(std::move(section));
 			} else if (Contains(line, '=')) {
 				LowerCaseAZ(line);
 				Remove(line, std::string(" "));
-				lines.push_back(line);
 				std::vector<std::string> nameVal = StringSplit(line, '=');
 				if (nameVal.size() == 2) {
 					if ((nameVal[0] == "root") && nameVal[1] == "true") {
 						isRoot = true;
 					}
+					if (!sections.empty()) {
+						sections.back().settings.emplace_back(nameVal[0], nameVal[1]);
+					}
 				}
 			}
 		}
 	}
 }
 
+std::shared_ptr<const ECForDirectory> EditorConfig::ForDirectory(const FilePath &dir) {
+	const FilePath fpec(dir, editorConfigName);
+	const time_t modified = fpec.ModifiedTime();
+	const long long length = modified ? fpec.GetFileLength() : 0;
+	const std::string key = dir.AsUTF8();
+	std::map<std::string, std::shared_ptr<const ECForDirectory>>::const_iterator it = cache.find(key);
+	if ((it != cache.end()) && (it->second->modified == modified) && (it->second->length == length)) {
+		return it->second;
+	}
+	if (cache.size() >= maxCachedDirectories) {
+		// Forget directories not in the current configuration
+		std::erase_if(cache, [this](const auto &entry) {
+			return std::ranges::find(config, entry.second) == config.end();
+		});
+	}
+	std::shared_ptr<ECForDirectory> ecfd = std::make_shared<ECForDirectory>();
+	ecfd->ReadOneDirectory(dir);
+	cache[key] = ecfd;
+	return ecfd;
+}
+
 void EditorConfig::ReadFromDirectory(const FilePath &dirStart) {
 	FilePath dir = dirStart;
 	while (true) {
-		ECForDirectory ecfd;
-		ecfd.ReadOneDirectory(dir);
+		std::shared_ptr<const ECForDirectory> ecfd = ForDirectory(dir);
 		config.insert(config.begin(), ecfd);
-		if (ecfd.isRoot || !dir.IsSet() || dir.IsRoot()) {
+		if (ecfd->isRoot || !dir.IsSet() || dir.IsRoot()) {
 			break;
 		}
 		// Up a level
@@ -99,33 +154,21 @@ void EditorConfig::ReadFromDirectory(const FilePath &dirStart) {
 	}
 }
 
-std::map<std::string, std::string> EditorConfig::MapFromAbsolutePath(const FilePath &absolutePath) const {
+std::map<std::string, std::string> EditorConfig::Resolve(const std::string &fullPath) const {
 	std::map<std::string, std::string> ret;
-	std::string fullPath = absolutePath.AsUTF8();
-#if defined(_WIN32)
-	// Convert Windows path separators to Unix
-	std::ranges::replace(fullPath, '\\', '/');
-#endif
-	for (const ECForDirectory &level : config) {
+	for (const std::shared_ptr<const ECForDirectory> &level : config) {
 		std::string relPath;
-		if (level.directory.length() <= fullPath.length()) {
-			relPath = fullPath.substr(level.directory.length());
+		if (level->directory.length() <= fullPath.length()) {
+			relPath = fullPath.substr(level->directory.length());
 		}
-		bool inActiveSection = false;
-		for (const std::string &line : level.lines) {
-			if (line.starts_with("[")) {
-				const std::string pattern = line.substr(1, line.size() - 2);
-				inActiveSection = PathMatch(pattern, relPath);
-				// PatternMatch only works with literal filenames, '?', '*', '**', '[]', '[!]', '{,}', '{..}', '\x'.
-			} else if (inActiveSection && Contains(line, '=')) {
-				const std::vector<std::string> nameVal = StringSplit(line, '=');
-				if (nameVal.size() == 2) {
-					if (nameVal[1] == "unset") {
-						std::map<std::string, std::string>::iterator it = ret.find(nameVal[0]);
-						if (it != ret.end())
-							ret.erase(it);
+		const std::u32string relPathU32 = PreparePath(relPath);
+		for (const ECSection &section : level->sections) {
+			if (PreparedPathMatch(section.pattern, relPathU32)) {
+				for (const std::pair<std::string, std::string> &nameVal : section.settings) {
+					if (nameVal.second == "unset") {
+						ret.erase(nameVal.first);
 					} else {
-						ret[nameVal[0]] = nameVal[1];
+						ret[nameVal.first] = nameVal.second;
 					}
 				}
 			}
@@ -152,6 +195,31 @@ std::map<std::string, std::string> EditorConfig::MapFromAbsolutePath(const FileP
 	return ret;
 }
 
+std::map<std::string, std::string> EditorConfig::MapFromAbsolutePath(const FilePath &absolutePath) const {
+	std::string fullPath = absolutePath.AsUTF8();
+#if defined(_WIN32)
+	// Convert Windows path separators to Unix
+	std::ranges::replace(fullPath, '\\', '/');
+#endif
+	std::map<std::string, ECResolution>::const_iterator it = resolutions.find(fullPath);
+	if ((it != resolutions.end()) && (it->second.levels == config)) {
+		return it->second.settings;
+	}
+	if (resolutions.size() >= maxResolutions) {
+		// Drop settings resolved from other configurations and, if still full, all of them
+		std::erase_if(resolutions, [this](const auto &entry) {
+			return entry.second.levels != config;
+		});
+		if (resolutions.size() >= maxResolutions) {
+			resolutions.clear();
+		}
+	}
+	ECResolution resolution{ config, Resolve(fullPath) };
+	std::map<std::string, std::string> ret = resolution.settings;
+	resolutions[fullPath] = std::move(resolution);
+	return ret;
+}
+
 void EditorConfig::Clear() noexcept {
 	config.clear();
 }
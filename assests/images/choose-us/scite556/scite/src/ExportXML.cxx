@@ -49,6 +49,7 @@
 #include "Cookie.h"
 #include "Worker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
 
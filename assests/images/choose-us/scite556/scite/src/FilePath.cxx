@@ -28,6 +28,7 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <pwd.h>
+#include <sys/uio.h>
 
 #endif
 
@@ -412,24 +413,56 @@ FilePath FilePath::UserHomeDirectory() {
 #endif
 }
 
+namespace {
+
+class DirectoryLister : public DirectoryVisitor {
+	const FilePath &directory;
+	FilePathSet &directories;
+	FilePathSet &files;
+public:
+	DirectoryLister(const FilePath &directory_, FilePathSet &directories_, FilePathSet &files_) noexcept :
+		directory(directory_), directories(directories_), files(files_) {
+	}
+	bool Entry(GUI::gui_string_view name, bool isDirectory) override {
+		FilePath pathFull(directory, FilePath(name));
+		if (isDirectory) {
+			directories.push_back(std::move(pathFull));
+		} else {
+			files.push_back(std::move(pathFull));
+		}
+		return true;
+	}
+};
+
+}
+
 void FilePath::List(FilePathSet &directories, FilePathSet &files) const {
+	DirectoryLister lister(*this, directories, files);
+	Enumerate(lister);
+	std::ranges::sort(files);
+	std::ranges::sort(directories);
+}
+
+// Read directory entries in the order the file system returns them. The type of each entry is
+// normally available from the directory itself, avoiding a stat call for each file which is
+// slow on network file systems.
+void FilePath::Enumerate(DirectoryVisitor &visitor) const {
 #ifdef _WIN32
 	FilePath wildCard(*this, GUI_TEXT("*.*"));
 	WIN32_FIND_DATAW findFileData;
-	HANDLE hFind = ::FindFirstFileW(wildCard.AsInternal(), &findFileData);
+	// Basic information omits short names and large fetch reduces round trips to network drives
+	HANDLE hFind = ::FindFirstFileExW(wildCard.AsInternal(), FindExInfoBasic, &findFileData,
+		FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
 	if (hFind != INVALID_HANDLE_VALUE) {
 		bool complete = false;
 		while (!complete) {
 			const std::wstring_view entryName = findFileData.cFileName;
 			if ((entryName != currentDirectory) && (entryName != parentDirectory)) {
-				FilePath pathFull(*this, findFileData.cFileName);
-				if (findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-					directories.push_back(pathFull);
-				} else {
-					files.push_back(pathFull);
+				if (!visitor.Entry(entryName, (findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)) {
+					complete = true;
 				}
 			}
-			if (!::FindNextFileW(hFind, &findFileData)) {
+			if (!complete && !::FindNextFileW(hFind, &findFileData)) {
 				complete = true;
 			}
 		}
@@ -446,19 +479,21 @@ void FilePath::List(FilePathSet &directories, FilePathSet &files) const {
 	while ((ent = readdir(dp)) != NULL) {
 		std::string_view entryName = ent->d_name;
 		if ((entryName != currentDirectory) && (entryName != parentDirectory)) {
-			FilePath pathFull(AsInternal(), ent->d_name);
-			if (pathFull.IsDirectory()) {
-				directories.push_back(pathFull);
-			} else {
-				files.push_back(pathFull);
+#ifdef DT_DIR
+			// Symbolic links and file systems that do not report types need to be examined
+			const bool known = (ent->d_type == DT_DIR) || (ent->d_type == DT_REG);
+			const bool isDirectory = known ? (ent->d_type == DT_DIR) : FilePath(*this, FilePath(entryName)).IsDirectory();
+#else
+			const bool isDirectory = FilePath(*this, FilePath(entryName)).IsDirectory();
+#endif
+			if (!visitor.Entry(entryName, isDirectory)) {
+				break;
 			}
 		}
 	}
 
 	closedir(dp);
 #endif
-	std::ranges::sort(files);
-	std::ranges::sort(directories);
 }
 
 FILE *FilePath::Open(const GUI::gui_char *mode) const noexcept {
@@ -489,6 +524,64 @@ void FilePath::Remove() const noexcept {
 	unlink(AsInternal());
 }
 
+// A hidden file in the same directory, so on the same file system, that can be written
+// then moved over this file to replace it in one step.
+FilePath FilePath::ReplacementPath() const {
+	GUI::gui_string name(configFileVisibilityString);
+	name += Name().AsInternal();
+	name += GUI_TEXT(".~save");
+	return FilePath(Directory(), FilePath(name));
+}
+
+// Can this file be replaced by moving another file over it without losing anything?
+// Links, files owned by others and read-only files must be written in place.
+bool FilePath::CanBeReplaced() const noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+	struct stat statusFile {};
+	if (lstat(AsInternal(), &statusFile) != 0) {
+		return errno == ENOENT;
+	}
+	return S_ISREG(statusFile.st_mode) && (statusFile.st_nlink == 1) &&
+		(statusFile.st_uid == geteuid()) && (access(AsInternal(), W_OK) == 0);
+#else
+	const DWORD attributes = ::GetFileAttributesW(AsInternal());
+	if (attributes == INVALID_FILE_ATTRIBUTES) {
+		return ::GetLastError() == ERROR_FILE_NOT_FOUND;
+	}
+	constexpr DWORD attributesPreventing =
+		FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_READONLY | FILE_ATTRIBUTE_REPARSE_POINT;
+	return (attributes & attributesPreventing) == 0;
+#endif
+}
+
+// Replace destination with this file in one step, keeping destination's permissions.
+bool FilePath::MoveOver(const FilePath &destination) const noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+	FileStatus statusDestination {};
+	if (stat(destination.AsInternal(), &statusDestination) == 0) {
+		chmod(AsInternal(), statusDestination.st_mode & 07777);
+	}
+	if (rename(AsInternal(), destination.AsInternal()) != 0) {
+		return false;
+	}
+	// Make the new directory entry durable
+	const int fdDirectory = open(destination.Directory().AsInternal(), O_RDONLY);
+	if (fdDirectory >= 0) {
+		fsync(fdDirectory);
+		close(fdDirectory);
+	}
+	return true;
+#else
+	// ReplaceFileW retains attributes and security of the replaced file
+	if (::ReplaceFileW(destination.AsInternal(), AsInternal(), nullptr,
+		REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr)) {
+		return true;
+	}
+	return ::MoveFileExW(AsInternal(), destination.AsInternal(),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#endif
+}
+
 #ifndef R_OK
 // Microsoft does not define the constants used to call access
 #define R_OK 4
@@ -585,28 +678,71 @@ bool PatternMatch(GUI::gui_string_view pattern, GUI::gui_string_view text) {
 
 }
 
-bool FilePath::Matches(GUI::gui_string_view pattern) const {
-	GUI::gui_string pat(pattern);
-	GUI::gui_string nameCopy(Name().fileName);
+FilePatternSet::FilePatternSet(GUI::gui_string_view patternSet) {
+	while (!patternSet.empty()) {
+		const size_t separator = patternSet.find_first_of(' ');
+		GUI::gui_string text(patternSet.substr(0, separator));
 #ifdef _WIN32
-	Lowercase(pat);
-	Lowercase(nameCopy);
-#endif
-	GUI::gui_string_view patView(pat);
-	while (!patView.empty()) {
-		const size_t separator = patView.find_first_of(' ');
-		const GUI::gui_string_view patElement(patView.substr(0, separator));
-		if (PatternMatch(patElement, nameCopy)) {
-			return true;
+		Lowercase(text);
+#endif
+		if (!text.empty()) {
+			// Most patterns are like "*.cxx" so check those without the general matcher
+			const size_t wildcard = text.find_first_of(GUI_TEXT("*?"));
+			if (text == GUI_TEXT("*")) {
+				patterns.push_back({Kind::any, {}});
+			} else if (wildcard == GUI::gui_string::npos) {
+				patterns.push_back({Kind::exact, text});
+			} else if ((wildcard == 0) && (text[0] == '*') && (text.find_first_of(GUI_TEXT("*?"), 1) == GUI::gui_string::npos)) {
+				patterns.push_back({Kind::suffix, text.substr(1)});
+			} else {
+				patterns.push_back({Kind::wild, text});
+			}
 		}
-		if (separator == std::string::npos) {
+		if (separator == GUI::gui_string_view::npos) {
+			break;
+		}
+		patternSet.remove_prefix(separator + 1);
+	}
+}
+
+bool FilePatternSet::Empty() const noexcept {
+	return patterns.empty();
+}
+
+bool FilePatternSet::Matches(GUI::gui_string_view name) const {
+#ifdef _WIN32
+	GUI::gui_string nameLower(name);
+	Lowercase(nameLower);
+	name = nameLower;
+#endif
+	for (const Pattern &pattern : patterns) {
+		switch (pattern.kind) {
+		case Kind::any:
+			return true;
+		case Kind::exact:
+			if (name == pattern.text) {
+				return true;
+			}
+			break;
+		case Kind::suffix:
+			if (name.ends_with(pattern.text)) {
+				return true;
+			}
+			break;
+		case Kind::wild:
+			if (PatternMatch(pattern.text, name)) {
+				return true;
+			}
 			break;
 		}
-		patView.remove_prefix(separator + 1);
 	}
 	return false;
 }
 
+bool FilePath::Matches(GUI::gui_string_view pattern) const {
+	return FilePatternSet(pattern).Matches(Name().fileName);
+}
+
 #ifdef _WIN32
 
 namespace {
@@ -792,3 +928,59 @@ std::string CommandExecute(const GUI::gui_char *command, const GUI::gui_char *di
 #endif
 	return output;
 }
+
+// Write two pieces of memory to a file with one call where possible.
+bool WriteGathered(FILE *fp, std::string_view first, std::string_view second) noexcept {
+#if defined(__unix__) || defined(__APPLE__)
+	if (fflush(fp) != 0) {
+		return false;
+	}
+	const int fd = fileno(fp);
+	iovec pieces[2] = {
+		{ const_cast<char *>(first.data()), first.size() },
+		{ const_cast<char *>(second.data()), second.size() },
+	};
+	iovec *piece = pieces;
+	int count = 2;
+	while (count > 0) {
+		if (piece->iov_len == 0) {
+			piece++;
+			count--;
+			continue;
+		}
+		const ssize_t written = writev(fd, piece, count);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		// Partial write so skip over what was written
+		size_t remove = written;
+		while ((count > 0) && (remove >= piece->iov_len)) {
+			remove -= piece->iov_len;
+			piece++;
+			count--;
+		}
+		if (count > 0) {
+			piece->iov_base = static_cast<char *>(piece->iov_base) + remove;
+			piece->iov_len -= remove;
+		}
+	}
+	return true;
+#else
+	return (first.empty() || (fwrite(first.data(), first.size(), 1, fp) == 1)) &&
+		(second.empty() || (fwrite(second.data(), second.size(), 1, fp) == 1));
+#endif
+}
+
+// Flush a file's buffers and wait until its contents are on the storage device.
+bool CommitFile(FILE *fp) noexcept {
+	if (fflush(fp) != 0) {
+		return false;
+	}
+#if defined(__unix__) || defined(__APPLE__)
+	return fsync(fileno(fp)) == 0;
+#else
+	return _commit(_fileno(fp)) == 0;
+#endif
+}
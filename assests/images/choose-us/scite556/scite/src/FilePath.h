@@ -30,6 +30,31 @@ struct FileCloser {
 
 using FileHolder = std::unique_ptr<FILE, FileCloser>;
 
+/// Receives the names of the entries of a directory, other than '.' and '..', as they are read.
+/// Return false from Entry to stop reading.
+class DirectoryVisitor {
+public:
+	virtual bool Entry(GUI::gui_string_view name, bool isDirectory) = 0;
+};
+
+/**
+ * A set of space separated wildcard patterns like "*.cxx *.h" where '*' matches any sequence of characters
+ * and '?' any single character. Split once so that many file names can be matched against the set.
+ * On Windows, matching is case-insensitive.
+ */
+class FilePatternSet {
+	enum class Kind { any, exact, suffix, wild };
+	struct Pattern {
+		Kind kind;
+		GUI::gui_string text;
+	};
+	std::vector<Pattern> patterns;
+public:
+	explicit FilePatternSet(GUI::gui_string_view patternSet);
+	bool Empty() const noexcept;
+	bool Matches(GUI::gui_string_view name) const;
+};
+
 class FilePath {
 	GUI::gui_string fileName;
 public:
@@ -71,9 +96,13 @@ public:
 	bool SetWorkingDirectory() const noexcept;
 	static FilePath UserHomeDirectory();
 	void List(FilePathSet &directories, FilePathSet &files) const;
+	void Enumerate(DirectoryVisitor &visitor) const;
 	FILE *Open(const GUI::gui_char *mode) const noexcept;
 	std::string Read() const;
 	void Remove() const noexcept;
+	FilePath ReplacementPath() const;
+	bool CanBeReplaced() const noexcept;
+	bool MoveOver(const FilePath &destination) const noexcept;
 	time_t ModifiedTime() const noexcept;
 	long long GetFileLength() const noexcept;
 	bool Exists() const noexcept;
@@ -83,5 +112,7 @@ public:
 };
 
 std::string CommandExecute(const GUI::gui_char *command, const GUI::gui_char *directoryForRun);
+bool WriteGathered(FILE *fp, std::string_view first, std::string_view second) noexcept;
+bool CommitFile(FILE *fp) noexcept;
 
 #endif
@@ -13,7 +13,9 @@
 #include <utility>
 #include <compare>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <set>
 #include <memory>
 #include <chrono>
 #include <atomic>
@@ -22,9 +24,11 @@
 #include "ILoader.h"
 
 #include "GUI.h"
+#include "StringHelpers.h"
 
 #include "FilePath.h"
 #include "Cookie.h"
+#include "Compressor.h"
 #include "Worker.h"
 #include "Utf8_16.h"
 #include "FileWorker.h"
@@ -56,6 +60,7 @@ void FileLoader::Execute() noexcept {
 				GUI::SleepMilliseconds(sleepTime);
 				const std::string_view converted = convert->convert(std::string_view(data.data(), lenFile));
 				err = pLoader->AddData(converted.data(), converted.size());
+				analysis.Analyse(converted);
 				IncrementProgress(lenFile);
 				if (et.Duration() > nextProgress) {
 					nextProgress = et.Duration() + timeBetweenProgress;
@@ -69,6 +74,8 @@ void FileLoader::Execute() noexcept {
 				// Handle case where convert is holding a lead surrogate but no more data
 				const std::string_view convertedTrail = convert->convert("");
 				err = pLoader->AddData(convertedTrail.data(), convertedTrail.size());
+				analysis.Analyse(convertedTrail);
+				analysis.Finish();
 			}
 			unicodeMode = convert->getEncoding();
 		}
@@ -93,12 +100,18 @@ void FileLoader::Cancel() noexcept {
 	pLoader = nullptr;
 }
 
-FileStorer::FileStorer(WorkerListener *pListener_, std::string_view bytes_, const FilePath &path_,
+FileStorer::FileStorer(WorkerListener *pListener_, std::string_view before_, std::string_view after_,
+		       const FilePath &path_, const FilePath &pathTemporary_,
 		       FILE *fp_, UniMode unicodeMode_, bool visibleProgress_) :
-	FileWorker(pListener_, path_, bytes_.size(), fp_), documentBytes(bytes_.data()), writtenSoFar(0),
+	FileWorker(pListener_, path_, before_.size() + after_.size(), fp_),
+	documentBefore(before_), documentAfter(after_), pathTemporary(pathTemporary_), writtenSoFar(0),
 	unicodeMode(unicodeMode_), visibleProgress(visibleProgress_) {
 	SetSizeJob(size);
 	convert = Utf8_16::Writer::Allocate(unicodeMode, blockSize);
+	if (unicodeMode == UniMode::uni16BE || unicodeMode == UniMode::uni16LE) {
+		// Allocate now as harder to report failure in storing thread
+		joined.reserve(blockSize);
+	}
 }
 
 namespace {
@@ -113,44 +126,99 @@ constexpr bool IsUTF8TrailByte(char ch) noexcept {
 
 }
 
-void FileStorer::Execute() noexcept {
+char FileStorer::ByteAt(size_t position) const noexcept {
+	if (position < documentBefore.size())
+		return documentBefore[position];
+	return documentAfter[position - documentBefore.size()];
+}
+
+// Contiguous view of part of the document, joining the two halves when needed.
+std::string_view FileStorer::Piece(size_t start, size_t length) noexcept {
+	const size_t lengthBefore = documentBefore.size();
+	if (start + length <= lengthBefore)
+		return documentBefore.substr(start, length);
+	if (start >= lengthBefore)
+		return documentAfter.substr(start - lengthBefore, length);
+	joined.assign(documentBefore.substr(start));
+	joined.append(documentAfter.substr(0, start + length - lengthBefore));
+	return joined;
+}
+
+// Write the document to fp in blocks so progress can be shown and the operation cancelled.
+// Text that does not need conversion is written straight from the two halves of the document.
+// When saving through a temporary file, it is committed to storage then moved over path.
+void FileStorer::Store() noexcept {
 	try {
 		if (fp) {
-			const std::string_view documentView(documentBytes, size);
+			const bool toUTF16 = (unicodeMode == UniMode::uni16BE) || (unicodeMode == UniMode::uni16LE);
+			if ((unicodeMode == UniMode::utf8) && (size > 0)) {
+				// Byte order mark is the only change for UTF-8
+				const std::string_view svUtf8BOM(UTF8BOM);
+				if (::fwrite(svUtf8BOM.data(), svUtf8BOM.size(), 1, fp) != 1) {
+					err = 1;
+				}
+			}
 			const size_t lengthDoc = size;
-			for (size_t startBlock = 0; startBlock < lengthDoc && (!Cancelling());) {
+			for (size_t startBlock = 0; startBlock < lengthDoc && (err == 0) && (!Cancelling());) {
 				GUI::SleepMilliseconds(sleepTime);
 				size_t grabSize = std::min(lengthDoc - startBlock, blockSize);
-				if ((unicodeMode != UniMode::uni8Bit) && (startBlock + grabSize < lengthDoc)) {
+				if (toUTF16 && (startBlock + grabSize < lengthDoc)) {
 					// Round down so only whole characters retrieved.
 					constexpr size_t maxRounding = 5;
 					size_t startLast = grabSize;
 					while ((startLast > 0) && ((grabSize - startLast) <= maxRounding) &&
-						IsUTF8TrailByte(documentBytes[startBlock + startLast]))
+						IsUTF8TrailByte(ByteAt(startBlock + startLast)))
 						startLast--;
 					if ((grabSize - startLast) < maxRounding)
 						grabSize = startLast;
 				}
-				const size_t written = convert->fwrite(documentView.substr(startBlock, grabSize), fp);
+				bool written = false;
+				if (toUTF16) {
+					written = convert->fwrite(Piece(startBlock, grabSize), fp) != 0;
+				} else {
+					const size_t lengthBefore = documentBefore.size();
+					const size_t endBlock = startBlock + grabSize;
+					const std::string_view first = (startBlock < lengthBefore) ?
+						documentBefore.substr(startBlock, std::min(endBlock, lengthBefore) - startBlock) : std::string_view();
+					const std::string_view second = (endBlock > lengthBefore) ?
+						documentAfter.substr(startBlock + first.size() - lengthBefore, grabSize - first.size()) : std::string_view();
+					written = WriteGathered(fp, first, second);
+				}
 				IncrementProgress(grabSize);
-				if (et.Duration() > nextProgress) {
+				if (pListener && (et.Duration() > nextProgress)) {
 					nextProgress = et.Duration() + timeBetweenProgress;
 					pListener->PostOnMainThread(WORK_FILEPROGRESS, this);
 				}
-				if (written == 0) {
+				if (!written) {
 					err = 1;
 					break;
 				}
 				startBlock += grabSize;
 			}
+			if (pathTemporary.IsSet() && (err == 0) && !Cancelling() && !CommitFile(fp)) {
+				err = 1;
+			}
 			if (fclose(fp) != 0) {
 				err = 1;
 			}
 			fp = nullptr;
+			if (pathTemporary.IsSet()) {
+				if ((err == 0) && !Cancelling() && !pathTemporary.MoveOver(path)) {
+					err = 1;
+				}
+				if ((err != 0) || Cancelling()) {
+					// Original file is untouched so discard partial copy
+					pathTemporary.Remove();
+				}
+			}
 		}
 	} catch (...) {
 		err = 1;
 	}
+}
+
+void FileStorer::Execute() noexcept {
+	Store();
 	SetCompleted();
 	try {
 		pListener->PostOnMainThread(WORK_FILEWRITTEN, this);
@@ -162,3 +230,34 @@ void FileStorer::Execute() noexcept {
 void FileStorer::Cancel() noexcept {
 	FileWorker::Cancel();
 }
+
+BufferCompressor::BufferCompressor(WorkerListener *pListener_, std::string_view before_, std::string_view after_) noexcept :
+	pListener(pListener_), documentBefore(before_), documentAfter(after_), failed(false) {
+	SetSizeJob(documentBefore.size() + documentAfter.size());
+}
+
+BufferCompressor::~BufferCompressor() noexcept {
+	Cancel();
+}
+
+void BufferCompressor::Execute() noexcept {
+	try {
+		for (std::string_view text : {documentBefore, documentAfter}) {
+			while (!text.empty() && !Cancelling()) {
+				const size_t lengthBlock = std::min(text.size(), CompressedText::blockSize);
+				compressed.Append(text.substr(0, lengthBlock));
+				IncrementProgress(lengthBlock);
+				text.remove_prefix(lengthBlock);
+			}
+		}
+		compressed.Compact();
+	} catch (...) {
+		failed = true;
+	}
+	SetCompleted();
+	try {
+		pListener->PostOnMainThread(WORK_BUFFERCOMPRESSED, this);
+	} catch (...) {
+		failed = true;
+	}
+}
@@ -35,6 +35,7 @@ public:
 	Scintilla::ILoader *pLoader;
 	size_t readSoFar;
 	UniMode unicodeMode;
+	TextAnalysis analysis;
 
 	FileLoader(WorkerListener *pListener_, Scintilla::ILoader *pLoader_, const FilePath &path_, size_t size_, FILE *fp_);
 	void Execute() noexcept override;
@@ -45,15 +46,23 @@ public:
 };
 
 class FileStorer : public FileWorker {
+	char ByteAt(size_t position) const noexcept;
+	std::string_view Piece(size_t start, size_t length) noexcept;
 public:
-	const char *documentBytes;
+	// The document is the text before Scintilla's gap followed by the text after the gap
+	std::string_view documentBefore;
+	std::string_view documentAfter;
+	FilePath pathTemporary;	///< Written then moved over path when set
 	size_t writtenSoFar;
 	UniMode unicodeMode;
 	bool visibleProgress;
 	std::unique_ptr<Utf8_16::Writer> convert;
+	std::string joined;	///< Holds a block that spans the gap when it must be converted
 
-	FileStorer(WorkerListener *pListener_, std::string_view bytes_, const FilePath &path_,
+	FileStorer(WorkerListener *pListener_, std::string_view before_, std::string_view after_,
+		   const FilePath &path_, const FilePath &pathTemporary_,
 		   FILE *fp_, UniMode unicodeMode_, bool visibleProgress_);
+	void Store() noexcept;
 	void Execute() noexcept override;
 	void Cancel() noexcept override;
 	bool IsLoading() const noexcept override {
@@ -61,10 +70,26 @@ public:
 	}
 };
 
+/// Compresses the text of a hidden buffer which must not change until finished or cancelled.
+class BufferCompressor : public Worker {
+public:
+	WorkerListener *pListener;
+	std::string_view documentBefore;
+	std::string_view documentAfter;
+	CompressedText compressed;
+	bool failed;
+
+	BufferCompressor(WorkerListener *pListener_, std::string_view before_, std::string_view after_) noexcept;
+	// Deleting waits for the compression thread to finish reading the document
+	~BufferCompressor() noexcept override;
+	void Execute() noexcept override;
+};
+
 enum {
 	WORK_FILEREAD = 1,
 	WORK_FILEWRITTEN = 2,
 	WORK_FILEPROGRESS = 3,
+	WORK_BUFFERCOMPRESSED = 4,
 	WORK_PLATFORM = 100
 };
 
@@ -2396,6 +2396,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCE_ZIG_STRING",7},
 	{"SCFIND_CXX11REGEX",0x00800000},
 	{"SCFIND_MATCHCASE",0x4},
+	{"SCFIND_MULTILINE",0x01000000},
 	{"SCFIND_NONE",0x0},
 	{"SCFIND_POSIX",0x00400000},
 	{"SCFIND_REGEXP",0x00200000},
@@ -3071,6 +3072,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SC_ALPHA_OPAQUE",255},
 	{"SC_ALPHA_TRANSPARENT",0},
 	{"SC_AUTOCOMPLETE_FIXED_SIZE",1},
+	{"SC_AUTOCOMPLETE_FUZZY_MATCH",4},
 	{"SC_AUTOCOMPLETE_NORMAL",0},
 	{"SC_AUTOCOMPLETE_SELECT_FIRST_ITEM",2},
 	{"SC_AUTOMATICFOLD_CHANGE",0x0004},
@@ -3480,6 +3482,7 @@ static IFaceFunction ifaceFunctions[] = {
 	{"EndUndoAction", 2079, iface_void, {iface_void, iface_void}},
 	{"EnsureVisible", 2232, iface_void, {iface_line, iface_void}},
 	{"EnsureVisibleEnforcePolicy", 2234, iface_void, {iface_line, iface_void}},
+	{"ExecuteBatch", 2815, iface_position, {iface_position, iface_pointer}},
 	{"ExpandChildren", 2239, iface_void, {iface_line, iface_int}},
 	{"FindColumn", 2456, iface_position, {iface_line, iface_position}},
 	{"FindIndicatorFlash", 2641, iface_void, {iface_position, iface_position}},
@@ -3509,6 +3512,7 @@ static IFaceFunction ifaceFunctions[] = {
 	{"GetNextTabStop", 2677, iface_int, {iface_line, iface_int}},
 	{"GetPropertyInt", 4010, iface_int, {iface_string, iface_int}},
 	{"GetRangePointer", 2643, iface_pointer, {iface_position, iface_position}},
+	{"GetSearchAllRanges", 2817, iface_position, {iface_position, iface_pointer}},
 	{"GetSelText", 2161, iface_position, {iface_void, iface_stringresult}},
 	{"GetStyledText", 2015, iface_position, {iface_void, iface_textrange}},
 	{"GetStyledTextFull", 2778, iface_position, {iface_void, iface_textrangefull}},
@@ -3532,6 +3536,7 @@ static IFaceFunction ifaceFunctions[] = {
 	{"IndicatorClearRange", 2505, iface_void, {iface_position, iface_position}},
 	{"IndicatorEnd", 2509, iface_position, {iface_int, iface_position}},
 	{"IndicatorFillRange", 2504, iface_void, {iface_position, iface_position}},
+	{"IndicatorFillSearchAll", 2818, iface_void, {iface_void, iface_void}},
 	{"IndicatorStart", 2508, iface_position, {iface_int, iface_position}},
 	{"IndicatorValueAt", 2507, iface_int, {iface_int, iface_position}},
 	{"InsertText", 2003, iface_void, {iface_position, iface_string}},
@@ -3634,6 +3639,7 @@ static IFaceFunction ifaceFunctions[] = {
 	{"ScrollRange", 2569, iface_void, {iface_position, iface_position}},
 	{"ScrollToEnd", 2629, iface_void, {iface_void, iface_void}},
 	{"ScrollToStart", 2628, iface_void, {iface_void, iface_void}},
+	{"SearchAllInTarget", 2816, iface_position, {iface_length, iface_string}},
 	{"SearchAnchor", 2366, iface_void, {iface_void, iface_void}},
 	{"SearchInTarget", 2197, iface_position, {iface_length, iface_string}},
 	{"SearchNext", 2367, iface_position, {iface_int, iface_string}},
@@ -3837,6 +3843,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"IndicatorCurrent", 2501, 2500, iface_int, iface_void},
 	{"IndicatorValue", 2503, 2502, iface_int, iface_void},
 	{"KeyWords", 0, 4005, iface_string, iface_int},
+	{"LayoutAllocations", 2819, 0, iface_position, iface_void},
 	{"LayoutCache", 2273, 2272, iface_int, iface_void},
 	{"LayoutThreads", 2776, 2775, iface_int, iface_void},
 	{"Length", 2006, 0, iface_position, iface_void},
@@ -4000,9 +4007,9 @@ static IFaceProperty ifaceProperties[] = {
 };
 
 enum {
-	ifaceFunctionCount = 333,
-	ifaceConstantCount = 3252,
-	ifacePropertyCount = 278
+	ifaceFunctionCount = 337,
+	ifaceConstantCount = 3254,
+	ifacePropertyCount = 279
 };
 
 //--Autogenerated
@@ -15,12 +15,14 @@
 #include <string_view>
 #include <vector>
 #include <set>
+#include <algorithm>
 #include <memory>
 #include <chrono>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
 #include "ScintillaCall.h"
+#include "ScintillaStructures.h"
 
 #include "GUI.h"
 #include "StringHelpers.h"
@@ -230,6 +232,36 @@ void *checkudata(lua_State *L, int ud, const char *tname) noexcept {
 	return nullptr;
 }
 
+// Find the function or property accessor for a message number.
+// Functions are indexed by message number on first use as this is needed for each batched message.
+IFaceFunction FunctionFromMessage(int message) {
+	static std::vector<IFaceFunction> byMessage;
+	if (byMessage.empty()) {
+		for (int funcIdx = 0; funcIdx < IFaceTable::functionCount; ++funcIdx) {
+			byMessage.push_back(IFaceTable::functions[funcIdx]);
+		}
+		for (int propIdx = 0; propIdx < IFaceTable::propertyCount; ++propIdx) {
+			if (IFaceTable::properties[propIdx].getter) {
+				byMessage.push_back(IFaceTable::properties[propIdx].GetterFunction());
+			}
+			if (IFaceTable::properties[propIdx].setter) {
+				byMessage.push_back(IFaceTable::properties[propIdx].SetterFunction());
+			}
+		}
+		// Stable so functions are found before property accessors with the same message
+		std::stable_sort(byMessage.begin(), byMessage.end(), [](const IFaceFunction &a, const IFaceFunction &b) noexcept {
+			return a.value < b.value;
+		});
+	}
+	const auto it = std::lower_bound(byMessage.begin(), byMessage.end(), message, [](const IFaceFunction &f, int value) noexcept {
+		return f.value < value;
+	});
+	if ((it != byMessage.end()) && (it->value == message)) {
+		return *it;
+	}
+	return IFaceFunction{ "", 0, iface_void, {iface_void, iface_void} };
+}
+
 int cf_scite_send(lua_State *L) {
 	// This is reinstated as a replacement for the old <pane>:send, which was removed
 	// due to safety concerns.  Is now exposed as scite.SendEditor / scite.SendOutput.
@@ -243,25 +275,7 @@ int cf_scite_send(lua_State *L) {
 	lua_pushvalue(L, paneIndex);
 	lua_replace(L, 1);
 
-	IFaceFunction func = { "", 0, iface_void, {iface_void, iface_void} };
-	for (int funcIdx = 0; funcIdx < IFaceTable::functionCount; ++funcIdx) {
-		if (IFaceTable::functions[funcIdx].value == message) {
-			func = IFaceTable::functions[funcIdx];
-			break;
-		}
-	}
-
-	if (func.value == 0) {
-		for (int propIdx = 0; propIdx < IFaceTable::propertyCount; ++propIdx) {
-			if (IFaceTable::properties[propIdx].getter == message) {
-				func = IFaceTable::properties[propIdx].GetterFunction();
-				break;
-			} else if (IFaceTable::properties[propIdx].setter == message) {
-				func = IFaceTable::properties[propIdx].SetterFunction();
-				break;
-			}
-		}
-	}
+	const IFaceFunction func = FunctionFromMessage(message);
 
 	if (func.value != 0) {
 		if (IFaceFunctionIsScriptable(func)) {
@@ -676,6 +690,147 @@ int cf_pane_match_generator(lua_State *L) {
 	return 1;
 }
 
+// Pane batch object.  Collects (message, wParam, lParam) records in a Lua table so
+// string arguments stay alive, then sends them all with one SCI_EXECUTEBATCH call.
+// Record i is stored at indices 3*i-2 (message), 3*i-1 (wParam) and 3*i (lParam).
+
+int cf_batch_add(lua_State *L) {
+	luaL_checktype(L, 1, LUA_TTABLE);
+	const int message = luaL_checkint(L, 2);
+	if ((lua_type(L, 3) == LUA_TSTRING) && lua_isnone(L, 4)) {
+		// batch:add(message, text) for functions with just a string argument
+		lua_pushnil(L);
+		lua_insert(L, 3);
+	}
+	const IFaceFunction func = FunctionFromMessage(message);
+	if (func.value == 0) {
+		raise_error(L, "Message number does not match any published Scintilla function or property");
+		return 0;
+	}
+	// Pointer arguments would allow scripts to read and write any memory
+	if (!IFaceFunctionIsScriptable(func) ||
+		(func.paramType[0] == iface_pointer) || (func.paramType[1] == iface_pointer) ||
+		(func.paramType[0] == iface_keymod) || (func.paramType[1] == iface_stringresult) ||
+		((func.paramType[1] == iface_string) && (lua_type(L, 4) != LUA_TSTRING) && !lua_isnoneornil(L, 4))) {
+		raise_error(L, "Cannot batch this function: only numeric, boolean and string arguments are supported.");
+		return 0;
+	}
+
+	const int count = static_cast<int>(lua_objlen(L, 1));
+	lua_pushinteger(L, message);
+	lua_rawseti(L, 1, count + 1);
+	if ((func.paramType[0] == iface_length) && (lua_type(L, 4) == LUA_TSTRING) && lua_isnoneornil(L, 3)) {
+		// Length of string argument is implied
+		lua_pushinteger(L, lua_strlen(L, 4));
+	} else if (lua_isboolean(L, 3)) {
+		lua_pushinteger(L, lua_toboolean(L, 3));
+	} else {
+		lua_pushinteger(L, luaL_optinteger(L, 3, 0));
+	}
+	lua_rawseti(L, 1, count + 2);
+	if (lua_type(L, 4) == LUA_TSTRING) {
+		lua_pushvalue(L, 4);
+	} else if (lua_isboolean(L, 4)) {
+		lua_pushinteger(L, lua_toboolean(L, 4));
+	} else {
+		lua_pushinteger(L, luaL_optinteger(L, 4, 0));
+	}
+	lua_rawseti(L, 1, count + 3);
+	return 0;
+}
+
+int cf_batch_execute(lua_State *L) {
+	luaL_checktype(L, 1, LUA_TTABLE);
+	const ExtensionAPI::Pane p = check_pane_object(L, 1);
+	const int records = static_cast<int>(lua_objlen(L, 1)) / 3;
+
+	// Use Lua allocated memory so nothing leaks if Lua does a longjmp
+	SA::BatchMessage *messages = static_cast<SA::BatchMessage *>(
+		lua_newuserdata(L, sizeof(SA::BatchMessage) * (records + 1)));
+	intptr_t *results = static_cast<intptr_t *>(lua_newuserdata(L, sizeof(intptr_t) * (records + 1)));
+	for (int i = 0; i < records; i++) {
+		lua_rawgeti(L, 1, i * 3 + 1);
+		lua_rawgeti(L, 1, i * 3 + 2);
+		lua_rawgeti(L, 1, i * 3 + 3);
+		messages[i].message = static_cast<unsigned int>(lua_tointeger(L, -3));
+		messages[i].wParam = static_cast<SA::uptr_t>(lua_tointeger(L, -2));
+		if (lua_type(L, -1) == LUA_TSTRING) {
+			// The string is kept alive by the batch table
+			messages[i].lParam = SptrFromString(lua_tostring(L, -1));
+		} else {
+			messages[i].lParam = lua_tointeger(L, -1);
+		}
+		lua_pop(L, 3);
+		results[i] = 0;
+	}
+
+	SA::MessageBatch batch{ messages, results, 0 };
+	if (records > 0) {
+		try {
+			host->Send(p, SA::Message::ExecuteBatch, records, SptrFromPointer(&batch));
+		} catch (const SA::Failure &sf) {
+			// The batch stopped at the failing message and batch.executed counts up to it
+			std::string failureExplanation;
+			failureExplanation += ">Lua: Scintilla failure ";
+			failureExplanation += StdStringFromInteger(static_cast<int>(sf.status));
+			failureExplanation += " in batch.\n";
+			host->PaneCaller(p).SetStatus(SA::Status::Ok);
+			host->Trace(failureExplanation.c_str());
+		}
+	}
+
+	const int executed = static_cast<int>(batch.executed);
+	lua_createtable(L, executed, 0);
+	for (int i = 0; i < executed; i++) {
+		lua_pushinteger(L, results[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_pushinteger(L, executed);
+
+	// Empty the batch so it can be reused
+	for (int i = records * 3; i >= 1; i--) {
+		lua_pushnil(L);
+		lua_rawseti(L, 1, i);
+	}
+	return 2;
+}
+
+int cf_batch_clear(lua_State *L) {
+	luaL_checktype(L, 1, LUA_TTABLE);
+	for (int i = static_cast<int>(lua_objlen(L, 1)); i >= 1; i--) {
+		lua_pushnil(L);
+		lua_rawseti(L, 1, i);
+	}
+	return 0;
+}
+
+int cf_batch_count(lua_State *L) {
+	luaL_checktype(L, 1, LUA_TTABLE);
+	lua_pushinteger(L, lua_objlen(L, 1) / 3);
+	return 1;
+}
+
+int cf_pane_batch(lua_State *L) {
+	check_pane_object(L, 1);
+	lua_newtable(L);
+	lua_pushvalue(L, 1);
+	lua_setfield(L, -2, "pane");
+	if (luaL_newmetatable(L, "SciTE_MT_PaneBatch")) {
+		lua_newtable(L);
+		lua_pushcfunction(L, cf_batch_add);
+		lua_setfield(L, -2, "add");
+		lua_pushcfunction(L, cf_batch_execute);
+		lua_setfield(L, -2, "execute");
+		lua_pushcfunction(L, cf_batch_clear);
+		lua_setfield(L, -2, "clear");
+		lua_pushcfunction(L, cf_batch_count);
+		lua_setfield(L, -2, "count");
+		lua_setfield(L, -2, "__index");
+	}
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
 int cf_props_metatable_index(lua_State *L) {
 	const int selfArg = lua_isuserdata(L, 1) ? 1 : 0;
 
@@ -891,7 +1046,10 @@ int iface_function_helper(lua_State *L, const IFaceFunction &func) {
 
 	intptr_t params[2] = {0, 0};
 
-	std::string stringResult;
+	// String results are written directly into a Lua buffer which is freed by
+	// Lua so it won't leak if Lua does a longjmp.
+	luaL_Buffer stringResult {};
+	intptr_t stringResultLen = 0;
 	bool needStringResult = false;
 
 	int loopParamCount = 2;
@@ -902,8 +1060,7 @@ int iface_function_helper(lua_State *L, const IFaceFunction &func) {
 		loopParamCount = 0;
 	} else if ((func.paramType[1] == iface_stringresult) || (func.returnType == iface_stringresult)) {
 		needStringResult = true;
-		// The buffer will be allocated later, so it won't leak if Lua does
-		// a longjmp in response to a bad arg.
+		// The buffer will be allocated after the arguments are checked.
 		if (func.paramType[0] == iface_length) {
 			loopParamCount = 0;
 		} else {
@@ -928,9 +1085,11 @@ int iface_function_helper(lua_State *L, const IFaceFunction &func) {
 	}
 
 	if (needStringResult) {
-		const intptr_t stringResultLen = host->Send(p, static_cast<SA::Message>(func.value), params[0], 0);
-		stringResult.assign(stringResultLen, '\0');
-		params[1] = SptrFromPointer(stringResult.data());
+		stringResultLen = host->Send(p, static_cast<SA::Message>(func.value), params[0], 0);
+		// Allow for a terminating NUL which some messages write
+		char *buffer = luaL_buffinitsize(L, &stringResult, stringResultLen + 1);
+		buffer[0] = '\0';
+		params[1] = SptrFromPointer(buffer);
 		if (func.paramType[0] == iface_length) {
 			params[0] = stringResultLen;
 		}
@@ -959,7 +1118,7 @@ int iface_function_helper(lua_State *L, const IFaceFunction &func) {
 	int resultCount = 0;
 
 	if (needStringResult) {
-		push_string(L, stringResult);
+		luaL_pushresultsize(&stringResult, stringResultLen);
 		resultCount++;
 	}
 
@@ -1031,105 +1190,97 @@ int cf_pane_iface_function(lua_State *L) {
 	}
 }
 
-int push_iface_function(lua_State *L, const char *name) {
-	int i = IFaceTable::FindFunction(name);
-	if (i >= 0) {
-		if (IFaceFunctionIsScriptable(IFaceTable::functions[i])) {
-			lua_pushlightuserdata(L, const_cast<IFaceFunction *>(IFaceTable::functions+i));
-			lua_pushcclosure(L, cf_pane_iface_function, 1);
-
-			// Since Lua experts say it is inefficient to create closures / cfunctions
-			// in an inner loop, I tried caching the closures in the metatable, and looking
-			// for them there first.  However, it made very little difference and did not
-			// seem worth the added complexity. - WBD
+int push_iface_propval(lua_State *L, const IFaceProperty &prop) {
+	// this function returns -1 if the property can not be read.
 
-			return 1;
-		}
+	if (!IFacePropertyIsScriptable(prop)) {
+		raise_error(L, "Error: iface property is not scriptable.");
+		return -1;
 	}
-	return -1; // signal to try next pane index handler
-}
-
-int push_iface_propval(lua_State *L, const char *name) {
-	// this function doesn't raise errors, but returns 0 if the function is not handled.
 
-	const int propidx = IFaceTable::FindProperty(name);
-	if (propidx >= 0) {
-		const IFaceProperty &prop = IFaceTable::properties[propidx];
-		if (!IFacePropertyIsScriptable(prop)) {
-			raise_error(L, "Error: iface property is not scriptable.");
-			return -1;
+	if (prop.paramType == iface_void) {
+		if (prop.getter) {
+			lua_settop(L, 1);
+			return iface_function_helper(L, prop.GetterFunction());
 		}
+	} else if (prop.paramType == iface_bool) {
+		// The bool getter is untested since there are none in the iface.
+		// However, the following is suggested as a reference protocol.
+		const ExtensionAPI::Pane p = check_pane_object(L, 1);
 
-		if (prop.paramType == iface_void) {
-			if (prop.getter) {
+		if (prop.getter) {
+			if (host->Send(p, static_cast<SA::Message>(prop.getter), 1, 0)) {
+				lua_pushnil(L);
+				return 1;
+			} else {
 				lua_settop(L, 1);
+				lua_pushboolean(L, 0);
 				return iface_function_helper(L, prop.GetterFunction());
 			}
-		} else if (prop.paramType == iface_bool) {
-			// The bool getter is untested since there are none in the iface.
-			// However, the following is suggested as a reference protocol.
-			const ExtensionAPI::Pane p = check_pane_object(L, 1);
-
-			if (prop.getter) {
-				if (host->Send(p, static_cast<SA::Message>(prop.getter), 1, 0)) {
-					lua_pushnil(L);
-					return 1;
-				} else {
-					lua_settop(L, 1);
-					lua_pushboolean(L, 0);
-					return iface_function_helper(L, prop.GetterFunction());
-				}
+		}
+	} else {
+		// Indexed property.  These return an object with the following behaviour:
+		// if there is a getter, __index calls it
+		// otherwise, __index raises "property 'name' is write-only".
+		// if there is a setter, __newindex calls it
+		// otherwise, __newindex raises "property 'name' is read-only"
+
+		IFacePropertyBinding *ipb = static_cast<IFacePropertyBinding *>(lua_newuserdata(L, sizeof(IFacePropertyBinding)));
+		if (ipb) {
+			ipb->pane = check_pane_object(L, 1);
+			ipb->prop = &prop;
+			if (luaL_newmetatable(L, "SciTE_MT_IFacePropertyBinding")) {
+				lua_pushliteral(L, "__index");
+				lua_pushcfunction(L, cf_ifaceprop_metatable_index);
+				lua_settable(L, -3);
+				lua_pushliteral(L, "__newindex");
+				lua_pushcfunction(L, cf_ifaceprop_metatable_newindex);
+				lua_settable(L, -3);
 			}
+			lua_setmetatable(L, -2);
+			return 1;
 		} else {
-			// Indexed property.  These return an object with the following behaviour:
-			// if there is a getter, __index calls it
-			// otherwise, __index raises "property 'name' is write-only".
-			// if there is a setter, __newindex calls it
-			// otherwise, __newindex raises "property 'name' is read-only"
-
-			IFacePropertyBinding *ipb = static_cast<IFacePropertyBinding *>(lua_newuserdata(L, sizeof(IFacePropertyBinding)));
-			if (ipb) {
-				ipb->pane = check_pane_object(L, 1);
-				ipb->prop = &prop;
-				if (luaL_newmetatable(L, "SciTE_MT_IFacePropertyBinding")) {
-					lua_pushliteral(L, "__index");
-					lua_pushcfunction(L, cf_ifaceprop_metatable_index);
-					lua_settable(L, -3);
-					lua_pushliteral(L, "__newindex");
-					lua_pushcfunction(L, cf_ifaceprop_metatable_newindex);
-					lua_settable(L, -3);
-				}
-				lua_setmetatable(L, -2);
-				return 1;
-			} else {
-				raise_error(L, "Internal error: failed to allocate userdata for indexed property");
-				return -1;
-			}
+			raise_error(L, "Internal error: failed to allocate userdata for indexed property");
+			return -1;
 		}
 	}
 
-	return -1; // signal to try next pane index handler
+	return -1;
+}
+
+const IFaceProperty *pane_property(lua_State *L, int index) noexcept {
+	// Properties are held in a table, shared by the __index and __newindex
+	// closures as their upvalue, that maps names to IFaceProperty.
+	lua_pushvalue(L, index);
+	lua_rawget(L, lua_upvalueindex(1));
+	const IFaceProperty *prop = static_cast<const IFaceProperty *>(lua_touserdata(L, -1));
+	lua_pop(L, 1);
+	return prop;
 }
 
 int cf_pane_metatable_index(lua_State *L) {
 	if (lua_isstring(L, 2)) {
 		const char *name = lua_tostring(L, 2);
 
-		// these return the number of values pushed (possibly 0), or -1 if no match
-		int results = push_iface_function(L, name);
-		if (results < 0)
-			results = push_iface_propval(L, name);
-
-		if (results >= 0) {
-			return results;
-		} else if (name[0] != '_') {
+		// Iface functions and built-in functions are closures in the metatable.
+		if (name[0] != '_') {
 			lua_getmetatable(L, 1);
 			if (lua_istable(L, -1)) {
 				lua_pushvalue(L, 2);
-				lua_gettable(L, -2);
+				lua_rawget(L, -2);
 				if (!lua_isnil(L, -1))
 					return 1;
 			}
+			lua_settop(L, 2);
+		}
+
+		const IFaceProperty *prop = pane_property(L, 2);
+		if (prop) {
+			// returns the number of values pushed (possibly 0), or -1 if not readable
+			const int results = push_iface_propval(L, *prop);
+			if (results >= 0) {
+				return results;
+			}
 		}
 	}
 
@@ -1139,9 +1290,9 @@ int cf_pane_metatable_index(lua_State *L) {
 
 int cf_pane_metatable_newindex(lua_State *L) {
 	if (lua_isstring(L, 2)) {
-		const int propidx = IFaceTable::FindProperty(lua_tostring(L, 2));
-		if (propidx >= 0) {
-			const IFaceProperty &prop = IFaceTable::properties[propidx];
+		const IFaceProperty *pprop = pane_property(L, 2);
+		if (pprop) {
+			const IFaceProperty &prop = *pprop;
 			if (IFacePropertyIsScriptable(prop)) {
 				if (prop.setter) {
 					// stack needs to be rearranged to look like an iface function call
@@ -1178,14 +1329,31 @@ int cf_pane_metatable_newindex(lua_State *L) {
 void push_pane_object(lua_State *L, ExtensionAPI::Pane p) noexcept {
 	*static_cast<ExtensionAPI::Pane *>(lua_newuserdata(L, sizeof(p))) = p;
 	if (luaL_newmetatable(L, "SciTE_MT_Pane")) {
-		lua_pushcfunction(L, cf_pane_metatable_index);
-		lua_setfield(L, -2, "__index");
-		lua_pushcfunction(L, cf_pane_metatable_newindex);
+		// Build the name tables once so that each access from Lua is a table
+		// lookup instead of a search of IFaceTable.
+		lua_createtable(L, 0, IFaceTable::propertyCount);
+		for (int i = 0; i < IFaceTable::propertyCount; i++) {
+			lua_pushlightuserdata(L, const_cast<IFaceProperty *>(IFaceTable::properties + i));
+			lua_setfield(L, -2, IFaceTable::properties[i].name);
+		}
+		lua_pushvalue(L, -1);
+		lua_pushcclosure(L, cf_pane_metatable_index, 1);
+		lua_setfield(L, -3, "__index");
+		lua_pushcclosure(L, cf_pane_metatable_newindex, 1);
 		lua_setfield(L, -2, "__newindex");
 
-		// Push built-in functions into the metatable, where the custom
+		// Push iface and built-in functions into the metatable, where the custom
 		// __index metamethod will find them.
 
+		for (int i = 0; i < IFaceTable::functionCount; i++) {
+			const IFaceFunction *func = IFaceTable::functions + i;
+			if (IFaceFunctionIsScriptable(*func)) {
+				lua_pushlightuserdata(L, const_cast<IFaceFunction *>(func));
+				lua_pushcclosure(L, cf_pane_iface_function, 1);
+				lua_setfield(L, -2, func->name);
+			}
+		}
+
 		lua_pushcfunction(L, cf_pane_findtext);
 		lua_setfield(L, -2, "findtext");
 		lua_pushcfunction(L, cf_pane_textrange);
@@ -1196,6 +1364,8 @@ void push_pane_object(lua_State *L, ExtensionAPI::Pane p) noexcept {
 		lua_setfield(L, -2, "remove");
 		lua_pushcfunction(L, cf_pane_append);
 		lua_setfield(L, -2, "append");
+		lua_pushcfunction(L, cf_pane_batch);
+		lua_setfield(L, -2, "batch");
 
 		lua_pushcfunction(L, cf_pane_match_generator);
 		lua_pushcclosure(L, cf_pane_match, 1);
@@ -2011,6 +2181,71 @@ struct StylingContext {
 		return 1;
 	}
 
+	// Run-oriented calls that let a script examine a whole range or line as one string
+	// and apply the resulting styles with one message instead of stepping per character.
+
+	static int Text(lua_State *L) {
+		StylingContext *context = Context(L);
+		SA::Span range(context->startPos, context->startPos + context->lengthDoc);
+		if (lua_gettop(L) >= 3) {
+			range.start = luaL_checkinteger(L, 2);
+			range.end = range.start + luaL_checkinteger(L, 3);
+		}
+		push_string(L, context->styler->Text(range));
+		return 1;
+	}
+
+	static int LineText(lua_State *L) {
+		StylingContext *context = Context(L);
+		const SA::Line line = luaL_checkinteger(L, 2);
+		const SA::Span range(context->styler->LineStart(line), context->styler->LineStart(line + 1));
+		push_string(L, context->styler->Text(range));
+		return 1;
+	}
+
+	static int SetStyles(lua_State *L) {
+		StylingContext *context = Context(L);
+		const SA::Position start = luaL_checkinteger(L, 2);
+		std::string styles;
+		if (lua_type(L, 3) == LUA_TSTRING) {
+			// One style byte per document byte
+			size_t length = 0;
+			const char *s = lua_tolstring(L, 3, &length);
+			styles.assign(s, length);
+		} else {
+			// Table of alternating run lengths and styles: {length1, style1, length2, style2, ...}
+			luaL_checktype(L, 3, LUA_TTABLE);
+			const int items = static_cast<int>(lua_objlen(L, 3));
+			// Validate before allocating so the buffer won't leak if Lua does a longjmp in response to a bad run.
+			SA::Position total = 0;
+			for (int i = 1; i < items; i += 2) {
+				lua_rawgeti(L, 3, i);
+				lua_rawgeti(L, 3, i + 1);
+				const SA::Position length = luaL_checkinteger(L, -2);
+				luaL_checkinteger(L, -1);
+				lua_pop(L, 2);
+				if (length > 0)
+					total += length;
+			}
+			styles.reserve(total);
+			for (int i = 1; i < items; i += 2) {
+				lua_rawgeti(L, 3, i);
+				lua_rawgeti(L, 3, i + 1);
+				const SA::Position length = lua_tointeger(L, -2);
+				const int style = static_cast<int>(lua_tointeger(L, -1));
+				lua_pop(L, 2);
+				if (length > 0)
+					styles.append(length, static_cast<char>(style));
+			}
+		}
+		// Styles already coloured are written from the previous styling position
+		context->styler->Flush();
+		context->styler->StartAt(start);
+		context->styler->StartSegment(start);
+		context->styler->SetStyles(styles.length(), styles.data());
+		return 0;
+	}
+
 	void PushMethod(lua_State *L, lua_CFunction fn, const char *name) noexcept {
 		lua_pushlightuserdata(L, this);
 		lua_pushcclosure(L, fn, 1);
@@ -2018,19 +2253,75 @@ struct StylingContext {
 	}
 };
 
+namespace {
+
+// The styler table passed to OnStyle and its method closures are created once and kept in
+// the registry. Their closures refer to this context so only the fields change between calls.
+StylingContext stylingContext {};
+bool stylingContextBusy = false;
+
+void PushStylingMethods(lua_State *L, StylingContext &sc) {
+	lua_newtable(L);
+
+	sc.PushMethod(L, StylingContext::Line, "Line");
+	sc.PushMethod(L, StylingContext::CharAt, "CharAt");
+	sc.PushMethod(L, StylingContext::StyleAt, "StyleAt");
+	sc.PushMethod(L, StylingContext::LevelAt, "LevelAt");
+	sc.PushMethod(L, StylingContext::SetLevelAt, "SetLevelAt");
+	sc.PushMethod(L, StylingContext::LineState, "LineState");
+	sc.PushMethod(L, StylingContext::SetLineState, "SetLineState");
+
+	sc.PushMethod(L, StylingContext::StartStyling, "StartStyling");
+	sc.PushMethod(L, StylingContext::EndStyling, "EndStyling");
+	sc.PushMethod(L, StylingContext::More, "More");
+	sc.PushMethod(L, StylingContext::Forward, "Forward");
+	sc.PushMethod(L, StylingContext::Position, "Position");
+	sc.PushMethod(L, StylingContext::AtLineStart, "AtLineStart");
+	sc.PushMethod(L, StylingContext::AtLineEnd, "AtLineEnd");
+	sc.PushMethod(L, StylingContext::State, "State");
+	sc.PushMethod(L, StylingContext::SetState, "SetState");
+	sc.PushMethod(L, StylingContext::ForwardSetState, "ForwardSetState");
+	sc.PushMethod(L, StylingContext::ChangeState, "ChangeState");
+	sc.PushMethod(L, StylingContext::Current, "Current");
+	sc.PushMethod(L, StylingContext::Next, "Next");
+	sc.PushMethod(L, StylingContext::Previous, "Previous");
+	sc.PushMethod(L, StylingContext::Token, "Token");
+	sc.PushMethod(L, StylingContext::Match, "Match");
+
+	sc.PushMethod(L, StylingContext::Text, "Text");
+	sc.PushMethod(L, StylingContext::LineText, "LineText");
+	sc.PushMethod(L, StylingContext::SetStyles, "SetStyles");
+}
+
+}
+
 bool LuaExtension::OnStyle(SA::Position startPos, SA::Position lengthDoc, int initStyle, StyleWriter *styler) {
 	bool handled = false;
 	if (luaState) {
 		if (lua_getglobal(luaState, "OnStyle") != LUA_TNIL) {
 
-			StylingContext sc {};
+			// A nested call, perhaps from a script forcing styling, gets its own context.
+			StylingContext nestedContext {};
+			const bool useCached = !stylingContextBusy;
+			StylingContext &sc = useCached ? stylingContext : nestedContext;
+			sc = StylingContext {};
 			sc.startPos = startPos;
 			sc.lengthDoc = lengthDoc;
 			sc.initStyle = initStyle;
 			sc.styler = styler;
 			sc.codePage = host->PaneCaller(ExtensionAPI::paneEditor).CodePage();
 
-			lua_newtable(luaState);
+			if (useCached) {
+				lua_getfield(luaState, LUA_REGISTRYINDEX, "SciTE_StylingContext");
+				if (!lua_istable(luaState, -1)) {
+					lua_pop(luaState, 1);
+					PushStylingMethods(luaState, sc);
+					lua_pushvalue(luaState, -1);
+					lua_setfield(luaState, LUA_REGISTRYINDEX, "SciTE_StylingContext");
+				}
+			} else {
+				PushStylingMethods(luaState, sc);
+			}
 
 			lua_pushstring(luaState, "startPos");
 			lua_pushinteger(luaState, startPos);
@@ -2049,32 +2340,10 @@ bool LuaExtension::OnStyle(SA::Position startPos, SA::Position lengthDoc, int in
 			push_string(luaState, lang);
 			lua_settable(luaState, -3);
 
-			sc.PushMethod(luaState, StylingContext::Line, "Line");
-			sc.PushMethod(luaState, StylingContext::CharAt, "CharAt");
-			sc.PushMethod(luaState, StylingContext::StyleAt, "StyleAt");
-			sc.PushMethod(luaState, StylingContext::LevelAt, "LevelAt");
-			sc.PushMethod(luaState, StylingContext::SetLevelAt, "SetLevelAt");
-			sc.PushMethod(luaState, StylingContext::LineState, "LineState");
-			sc.PushMethod(luaState, StylingContext::SetLineState, "SetLineState");
-
-			sc.PushMethod(luaState, StylingContext::StartStyling, "StartStyling");
-			sc.PushMethod(luaState, StylingContext::EndStyling, "EndStyling");
-			sc.PushMethod(luaState, StylingContext::More, "More");
-			sc.PushMethod(luaState, StylingContext::Forward, "Forward");
-			sc.PushMethod(luaState, StylingContext::Position, "Position");
-			sc.PushMethod(luaState, StylingContext::AtLineStart, "AtLineStart");
-			sc.PushMethod(luaState, StylingContext::AtLineEnd, "AtLineEnd");
-			sc.PushMethod(luaState, StylingContext::State, "State");
-			sc.PushMethod(luaState, StylingContext::SetState, "SetState");
-			sc.PushMethod(luaState, StylingContext::ForwardSetState, "ForwardSetState");
-			sc.PushMethod(luaState, StylingContext::ChangeState, "ChangeState");
-			sc.PushMethod(luaState, StylingContext::Current, "Current");
-			sc.PushMethod(luaState, StylingContext::Next, "Next");
-			sc.PushMethod(luaState, StylingContext::Previous, "Previous");
-			sc.PushMethod(luaState, StylingContext::Token, "Token");
-			sc.PushMethod(luaState, StylingContext::Match, "Match");
-
+			const bool wasBusy = stylingContextBusy;
+			stylingContextBusy = true;
 			handled = call_function(luaState, 1);
+			stylingContextBusy = wasBusy;
 		} else {
 			lua_pop(luaState, 1);
 		}
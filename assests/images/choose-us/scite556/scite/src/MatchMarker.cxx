@@ -29,21 +29,66 @@ namespace {
 // Limit the search duration to 250 ms. Avoid to freeze editor for huge lines.
 constexpr double maxDuration = 0.25;
 
+// Each step searches as much text as the measured rate of searching allows in stepDuration
+// so that one search call can not run much longer than maxDuration.
+constexpr double stepDuration = maxDuration / 4;
+constexpr SA::Position bytesStepInitial = 0x40000;
+constexpr SA::Position bytesStepMinimum = 0x1000;
+
+LineRange LinesAroundView(SA::ScintillaCall *pSci) {
+	const SA::Line lineEnd = pSci->LineCount();
+	const SA::Line lineStartVisible = pSci->FirstVisibleLine();
+	const SA::Line docLineStartVisible = pSci->DocLineFromVisible(lineStartVisible);
+	const SA::Line linesOnScreen = pSci->LinesOnScreen();
+	constexpr SA::Line surround = 40;
+	LineRange rangePriority(docLineStartVisible - surround, docLineStartVisible + linesOnScreen + surround);
+	if (rangePriority.lineStart < 0)
+		rangePriority.lineStart = 0;
+	if (rangePriority.lineEnd > lineEnd)
+		rangePriority.lineEnd = lineEnd;
+	return rangePriority;
+}
+
+// Add range to covered which is sorted and disjoint and return the parts of range that
+// were not already covered.
+std::vector<LineRange> AddLineRange(std::vector<LineRange> &covered, LineRange range) {
+	std::vector<LineRange> added;
+	if (range.lineStart >= range.lineEnd)
+		return added;
+	SA::Line line = range.lineStart;
+	for (const LineRange &lr : covered) {
+		if (lr.lineEnd > line && lr.lineStart < range.lineEnd) {
+			if (lr.lineStart > line)
+				added.emplace_back(line, lr.lineStart);
+			line = lr.lineEnd;
+		}
+	}
+	if (line < range.lineEnd)
+		added.emplace_back(line, range.lineEnd);
+
+	covered.push_back(range);
+	std::sort(covered.begin(), covered.end(), [](const LineRange &a, const LineRange &b) noexcept {
+		return a.lineStart < b.lineStart;
+	});
+	std::vector<LineRange> merged;
+	for (const LineRange &lr : covered) {
+		if (!merged.empty() && lr.lineStart <= merged.back().lineEnd) {
+			merged.back().lineEnd = std::max(merged.back().lineEnd, lr.lineEnd);
+		} else {
+			merged.push_back(lr);
+		}
+	}
+	covered = merged;
+	return added;
+}
+
 }
 
 std::vector<LineRange> LinesBreak(SA::ScintillaCall *pSci) {
 	std::vector<LineRange> lineRanges;
 	if (pSci) {
 		const SA::Line lineEnd = pSci->LineCount();
-		const SA::Line lineStartVisible = pSci->FirstVisibleLine();
-		const SA::Line docLineStartVisible = pSci->DocLineFromVisible(lineStartVisible);
-		const SA::Line linesOnScreen = pSci->LinesOnScreen();
-		constexpr SA::Line surround = 40;
-		LineRange rangePriority(docLineStartVisible - surround, docLineStartVisible + linesOnScreen + surround);
-		if (rangePriority.lineStart < 0)
-			rangePriority.lineStart = 0;
-		if (rangePriority.lineEnd > lineEnd)
-			rangePriority.lineEnd = lineEnd;
+		const LineRange rangePriority = LinesAroundView(pSci);
 		lineRanges.push_back(rangePriority);
 		if (rangePriority.lineEnd < lineEnd)
 			lineRanges.emplace_back(rangePriority.lineEnd, lineEnd);
@@ -54,7 +99,8 @@ std::vector<LineRange> LinesBreak(SA::ScintillaCall *pSci) {
 }
 
 MatchMarker::MatchMarker() :
-	pSci(nullptr), styleMatch(-1), flagsMatch(static_cast<SA::FindOption>(0)), indicator(0), bookMark(-1) {
+	pSci(nullptr), styleMatch(-1), flagsMatch(static_cast<SA::FindOption>(0)), indicator(0), bookMark(-1),
+	incremental(false), indexValid(false), document(nullptr), bytesStep(bytesStepInitial) {
 }
 
 void MatchMarker::StartMatch(SA::ScintillaCall *pSci_,
@@ -68,12 +114,78 @@ void MatchMarker::StartMatch(SA::ScintillaCall *pSci_,
 	indicator = indicator_;
 	bookMark = bookMark_;
 	showContext = showContext_;
+	incremental = false;
+	indexValid = false;
+	linesSearched.clear();
+	marked.clear();
 	lineRanges = LinesBreak(pSci);
 	matches.clear();
 	// Perform the initial marking immediately to avoid flashing
 	Continue();
 }
 
+// Mark matches around the view now and extend as the view scrolls, remembering each match
+// so that the marks can be removed without clearing the whole document.
+void MatchMarker::StartViewMatch(SA::ScintillaCall *pSci_,
+				 const std::string &textMatch_, SA::FindOption flagsMatch_, int styleMatch_,
+				 int indicator_) {
+	pSci = pSci_;
+	textMatch = textMatch_;
+	flagsMatch = flagsMatch_;
+	styleMatch = styleMatch_;
+	indicator = indicator_;
+	bookMark = -1;
+	showContext = {};
+	incremental = true;
+	indexValid = true;
+	document = pSci->DocPointer();
+	linesSearched.clear();
+	marked.clear();
+	matches.clear();
+	lineRanges = AddLineRange(linesSearched, LinesAroundView(pSci));
+	Continue();
+}
+
+// Is this the current incremental match and are its marks still where they were placed?
+bool MatchMarker::SameMatch(SA::ScintillaCall *pSci_,
+			    const std::string &textMatch_, SA::FindOption flagsMatch_, int styleMatch_) {
+	return incremental && indexValid && pSci && (pSci == pSci_) &&
+		(textMatch == textMatch_) && (flagsMatch == flagsMatch_) && (styleMatch == styleMatch_) &&
+		(document == pSci->DocPointer());
+}
+
+void MatchMarker::ExtendToView() {
+	if (!incremental || !indexValid || !pSci || (document != pSci->DocPointer()))
+		return;
+	const std::vector<LineRange> added = AddLineRange(linesSearched, LinesAroundView(pSci));
+	if (!added.empty()) {
+		lineRanges.insert(lineRanges.begin(), added.begin(), added.end());
+		Continue();
+	}
+}
+
+// Remove the marks of an incremental match. Returns false when the marks are not known
+// so the caller must clear the indicator over the whole document.
+// Once cleared, there are no marks so later calls succeed until the text is modified.
+bool MatchMarker::ClearMarks() {
+	lineRanges.clear();
+	const bool known = indexValid && pSci && (document == pSci->DocPointer());
+	if (known) {
+		pSci->SetIndicatorCurrent(indicator);
+		for (const SA::Span &span : marked) {
+			pSci->IndicatorClearRange(span.start, span.Length());
+		}
+	}
+	incremental = false;
+	linesSearched.clear();
+	marked.clear();
+	return known;
+}
+
+void MatchMarker::TextModified() noexcept {
+	indexValid = false;
+}
+
 bool MatchMarker::Complete() const noexcept {
 	return lineRanges.empty();
 }
@@ -91,6 +203,11 @@ void MatchMarker::Continue() {
 
 	pSci->SetSearchFlags(flagsMatch);
 	const SA::Position positionStart = pSci->LineStart(rangeSearch.lineStart);
+	// Shorten the segment to the text that can be searched in the time allowed for a step
+	// while always searching at least one line.
+	const SA::Line lineEndBudget = pSci->LineFromPosition(positionStart + bytesStep) + 1;
+	if (lineEndSegment > lineEndBudget)
+		lineEndSegment = lineEndBudget;
 	const SA::Position positionEnd = pSci->LineStart(lineEndSegment);
 	pSci->SetTarget(SA::Span(positionStart, positionEnd));
 	pSci->IndicatorClearRange(positionStart, positionEnd - positionStart);
@@ -98,36 +215,47 @@ void MatchMarker::Continue() {
 	//Monitor the amount of time took by the search.
 	GUI::ElapsedTime searchElapsedTime;
 
-	SA::Position matchPrevious = SA::InvalidPosition;
-
-	// Find the first occurrence of word.
-	SA::Span rangeFound = pSci->SpanSearchInTarget(textMatch);
-	while ((rangeFound.start >= 0) && (rangeFound.start != matchPrevious)) {
-		matchPrevious = rangeFound.start;
-		if (searchElapsedTime.Duration() > maxDuration) {
-			// Clear all indicators because timer has expired.
-			pSci->IndicatorClearRange(0, pSci->Length());
-			lineRanges.clear();
-			break;
-		}
-
-		if ((styleMatch < 0) || (styleMatch == pSci->UnsignedStyleAt(rangeFound.start))) {
-			pSci->IndicatorFillRange(rangeFound.start, rangeFound.Length());
-			const SA::Line line = pSci->LineFromPosition(rangeFound.start);
-			if ((bookMark >= 0) && (showContext != 0)) {
-				pSci->MarkerAdd(line, bookMark);
-			}
-			if (showContext >= 0) {
-				matches.insert(line);
+	// Find all the occurrences in one call.
+	const SA::Position countFound = pSci->SearchAllInTarget(textMatch);
+	const double durationSearch = searchElapsedTime.Duration();
+	if (durationSearch > 0) {
+		const double bytesPerSecond = static_cast<double>(positionEnd - positionStart) / durationSearch;
+		// Grow gradually as short durations are imprecise
+		const SA::Position bytesAllowed = static_cast<SA::Position>(std::min(bytesPerSecond * stepDuration, bytesStep * 4.0));
+		bytesStep = std::max(bytesStepMinimum, bytesAllowed);
+	}
+	if (durationSearch > maxDuration) {
+		// Clear all indicators because timer has expired.
+		pSci->IndicatorClearRange(0, pSci->Length());
+		lineRanges.clear();
+		marked.clear();
+		// Do not search again as the view scrolls
+		AddLineRange(linesSearched, LineRange(0, pSci->LineCount()));
+	} else if (countFound > 0) {
+		const bool addMarkers = (bookMark >= 0) && (showContext != 0);
+		const bool collectLines = showContext >= 0;
+		if ((styleMatch < 0) && !addMarkers && !collectLines && !incremental) {
+			pSci->IndicatorFillSearchAll();
+		} else {
+			std::vector<SA::Position> ranges(countFound * 2);
+			pSci->GetSearchAllRanges(countFound, ranges.data());
+			for (SA::Position i = 0; i < countFound; i++) {
+				const SA::Span rangeFound(ranges[i * 2], ranges[i * 2] + ranges[i * 2 + 1]);
+				if ((styleMatch < 0) || (styleMatch == pSci->UnsignedStyleAt(rangeFound.start))) {
+					pSci->IndicatorFillRange(rangeFound.start, rangeFound.Length());
+					if (incremental) {
+						marked.push_back(rangeFound);
+					}
+					const SA::Line line = pSci->LineFromPosition(rangeFound.start);
+					if (addMarkers) {
+						pSci->MarkerAdd(line, bookMark);
+					}
+					if (collectLines) {
+						matches.insert(line);
+					}
+				}
 			}
 		}
-		if (rangeFound.Length() == 0) {
-			// Empty matches are possible for regex
-			rangeFound.end = pSci->PositionAfter(rangeFound.end);
-		}
-		// Try to find next occurrence of word.
-		pSci->SetTarget(SA::Span(rangeFound.end, positionEnd));
-		rangeFound = pSci->SpanSearchInTarget(textMatch);
 	}
 
 	// Retire searched lines
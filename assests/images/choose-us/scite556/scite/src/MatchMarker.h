@@ -26,11 +26,27 @@ class MatchMarker {
 	std::optional<Scintilla::Line> showContext;
 	std::vector<LineRange> lineRanges;
 	std::set<Scintilla::Line> matches;
+	// Incremental matching only searches lines around the view and remembers what it marked
+	bool incremental;
+	bool indexValid;
+	Scintilla::IDocumentEditable *document;
+	std::vector<LineRange> linesSearched;
+	std::vector<Scintilla::Span> marked;
+	// Amount of text searched in each step, adapted to how fast the search runs
+	Scintilla::Position bytesStep;
 public:
 	MatchMarker();	// Not noexcept as std::vector constructor throws
 	void StartMatch(Scintilla::ScintillaCall *pSci_,
 			const std::string &textMatch_, Scintilla::FindOption flagsMatch_, int styleMatch_,
 			int indicator_, int bookMark_, std::optional<Scintilla::Line> showContext_={});
+	void StartViewMatch(Scintilla::ScintillaCall *pSci_,
+			const std::string &textMatch_, Scintilla::FindOption flagsMatch_, int styleMatch_,
+			int indicator_);
+	bool SameMatch(Scintilla::ScintillaCall *pSci_,
+			const std::string &textMatch_, Scintilla::FindOption flagsMatch_, int styleMatch_);
+	void ExtendToView();
+	bool ClearMarks();
+	void TextModified() noexcept;
 	bool Complete() const noexcept;
 	void Continue();
 	void Stop() noexcept;
@@ -8,7 +8,12 @@
 #ifndef PATHMATCH_H
 #define PATHMATCH_H
 
-bool PatternMatch(std::u32string_view pattern, std::u32string_view text) noexcept;
+class CompiledPattern;
+
+std::u32string PreparePattern(std::string pattern);
+std::u32string PreparePath(std::string relPath);
+bool PreparedPathMatch(std::u32string_view patternU32, std::u32string_view relPathU32) noexcept;
+bool PreparedPathMatch(const CompiledPattern &pattern, std::u32string_view relPathU32) noexcept;
 bool PathMatch(std::string pattern, std::string relPath);
 
 #endif
@@ -0,0 +1,552 @@
+// SciTE - Scintilla based Text Editor
+/** @file PatternMatch.cxx
+ ** Match text against wildcard patterns.
+ **/
+// Copyright 2018 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstdint>
+#include <cassert>
+
+#include <tuple>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+
+#include "GUI.h"
+
+#include "StringHelpers.h"
+#include "PatternMatch.h"
+
+namespace {
+
+constexpr int decimalbase = 10;
+// Larger than any int so integers are not compared after overflowing
+constexpr long long integerLimit = 1LL << 32;
+
+int IntFromString(std::u32string_view s) noexcept {
+	if (s.empty()) {
+		return 0;
+	}
+	const bool negate = s.front() == '-';
+	if (negate) {
+		s.remove_prefix(1);
+	}
+	int value = 0;
+	while (!s.empty()) {
+		value = value * decimalbase + s.front() - '0';
+		s.remove_prefix(1);
+	}
+	return negate ? -value : value;
+}
+
+constexpr bool IsDigit(char32_t ch) noexcept {
+	return ch >= '0' && ch <= '9';
+}
+
+// Find the length of the integer, an optional '-' then digits, at the start of text.
+// Returns 0 when there is no integer.
+size_t IntegerAt(std::u32string_view text, long long &value) noexcept {
+	size_t length = 0;
+	const bool negate = !text.empty() && text.front() == '-';
+	if (negate) {
+		length++;
+	}
+	if ((length >= text.size()) || !IsDigit(text[length])) {
+		return 0;
+	}
+	value = 0;
+	while ((length < text.size()) && IsDigit(text[length])) {
+		value = std::min(value * decimalbase + text[length] - '0', integerLimit);
+		length++;
+	}
+	if (negate) {
+		value = -value;
+	}
+	return length;
+}
+
+// Match the rest of a pattern against the rest of text trying every possibility in the same
+// way as CompiledPattern so the two agree.
+bool MatchRest(std::u32string_view pattern, std::u32string_view text) noexcept {
+	if (pattern.empty()) {
+		return text.empty();
+	} else if (pattern.front() == '\\') {
+		pattern.remove_prefix(1);
+		if (pattern.empty()) {
+			// Escape with nothing being escaped
+			return false;
+		}
+		if (text.empty()) {
+			return false;
+		}
+		if (pattern.front() == text.front()) {
+			pattern.remove_prefix(1);
+			text.remove_prefix(1);
+			return MatchRest(pattern, text);
+		}
+		return false;
+	} else if (pattern.front() == '*') {
+		pattern.remove_prefix(1);
+		if (!pattern.empty() && pattern.front() == '*') {
+			pattern.remove_prefix(1);
+			// "**" matches anything including "/"
+			while (!text.empty()) {
+				if (MatchRest(pattern, text)) {
+					return true;
+				}
+				text.remove_prefix(1);
+			}
+		} else {
+			while (!text.empty()) {
+				if (MatchRest(pattern, text)) {
+					return true;
+				}
+				if (text.front() == '/') {
+					// "/" not matched by single "*"
+					return false;
+				}
+				text.remove_prefix(1);
+			}
+		}
+		assert(text.empty());
+		// Consumed whole text with wildcard so match if the rest of the pattern can match nothing
+		return MatchRest(pattern, text);
+	} else if (pattern.front() == '{') {
+		// Before checking for empty text as an empty alternate matches nothing
+		if (pattern.length() < 2) {
+			return false;
+		}
+		const size_t endParen = pattern.find('}');
+		if (endParen == std::u32string_view::npos) {
+			// Malformed {x} pattern
+			return false;
+		}
+		std::u32string_view parenExpression = pattern.substr(1, endParen - 1);
+		const std::u32string_view patternAfter = pattern.substr(endParen + 1);
+		const size_t dotdot = parenExpression.find(U"..");
+		if (dotdot != std::u32string_view::npos) {
+			// Numeric range: {10..20}
+			const std::u32string_view firstRange = parenExpression.substr(0, dotdot);
+			const std::u32string_view lastRange = parenExpression.substr(dotdot+2);
+			if (firstRange.empty() || lastRange.empty()) {
+				// Malformed {s..e} range pattern
+				return false;
+			}
+			// The integer extends to the end of its digits
+			long long value = 0;
+			const size_t length = IntegerAt(text, value);
+			if (!length || (value < IntFromString(firstRange)) || (value > IntFromString(lastRange))) {
+				return false;
+			}
+			return MatchRest(patternAfter, text.substr(length));
+		}
+		// Alternates: {a,b,cd} where each alternate that matches is tried
+		for (bool finalAlt = false; !finalAlt;) {
+			const size_t comma = parenExpression.find(',');
+			finalAlt = comma == std::u32string_view::npos;
+			const std::u32string_view oneAlt = parenExpression.substr(0, comma);
+			parenExpression.remove_prefix(finalAlt ? parenExpression.length() : comma + 1);
+			if ((oneAlt == text.substr(0, oneAlt.length())) &&
+				MatchRest(patternAfter, text.substr(oneAlt.length()))) {
+				return true;
+			}
+		}
+		return false;
+	} else if (text.empty()) {
+		return false;
+	} else if (pattern.front() == '?') {
+		if (text.front() == '/') {
+			return false;
+		}
+		pattern.remove_prefix(1);
+		text.remove_prefix(1);
+		return MatchRest(pattern, text);
+	} else if (pattern.front() == '[') {
+		pattern.remove_prefix(1);
+		if (pattern.empty()) {
+			return false;
+		}
+		const bool positive = pattern.front() != '!';
+		if (!positive) {
+			pattern.remove_prefix(1);
+			if (pattern.empty()) {
+				return false;
+			}
+		}
+		bool inSet = false;
+		if (!pattern.empty() && pattern.front() == ']') {
+			// First is allowed to be ']'
+			if (pattern.front() == text.front()) {
+				inSet = true;
+			}
+			pattern.remove_prefix(1);
+		}
+		char32_t start = 0;
+		while (!pattern.empty() && pattern.front() != ']') {
+			if (pattern.front() == '-') {
+				pattern.remove_prefix(1);
+				if (!pattern.empty()) {
+					const char32_t end = pattern.front();
+					if ((text.front() >= start) && (text.front() <= end)) {
+						inSet = true;
+					}
+				}
+			} else if (pattern.front() == text.front()) {
+				inSet = true;
+			}
+			if (!pattern.empty()) {
+				start = pattern.front();
+				pattern.remove_prefix(1);
+			}
+		}
+		if (!pattern.empty()) {
+			pattern.remove_prefix(1);
+		}
+		if (inSet != positive) {
+			return false;
+		}
+		text.remove_prefix(1);
+		return MatchRest(pattern, text);
+	} else if (pattern.front() == text.front()) {
+		pattern.remove_prefix(1);
+		text.remove_prefix(1);
+		return MatchRest(pattern, text);
+	}
+	return false;
+}
+
+}
+
+bool PatternMatch(std::u32string_view pattern, std::u32string_view text) noexcept {
+	// Any text is matched by itself
+	return (pattern == text) || MatchRest(pattern, text);
+}
+
+namespace {
+
+constexpr uint64_t Bit(size_t position) noexcept {
+	return (position < 64) ? (1ULL << position) : 0;
+}
+
+}
+
+// The automaton is built with the Glushkov construction: each element of the pattern adds
+// positions and links the positions that may end the pattern so far to those that may start
+// the element. Stars link back to themselves so consume any number of characters.
+// Alternates of {a,b} are literal so every alternate is a chain of literal positions.
+// Patterns that can not match, such as an unterminated "{", are marked impossible.
+
+CompiledPattern::CompiledPattern(std::u32string_view pattern_) : pattern(pattern_) {
+	// Positions that may have consumed the last character of text matched so far
+	Mask lastSoFar = 0;
+	bool emptySoFar = true;
+	auto addElement = [&](Mask firstElement, Mask lastElement, bool emptyElement) {
+		for (size_t p = 0; p < positions.size(); p++) {
+			if (lastSoFar & Bit(p)) {
+				positions[p].follow |= firstElement;
+			}
+		}
+		if (emptySoFar) {
+			initial |= firstElement;
+		}
+		lastSoFar = lastElement | (emptyElement ? lastSoFar : 0);
+		emptySoFar = emptySoFar && emptyElement;
+	};
+	auto addPosition = [&](const Position &position) {
+		positions.push_back(position);
+		return Bit(positions.size() - 1);
+	};
+	auto addSingle = [&](const Position &position) {
+		const Mask bit = addPosition(position);
+		addElement(bit, bit, false);
+	};
+
+	std::u32string_view rest = pattern;
+	while (!rest.empty() && !impossible) {
+		const char32_t ch = rest.front();
+		rest.remove_prefix(1);
+		if (ch == '\\') {
+			if (rest.empty()) {
+				// Escape with nothing being escaped
+				impossible = true;
+			} else {
+				addSingle({Kind::literal, true, rest.front()});
+				rest.remove_prefix(1);
+			}
+		} else if (ch == '*') {
+			Position star{Kind::star};
+			if (!rest.empty() && rest.front() == '*') {
+				// "**" matches anything including "/"
+				star.kind = Kind::starStar;
+				rest.remove_prefix(1);
+			}
+			star.follow = Bit(positions.size());
+			const Mask bit = addPosition(star);
+			addElement(bit, bit, true);
+		} else if (ch == '?') {
+			addSingle({Kind::anyOne});
+		} else if (ch == '[') {
+			if (rest.empty()) {
+				impossible = true;
+				break;
+			}
+			Position set{Kind::set, rest.front() != '!'};
+			if (!set.positive) {
+				rest.remove_prefix(1);
+				if (rest.empty()) {
+					impossible = true;
+					break;
+				}
+			}
+			set.rangesStart = ranges.size();
+			if (rest.front() == ']') {
+				// First is allowed to be ']'
+				ranges.push_back({']', ']'});
+				rest.remove_prefix(1);
+			}
+			char32_t start = 0;
+			while (!rest.empty() && rest.front() != ']') {
+				if (rest.front() == '-') {
+					rest.remove_prefix(1);
+					if (!rest.empty()) {
+						ranges.push_back({start, rest.front()});
+					}
+				} else {
+					ranges.push_back({rest.front(), rest.front()});
+				}
+				if (!rest.empty()) {
+					start = rest.front();
+					rest.remove_prefix(1);
+				}
+			}
+			if (!rest.empty()) {
+				rest.remove_prefix(1);
+			}
+			set.rangesEnd = ranges.size();
+			addSingle(set);
+		} else if (ch == '{') {
+			const size_t endParen = rest.find('}');
+			if (rest.empty() || (endParen == std::u32string_view::npos)) {
+				// Malformed {x} pattern
+				impossible = true;
+				break;
+			}
+			const std::u32string_view parenExpression = rest.substr(0, endParen);
+			rest.remove_prefix(endParen + 1);
+			const size_t dotdot = parenExpression.find(U"..");
+			if (dotdot != std::u32string_view::npos) {
+				// Numeric range: {10..20}
+				const std::u32string_view firstRange = parenExpression.substr(0, dotdot);
+				const std::u32string_view lastRange = parenExpression.substr(dotdot + 2);
+				if (firstRange.empty() || lastRange.empty()) {
+					// Malformed {s..e} range pattern
+					impossible = true;
+					break;
+				}
+				Position integer{Kind::integer};
+				integer.first = IntFromString(firstRange);
+				integer.last = IntFromString(lastRange);
+				addSingle(integer);
+			} else {
+				// Alternates: {a,b,cd}
+				Mask firstElement = 0;
+				Mask lastElement = 0;
+				bool emptyElement = false;
+				std::u32string_view alternates = parenExpression;
+				for (bool finalAlt = false; !finalAlt;) {
+					const size_t comma = alternates.find(',');
+					finalAlt = comma == std::u32string_view::npos;
+					const std::u32string_view alternate = alternates.substr(0, comma);
+					alternates.remove_prefix(finalAlt ? alternates.length() : comma + 1);
+					if (alternate.empty()) {
+						emptyElement = true;
+						continue;
+					}
+					Mask previous = 0;
+					for (const char32_t chAlternate : alternate) {
+						const Mask bit = addPosition({Kind::literal, true, chAlternate});
+						if (previous) {
+							positions[positions.size() - 2].follow |= bit;
+						} else {
+							firstElement |= bit;
+						}
+						previous = bit;
+					}
+					lastElement |= previous;
+				}
+				addElement(firstElement, lastElement, emptyElement);
+			}
+		} else {
+			addSingle({Kind::literal, true, ch});
+		}
+	}
+	final = lastSoFar;
+	matchesEmpty = emptySoFar;
+	compiled = positions.size() <= maxPositions;
+	if (!compiled) {
+		positions.clear();
+		ranges.clear();
+	}
+}
+
+bool CompiledPattern::Accepts(const Position &position, char32_t ch) const noexcept {
+	switch (position.kind) {
+	case Kind::literal:
+		return ch == position.ch;
+	case Kind::anyOne:
+	case Kind::star:
+		return ch != '/';
+	case Kind::starStar:
+		return true;
+	case Kind::set: {
+			bool inSet = false;
+			for (size_t r = position.rangesStart; r < position.rangesEnd; r++) {
+				if ((ch >= ranges[r].start) && (ch <= ranges[r].end)) {
+					inSet = true;
+					break;
+				}
+			}
+			return inSet == position.positive;
+		}
+	case Kind::integer:
+		break;
+	}
+	return false;
+}
+
+bool CompiledPattern::Matches(std::u32string_view text) const noexcept {
+	// As with PatternMatch, any text is matched by itself
+	if (text == pattern) {
+		return true;
+	}
+	if (impossible) {
+		return false;
+	}
+	if (!compiled) {
+		return MatchRest(pattern, text);
+	}
+	Mask current = 0;
+	// An integer consumes several characters so its position is held until the end of the integer.
+	// All integers started inside one run of digits end together so only one end is needed.
+	Mask pending = 0;
+	size_t pendingEnd = 0;
+	for (size_t i = 0; i < text.size(); i++) {
+		Mask candidates = (i == 0) ? initial : 0;
+		for (size_t p = 0; p < positions.size(); p++) {
+			if (current & Bit(p)) {
+				candidates |= positions[p].follow;
+			}
+		}
+		Mask next = 0;
+		for (size_t p = 0; p < positions.size(); p++) {
+			if (!(candidates & Bit(p))) {
+				continue;
+			}
+			const Position &position = positions[p];
+			if (position.kind == Kind::integer) {
+				long long value = 0;
+				const size_t length = IntegerAt(text.substr(i), value);
+				if (length && (value >= position.first) && (value <= position.last)) {
+					assert(!pending || (pendingEnd == i + length));
+					pending |= Bit(p);
+					pendingEnd = i + length;
+				}
+			} else if (Accepts(position, text[i])) {
+				next |= Bit(p);
+			}
+		}
+		if (pending && (pendingEnd == i + 1)) {
+			next |= pending;
+			pending = 0;
+		}
+		current = next;
+		if (!current && !pending) {
+			return false;
+		}
+	}
+	return text.empty() ? matchesEmpty : ((current & final) != 0);
+}
+
+namespace {
+
+bool CharacterMatch(char patternChar, char ch, bool caseSensitive) noexcept {
+	return (patternChar == '?') || (patternChar == ch) ||
+		(!caseSensitive && (MakeUpperCase(patternChar) == MakeUpperCase(ch)));
+}
+
+// Match a segment of a pattern that contains no '*' against the start of text.
+bool SegmentMatch(std::string_view segment, std::string_view text, bool caseSensitive) noexcept {
+	if (segment.length() > text.length()) {
+		return false;
+	}
+	for (size_t i = 0; i < segment.length(); i++) {
+		if (!CharacterMatch(segment[i], text[i], caseSensitive)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+// Match file names to patterns allowing for '*' and '?'.
+// The pattern is treated as a list of segments separated by '*'. The first segment must match
+// at the start of the text and the last at the end. As every '*' matches anything, finding each
+// middle segment as early as possible leaves the most text for the remaining segments.
+
+bool MatchWild(std::string_view pattern, std::string_view text, bool caseSensitive) noexcept {
+	if (caseSensitive ? (pattern == text) : EqualCaseInsensitive(pattern, text)) {
+		return true;
+	}
+	const size_t firstStar = pattern.find('*');
+	if (firstStar == std::string_view::npos) {
+		return (pattern.length() == text.length()) && SegmentMatch(pattern, text, caseSensitive);
+	}
+	const size_t lastStar = pattern.rfind('*');
+	const std::string_view prefix = pattern.substr(0, firstStar);
+	const std::string_view suffix = pattern.substr(lastStar + 1);
+	if (prefix.length() + suffix.length() > text.length()) {
+		return false;
+	}
+	if (!SegmentMatch(prefix, text, caseSensitive) ||
+		!SegmentMatch(suffix, text.substr(text.length() - suffix.length()), caseSensitive)) {
+		return false;
+	}
+	std::string_view middle = pattern.substr(firstStar + 1, lastStar - firstStar);
+	std::string_view remaining = text.substr(prefix.length(), text.length() - prefix.length() - suffix.length());
+	while (!middle.empty()) {
+		const size_t star = middle.find('*');
+		const std::string_view segment = middle.substr(0, star);
+		middle.remove_prefix((star == std::string_view::npos) ? middle.length() : star + 1);
+		if (segment.empty()) {
+			continue;
+		}
+		size_t position = 0;
+		while (!SegmentMatch(segment, remaining.substr(position), caseSensitive)) {
+			if (position + segment.length() >= remaining.length()) {
+				return false;
+			}
+			position++;
+		}
+		remaining.remove_prefix(position + segment.length());
+	}
+	return true;
+}
+
+bool MatchWildSet(std::string_view patternSet, std::string_view text, bool caseSensitive) noexcept {
+	while (!patternSet.empty()) {
+		const size_t sepPos = patternSet.find_first_of(';');
+		const std::string_view pattern = patternSet.substr(0, sepPos);
+		if (MatchWild(pattern, text, caseSensitive)) {
+			return true;
+		}
+		// Move to next
+		patternSet = (sepPos == std::string_view::npos) ? "" : patternSet.substr(sepPos + 1);
+	}
+	return false;
+}
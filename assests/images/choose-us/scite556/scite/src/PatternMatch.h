@@ -0,0 +1,57 @@
+// SciTE - Scintilla based Text Editor
+/** @file PatternMatch.h
+ ** Match text against wildcard patterns.
+ **/
+// Copyright 2018 by Neil Hodgson <neilh@scintilla.org>
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef PATTERNMATCH_H
+#define PATTERNMATCH_H
+
+bool PatternMatch(std::u32string_view pattern, std::u32string_view text) noexcept;
+
+/**
+ * An EditorConfig pattern compiled once into an automaton so that many paths can be matched
+ * in time proportional to the path length without allocating.
+ * Each position of the automaton consumes one character, a set, a wildcard or an integer, and
+ * the text is matched by tracking the set of positions that could have been reached.
+ * Patterns with more positions than fit in a Mask fall back to PatternMatch which follows
+ * the same rules.
+ */
+class CompiledPattern {
+	using Mask = uint64_t;
+	static constexpr size_t maxPositions = 64;
+	enum class Kind { literal, anyOne, set, star, starStar, integer };
+	struct Position {
+		Kind kind = Kind::literal;
+		bool positive = true;
+		char32_t ch = 0;
+		size_t rangesStart = 0;
+		size_t rangesEnd = 0;
+		int first = 0;
+		int last = 0;
+		Mask follow = 0;
+	};
+	struct Range {
+		char32_t start;
+		char32_t end;
+	};
+	std::u32string pattern;
+	std::vector<Position> positions;
+	std::vector<Range> ranges;
+	Mask initial = 0;
+	Mask final = 0;
+	bool matchesEmpty = false;
+	bool impossible = false;
+	bool compiled = false;
+	bool Accepts(const Position &position, char32_t ch) const noexcept;
+public:
+	CompiledPattern() noexcept = default;
+	explicit CompiledPattern(std::u32string_view pattern_);
+	bool Matches(std::u32string_view text) const noexcept;
+};
+
+bool MatchWild(std::string_view pattern, std::string_view text, bool caseSensitive) noexcept;
+bool MatchWildSet(std::string_view patternSet, std::string_view text, bool caseSensitive) noexcept;
+
+#endif
@@ -0,0 +1,177 @@
+// SciTE - Scintilla based Text Editor
+/** @file PreprocessorIndex.cxx
+ ** Index the preprocessor condition lines of a document.
+ **/
+// Copyright 2026 by the Tidy-touch contributors
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "ScintillaTypes.h"
+
+#include "PreprocessorIndex.h"
+
+namespace SA = Scintilla;
+
+void PreprocessorIndex::Invalidate() noexcept {
+	built = false;
+	linked = false;
+	document = nullptr;
+	conditionals.clear();
+}
+
+bool PreprocessorIndex::Valid(const void *document_, std::string_view definition_, SA::Line lineCount_) const noexcept {
+	return built && (document == document_) && (definition == definition_) && (lineCount == lineCount_);
+}
+
+void PreprocessorIndex::Start(const void *document_, std::string_view definition_, SA::Line lineCount_) {
+	Invalidate();
+	built = true;
+	document = document_;
+	definition = definition_;
+	lineCount = lineCount_;
+	dirtyStart = 0;
+	dirtyEnd = 0;
+}
+
+void PreprocessorIndex::Add(SA::Line line, PreProc kind) {
+	conditionals.push_back({ line, kind, 0, 0, 0 });
+	linked = false;
+}
+
+// Index of the first conditional after line.
+size_t PreprocessorIndex::After(SA::Line line) const noexcept {
+	const auto it = std::upper_bound(conditionals.begin(), conditionals.end(), line,
+		[](SA::Line lineFind, const Conditional &conditional) noexcept {
+		return lineFind < conditional.line;
+	});
+	return it - conditionals.begin();
+}
+
+// Text was inserted or deleted on line, adding (or removing if negative) linesAdded lines.
+void PreprocessorIndex::LinesModified(SA::Line line, SA::Line linesAdded) {
+	if (!built)
+		return;
+	if (linesAdded < 0) {
+		// Lines after line up to line-linesAdded were merged into line
+		const auto itFirst = conditionals.begin() + After(line);
+		const auto itLast = conditionals.begin() + After(line - linesAdded);
+		conditionals.erase(itFirst, itLast);
+	}
+	if (linesAdded != 0) {
+		for (size_t i = After(line); i < conditionals.size(); i++) {
+			conditionals[i].line += linesAdded;
+		}
+	}
+	lineCount += linesAdded;
+	if (dirtyStart < dirtyEnd) {
+		if (dirtyStart > line)
+			dirtyStart = std::max(dirtyStart + linesAdded, line);
+		if (dirtyEnd > line)
+			dirtyEnd = std::max(dirtyEnd + linesAdded, line + 1);
+		dirtyStart = std::min(dirtyStart, line);
+		dirtyEnd = std::max(dirtyEnd, line + 1 + std::max<SA::Line>(linesAdded, 0));
+	} else {
+		dirtyStart = line;
+		dirtyEnd = line + 1 + std::max<SA::Line>(linesAdded, 0);
+	}
+	linked = false;
+}
+
+SA::Line PreprocessorIndex::DirtyStart() const noexcept {
+	return dirtyStart;
+}
+
+SA::Line PreprocessorIndex::DirtyEnd() const noexcept {
+	return dirtyEnd;
+}
+
+void PreprocessorIndex::SetLine(SA::Line line, PreProc kind) {
+	const size_t index = After(line);
+	const bool present = (index > 0) && (conditionals[index - 1].line == line);
+	if (present) {
+		if (kind == PreProc::None) {
+			conditionals.erase(conditionals.begin() + index - 1);
+		} else {
+			conditionals[index - 1].kind = kind;
+		}
+	} else if (kind != PreProc::None) {
+		conditionals.insert(conditionals.begin() + index, { line, kind, 0, 0, 0 });
+	}
+	linked = false;
+}
+
+void PreprocessorIndex::Clean() noexcept {
+	dirtyStart = 0;
+	dirtyEnd = 0;
+}
+
+PreProc PreprocessorIndex::KindOfLine(SA::Line line) const noexcept {
+	const size_t index = After(line);
+	if ((index > 0) && (conditionals[index - 1].line == line))
+		return conditionals[index - 1].kind;
+	return PreProc::None;
+}
+
+// Find the nesting of each conditional then, for each conditional, the nearest middle or end
+// at the same nesting searching forward and the nearest start or middle searching backward.
+// These are the conditions that a search for a match starting at that conditional stops at.
+void PreprocessorIndex::Link() {
+	const size_t count = conditionals.size();
+	const int maxDepth = static_cast<int>(count);
+	int depth = 0;
+	for (Conditional &conditional : conditionals) {
+		conditional.depth = depth;
+		if (conditional.kind == PreProc::Start)
+			depth++;
+		else if (conditional.kind == PreProc::End)
+			depth--;
+	}
+	constexpr size_t none = std::numeric_limits<size_t>::max();
+	// Depths range from -count to count so offset by count when indexing
+	std::vector<size_t> nearest(2 * count + 2, none);
+	for (size_t i = 0; i < count; i++) {
+		Conditional &conditional = conditionals[i];
+		const int depthAfter = conditional.depth +
+			((conditional.kind == PreProc::Start) ? 1 : ((conditional.kind == PreProc::End) ? -1 : 0));
+		if (conditional.kind == PreProc::Start || conditional.kind == PreProc::Middle)
+			nearest[depthAfter + maxDepth] = i;
+		conditional.previous = nearest[depthAfter + maxDepth];
+	}
+	std::fill(nearest.begin(), nearest.end(), none);
+	for (size_t i = count; i-- > 0;) {
+		Conditional &conditional = conditionals[i];
+		if (conditional.kind == PreProc::Middle || conditional.kind == PreProc::End)
+			nearest[conditional.depth + maxDepth] = i;
+		conditional.next = nearest[conditional.depth + maxDepth];
+	}
+	linked = true;
+}
+
+// Line of the middle or end condition that matches a search forward from after line or -1.
+SA::Line PreprocessorIndex::Next(SA::Line line) {
+	if (!linked)
+		Link();
+	const size_t index = After(line);
+	if (index >= conditionals.size())
+		return -1;
+	const size_t match = conditionals[index].next;
+	return (match < conditionals.size()) ? conditionals[match].line : -1;
+}
+
+// Line of the start or middle condition that matches a search backward from before line or -1.
+SA::Line PreprocessorIndex::Previous(SA::Line line) {
+	if (!linked)
+		Link();
+	const size_t index = After(line - 1);
+	if (index == 0)
+		return -1;
+	const size_t match = conditionals[index - 1].previous;
+	return (match < conditionals.size()) ? conditionals[match].line : -1;
+}
@@ -0,0 +1,51 @@
+// SciTE - Scintilla based Text Editor
+/** @file PreprocessorIndex.h
+ ** Index the preprocessor condition lines of a document.
+ **/
+// Copyright 2026 by the Tidy-touch contributors
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef PREPROCESSORINDEX_H
+#define PREPROCESSORINDEX_H
+
+enum class PreProc { None, Start, Middle, End, Dummy };	///< Indicate the kind of preprocessor condition line
+
+/**
+ * The preprocessor condition lines of a document with their nesting so that matching
+ * conditions are found without examining each line.
+ * Follows modifications by moving lines and remembering which lines must be examined again.
+ */
+class PreprocessorIndex {
+	struct Conditional {
+		Scintilla::Line line;
+		PreProc kind;
+		int depth;	///< Nesting before this line
+		size_t next;	///< Matching middle or end found searching forward from here
+		size_t previous;	///< Matching start or middle found searching backward from here
+	};
+	std::vector<Conditional> conditionals;
+	bool built = false;
+	bool linked = false;
+	const void *document = nullptr;
+	std::string definition;
+	Scintilla::Line lineCount = 0;
+	Scintilla::Line dirtyStart = 0;	///< Lines from dirtyStart to dirtyEnd must be examined again
+	Scintilla::Line dirtyEnd = 0;
+	size_t After(Scintilla::Line line) const noexcept;
+	void Link();
+public:
+	void Invalidate() noexcept;
+	[[nodiscard]] bool Valid(const void *document_, std::string_view definition_, Scintilla::Line lineCount_) const noexcept;
+	void Start(const void *document_, std::string_view definition_, Scintilla::Line lineCount_);
+	void Add(Scintilla::Line line, PreProc kind);
+	void LinesModified(Scintilla::Line line, Scintilla::Line linesAdded);
+	[[nodiscard]] Scintilla::Line DirtyStart() const noexcept;
+	[[nodiscard]] Scintilla::Line DirtyEnd() const noexcept;
+	void SetLine(Scintilla::Line line, PreProc kind);
+	void Clean() noexcept;
+	[[nodiscard]] PreProc KindOfLine(Scintilla::Line line) const noexcept;
+	Scintilla::Line Next(Scintilla::Line line);
+	Scintilla::Line Previous(Scintilla::Line line);
+};
+
+#endif
@@ -6,6 +6,7 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
@@ -38,6 +39,7 @@
 
 #include "StringHelpers.h"
 #include "FilePath.h"
+#include "PatternMatch.h"
 #include "PathMatch.h"
 #include "PropSetFile.h"
 #include "EditorConfig.h"
@@ -478,66 +480,6 @@ bool PropSetFile::Read(const FilePath &filename, const FilePath &directoryForImp
 	return false;
 }
 
-namespace {
-
-bool StringEqual(std::string_view a, std::string_view b, bool caseSensitive) noexcept {
-	if (caseSensitive) {
-		return a == b;
-	}
-	return EqualCaseInsensitive(a, b);
-}
-
-// Match file names to patterns allowing for '*' and '?'.
-
-bool MatchWild(std::string_view pattern, std::string_view text, bool caseSensitive) {
-	if (StringEqual(pattern, text, caseSensitive)) {
-		return true;
-	} else if (pattern.empty()) {
-		return false;
-	} else if (pattern.front() == '*') {
-		pattern.remove_prefix(1);
-		if (pattern.empty()) {
-			return true;
-		}
-		while (!text.empty()) {
-			if (MatchWild(pattern, text, caseSensitive)) {
-				return true;
-			}
-			text.remove_prefix(1);
-		}
-	} else if (text.empty()) {
-		return false;
-	} else if (pattern.front() == '?') {
-		pattern.remove_prefix(1);
-		text.remove_prefix(1);
-		return MatchWild(pattern, text, caseSensitive);
-	} else if (caseSensitive && pattern.front() == text.front()) {
-		pattern.remove_prefix(1);
-		text.remove_prefix(1);
-		return MatchWild(pattern, text, caseSensitive);
-	} else if (!caseSensitive && MakeUpperCase(pattern.front()) == MakeUpperCase(text.front())) {
-		pattern.remove_prefix(1);
-		text.remove_prefix(1);
-		return MatchWild(pattern, text, caseSensitive);
-	}
-	return false;
-}
-
-bool MatchWildSet(std::string_view patternSet, std::string_view text, bool caseSensitive) {
-	while (!patternSet.empty()) {
-		const size_t sepPos = patternSet.find_first_of(';');
-		const std::string_view pattern = patternSet.substr(0, sepPos);
-		if (MatchWild(pattern, text, caseSensitive)) {
-			return true;
-		}
-		// Move to next
-		patternSet = (sepPos == std::string_view::npos) ? "" : patternSet.substr(sepPos + 1);
-	}
-	return false;
-}
-
-}
-
 std::string_view PropSetFile::GetWildUsingStart(const PropSetFile &psStart, std::string_view keybase, std::string_view filename) const {
 	const PropSetFile *psf = this;
 	while (psf) {
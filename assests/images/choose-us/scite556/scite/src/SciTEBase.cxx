@@ -56,10 +56,12 @@
 #include "JobQueue.h"
 
 #include "Cookie.h"
+#include "Compressor.h"
 #include "Worker.h"
 #include "Utf8_16.h"
 #include "FileWorker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "EditorConfig.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
@@ -202,6 +204,76 @@ UndoBlock::~UndoBlock() noexcept {
 	}
 }
 
+// Record replacing textOld at start with textNew, trimmed to the part that differs.
+void TextEdits::Replace(SA::Position start, std::string_view textOld, std::string_view textNew) {
+	while (!textOld.empty() && !textNew.empty() && (textOld.front() == textNew.front())) {
+		start++;
+		textOld.remove_prefix(1);
+		textNew.remove_prefix(1);
+	}
+	while (!textOld.empty() && !textNew.empty() && (textOld.back() == textNew.back())) {
+		textOld.remove_suffix(1);
+		textNew.remove_suffix(1);
+	}
+	if (textOld.empty() && textNew.empty())
+		return;
+	edits.push_back({ start, static_cast<SA::Position>(textOld.length()), replacements.length(), textNew.length() });
+	replacements.append(textNew);
+}
+
+bool TextEdits::Empty() const noexcept {
+	return edits.empty();
+}
+
+// Perform all the replacements as one undo action. Each replacement is notified so that
+// indexes maintained from modification notifications stay current.
+void TextEdits::Apply(Scintilla::ScintillaCall &sci) const {
+	if (edits.empty())
+		return;
+	UndoBlock ub(sci);
+	// Positions in edits are from before any replacement so track the change in length
+	SA::Position shift = 0;
+	for (const Edit &edit : edits) {
+		const SA::Position start = edit.start + shift;
+		sci.SetTargetRange(start, start + edit.lengthOld);
+		sci.ReplaceTarget(edit.lengthNew, replacements.data() + edit.offsetNew);
+		shift += static_cast<SA::Position>(edit.lengthNew) - edit.lengthOld;
+	}
+}
+
+// Remove the first line from text and return it without its line end.
+std::string_view TakeLine(std::string_view &text, bool unicodeLineEnds) noexcept {
+	size_t end = 0;
+	size_t lengthLineEnd = 0;
+	while (end < text.length()) {
+		const unsigned char ch = text[end];
+		if (ch == '\n') {
+			lengthLineEnd = 1;
+			break;
+		}
+		if (ch == '\r') {
+			lengthLineEnd = ((end + 1 < text.length()) && (text[end + 1] == '\n')) ? 2 : 1;
+			break;
+		}
+		if (unicodeLineEnds && (ch == 0xC2 || ch == 0xE2)) {
+			// NEL is C2 85, LS is E2 80 A8 and PS is E2 80 A9
+			const std::string_view tail = text.substr(end);
+			if (tail.starts_with("\xC2\x85")) {
+				lengthLineEnd = 2;
+				break;
+			}
+			if (tail.starts_with("\xE2\x80\xA8") || tail.starts_with("\xE2\x80\xA9")) {
+				lengthLineEnd = 3;
+				break;
+			}
+		}
+		end++;
+	}
+	const std::string_view line = text.substr(0, end);
+	text.remove_prefix(end + lengthLineEnd);
+	return line;
+}
+
 SciTEBase::SciTEBase(Extension *ext) : apis(true), pwFocussed(&wEditor), extender(ext) {
 	needIdle = false;
 	codePage = 0;
@@ -304,6 +376,7 @@ SciTEBase::SciTEBase(Extension *ext) : apis(true), pwFocussed(&wEditor), extende
 
 	timerMask = 0;
 	delayBeforeAutoSave = 0;
+	delayBeforeCompress = 0;
 
 	editorConfig = IEditorConfig::Create();
 }
@@ -316,6 +389,7 @@ SciTEBase::~SciTEBase() {
 
 void SciTEBase::Finalise() {
 	TimerEnd(timerAutoSave);
+	TimerEnd(timerCompress);
 }
 
 bool SciTEBase::PerformOnNewThread(Worker *pWorker) {
@@ -343,6 +417,9 @@ void SciTEBase::WorkerCommand(int cmd, Worker *pWorker) {
 	case WORK_FILEPROGRESS:
 		UpdateProgress(pWorker);
 		break;
+	case WORK_BUFFERCOMPRESSED:
+		BufferCompressed();
+		break;
 	}
 }
 
@@ -470,27 +547,23 @@ std::string SciTEBase::GetCurrentLine() {
 }
 
 /**
- * Check if the given line is a preprocessor condition line.
+ * Check if the given text is a preprocessor condition line.
  * @return The kind of preprocessor condition (enum values).
  */
-SciTEBase::PreProc SciTEBase::LinePreprocessorCondition(SA::Line line) {
-	const std::string text = GetLine(line);
-
-	const char *currChar = text.c_str();
-
-	while (IsASpace(*currChar)) {
-		currChar++;
+PreProc SciTEBase::PreprocessorCondition(std::string_view text) const {
+	while (!text.empty() && IsASpace(text.front())) {
+		text.remove_prefix(1);
 	}
-	if (preprocessorSymbol && (*currChar == preprocessorSymbol)) {
-		currChar++;
-		while (IsASpace(*currChar)) {
-			currChar++;
+	if (preprocessorSymbol && !text.empty() && (text.front() == preprocessorSymbol)) {
+		text.remove_prefix(1);
+		while (!text.empty() && IsASpace(text.front())) {
+			text.remove_prefix(1);
 		}
-		std::string word;
-		while (*currChar && !IsASpace(*currChar)) {
-			word.push_back(*currChar++);
+		size_t lengthWord = 0;
+		while ((lengthWord < text.length()) && !IsASpace(text[lengthWord])) {
+			lengthWord++;
 		}
-		std::map<std::string, PreProc>::const_iterator it = preprocOfString.find(word);
+		std::map<std::string, PreProc>::const_iterator it = preprocOfString.find(std::string(text.substr(0, lengthWord)));
 		if (it != preprocOfString.end()) {
 			return it->second;
 		}
@@ -498,35 +571,43 @@ SciTEBase::PreProc SciTEBase::LinePreprocessorCondition(SA::Line line) {
 	return PreProc::None;
 }
 
+PreProc SciTEBase::LinePreprocessorCondition(SA::Line line) {
+	return PreprocessorCondition(GetLine(line));
+}
+
 /**
- * Search a matching preprocessor condition line.
- * @return @c true if the end condition are meet.
- * Also set curLine to the line where one of these conditions is mmet.
+ * The preprocessor condition index of the current buffer, built from the whole text when
+ * needed or brought up to date by examining the lines modified since it was last used.
  */
-bool SciTEBase::FindMatchingPreprocessorCondition(
-	SA::Line &curLine,   		///< Number of the line where to start the search
-	int direction,   		///< Direction of search: 1 = forward, -1 = backward
-	PreProc condEnd1,   		///< First status of line for which the search is OK
-	PreProc condEnd2) {		///< Second one
-
-	bool isInside = false;
-	int level = 0;
-	const SA::Line maxLines = wEditor.LineCount() - 1;
-
-	while (curLine < maxLines && curLine > 0 && !isInside) {
-		curLine += direction;	// Increment or decrement
-		const PreProc status = LinePreprocessorCondition(curLine);
-
-		if ((direction == 1 && status == PreProc::Start) || (direction == -1 && status == PreProc::End)) {
-			level++;
-		} else if (level > 0 && ((direction == 1 && status == PreProc::End) || (direction == -1 && status == PreProc::Start))) {
-			level--;
-		} else if (level == 0 && (status == condEnd1 || status == condEnd2)) {
-			isInside = true;
+PreprocessorIndex &SciTEBase::PreprocessorConditions() {
+	PreprocessorIndex &index = CurrentBuffer()->preprocessorIndex;
+	const void *document = wEditor.DocPointer();
+	const SA::Line lineCount = wEditor.LineCount();
+	// Without insertion and deletion notifications the index can not follow modifications
+	const bool followed = FlagIsSet(wEditor.ModEventMask(), SA::ModificationFlags::InsertText);
+	if (!followed || !index.Valid(document, preprocDefinition, lineCount) ||
+		(index.DirtyEnd() - index.DirtyStart() > 1000)) {
+		index.Start(document, preprocDefinition, lineCount);
+		if (preprocessorSymbol) {
+			const bool unicodeLineEnds = wEditor.LineEndTypesActive() == SA::LineEndType::Unicode;
+			std::string_view text = TextAsView();
+			for (SA::Line line = 0; !text.empty(); line++) {
+				const std::string_view lineText = TakeLine(text, unicodeLineEnds);
+				if (lineText.find(preprocessorSymbol) != std::string_view::npos) {
+					const PreProc kind = PreprocessorCondition(lineText);
+					if (kind != PreProc::None)
+						index.Add(line, kind);
+				}
+			}
 		}
+	} else {
+		const SA::Line dirtyEnd = std::min(index.DirtyEnd(), lineCount);
+		for (SA::Line line = index.DirtyStart(); line < dirtyEnd; line++) {
+			index.SetLine(line, LinePreprocessorCondition(line));
+		}
+		index.Clean();
 	}
-
-	return isInside;
+	return index;
 }
 
 /**
@@ -538,56 +619,24 @@ bool SciTEBase::FindMatchingPreprocCondPosition(
 	SA::Position mppcAtCaret,   	///< Matching preproc. cond.: current position of caret
 	SA::Position &mppcMatch) {		///< Matching preproc. cond.: matching position
 
-	bool isInside = false;
+	PreprocessorIndex &index = PreprocessorConditions();
 
 	// Get current line
-	SA::Line curLine = wEditor.LineFromPosition(mppcAtCaret);
-	const PreProc status = LinePreprocessorCondition(curLine);
-
-	switch (status) {
-	case PreProc::Start:
-		if (isForward) {
-			isInside = FindMatchingPreprocessorCondition(curLine, 1,
-					PreProc::Middle, PreProc::End);
-		} else {
-			mppcMatch = mppcAtCaret;
-			return true;
-		}
-		break;
-	case PreProc::Middle:
-		if (isForward) {
-			isInside = FindMatchingPreprocessorCondition(curLine, 1,
-					PreProc::Middle, PreProc::End);
-		} else {
-			isInside = FindMatchingPreprocessorCondition(curLine, -1,
-					PreProc::Start, PreProc::Middle);
-		}
-		break;
-	case PreProc::End:
-		if (isForward) {
-			mppcMatch = mppcAtCaret;
-			return true;
-		} else {
-			isInside = FindMatchingPreprocessorCondition(curLine, -1,
-					PreProc::Start, PreProc::Middle);
-		}
-		break;
-	default:   	// Should be noPPC
+	const SA::Line curLine = wEditor.LineFromPosition(mppcAtCaret);
+	const PreProc status = index.KindOfLine(curLine);
 
-		if (isForward) {
-			isInside = FindMatchingPreprocessorCondition(curLine, 1,
-					PreProc::Middle, PreProc::End);
-		} else {
-			isInside = FindMatchingPreprocessorCondition(curLine, -1,
-					PreProc::Start, PreProc::Middle);
-		}
-		break;
+	if ((status == PreProc::Start && !isForward) || (status == PreProc::End && isForward)) {
+		mppcMatch = mppcAtCaret;
+		return true;
 	}
 
-	if (isInside) {
-		mppcMatch = wEditor.LineStart(curLine);
+	// Search forward for a middle or end, or backward for a start or middle, skipping nested conditions
+	const SA::Line lineMatch = isForward ? index.Next(curLine) : index.Previous(curLine);
+	if (lineMatch < 0) {
+		return false;
 	}
-	return isInside;
+	mppcMatch = wEditor.LineStart(lineMatch);
+	return true;
 }
 
 namespace {
@@ -851,22 +900,38 @@ void SciTEBase::HighlightCurrentWord(bool highlight) {
 		return;
 	}
 	GUI::ScintillaWindow &wCurrent = wOutput.HasFocus() ? wOutput : wEditor;
-	// Remove old indicators if any exist.
-	wCurrent.SetIndicatorCurrent(indicatorHighlightCurrentWord);
-	const SA::Position lenDoc = wCurrent.Length();
-	wCurrent.IndicatorClearRange(0, lenDoc);
-	if (!highlight)
-		return;
-	if (FilterShowing()) {
+	const SA::FindOption searchFlags = SA::FindOption::MatchCase | SA::FindOption::WholeWord;
+	std::string wordToFind;
+	int selectedStyle = -1;
+	bool noUserSelection = true;
+	if (highlight && !FilterShowing()) {
+		// Get start & end selection.
+		SA::Span sel = wCurrent.SelectionSpan();
+		noUserSelection = sel.start == sel.end;
+		const std::string sWordToFind = RangeExtendAndGrab(wCurrent, sel,
+					  &SciTEBase::islexerwordcharforsel);
+		// No highlight when no selection or multi-lines selection.
+		if (sWordToFind.find_first_of("\n\r ") == std::string::npos) {
+			// Get style of the current word to highlight only word with same style.
+			if (currentWordHighlight.isOnlyWithSameStyle)
+				selectedStyle = wCurrent.UnsignedStyleAt(sel.start);
+			// Manage word with DBCS.
+			wordToFind = EncodeString(sWordToFind);
+		}
+	}
+	if (!wordToFind.empty() && matchMarker.SameMatch(&wCurrent, wordToFind, searchFlags, selectedStyle)) {
+		// Word is already highlighted so avoid clearing and searching again
+		matchMarker.ExtendToView();
+		SetIdler(true);
 		return;
 	}
-	// Get start & end selection.
-	SA::Span sel = wCurrent.SelectionSpan();
-	const bool noUserSelection = sel.start == sel.end;
-	std::string sWordToFind = RangeExtendAndGrab(wCurrent, sel,
-				  &SciTEBase::islexerwordcharforsel);
-	if (sWordToFind.length() == 0 || (sWordToFind.find_first_of("\n\r ") != std::string::npos))
-		return; // No highlight when no selection or multi-lines selection.
+	// Remove old indicators if any exist.
+	if (!matchMarker.ClearMarks()) {
+		wCurrent.SetIndicatorCurrent(indicatorHighlightCurrentWord);
+		wCurrent.IndicatorClearRange(0, wCurrent.Length());
+	}
+	if (wordToFind.empty())
+		return;
 	if (noUserSelection && currentWordHighlight.statesOfDelay == CurrentWordHighlight::StatesOfDelay::noDelay) {
 		// Manage delay before highlight when no user selection but there is word at the caret.
 		currentWordHighlight.statesOfDelay = CurrentWordHighlight::StatesOfDelay::delay;
@@ -874,18 +939,11 @@ void SciTEBase::HighlightCurrentWord(bool highlight) {
 		currentWordHighlight.elapsedTimes.Duration(true);
 		return;
 	}
-	// Get style of the current word to highlight only word with same style.
-	int selectedStyle = wCurrent.UnsignedStyleAt(sel.start);
-	if (!currentWordHighlight.isOnlyWithSameStyle)
-		selectedStyle = -1;
-
-	// Manage word with DBCS.
-	const std::string wordToFind = EncodeString(sWordToFind);
 
-	const SA::FindOption searchFlags = SA::FindOption::MatchCase | SA::FindOption::WholeWord;
-	matchMarker.StartMatch(&wCurrent, wordToFind,
-			       searchFlags, selectedStyle,
-			       indicatorHighlightCurrentWord, -1);
+	// Mark the lines around the view now and more as the view scrolls
+	matchMarker.StartViewMatch(&wCurrent, wordToFind,
+				   searchFlags, selectedStyle,
+				   indicatorHighlightCurrentWord);
 	SetIdler(true);
 }
 
@@ -2399,6 +2457,17 @@ void SciTEBase::SetTextProperties(
 
 	ps.Set("NbOfLines", std::to_string(wEditor.LineCount()));
 
+	int buffersCompressed = 0;
+	size_t compressionSaving = 0;
+	for (BufferIndex i = 0; i < buffers.length; i++) {
+		if (buffers.buffers[i].IsCompressed()) {
+			buffersCompressed++;
+			compressionSaving += buffers.buffers[i].CompressionSaving();
+		}
+	}
+	ps.Set("BuffersCompressed", std::to_string(buffersCompressed));
+	ps.Set("CompressionSaving", std::to_string(compressionSaving));
+
 	const SA::Span range = wEditor.SelectionSpan();
 	const SA::Line selFirstLine = wEditor.LineFromPosition(range.start);
 	const SA::Line selLastLine = wEditor.LineFromPosition(range.end);
@@ -2517,22 +2586,30 @@ std::string CreateIndentation(int indent, int tabSize, bool insertSpaces) {
 }
 
 void SciTEBase::ConvertIndentation(int tabSize, int useTabs) {
-	UndoBlock ub(wEditor);
-	const SA::Line maxLine = wEditor.LineCount();
-	for (SA::Line line = 0; line < maxLine; line++) {
-		const SA::Position lineStart = wEditor.LineStart(line);
-		const int indent = GetLineIndentation(line);
-		const SA::Position indentPos = GetLineIndentPosition(line);
+	const int tabWidth = std::max(wEditor.TabWidth(), 1);
+	const bool unicodeLineEnds = wEditor.LineEndTypesActive() == SA::LineEndType::Unicode;
+	const std::string_view text = TextAsView();
+	std::string_view rest = text;
+	TextEdits edits;
+	while (!rest.empty()) {
+		const std::string_view line = TakeLine(rest, unicodeLineEnds);
+		// Measure indentation as Scintilla's LineIndentation does
+		int indent = 0;
+		size_t indentEnd = 0;
+		while ((indentEnd < line.length()) && IsSpaceOrTab(line[indentEnd])) {
+			if (line[indentEnd] == '\t')
+				indent = (indent / tabWidth + 1) * tabWidth;
+			else
+				indent++;
+			indentEnd++;
+		}
 		constexpr int maxIndentation = 1000;
 		if (indent < maxIndentation) {
-			std::string indentationNow = wEditor.StringOfRange(SA::Span(lineStart, indentPos));
-			std::string indentationWanted = CreateIndentation(indent, tabSize, !useTabs);
-			if (indentationNow != indentationWanted) {
-				wEditor.SetTarget(SA::Span(lineStart, indentPos));
-				wEditor.ReplaceTarget(indentationWanted);
-			}
+			const std::string indentationWanted = CreateIndentation(indent, tabSize, !useTabs);
+			edits.Replace(line.data() - text.data(), line.substr(0, indentEnd), indentationWanted);
 		}
 	}
+	edits.Apply(wEditor);
 }
 
 bool SciTEBase::RangeIsAllWhitespace(SA::Position start, SA::Position end) {
@@ -3956,6 +4033,11 @@ void SciTEBase::UpdateUI(const SCNotification *notification) {
 		RemoveFindMarks();
 	}
 	const SA::Update updated = static_cast<SA::Update>(notification->updated);
+	if (FlagIsSet(updated, SA::Update::VScroll)) {
+		// Highlight the current word in lines scrolled into view
+		matchMarker.ExtendToView();
+		SetIdler(true);
+	}
 	if (FlagIsSet(updated, SA::Update::Selection) || FlagIsSet(updated, SA::Update::Content)) {
 		if ((notification->nmhdr.idFrom == IDM_SRCWIN) == (pwFocussed == &wEditor)) {
 			// Only highlight focused pane.
@@ -3999,8 +4081,15 @@ void SciTEBase::Modified(const SCNotification *notification) {
 		static_cast<SA::ModificationFlags>(notification->modificationType);
 	const bool textWasModified = FlagIsSet(modificationType, SA::ModificationFlags::InsertText) ||
 		FlagIsSet(modificationType, SA::ModificationFlags::DeleteText);
-	if ((notification->nmhdr.idFrom == IDM_SRCWIN) && textWasModified)
+	if ((notification->nmhdr.idFrom == IDM_SRCWIN) && textWasModified) {
 		CurrentBuffer()->DocumentModified();
+		CurrentBuffer()->preprocessorIndex.LinesModified(
+			wEditor.LineFromPosition(notification->position), notification->linesAdded);
+	}
+	if (textWasModified) {
+		// Positions of current word marks are no longer known
+		matchMarker.TextModified();
+	}
 	if (FlagIsSet(modificationType, SA::ModificationFlags::LastStepInUndoRedo)) {
 		// When the user hits undo or redo, several normal insert/delete
 		// notifications may fire, but we will end up here in the end
@@ -4359,6 +4448,9 @@ void SciTEBase::OnTimer() {
 		}
 		SetDocumentAt(currentBuffer);
 	}
+	if (delayBeforeCompress) {
+		CompressBuffers();
+	}
 }
 
 void SciTEBase::SetIdler(bool on) {
@@ -4376,6 +4468,9 @@ void SciTEBase::OnIdle() {
 		matchMarker.Continue();
 		return;
 	}
+	if (preprocessorSymbol && !CurrentBuffer()->pFileWorker) {
+		PreprocessorConditions();
+	}
 	SetIdler(false);
 }
 
@@ -64,6 +64,18 @@ public:
 	}
 };
 
+// Settings held by a document rather than the view that are lost when a compressed document is expanded
+struct DocumentSettings {
+	SA::DocumentOption options = SA::DocumentOption::Default;
+	SA::EndOfLine eolMode = SA::EndOfLine::CrLf;
+	int tabWidth = 8;
+	int indent = 0;
+	bool useTabs = true;
+	bool tabIndents = true;
+	bool backSpaceUnIndents = false;
+	bool readOnly = false;
+};
+
 struct BufferState {
 public:
 	RecentFile file;
@@ -78,6 +90,7 @@ public:
 };
 
 struct FileWorker;
+class BufferCompressor;
 
 // Scintilla documents can only be released by calling a method on a Scintilla
 // instance so store a Scintilla instance in the release functor
@@ -97,6 +110,8 @@ public:
 	bool useMonoFont;
 	enum class LifeState { empty, reading, readAll, opened } lifeState;
 	UniMode unicodeMode;
+	TextAnalysis analysis;	///< Examined while loading and used when opening completes
+	PreprocessorIndex preprocessorIndex;
 	time_t fileModTime;
 	time_t fileModLastAsk;
 	time_t documentModTime;
@@ -105,6 +120,14 @@ public:
 	std::vector<SA::Line> foldState;
 	std::vector<SA::Line> bookmarks;
 	std::unique_ptr<FileWorker> pFileWorker;
+	// While hidden and unmodified the text may be compressed and the document released
+	time_t timeHidden;
+	unsigned int generation;	///< Counts modifications so text from before one is not kept
+	unsigned int generationHidden;
+	std::string_view textBefore;
+	std::string_view textAfter;
+	DocumentSettings documentSettings;
+	std::unique_ptr<BufferCompressor> pCompressor;
 	PropSetFile props;
 	enum class FutureDo { none=0, finishSave=1 } futureDo;
 	Buffer();
@@ -128,6 +151,11 @@ public:
 	bool FinishSave() noexcept;
 
 	void CancelLoad();
+
+	void Hide(std::string_view before, std::string_view after, const DocumentSettings &settings) noexcept;
+	void Show() noexcept;
+	bool IsCompressed() const noexcept;
+	size_t CompressionSaving() const noexcept;
 };
 
 struct BackgroundActivities {
@@ -309,6 +337,24 @@ public:
 	~UndoBlock() noexcept;
 };
 
+/// Replacements found in one pass over a document's text that are applied together.
+class TextEdits {
+	struct Edit {
+		SA::Position start;
+		SA::Position lengthOld;
+		size_t offsetNew;
+		size_t lengthNew;
+	};
+	std::vector<Edit> edits;
+	std::string replacements;
+public:
+	void Replace(SA::Position start, std::string_view textOld, std::string_view textNew);
+	[[nodiscard]] bool Empty() const noexcept;
+	void Apply(Scintilla::ScintillaCall &sci) const;
+};
+
+std::string_view TakeLine(std::string_view &text, bool unicodeLineEnds) noexcept;
+
 class SciTEBase : public ExtensionAPI, public Searcher, public WorkerListener {
 protected:
 	bool needIdle;
@@ -316,6 +362,7 @@ protected:
 	FilePath filePath;
 	FilePath dirNameAtExecute;
 	FilePath dirNameForExecute;
+	std::string textWhileSaving;	///< Copy of the document returned by TextAsView during a background save
 
 	static constexpr int fileStackMax = 10;
 	RecentFile recentFileStack[fileStackMax];
@@ -371,9 +418,9 @@ protected:
 	StyleAndWords statementEnd;
 	StyleAndWords blockStart;
 	StyleAndWords blockEnd;
-	enum class PreProc { None, Start, Middle, End, Dummy };	///< Indicate the kind of preprocessor condition line
 	char preprocessorSymbol;	///< Preprocessor symbol (in C, #)
 	std::map<std::string, PreProc> preprocOfString; ///< Map preprocessor keywords to positions
+	std::string preprocDefinition;	///< Symbol and keywords that were used to build preprocessor indices
 	/// In C, if ifdef ifndef : start, else elif : middle, endif : end.
 
 	GUI::Window wSciTE;  ///< Contains wToolBar, wTabBar, wContent, and wStatusBar
@@ -422,8 +469,9 @@ protected:
 	bool canRedo;
 
 	int timerMask;
-	enum { timerAutoSave=1 };
+	enum { timerAutoSave=1, timerCompress=2 };
 	int delayBeforeAutoSave;
+	int delayBeforeCompress;
 
 	int heightOutput;
 	int heightOutputStartDrag;
@@ -511,6 +559,9 @@ protected:
 	// Handle buffers
 	SA::IDocumentEditable *GetDocumentAt(BufferIndex index);
 	void SwitchDocumentAt(BufferIndex index, SA::IDocumentEditable *pdoc);
+	void ShowDocumentAt(BufferIndex index);
+	void CompressBuffers();
+	void BufferCompressed();
 	void SaveFolds(std::vector<SA::Line> &folds);
 	void RestoreFolds(const std::vector<SA::Line> &folds);
 	void UpdateBuffersCurrent();
@@ -558,8 +609,9 @@ protected:
 	SA::Position GetCaretInLine();
 	std::string GetLine(SA::Line line);
 	std::string GetCurrentLine();
+	PreProc PreprocessorCondition(std::string_view text) const;
 	PreProc LinePreprocessorCondition(SA::Line line);
-	bool FindMatchingPreprocessorCondition(SA::Line &curLine, int direction, PreProc condEnd1, PreProc condEnd2);
+	PreprocessorIndex &PreprocessorConditions();
 	bool FindMatchingPreprocCondPosition(bool isForward, SA::Position mppcAtCaret, SA::Position &mppcMatch);
 	bool FindMatchingBracePosition(bool editor, SA::Position &braceAtCaret, SA::Position &braceOpposite, bool sloppy);
 	void BraceMatch(bool editor);
@@ -586,8 +638,8 @@ protected:
 	void RestoreState(const Buffer &buffer, bool restoreBookmarks);
 	void Close(bool updateUI = true, bool loadingSession = false, bool makingRoomForNew = false);
 	static bool Exists(const GUI::gui_char *dir, const GUI::gui_char *path, FilePath *resultPath);
-	void DiscoverEOLSetting();
-	void DiscoverIndentSetting();
+	void DiscoverEOLSetting(const TextAnalysis &analysis);
+	void DiscoverIndentSetting(const TextAnalysis &analysis);
 	std::string DiscoverLanguage();
 	void OpenCurrentFile(long long fileSize, bool suppressMessage, bool asynchronous);
 	virtual void OpenUriList(const char *) {}
@@ -595,7 +647,6 @@ protected:
 	virtual bool SaveAsDialog() = 0;
 	virtual void LoadSessionDialog() {}
 	virtual void SaveSessionDialog() {}
-	void CountLineEnds(int &linesCR, int &linesLF, int &linesCRLF);
 	enum OpenFlags {
 		ofNone = 0, 		// Default
 		ofNoSaveIfDirty = 1, 	// Suppress check for unsaved changes
@@ -928,7 +979,7 @@ protected:
 	void OpenFilesFromStdin();
 	virtual bool GrepIntoDirectory(const FilePath &directory);
 	void GrepRecursive(GrepFlags gf, const FilePath &baseDir, const char *searchString,
-		GUI::gui_string_view fileTypes, GUI::gui_string_view excludedTypes);
+		const FilePatternSet &fileTypes, const FilePatternSet &excludedTypes);
 	void InternalGrep(GrepFlags gf, const FilePath &directory, GUI::gui_string_view fileTypes, GUI::gui_string_view excludedTypes,
 			  std::string_view search, SA::Position &originalEnd);
 	void EnumProperties(const char *propkind);
@@ -47,10 +47,12 @@
 #include "SciTE.h"
 #include "JobQueue.h"
 #include "Cookie.h"
+#include "Compressor.h"
 #include "Worker.h"
 #include "Utf8_16.h"
 #include "FileWorker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
 
@@ -69,7 +71,8 @@ void BufferDocReleaser::operator()(SA::IDocumentEditable *pDoc) noexcept {
 Buffer::Buffer() :
 	file(), isDirty(false), isReadOnly(false), failedSave(false), useMonoFont(false), lifeState(LifeState::empty),
 	unicodeMode(UniMode::uni8Bit), fileModTime(0), fileModLastAsk(0), documentModTime(0),
-	findMarks(FindMarks::none), futureDo(FutureDo::none) {}
+	findMarks(FindMarks::none), timeHidden(0), generation(0), generationHidden(0),
+	futureDo(FutureDo::none) {}
 
 void Buffer::Init() {
 	file.Init();
@@ -79,6 +82,8 @@ void Buffer::Init() {
 	useMonoFont = false;
 	lifeState = LifeState::empty;
 	unicodeMode = UniMode::uni8Bit;
+	analysis = TextAnalysis();
+	preprocessorIndex.Invalidate();
 	fileModTime = 0;
 	fileModLastAsk = 0;
 	documentModTime = 0;
@@ -87,6 +92,7 @@ void Buffer::Init() {
 	foldState.clear();
 	bookmarks.clear();
 	pFileWorker.reset();
+	Show();
 	futureDo = FutureDo::none;
 	doc.reset();
 }
@@ -100,6 +106,9 @@ void Buffer::SetTimeFromFile() {
 
 void Buffer::DocumentModified() noexcept {
 	documentModTime = time(nullptr);
+	// Text compressed or being compressed is no longer that of the document
+	generation++;
+	pCompressor.reset();
 }
 
 bool Buffer::NeedsSave(int delayBeforeSave) const  noexcept {
@@ -171,6 +180,40 @@ void Buffer::CancelLoad() {
 	}
 }
 
+// Remember where the text of a document that is no longer displayed is so that it may be compressed
+// later. Only valid while the document is not displayed as that is the only way it can change.
+void Buffer::Hide(std::string_view before, std::string_view after, const DocumentSettings &settings) noexcept {
+	timeHidden = time(nullptr);
+	generationHidden = generation;
+	textBefore = before;
+	textAfter = after;
+	documentSettings = settings;
+}
+
+// The document is about to be displayed so stop any compression.
+// Any compressed text is discarded so must have been expanded first.
+void Buffer::Show() noexcept {
+	pCompressor.reset();
+	timeHidden = 0;
+	textBefore = {};
+	textAfter = {};
+}
+
+bool Buffer::IsCompressed() const noexcept {
+	return !doc && pCompressor && pCompressor->FinishedJob();
+}
+
+// Estimate memory saved by compressing as the text and its styles less the compressed text
+size_t Buffer::CompressionSaving() const noexcept {
+	if (!IsCompressed()) {
+		return 0;
+	}
+	const size_t length = pCompressor->compressed.Length();
+	const size_t documentSize = SA::FlagSet(documentSettings.options, SA::DocumentOption::StylesNone) ? length : length * 2;
+	const size_t compressedSize = pCompressor->compressed.Size();
+	return (documentSize > compressedSize) ? documentSize - compressedSize : 0;
+}
+
 BufferList::BufferList() : current(0), stackcurrent(0), stack(0), buffers(0), length(0), lengthVisible(0), initialised(false) {}
 
 BufferIndex BufferList::size() const noexcept {
@@ -419,23 +462,167 @@ SA::IDocumentEditable *SciTEBase::GetDocumentAt(BufferIndex index) {
 	if (index < 0 || index >= buffers.size()) {
 		return nullptr;
 	}
-	if (!buffers.buffers[index].doc) {
+	Buffer &buffer = buffers.buffers[index];
+	if (buffer.IsCompressed()) {
+		// Expand into a new document with the same options
+		const CompressedText &compressed = buffer.pCompressor->compressed;
+		Scintilla::ILoader *pLoader = static_cast<Scintilla::ILoader *>(
+			wEditor.CreateLoader(compressed.Length(), buffer.documentSettings.options));
+		if (pLoader) {
+			std::string text;
+			int status = static_cast<int>(SA::Status::Ok);
+			for (size_t block = 0; (block < compressed.Blocks()) && (status == static_cast<int>(SA::Status::Ok)); block++) {
+				text.resize(compressed.BlockLength(block));
+				if (compressed.Expand(block, text.data())) {
+					status = pLoader->AddData(text.data(), text.size());
+				} else {
+					status = static_cast<int>(SA::Status::Failure);
+				}
+			}
+			if (status == static_cast<int>(SA::Status::Ok)) {
+				buffer.doc.reset(static_cast<SA::IDocumentEditable *>(pLoader->ConvertToDocument()));
+			} else {
+				pLoader->Release();
+			}
+		}
+		if (!buffer.doc) {
+			// Keep the compressed text so expansion can be retried and show an empty read-only
+			// document that can not be saved over the file in its place.
+			buffer.lifeState = Buffer::LifeState::empty;
+			buffer.isReadOnly = true;
+			// No longer hidden so the placeholder is not taken for a document being compressed
+			buffer.timeHidden = 0;
+			buffer.doc.reset(wEditor.CreateDocument(0, SA::DocumentOption::Default));
+			const GUI::gui_string msg = LocaliseMessage("Could not expand the compressed text of '^0'.",
+				buffer.file.AsInternal());
+			WindowMessageBox(wSciTE, msg, mbsIconWarning);
+			return buffer.doc.get();
+		}
+		buffer.lifeState = Buffer::LifeState::opened;
+		buffer.isReadOnly = buffer.documentSettings.readOnly;
+	}
+	buffer.Show();
+	if (!buffer.doc) {
 		// Create a new document buffer
-		buffers.buffers[index].doc.reset(wEditor.CreateDocument(0, SA::DocumentOption::Default));
+		buffer.doc.reset(wEditor.CreateDocument(0, SA::DocumentOption::Default));
 	}
-	return buffers.buffers[index].doc.get();
+	return buffer.doc.get();
 }
 
 void SciTEBase::SwitchDocumentAt(BufferIndex index, SA::IDocumentEditable *pdoc) {
 	if (index < 0 || index >= buffers.size()) {
 		return;
 	}
+	buffers.buffers[index].Show();
 	buffers.buffers[index].doc.reset(pdoc);
 	if (index == buffers.Current()) {
 		wEditor.SetDocPointer(buffers.buffers[index].doc.get());
 	}
 }
 
+// Display the document of a buffer in the editor. The text of an unmodified document being hidden
+// is remembered so that it may be compressed later. Bookmarks are restored into an expanded document.
+void SciTEBase::ShowDocumentAt(BufferIndex index) {
+	// Smaller documents are not worth compressing
+	constexpr SA::Position minimumCompress = CompressedText::blockSize;
+	const SA::IDocumentEditable *pdocHiding = wEditor.DocPointer();
+	for (BufferIndex i = 0; i < buffers.length; i++) {
+		Buffer &buffer = buffers.buffers[i];
+		if ((i != index) && buffer.pCompressor && (buffer.doc.get() == pdocHiding)) {
+			// Drop the placeholder shown when expansion failed so expansion is tried again next time
+			buffer.doc.reset();
+		} else if ((i != index) && buffer.doc && (buffer.doc.get() == pdocHiding) &&
+			delayBeforeCompress && !buffer.isDirty && !buffer.pFileWorker &&
+			(buffer.lifeState == Buffer::LifeState::opened) && (wEditor.Length() >= minimumCompress)) {
+			buffer.bookmarks.clear();
+			SA::Line lineBookmark = -1;
+			while ((lineBookmark = wEditor.MarkerNext(lineBookmark + 1, 1 << markerBookmark)) >= 0) {
+				buffer.bookmarks.push_back(lineBookmark);
+			}
+			// Take the text from each side of the gap as moving the gap would be slow
+			const SA::Position length = wEditor.Length();
+			const SA::Position gap = wEditor.GapPosition();
+			DocumentSettings settings;
+			settings.options = wEditor.DocumentOptions();
+			settings.eolMode = wEditor.EOLMode();
+			settings.tabWidth = wEditor.TabWidth();
+			settings.indent = wEditor.Indent();
+			settings.useTabs = wEditor.UseTabs();
+			settings.tabIndents = wEditor.TabIndents();
+			settings.backSpaceUnIndents = wEditor.BackSpaceUnIndents();
+			settings.readOnly = buffer.isReadOnly;
+			buffer.Hide(std::string_view(static_cast<const char *>(wEditor.RangePointer(0, gap)), gap),
+				std::string_view(static_cast<const char *>(wEditor.RangePointer(gap, length - gap)), length - gap),
+				settings);
+		}
+	}
+	const Buffer &buffer = buffers.buffers[index];
+	const bool expanding = buffer.IsCompressed();
+	wEditor.SetDocPointer(GetDocumentAt(index));
+	if (expanding) {
+		// A new document starts with default settings so restore those of the hidden document
+		const DocumentSettings &settings = buffer.documentSettings;
+		wEditor.SetEOLMode(settings.eolMode);
+		wEditor.SetTabWidth(settings.tabWidth);
+		wEditor.SetIndent(settings.indent);
+		wEditor.SetUseTabs(settings.useTabs);
+		wEditor.SetTabIndents(settings.tabIndents);
+		wEditor.SetBackSpaceUnIndents(settings.backSpaceUnIndents);
+		wEditor.SetUndoCollection(true);
+		wEditor.SetSavePoint();
+		wEditor.SetReadOnly(buffer.isReadOnly);
+		if (buffer.pCompressor) {
+			// Expansion failed so the text and its bookmarks are not present
+			return;
+		}
+		for (const SA::Line bookmark : buffer.bookmarks) {
+			wEditor.MarkerAdd(bookmark, markerBookmark);
+		}
+	}
+}
+
+// Called on the timer to start compressing one hidden buffer that has not been displayed recently
+void SciTEBase::CompressBuffers() {
+	const time_t now = time(nullptr);
+	for (BufferIndex i = 0; i < buffers.length; i++) {
+		if (buffers.buffers[i].pCompressor && !buffers.buffers[i].pCompressor->FinishedJob()) {
+			// Only compress one buffer at a time
+			return;
+		}
+	}
+	for (BufferIndex i = 0; i < buffers.length; i++) {
+		Buffer &buffer = buffers.buffers[i];
+		if ((i != buffers.Current()) && buffer.timeHidden && !buffer.pCompressor && buffer.doc &&
+			(buffer.generation == buffer.generationHidden) && !buffer.isDirty && !buffer.pFileWorker && (now - buffer.timeHidden >= delayBeforeCompress)) {
+			buffer.pCompressor = std::make_unique<BufferCompressor>(this, buffer.textBefore, buffer.textAfter);
+			if (!PerformOnNewThread(buffer.pCompressor.get())) {
+				// Avoid waiting for a thread that never started
+				buffer.pCompressor->SetCompleted();
+				buffer.Show();
+			}
+			return;
+		}
+	}
+}
+
+// The compressor that finished may have been deleted and its address reused so any buffer
+// whose compression has finished is completed rather than looking for that compressor.
+void SciTEBase::BufferCompressed() {
+	for (BufferIndex i = 0; i < buffers.length; i++) {
+		Buffer &buffer = buffers.buffers[i];
+		if (buffer.timeHidden && buffer.doc && buffer.pCompressor && buffer.pCompressor->FinishedJob()) {
+			if (buffer.pCompressor->failed || (i == buffers.Current()) ||
+				(buffer.generation != buffer.generationHidden)) {
+				buffer.Show();
+			} else {
+				// Compressed text now held by pCompressor
+				buffer.doc.reset();
+				UpdateStatusBar(false);
+			}
+		}
+	}
+}
+
 void SciTEBase::SetDocumentAt(BufferIndex index, bool updateStack) {
 	const BufferIndex currentbuf = buffers.Current();
 
@@ -464,7 +651,7 @@ void SciTEBase::SetDocumentAt(BufferIndex index, bool updateStack) {
 	SetFileName(bufferNext.file);
 	propsDiscovered = bufferNext.props;
 	propsDiscovered.superPS = &propsLocal;
-	wEditor.SetDocPointer(GetDocumentAt(buffers.Current()));
+	ShowDocumentAt(buffers.Current());
 	const bool restoreBookmarks = bufferNext.lifeState == Buffer::LifeState::readAll;
 	PerformDeferredTasks();
 	if (bufferNext.lifeState == Buffer::LifeState::readAll) {
@@ -927,8 +1114,7 @@ void SciTEBase::New() {
 		buffers.SetCurrent(buffers.Add());
 	}
 
-	SA::IDocumentEditable *doc = GetDocumentAt(buffers.Current());
-	wEditor.SetDocPointer(doc);
+	ShowDocumentAt(buffers.Current());
 
 	FilePath curDirectory(filePath.Directory());
 	filePath.Set(curDirectory, GUI_TEXT(""));
@@ -1027,7 +1213,7 @@ void SciTEBase::Close(bool updateUI, bool loadingSession, bool makingRoomForNew)
 			filePath = bufferNext.file;
 		propsDiscovered = bufferNext.props;
 		propsDiscovered.superPS = &propsLocal;
-		wEditor.SetDocPointer(GetDocumentAt(buffers.Current()));
+		ShowDocumentAt(buffers.Current());
 		PerformDeferredTasks();
 		if (bufferNext.lifeState == Buffer::LifeState::readAll) {
 			//restoreBookmarks = true;
@@ -49,10 +49,12 @@
 #include "SciTE.h"
 #include "JobQueue.h"
 #include "Cookie.h"
+#include "Compressor.h"
 #include "Worker.h"
 #include "Utf8_16.h"
 #include "FileWorker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
 
@@ -110,40 +112,12 @@ bool SciTEBase::Exists(const GUI::gui_char *dir, const GUI::gui_char *path, File
 	return true;
 }
 
-void SciTEBase::CountLineEnds(int &linesCR, int &linesLF, int &linesCRLF) {
-	linesCR = 0;
-	linesLF = 0;
-	linesCRLF = 0;
-	const SA::Position lengthDoc = LengthDocument();
-	char chPrev = ' ';
-	TextReader acc(wEditor);
-	char chNext = acc.SafeGetCharAt(0);
-	for (SA::Position i = 0; i < lengthDoc; i++) {
-		const char ch = chNext;
-		chNext = acc.SafeGetCharAt(i + 1);
-		if (ch == '\r') {
-			if (chNext == '\n')
-				linesCRLF++;
-			else
-				linesCR++;
-		} else if (ch == '\n') {
-			if (chPrev != '\r') {
-				linesLF++;
-			}
-		} else if (i > 1000000) {
-			return;
-		}
-		chPrev = ch;
-	}
-}
-
-void SciTEBase::DiscoverEOLSetting() {
+void SciTEBase::DiscoverEOLSetting(const TextAnalysis &analysis) {
 	SetEol();
 	if (props.GetInt("eol.auto")) {
-		int linesCR;
-		int linesLF;
-		int linesCRLF;
-		CountLineEnds(linesCR, linesLF, linesCRLF);
+		const size_t linesCR = analysis.linesCR;
+		const size_t linesLF = analysis.linesLF;
+		const size_t linesCRLF = analysis.linesCRLF;
 		if (((linesLF >= linesCR) && (linesLF > linesCRLF)) || ((linesLF > linesCR) && (linesLF >= linesCRLF)))
 			wEditor.SetEOLMode(SA::EndOfLine::Lf);
 		else if (((linesCR >= linesLF) && (linesCR > linesCRLF)) || ((linesCR > linesLF) && (linesCR >= linesCRLF)))
@@ -195,50 +169,8 @@ std::string SciTEBase::DiscoverLanguage() {
 	return languageOverride;
 }
 
-void SciTEBase::DiscoverIndentSetting() {
-	const SA::Position lengthDoc = std::min<SA::Position>(LengthDocument(), 1000000);
-	TextReader acc(wEditor);
-	bool newline = true;
-	int indent = 0; // current line indentation
-	int tabSizes[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 }; // number of lines with corresponding indentation (index 0 - tab)
-	int prevIndent = 0; // previous line indentation
-	int prevTabSize = -1; // previous line tab size
-	for (int i = 0; i < lengthDoc; i++) {
-		const char ch = acc[i];
-		if (ch == '\r' || ch == '\n') {
-			indent = 0;
-			newline = true;
-		} else if (newline && ch == ' ') {
-			indent++;
-		} else if (newline) {
-			if (indent) {
-				if (indent == prevIndent && prevTabSize != -1) {
-					tabSizes[prevTabSize]++;
-				} else if (indent > prevIndent && prevIndent != -1) {
-					if (indent - prevIndent <= 8) {
-						prevTabSize = indent - prevIndent;
-						tabSizes[prevTabSize]++;
-					} else {
-						prevTabSize = -1;
-					}
-				}
-				prevIndent = indent;
-			} else if (ch == '\t') {
-				tabSizes[0]++;
-				prevIndent = -1;
-			} else {
-				prevIndent = 0;
-			}
-			newline = false;
-		}
-	}
-	// maximum non-zero indent
-	int topTabSize = -1;
-	for (int j = 0; j <= 8; j++) {
-		if (tabSizes[j] && (topTabSize == -1 || tabSizes[j] > tabSizes[topTabSize])) {
-			topTabSize = j;
-		}
-	}
+void SciTEBase::DiscoverIndentSetting(const TextAnalysis &analysis) {
+	const int topTabSize = analysis.IndentStep();
 	// set indentation
 	if (topTabSize == 0) {
 		wEditor.SetUseTabs(true);
@@ -328,6 +260,7 @@ void SciTEBase::OpenCurrentFile(const long long fileSize, bool suppressMessage,
 		PerformOnNewThread(CurrentBuffer()->pFileWorker.get());
 	} else {
 		std::unique_ptr<Utf8_16::Reader> convert = Utf8_16::Reader::Allocate();
+		TextAnalysis analysis;
 		{
 			UndoBlock ub(wEditor);	// Group together clear and insert
 			wEditor.ClearAll();
@@ -337,15 +270,19 @@ void SciTEBase::OpenCurrentFile(const long long fileSize, bool suppressMessage,
 			while (lenFile > 0) {
 				const std::string_view dataBlock = convert->convert(std::string_view(data.data(), lenFile));
 				AddText(wEditor, dataBlock);
+				analysis.Analyse(dataBlock);
 				lenFile = fread(data.data(), 1, data.size(), fp);
 			}
 			fclose(fp);
 			// Handle case where convert is holding a lead surrogate but no more data
 			const std::string_view dataTrail = convert->convert("");
 			AddText(wEditor, dataTrail);
+			analysis.Analyse(dataTrail);
+			analysis.Finish();
 		}
 
 		CurrentBuffer()->unicodeMode = convert->getEncoding();
+		CurrentBuffer()->analysis = analysis;
 
 		CompleteOpen(OpenCompletion::synchronous);
 	}
@@ -357,6 +294,7 @@ void SciTEBase::TextRead(FileWorker *pFileWorker) {
 	// May not be found if load cancelled
 	if ((iBuffer >= 0) && pFileLoader) {
 		buffers.buffers[iBuffer].unicodeMode = pFileLoader->unicodeMode;
+		buffers.buffers[iBuffer].analysis = pFileLoader->analysis;
 		buffers.buffers[iBuffer].lifeState = Buffer::LifeState::readAll;
 		if (pFileLoader->err) {
 			GUI::gui_string msg = LocaliseMessage("Could not open file '^0'.", pFileLoader->path.AsInternal());
@@ -411,6 +349,18 @@ void SciTEBase::CompleteOpen(OpenCompletion oc) {
 		SizeSubWindows();
 	}
 
+	TextAnalysis &analysis = CurrentBuffer()->analysis;
+	if (!analysis.complete) {
+		// Not examined while loading so examine the document now
+		analysis.Analyse(std::string_view(static_cast<const char *>(wEditor.CharacterPointer()), LengthDocument()));
+		analysis.Finish();
+	}
+
+	if ((CurrentBuffer()->unicodeMode == UniMode::uni8Bit) && props.GetInt("utf8.auto") &&
+		analysis.nonASCII && analysis.validUTF8) {
+		// No BOM or coding cookie but the text is UTF-8 so treat as if there was a cookie
+		CurrentBuffer()->unicodeMode = UniMode::cookie;
+	}
 	if (CurrentBuffer()->unicodeMode != UniMode::uni8Bit) {
 		// Override the code page if Unicode
 		codePage = SA::CpUtf8;
@@ -419,11 +369,13 @@ void SciTEBase::CompleteOpen(OpenCompletion oc) {
 	}
 	wEditor.SetCodePage(codePage);
 
-	DiscoverEOLSetting();
+	DiscoverEOLSetting(analysis);
 
 	if (props.GetInt("indent.auto")) {
-		DiscoverIndentSetting();
+		DiscoverIndentSetting(analysis);
 	}
+	// Only needed when opening
+	analysis = TextAnalysis();
 
 	if (!wEditor.UndoCollection()) {
 		wEditor.SetUndoCollection(true);
@@ -861,6 +813,12 @@ void SciTEBase::Revert() {
 
 std::string_view SciTEBase::TextAsView() {
 	const SA::Position length = wEditor.Length();
+	if (CurrentBuffer()->pFileWorker && !CurrentBuffer()->pFileWorker->IsLoading()) {
+		// Being saved in the background from both sides of the gap so the gap must
+		// not move: return a copy instead.
+		textWhileSaving = wEditor.StringOfRange(SA::Span(0, length));
+		return textWhileSaving;
+	}
 	const char *documentMemory = static_cast<const char *>(wEditor.CharacterPointer());
 	return std::string_view(documentMemory, length);
 }
@@ -1011,6 +969,7 @@ SciTEBase::SaveResult SciTEBase::SaveIfUnsureAll() {
 	// Release all the extra documents
 	for (Buffer &buffer : buffers.buffers) {
 		if (buffer.doc && !buffer.pFileWorker) {
+			buffer.Show();
 			buffer.doc.reset();
 		}
 	}
@@ -1142,18 +1101,21 @@ private:
 };
 
 void SciTEBase::StripTrailingSpaces() {
-	const SA::Line maxLines = wEditor.LineCount();
-	SelectionKeeper keeper(wEditor);
-	for (SA::Line line = 0; line < maxLines; line++) {
-		const SA::Position lineStart = wEditor.LineStart(line);
-		const SA::Position lineEnd = wEditor.LineEnd(line);
-		SA::Position firstSpace = lineEnd;
-		while ((firstSpace > lineStart) && IsSpaceOrTab(wEditor.CharacterAt(firstSpace-1))) {
+	const bool unicodeLineEnds = wEditor.LineEndTypesActive() == SA::LineEndType::Unicode;
+	const std::string_view text = TextAsView();
+	std::string_view rest = text;
+	TextEdits edits;
+	while (!rest.empty()) {
+		const std::string_view line = TakeLine(rest, unicodeLineEnds);
+		size_t firstSpace = line.length();
+		while ((firstSpace > 0) && IsSpaceOrTab(line[firstSpace - 1])) {
 			firstSpace--;
 		}
-		if (firstSpace < lineEnd) {
-			wEditor.DeleteRange(firstSpace, lineEnd-firstSpace);
-		}
+		edits.Replace(line.data() + firstSpace - text.data(), line.substr(firstSpace), "");
+	}
+	if (!edits.Empty()) {
+		SelectionKeeper keeper(wEditor);
+		edits.Apply(wEditor);
 	}
 }
 
@@ -1196,13 +1158,29 @@ bool SciTEBase::SaveBuffer(const FilePath &saveName, SaveFlags sf) {
 
 	if (!retVal) {
 
-		FILE *fp = saveName.Open(fileWrite);
+		// Write to a temporary file then move it over the original so that a failure
+		// while writing leaves the original intact.
+		FilePath pathTemporary;
+		if (props.GetInt("save.atomic") && saveName.CanBeReplaced()) {
+			pathTemporary = saveName.ReplacementPath();
+		}
+		FILE *fp = pathTemporary.Open(fileWrite);
+		if (!fp) {
+			pathTemporary.Init();
+			fp = saveName.Open(fileWrite);
+		}
 		if (fp) {
-			const size_t lengthDoc = LengthDocument();
+			// Write the two halves of Scintilla's gap buffer as they are as moving the gap
+			// to make the text contiguous is slow for large documents.
+			const SA::Position lengthDoc = LengthDocument();
+			const SA::Position gap = wEditor.GapPosition();
+			const std::string_view documentBefore(static_cast<const char *>(wEditor.RangePointer(0, gap)), gap);
+			const std::string_view documentAfter(static_cast<const char *>(wEditor.RangePointer(gap, lengthDoc - gap)), lengthDoc - gap);
 			if (!(sf & sfSynchronous)) {
+				// Read-only so the halves are not changed until the background save completes
 				wEditor.SetReadOnly(true);
-				const std::string_view documentBytes = TextAsView();
-				CurrentBuffer()->pFileWorker = std::make_unique<FileStorer>(this, documentBytes, saveName, fp, CurrentBuffer()->unicodeMode, (sf & sfProgressVisible));
+				CurrentBuffer()->pFileWorker = std::make_unique<FileStorer>(this, documentBefore, documentAfter,
+					saveName, pathTemporary, fp, CurrentBuffer()->unicodeMode, (sf & sfProgressVisible));
 				CurrentBuffer()->pFileWorker->sleepTime = props.GetInt("asynchronous.sleep");
 				if (PerformOnNewThread(CurrentBuffer()->pFileWorker.get())) {
 					retVal = true;
@@ -1211,26 +1189,10 @@ bool SciTEBase::SaveBuffer(const FilePath &saveName, SaveFlags sf) {
 					WindowMessageBox(wSciTE, msg);
 				}
 			} else {
-				std::unique_ptr<Utf8_16::Writer> convert = Utf8_16::Writer::Allocate(CurrentBuffer()->unicodeMode, blockSize);
-				std::vector<char> data(blockSize);
-				retVal = true;
-				for (size_t startBlock = 0; startBlock < lengthDoc;) {
-					size_t grabSize = std::min(lengthDoc - startBlock, blockSize);
-					// Round down so only whole characters retrieved.
-					grabSize = wEditor.PositionBefore(startBlock + grabSize + 1) - startBlock;
-					const SA::Span rangeGrab(startBlock, startBlock + grabSize);
-					CopyText(wEditor, data.data(), rangeGrab);
-					const size_t written = convert->fwrite(std::string_view(data.data(), grabSize), fp);
-					if (written == 0) {
-						retVal = false;
-						break;
-					}
-					startBlock += grabSize;
-				}
-				if (fclose(fp) != 0) {
-					retVal = false;
-				}
-				fp = nullptr;
+				FileStorer storer(nullptr, documentBefore, documentAfter,
+					saveName, pathTemporary, fp, CurrentBuffer()->unicodeMode, false);
+				storer.Store();
+				retVal = storer.err == 0;
 			}
 		}
 	}
@@ -1545,53 +1507,80 @@ constexpr bool IsWordCharacter(int ch) noexcept {
 	return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')  || (ch >= '0' && ch <= '9')  || (ch == '_');
 }
 
+namespace {
+
+// Gather the files to search and the directories to descend into, checking each name as it is read
+// so that paths are only built for wanted entries.
+class GrepLister : public DirectoryVisitor {
+	const FilePath &directory;
+	const FilePatternSet &fileTypes;
+	const FilePatternSet &excludedTypes;
+public:
+	FilePathSet directories;
+	FilePathSet files;
+	GrepLister(const FilePath &directory_, const FilePatternSet &fileTypes_, const FilePatternSet &excludedTypes_) noexcept :
+		directory(directory_), fileTypes(fileTypes_), excludedTypes(excludedTypes_) {
+	}
+	bool Entry(GUI::gui_string_view name, bool isDirectory) override {
+		if (!excludedTypes.Empty() && excludedTypes.Matches(name)) {
+			return true;
+		}
+		if (isDirectory) {
+			directories.emplace_back(directory, FilePath(name));
+		} else if (fileTypes.Empty() || fileTypes.Matches(name)) {
+			files.emplace_back(directory, FilePath(name));
+		}
+		return true;
+	}
+};
+
+}
+
 bool SciTEBase::GrepIntoDirectory(const FilePath &directory) {
 	const GUI::gui_char *sDirectory = directory.AsInternal();
 	return sDirectory[0] != '.';
 }
 
 void SciTEBase::GrepRecursive(GrepFlags gf, const FilePath &baseDir, const char *searchString,
-	GUI::gui_string_view fileTypes, GUI::gui_string_view excludedTypes) {
+	const FilePatternSet &fileTypes, const FilePatternSet &excludedTypes) {
 	constexpr int checkAfterLines = 10'000;
-	FilePathSet directories;
-	FilePathSet files;
-	baseDir.List(directories, files);
+	GrepLister lister(baseDir, fileTypes, excludedTypes);
+	baseDir.Enumerate(lister);
+	std::ranges::sort(lister.files);
+	std::ranges::sort(lister.directories);
 	const size_t searchLength = strlen(searchString);
 	std::string os;
-	for (const FilePath &fPath : files) {
+	for (const FilePath &fPath : lister.files) {
 		if (jobQueue.Cancelled())
 			return;
-		if ((fileTypes.empty() || fPath.Matches(fileTypes)) &&
-			((excludedTypes.empty() || !fPath.Matches(excludedTypes)))) {
-			//OutputAppendStringSynchronised(fPath.AsUTF8());
-			//OutputAppendStringSynchronised("\n");
-			FileReader fr(fPath, FlagIsSet(gf, GrepFlags::matchCase));
-			if (FlagIsSet(gf, GrepFlags::binary) || !fr.BufferContainsNull()) {
-				while (const char *line = fr.Next()) {
-					if (((fr.LineNumber() % checkAfterLines) == 0) && jobQueue.Cancelled())
-						return;
-					const char *match = strstr(line, searchString);
-					if (match) {
-						if (FlagIsSet(gf, GrepFlags::wholeWord)) {
-							const char *lineEnd = line + strlen(line);
-							while (match) {
-								if (((match == line) || !IsWordCharacter(match[-1])) &&
-										((match + searchLength == (lineEnd)) || !IsWordCharacter(match[searchLength]))) {
-									break;
-								}
-								match = strstr(match + 1, searchString);
+		//OutputAppendStringSynchronised(fPath.AsUTF8());
+		//OutputAppendStringSynchronised("\n");
+		FileReader fr(fPath, FlagIsSet(gf, GrepFlags::matchCase));
+		if (FlagIsSet(gf, GrepFlags::binary) || !fr.BufferContainsNull()) {
+			while (const char *line = fr.Next()) {
+				if (((fr.LineNumber() % checkAfterLines) == 0) && jobQueue.Cancelled())
+					return;
+				const char *match = strstr(line, searchString);
+				if (match) {
+					if (FlagIsSet(gf, GrepFlags::wholeWord)) {
+						const char *lineEnd = line + strlen(line);
+						while (match) {
+							if (((match == line) || !IsWordCharacter(match[-1])) &&
+									((match + searchLength == (lineEnd)) || !IsWordCharacter(match[searchLength]))) {
+								break;
 							}
-						}
-						if (match) {
-							os.append(fPath.AsUTF8());
-							os.append(":");
-							std::string lNumber = StdStringFromInteger(fr.LineNumber());
-							os.append(lNumber);
-							os.append(":");
-							os.append(fr.Original());
-							os.append("\n");
+							match = strstr(match + 1, searchString);
 						}
 					}
+					if (match) {
+						os.append(fPath.AsUTF8());
+						os.append(":");
+						std::string lNumber = StdStringFromInteger(fr.LineNumber());
+						os.append(lNumber);
+						os.append(":");
+						os.append(fr.Original());
+						os.append("\n");
+					}
 				}
 			}
 		}
@@ -1603,11 +1592,9 @@ void SciTEBase::GrepRecursive(GrepFlags gf, const FilePath &baseDir, const char
 			OutputAppendStringSynchronised(os);
 		}
 	}
-	for (const FilePath &fPath : directories) {
+	for (const FilePath &fPath : lister.directories) {
 		if (FlagIsSet(gf, GrepFlags::dot) || GrepIntoDirectory(fPath.Name())) {
-			if ((excludedTypes.empty() || !fPath.Matches(excludedTypes))) {
-				GrepRecursive(gf, fPath, searchString, fileTypes, excludedTypes);
-			}
+			GrepRecursive(gf, fPath, searchString, fileTypes, excludedTypes);
 		}
 	}
 }
@@ -1630,7 +1617,7 @@ void SciTEBase::InternalGrep(GrepFlags gf, const FilePath &directory, GUI::gui_s
 	if (!FlagIsSet(gf, GrepFlags::matchCase)) {
 		LowerCaseAZ(searchString);
 	}
-	GrepRecursive(gf, directory, searchString.c_str(), fileTypes, excludedTypes);
+	GrepRecursive(gf, directory, searchString.c_str(), FilePatternSet(fileTypes), FilePatternSet(excludedTypes));
 	if (!FlagIsSet(gf, GrepFlags::stdOut)) {
 		std::string sExitMessage(">");
 		if (jobQueue.TimeCommands()) {
@@ -66,6 +66,7 @@ const GUI::gui_char menuAccessIndicator[] = GUI_TEXT("&");
 #include "Cookie.h"
 #include "Worker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "EditorConfig.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
@@ -1280,13 +1281,20 @@ void SciTEBase::ReadProperties() {
 	const std::string ppSymbol = props.GetNewExpandString("preprocessor.symbol.", fileNameForExtension);
 	preprocessorSymbol = ppSymbol.empty() ? 0 : ppSymbol[0];
 	preprocOfString.clear();
+	preprocDefinition = ppSymbol;
 	for (const PropToPPC &preproc : propToPPC) {
 		const std::string list = props.GetNewExpandString(preproc.propName, fileNameForExtension);
+		preprocDefinition.append("\n");
+		preprocDefinition.append(list);
 		const std::vector<std::string> words = StringSplit(list, ' ');
 		for (const std::string &word : words) {
 			preprocOfString[word] = preproc.ppc;
 		}
 	}
+	if (preprocessorSymbol) {
+		// Index preprocessor conditions when idle
+		SetIdler(true);
+	}
 
 	std::vector<std::string> fileSets = StringSplit(props.GetNewExpandString("find.files"), '|');
 	for (const std::string &fileSet : fileSets) {
@@ -1600,6 +1608,13 @@ void SciTEBase::ReadProperties() {
 		TimerEnd(timerAutoSave);
 	}
 
+	delayBeforeCompress = props.GetInt("buffers.compress.minutes") * 60;
+	if (delayBeforeCompress) {
+		TimerStart(timerCompress);
+	} else {
+		TimerEnd(timerCompress);
+	}
+
 	firstPropertiesRead = false;
 	needReadProperties = false;
 }
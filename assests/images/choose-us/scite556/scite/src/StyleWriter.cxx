@@ -9,6 +9,7 @@
 
 #include <string>
 #include <string_view>
+#include <algorithm>
 #include <chrono>
 
 #include "ScintillaTypes.h"
@@ -21,12 +22,16 @@
 namespace SA = Scintilla;
 
 TextReader::TextReader(SA::ScintillaCall &sc_) noexcept :
+	text(nullptr),
+	direct(true),
+	windowSize(bufferSize),
 	startPos(extremePosition),
 	endPos(0),
+	styleStart(extremePosition),
+	styleEnd(0),
 	codePage(0),
 	sc(sc_),
 	lenDoc(-1) {
-	buf[0] = 0;
 }
 
 bool TextReader::InternalIsLeadByte(char ch) const {
@@ -36,15 +41,41 @@ bool TextReader::InternalIsLeadByte(char ch) const {
 void TextReader::Fill(SA::Position position) {
 	if (lenDoc == -1)
 		lenDoc = sc.Length();
+	if ((position >= endPos) && (startPos != extremePosition)) {
+		// Reading forward so use a larger window
+		windowSize = std::min(windowSize * 2, maxWindowSize);
+	}
 	startPos = position - slopSize;
-	if (startPos + bufferSize > lenDoc)
-		startPos = lenDoc - bufferSize;
+	if (startPos + windowSize > lenDoc)
+		startPos = lenDoc - windowSize;
 	if (startPos < 0)
 		startPos = 0;
-	endPos = startPos + bufferSize;
+	endPos = startPos + windowSize;
 	if (endPos > lenDoc)
 		endPos = lenDoc;
-	CopyText(sc, buf, SA::Span(startPos, endPos));
+	if (endPos <= startPos) {
+		// Empty document so no access needed
+		text = "";
+		return;
+	}
+	if (direct) {
+		// Keep the window on one side of Scintilla's gap so the gap is not moved as that is slow
+		// and would change the text a background save is writing
+		const SA::Position gap = sc.GapPosition();
+		if ((startPos < gap) && (gap < endPos)) {
+			if (position < gap)
+				endPos = gap;
+			else
+				startPos = gap;
+		}
+		text = static_cast<const char *>(sc.RangePointer(startPos, endPos - startPos));
+		if (text)
+			return;
+		direct = false;
+	}
+	buf.resize(windowSize);
+	CopyText(sc, buf.data(), SA::Span(startPos, endPos));
+	text = buf.c_str();
 }
 
 bool TextReader::Match(SA::Position pos, const char *s) {
@@ -56,8 +87,15 @@ bool TextReader::Match(SA::Position pos, const char *s) {
 	return true;
 }
 
-int TextReader::StyleAt(SA::Position position) {
-	return sc.UnsignedStyleAt(position);
+void TextReader::FillStyles(SA::Position position) {
+	styleStart = std::max<SA::Position>(position - slopSize, 0);
+	styleEnd = std::min(styleStart + bufferSize, Length());
+	if (styleEnd <= styleStart)
+		return;
+	// Each position is retrieved as a character followed by its style with a terminating NUL pair
+	styled.resize((styleEnd - styleStart) * 2 + 2);
+	SA::TextRangeFull tr{ {styleStart, styleEnd}, styled.data() };
+	sc.GetStyledTextFull(&tr);
 }
 
 SA::Line TextReader::GetLine(SA::Position position) {
@@ -82,11 +120,23 @@ int TextReader::GetLineState(SA::Line line) {
 	return sc.LineState(line);
 }
 
+// Retrieve a range in one call rather than through the buffer so scripts can examine whole lines.
+std::string TextReader::Text(SA::Span range) {
+	const SA::Position length = Length();
+	if (range.start < 0)
+		range.start = 0;
+	if (range.end > length)
+		range.end = length;
+	if (range.end <= range.start)
+		return std::string();
+	std::string text(range.Length(), '\0');
+	CopyText(sc, text.data(), range);
+	return text;
+}
+
 StyleWriter::StyleWriter(SA::ScintillaCall &sc_) noexcept :
 	TextReader(sc_),
-	validLen(0),
 	startSeg(0) {
-	styleBuf[0] = 0;
 }
 
 void StyleWriter::SetLineState(SA::Line line, int state) {
@@ -104,30 +154,41 @@ void StyleWriter::StartSegment(SA::Position pos) noexcept {
 void StyleWriter::ColourTo(SA::Position pos, int chAttr) {
 	// Only perform styling if non empty range
 	if (pos != startSeg - 1) {
-		if (validLen + (pos - startSeg + 1) >= bufferSize)
+		const size_t lengthSegment = pos - startSeg + 1;
+		if (styleBuf.length() + lengthSegment > maxStyleBufferSize)
 			Flush();
-		if (validLen + (pos - startSeg + 1) >= bufferSize) {
+		if (lengthSegment > maxStyleBufferSize) {
 			// Too big for buffer so send directly
-			sc.SetStyling(pos - startSeg + 1, chAttr);
+			sc.SetStyling(lengthSegment, chAttr);
 		} else {
-			for (SA::Position i = startSeg; i <= pos; i++) {
-				styleBuf[validLen++] = static_cast<char>(chAttr);
-			}
+			styleBuf.append(lengthSegment, static_cast<char>(chAttr));
 		}
 	}
 	startSeg = pos+1;
 }
 
+// Apply a whole run of styles with one message, bypassing the segment buffer.
+void StyleWriter::SetStyles(SA::Position length, const char *styles) {
+	Flush();
+	if (length > 0) {
+		sc.SetStylingEx(length, styles);
+	}
+	startSeg += length;
+}
+
 void StyleWriter::SetLevel(SA::Line line, SA::FoldLevel level) {
 	sc.SetFoldLevel(line, level);
 }
 
 void StyleWriter::Flush() {
 	startPos = extremePosition;
+	// Styles read before are replaced by those written
+	styleStart = extremePosition;
+	styleEnd = 0;
 	lenDoc = -1;
-	if (validLen > 0) {
-		sc.SetStylingEx(validLen, styleBuf);
-		validLen = 0;
+	if (!styleBuf.empty()) {
+		sc.SetStylingEx(styleBuf.length(), styleBuf.data());
+		styleBuf.clear();
 	}
 }
 
@@ -8,19 +8,29 @@
 #ifndef STYLEWRITER_H
 #define STYLEWRITER_H
 
-// Read only access to a document, its styles and other data
+// Read only access to a document, its styles and other data.
+// Text is read through a window that points directly into Scintilla's buffer where possible
+// so the document's text must not be modified while a TextReader is in use.
 class TextReader {
 protected:
 	static constexpr Scintilla::Position extremePosition = INTPTR_MAX;
-	/** @a bufferSize is a trade off between time taken to copy the characters
-	 * and retrieval overhead.
-	 * @a slopSize positions the buffer before the desired position
+	/** @a bufferSize is the initial size of the window which doubles each time reading
+	 * moves forward past its end up to @a maxWindowSize. Small windows suit reading near a
+	 * position while large windows reduce retrieval overhead when examining a whole document.
+	 * @a slopSize positions the window before the desired position
 	 * in case there is some backtracking. */
 	static constexpr Scintilla::Position bufferSize = 4000;
+	static constexpr Scintilla::Position maxWindowSize = 1024 * 1024;
 	static constexpr Scintilla::Position slopSize = bufferSize / 8;
-	char buf[bufferSize+1];
+	const char *text;	///< Text from startPos to endPos, either in Scintilla or in buf
+	std::string buf;	///< Copy of text when Scintilla does not provide direct access
+	bool direct;
+	Scintilla::Position windowSize;
 	Scintilla::Position startPos;
 	Scintilla::Position endPos;
+	std::string styled;	///< Characters interleaved with their styles from styleStart to styleEnd
+	Scintilla::Position styleStart;
+	Scintilla::Position styleEnd;
 	int codePage;
 
 	Scintilla::ScintillaCall &sc;
@@ -28,6 +38,7 @@ protected:
 
 	bool InternalIsLeadByte(char ch) const;
 	void Fill(Scintilla::Position position);
+	void FillStyles(Scintilla::Position position);
 public:
 	explicit TextReader(Scintilla::ScintillaCall &sc_) noexcept;
 	// Deleted so TextReader objects can not be copied.
@@ -37,7 +48,7 @@ public:
 		if (position < startPos || position >= endPos) {
 			Fill(position);
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 	/** Safe version of operator[], returning a defined value for invalid position. */
 	char SafeGetCharAt(Scintilla::Position position, char chDefault=' ') {
@@ -48,7 +59,7 @@ public:
 				return chDefault;
 			}
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 	bool IsLeadByte(char ch) const {
 		return codePage && InternalIsLeadByte(ch);
@@ -57,19 +68,31 @@ public:
 		codePage = codePage_;
 	}
 	bool Match(Scintilla::Position pos, const char *s);
-	int StyleAt(Scintilla::Position position);
+	/** Styles are read through their own window as a message for each position is slow. */
+	int StyleAt(Scintilla::Position position) {
+		if (position < styleStart || position >= styleEnd) {
+			FillStyles(position);
+			if (position < styleStart || position >= styleEnd) {
+				// Position is outside range of document
+				return 0;
+			}
+		}
+		return static_cast<unsigned char>(styled[(position - styleStart) * 2 + 1]);
+	}
 	Scintilla::Line GetLine(Scintilla::Position position);
 	Scintilla::Position LineStart(Scintilla::Line line);
 	Scintilla::FoldLevel LevelAt(Scintilla::Line line);
 	Scintilla::Position Length();
 	int GetLineState(Scintilla::Line line);
+	std::string Text(Scintilla::Span range);
 };
 
 // Adds methods needed to write styles and folding
+// Styles are gathered and sent to Scintilla in large blocks.
 class StyleWriter : public TextReader {
 protected:
-	char styleBuf[bufferSize];
-	Scintilla::Position validLen;
+	static constexpr size_t maxStyleBufferSize = 1024 * 1024;
+	std::string styleBuf;
 	Scintilla::Position startSeg;
 public:
 	explicit StyleWriter(Scintilla::ScintillaCall &sc_) noexcept;
@@ -83,6 +106,7 @@ public:
 	Scintilla::Position GetStartSegment() const noexcept { return startSeg; }
 	void StartSegment(Scintilla::Position pos) noexcept;
 	void ColourTo(Scintilla::Position pos, int chAttr);
+	void SetStyles(Scintilla::Position length, const char *styles);
 	void SetLevel(Scintilla::Line line, Scintilla::FoldLevel level);
 };
 
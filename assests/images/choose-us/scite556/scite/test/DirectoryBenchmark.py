@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# DirectoryBenchmark.py
+# Time SciTE's internal Find in Files over a large synthetic directory tree.
+# Most of the time for a search that matches few files is spent listing directories and
+# checking file names against the file patterns.
+# The tree is created once in the temporary directory, or the directory given by -d, and reused.
+# Run with the path to the SciTE executable, defaulting to ../bin/SciTE relative to this script.
+# Requires Python 3.6 or later
+
+import argparse, os, pathlib, subprocess, sys, tempfile, time
+
+def CreateTree(base, directories, filesPerDirectory):
+	marker = base / ("complete-%d-%d" % (directories, filesPerDirectory))
+	if marker.exists():
+		return
+	print("Creating", directories * filesPerDirectory, "files in", base)
+	extensions = [".c", ".h", ".txt", ".o", ".py"]
+	for d in range(directories):
+		# Nest some directories to exercise the recursion
+		directory = base / ("d%d" % (d // 100)) / ("e%d" % d)
+		directory.mkdir(parents=True, exist_ok=True)
+		for f in range(filesPerDirectory):
+			(directory / ("f%d%s" % (f, extensions[f % len(extensions)]))).write_bytes(b"x\n")
+	marker.write_bytes(b"")
+
+def TimeGrep(sciTE, base, fileTypes, excludedTypes, repeats):
+	# Flags for -grep are whole word, match case, dot directories and binary files with ~ for off
+	command = [str(sciTE), "-grep", "~~~~", fileTypes, excludedTypes, "needle"]
+	best = None
+	for _ in range(repeats):
+		start = time.perf_counter()
+		subprocess.run(command, cwd=base, stdout=subprocess.DEVNULL, check=False)
+		duration = time.perf_counter() - start
+		best = duration if best is None else min(best, duration)
+	print("%-24s %-10s %8.3f s" % (fileTypes, excludedTypes, best))
+
+def main():
+	here = pathlib.Path(__file__).resolve().parent
+	exe = "SciTE.exe" if sys.platform == "win32" else "SciTE"
+	parser = argparse.ArgumentParser(description="Time Find in Files over a synthetic tree")
+	parser.add_argument("scite", nargs="?", default=str(here.parent / "bin" / exe))
+	parser.add_argument("-d", "--directory", default=os.path.join(tempfile.gettempdir(), "scitedirbench"))
+	parser.add_argument("-n", "--directories", type=int, default=500)
+	parser.add_argument("-f", "--files", type=int, default=1000)
+	parser.add_argument("-r", "--repeats", type=int, default=3)
+	args = parser.parse_args()
+
+	base = pathlib.Path(args.directory)
+	CreateTree(base, args.directories, args.files)
+	for fileTypes, excludedTypes in [("*", ""), ("*.c *.h", ""), ("*.c *.h *.cxx *.py", "*.o"), ("f1?.*", "")]:
+		TimeGrep(args.scite, base, fileTypes, excludedTypes, args.repeats)
+
+if __name__ == "__main__":
+	main()
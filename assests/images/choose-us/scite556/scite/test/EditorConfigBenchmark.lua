@@ -0,0 +1,47 @@
+-- Time opening many files from a deep directory tree with a .editorconfig at each level.
+-- Load from the Lua startup script or with dofile, set editor.config.enable=1 then run
+-- BenchmarkEditorConfig() from the command pane or a tool command. The tree is created in
+-- the directory given as an argument or in the temporary directory.
+-- Timings are printed to the output pane.
+
+local depth = 25
+local filesPerLevel = 40
+local IDM_CLOSE = 105
+
+function BenchmarkEditorConfig(base)
+	local windows = props["PLAT_WIN"] == "1"
+	local sep = windows and "\\" or "/"
+	base = base or ((os.getenv("TEMP") or os.getenv("TMPDIR") or "/tmp") .. sep .. "ecbench")
+	local files = {}
+	local dir = base
+	for level = 1, depth do
+		dir = dir .. sep .. "d" .. level
+		if windows then
+			os.execute('mkdir "' .. dir .. '"')
+		else
+			os.execute('mkdir -p "' .. dir .. '"')
+		end
+		local ec = io.open(dir .. sep .. ".editorconfig", "w")
+		ec:write("[*]\nindent_style = space\n",
+			"[*.{c,h}]\nindent_size = ", level % 8 + 1, "\n",
+			"[{src,include}/**/*.x]\ntab_width = 3\n",
+			"[Makefile]\nindent_style = tab\n")
+		ec:close()
+		for i = 1, filesPerLevel do
+			local name = dir .. sep .. "f" .. i .. ".c"
+			local f = io.open(name, "w")
+			f:write("int x;\n")
+			f:close()
+			files[#files + 1] = name
+		end
+	end
+
+	local start = os.clock()
+	for _, name in ipairs(files) do
+		scite.Open(name)
+		scite.MenuCommand(IDM_CLOSE)
+	end
+	local duration = os.clock() - start
+	print(string.format("%d files at depth %d: %8.3f s %8.3f ms per file",
+		#files, depth, duration, duration * 1000 / #files))
+end
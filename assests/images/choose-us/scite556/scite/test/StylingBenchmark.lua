@@ -0,0 +1,122 @@
+-- Compare the per-character styler API with the run-oriented API for script lexers.
+-- Load from the Lua startup script or with dofile, open a large file, set its lexer to
+-- script_bench (lexer.*.txt=script_bench) then run BenchmarkStyling() from the command
+-- pane or a tool command. Timings are printed to the output pane.
+
+local S_DEFAULT, S_IDENTIFIER, S_NUMBER, S_STRING, S_COMMENT, S_KEYWORD = 0, 1, 2, 3, 4, 5
+local keywords = { ["local"]=true, ["function"]=true, ["end"]=true, ["return"]=true,
+	["if"]=true, ["then"]=true, ["else"]=true, ["for"]=true, ["do"]=true, ["while"]=true }
+local identifierCharacters = "_abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+
+local mode = "runs"
+
+-- Per-character lexer using StartStyling / More / Forward / EndStyling
+local function StyleCharacters(styler)
+	styler:StartStyling(styler.startPos, styler.lengthDoc, styler.initStyle)
+	while styler:More() do
+		local state = styler:State()
+		if state == S_IDENTIFIER then
+			if not identifierCharacters:find(styler:Current(), 1, true) then
+				if keywords[styler:Token()] then
+					styler:ChangeState(S_KEYWORD)
+				end
+				styler:SetState(S_DEFAULT)
+			end
+		elseif state == S_NUMBER then
+			if not styler:Current():match("%d") then
+				styler:SetState(S_DEFAULT)
+			end
+		elseif state == S_STRING then
+			if styler:Current() == '"' then
+				styler:ForwardSetState(S_DEFAULT)
+			elseif styler:AtLineEnd() then
+				styler:SetState(S_DEFAULT)
+			end
+		elseif state == S_COMMENT then
+			if styler:AtLineEnd() then
+				styler:SetState(S_DEFAULT)
+			end
+		end
+
+		if styler:State() == S_DEFAULT then
+			local ch = styler:Current()
+			if styler:Match("--") then
+				styler:SetState(S_COMMENT)
+			elseif ch == '"' then
+				styler:SetState(S_STRING)
+			elseif ch:match("%d") then
+				styler:SetState(S_NUMBER)
+			elseif identifierCharacters:find(ch, 1, true) then
+				styler:SetState(S_IDENTIFIER)
+			end
+		end
+		styler:Forward()
+	end
+	styler:EndStyling()
+end
+
+-- Run-oriented lexer: examine the whole range as one string and apply all styles at once
+local function StyleRuns(styler)
+	local text = styler:Text()
+	local runs = {}
+	local n = 0
+	local function add(length, style)
+		runs[n + 1] = length
+		runs[n + 2] = style
+		n = n + 2
+	end
+	local pos = 1
+	while pos <= #text do
+		local s, e = text:find("^[%a_][%w_]*", pos)
+		if s then
+			add(e - s + 1, keywords[text:sub(s, e)] and S_KEYWORD or S_IDENTIFIER)
+		else
+			s, e = text:find("^%d+", pos)
+			if s then
+				add(e - s + 1, S_NUMBER)
+			else
+				s, e = text:find('^"[^"\r\n]*"?', pos)
+				if s then
+					add(e - s + 1, S_STRING)
+				else
+					s, e = text:find("^%-%-[^\r\n]*", pos)
+					if s then
+						add(e - s + 1, S_COMMENT)
+					else
+						s, e = text:find("^[^%w_\"%-]+", pos)
+						if not s then
+							e = pos
+						end
+						add(e - pos + 1, S_DEFAULT)
+					end
+				end
+			end
+		end
+		pos = e + 1
+	end
+	styler:SetStyles(styler.startPos, runs)
+end
+
+function OnStyle(styler)
+	if styler.language ~= "script_bench" then
+		return
+	end
+	if mode == "runs" then
+		StyleRuns(styler)
+	else
+		StyleCharacters(styler)
+	end
+end
+
+function BenchmarkStyling()
+	local length = editor.Length
+	for _, m in ipairs({"characters", "runs"}) do
+		mode = m
+		editor:ClearDocumentStyle()
+		local start = os.clock()
+		editor:Colourise(0, -1)
+		local duration = os.clock() - start
+		print(string.format("%-10s %8.3f s %8.2f MB/s", m, duration, length / duration / 1e6))
+	end
+	mode = "runs"
+end
@@ -0,0 +1,34 @@
+-- Time a script lexer that reads the document through StyleWriter and counts line ends
+-- one character at a time.
+-- Load from the Lua startup script or with dofile and open a large file.
+-- Set the file's lexer to script_reader (lexer.*.txt=script_reader) then run
+-- BenchmarkLineEnds() to time the script lexer.
+-- Timings are printed to the output pane.
+
+local lineEnds = 0
+
+-- Walk the styled range character by character, counting line ends
+function OnStyle(styler)
+	if styler.language ~= "script_reader" then
+		return
+	end
+	styler:StartStyling(styler.startPos, styler.lengthDoc, styler.initStyle)
+	while styler:More() do
+		if styler:AtLineEnd() then
+			lineEnds = lineEnds + 1
+		end
+		styler:Forward()
+	end
+	styler:EndStyling()
+end
+
+function BenchmarkLineEnds()
+	local length = editor.Length
+	lineEnds = 0
+	editor:ClearDocumentStyle()
+	local start = os.clock()
+	editor:Colourise(0, -1)
+	local duration = os.clock() - start
+	print(string.format("%-14s %8.3f s %8.2f MB/s %d line ends", "line ends", duration,
+		length / duration / 1e6, lineEnds))
+end
@@ -4,7 +4,7 @@
 DEL = del /q
 EXE = unitTest.exe
 
-INCLUDEDIRS = /I../src
+INCLUDEDIRS = /I../src /I../../scintilla/include
 
 CXXFLAGS = /MP /EHsc /std:c++20 $(OPTIMIZATION) /nologo /D_HAS_AUTO_PTR_ETC=1 /wd 4805 $(INCLUDEDIRS)
 
@@ -12,7 +12,10 @@ CXXFLAGS = /MP /EHsc /std:c++20 $(OPTIMIZATION) /nologo /D_HAS_AUTO_PTR_ETC=1 /w
 TESTSRC=test*.cxx
 # Files being tested from scintilla/src directory
 TESTEDSRC=\
+ ../src/Compressor.cxx \
  ../src/Cookie.cxx \
+ ../src/PatternMatch.cxx \
+ ../src/PreprocessorIndex.cxx \
  ../src/StringHelpers.cxx \
  ../src/Utf8_16.cxx
 
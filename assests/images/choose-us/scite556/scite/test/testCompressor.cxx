@@ -0,0 +1,110 @@
+/** @file testCompressor.cxx
+ ** Unit Tests for SciTE internal data structures
+ **/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Compressor.h"
+
+#include "catch.hpp"
+
+using namespace std::literals;
+
+namespace {
+
+std::string Expanded(std::string_view compressed, size_t lengthText) {
+	std::string text(lengthText, '\0');
+	REQUIRE(ExpandBlock(compressed, text.data(), text.size()));
+	return text;
+}
+
+std::string RoundTrip(std::string_view text) {
+	return Expanded(CompressBlock(text), text.size());
+}
+
+std::string Expanded(const CompressedText &ct) {
+	std::string text;
+	for (size_t block = 0; block < ct.Blocks(); block++) {
+		std::string expanded(ct.BlockLength(block), '\0');
+		REQUIRE(ct.Expand(block, expanded.data()));
+		text += expanded;
+	}
+	return text;
+}
+
+}
+
+TEST_CASE("Compressor") {
+
+	SECTION("Short") {
+		REQUIRE(RoundTrip("").empty());
+		REQUIRE(RoundTrip("a") == "a");
+		REQUIRE(RoundTrip("abcd") == "abcd");
+		REQUIRE(RoundTrip("abcdabcd") == "abcdabcd");
+	}
+
+	SECTION("Repetitive") {
+		// Overlapping match and lengths needing extension bytes
+		const std::string same(1000, 'x');
+		REQUIRE(RoundTrip(same) == same);
+		REQUIRE(CompressBlock(same).size() < 20);
+
+		std::string lines;
+		for (int i = 0; i < 5000; i++) {
+			lines += "2026-10-17 12:00:00 INFO request " + std::to_string(i) + " completed\n";
+		}
+		const std::string compressed = CompressBlock(lines);
+		REQUIRE(compressed.size() < lines.size() / 3);
+		REQUIRE(Expanded(compressed, lines.size()) == lines);
+	}
+
+	SECTION("Random") {
+		// Long literal runs and offsets beyond the match window
+		std::string text;
+		uint32_t seed = 1;
+		for (int i = 0; i < 200000; i++) {
+			seed = seed * 1103515245 + 12345;
+			text.push_back(static_cast<char>(seed >> 16));
+		}
+		text += text.substr(0, 1000);
+		REQUIRE(RoundTrip(text) == text);
+	}
+
+	SECTION("Corrupt") {
+		const std::string text = "abcdefgh abcdefgh abcdefgh";
+		const std::string compressed = CompressBlock(text);
+		std::string expanded(text.size(), '\0');
+		// Truncated data or wrong length fail rather than writing outside text
+		REQUIRE(!ExpandBlock(std::string_view(compressed).substr(0, compressed.size() / 2), expanded.data(), expanded.size()));
+		REQUIRE(!ExpandBlock(compressed, expanded.data(), expanded.size() - 1));
+		// Offset before start of text
+		REQUIRE(!ExpandBlock("\x10" "a" "\x05\x00"sv, expanded.data(), expanded.size()));
+	}
+
+	SECTION("Blocks") {
+		CompressedText ct;
+		REQUIRE(ct.Empty());
+		std::string text;
+		for (int i = 0; i < 3000; i++) {
+			text += "line " + std::to_string(i % 7) + "\n";
+		}
+		ct.Append(text);
+		// Incompressible block is stored as is
+		ct.Append("xyz");
+		ct.Append(text);
+		ct.Compact();
+		REQUIRE(!ct.Empty());
+		REQUIRE(ct.Blocks() == 3);
+		REQUIRE(ct.Length() == text.size() * 2 + 3);
+		REQUIRE(ct.Size() < text.size());
+		REQUIRE(Expanded(ct) == text + "xyz" + text);
+		ct.Clear();
+		REQUIRE(ct.Empty());
+		REQUIRE(ct.Length() == 0);
+	}
+}
@@ -0,0 +1,114 @@
+/** @file testCookie.cxx
+ ** Unit Tests for SciTE internal data structures
+ **/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+#include "Cookie.h"
+
+#include "catch.hpp"
+
+using namespace std::literals;
+
+namespace {
+
+// Analyse text in blocks of blockSize bytes to check state is carried between blocks
+TextAnalysis Analysed(std::string_view text, size_t blockSize) {
+	TextAnalysis analysis;
+	while (!text.empty()) {
+		const size_t lenBlock = std::min(text.size(), blockSize);
+		analysis.Analyse(text.substr(0, lenBlock));
+		text.remove_prefix(lenBlock);
+	}
+	analysis.Finish();
+	return analysis;
+}
+
+}
+
+TEST_CASE("CodingCookie") {
+
+	SECTION("Lines") {
+		REQUIRE(ExtractLine("ab\r\ncd") == "ab\r\n");
+		REQUIRE(ExtractLine("ab\ncd") == "ab\n");
+		REQUIRE(ExtractLine("ab") == "ab");
+	}
+
+	SECTION("Cookie") {
+		REQUIRE(CodingCookieValue("# -*- coding: utf-8 -*-\n") == UniMode::cookie);
+		REQUIRE(CodingCookieValue("#!/usr/bin/python\n# coding=UTF-8\n") == UniMode::cookie);
+		REQUIRE(CodingCookieValue("# coding: latin-1\n") == UniMode::uni8Bit);
+		// Only the first 2 lines are examined
+		REQUIRE(CodingCookieValue("\n\n# coding: utf-8\n") == UniMode::uni8Bit);
+	}
+}
+
+TEST_CASE("TextAnalysis") {
+
+	SECTION("LineEnds") {
+		for (const size_t blockSize : { 1, 2, 3, 7, 1024 }) {
+			const TextAnalysis analysis = Analysed("a\r\nb\nc\rd\r\n\r\n\n\r", blockSize);
+			REQUIRE(analysis.linesCRLF == 3);
+			REQUIRE(analysis.linesLF == 2);
+			REQUIRE(analysis.linesCR == 2);
+		}
+	}
+
+	SECTION("LongLines") {
+		// Line ends at every alignment within long lines
+		std::string text;
+		for (size_t len = 0; len < 40; len++) {
+			text += std::string(len, 'x') + "\r\n";
+			text += std::string(len, 'y') + "\n";
+			text += std::string(len, 'z') + "\r";
+		}
+		for (const size_t blockSize : { 5, 13, 4096 }) {
+			const TextAnalysis analysis = Analysed(text, blockSize);
+			REQUIRE(analysis.linesCRLF == 40);
+			REQUIRE(analysis.linesLF == 40);
+			REQUIRE(analysis.linesCR == 40);
+			REQUIRE(!analysis.nonASCII);
+		}
+	}
+
+	SECTION("Indentation") {
+		const TextAnalysis analysisSpaces = Analysed(
+			"if a:\n    b\n    c\n        d\nif e:\n    f\n", 1024);
+		REQUIRE(analysisSpaces.IndentStep() == 4);
+		const TextAnalysis analysisTabs = Analysed(
+			"if a:\n\tb\n\tc\n\t\td\n  e\n", 3);
+		REQUIRE(analysisTabs.IndentStep() == 0);
+		const TextAnalysis analysisNone = Analysed("a\nb\n", 1024);
+		REQUIRE(analysisNone.IndentStep() == -1);
+	}
+
+	SECTION("UTF8") {
+		// U+0393, U+30A6 and U+10348 split at every block size
+		constexpr std::string_view utf8 = "a \xCE\x93 \xE3\x82\xA6 \xF0\x90\x8D\x88 end of line\n"sv;
+		for (size_t blockSize = 1; blockSize < utf8.length(); blockSize++) {
+			const TextAnalysis analysis = Analysed(utf8, blockSize);
+			REQUIRE(analysis.nonASCII);
+			REQUIRE(analysis.validUTF8);
+		}
+		const TextAnalysis analysisASCII = Analysed("plain text\n", 1024);
+		REQUIRE(!analysisASCII.nonASCII);
+		REQUIRE(analysisASCII.validUTF8);
+		// Latin-1
+		REQUIRE(!Analysed("caf\xE9 au lait\n", 1024).validUTF8);
+		// Truncated at end
+		REQUIRE(!Analysed("\xE3\x82", 1024).validUTF8);
+		// Overlong
+		REQUIRE(!Analysed("\xC0\xAF", 1024).validUTF8);
+		REQUIRE(!Analysed("\xE0\x80\xAF", 1024).validUTF8);
+		// Surrogate
+		REQUIRE(!Analysed("\xED\xA0\x80", 1024).validUTF8);
+		// Beyond U+10FFFF
+		REQUIRE(!Analysed("\xF4\x90\x80\x80", 1024).validUTF8);
+	}
+}
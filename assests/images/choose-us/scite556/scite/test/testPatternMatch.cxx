@@ -0,0 +1,211 @@
+/** @file testPatternMatch.cxx
+ ** Unit Tests for SciTE internal data structures
+ **/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "PatternMatch.h"
+
+#include "catch.hpp"
+
+using namespace std::literals;
+
+namespace {
+
+// Check the compiled pattern gives the same result as the interpreted pattern
+bool Match(std::u32string_view pattern, std::u32string_view text) {
+	const bool compiledMatches = CompiledPattern(pattern).Matches(text);
+	REQUIRE(compiledMatches == PatternMatch(pattern, text));
+	return compiledMatches;
+}
+
+}
+
+TEST_CASE("PatternMatch") {
+
+	SECTION("Literals") {
+		REQUIRE(Match(U"", U""));
+		REQUIRE(Match(U"a", U"a"));
+		REQUIRE(!Match(U"a", U"b"));
+		REQUIRE(Match(U"ab", U"ab"));
+		REQUIRE(!Match(U"ab", U"a"));
+		REQUIRE(!Match(U"a", U"ab"));
+		REQUIRE(!Match(U"", U"a"));
+		REQUIRE(Match(U"a\\*", U"a*"));
+		REQUIRE(!Match(U"a\\*", U"ab"));
+	}
+
+	SECTION("Star") {
+		// * matches anything except for '/'
+		REQUIRE(Match(U"*", U""));
+		REQUIRE(Match(U"*", U"a"));
+		REQUIRE(Match(U"*", U"ab"));
+
+		REQUIRE(Match(U"a*", U"a"));
+		REQUIRE(Match(U"a*", U"ab"));
+		REQUIRE(Match(U"a*", U"abc"));
+		REQUIRE(!Match(U"a*", U"bc"));
+
+		REQUIRE(Match(U"*a", U"a"));
+		REQUIRE(Match(U"*a", U"za"));
+		REQUIRE(Match(U"*a", U"yza"));
+		REQUIRE(!Match(U"*a", U"xyz"));
+		REQUIRE(!Match(U"a*z", U"a/z"));
+		REQUIRE(Match(U"a*b*c", U"abc"));
+		REQUIRE(Match(U"a*b*c", U"a1b234c"));
+		REQUIRE(!Match(U"a*b*c", U"a1b234"));
+		REQUIRE(Match(U"*.cxx", U"Editor.cxx"));
+		REQUIRE(!Match(U"*.cxx", U"Editor.cxx.orig"));
+	}
+
+	SECTION("Question") {
+		// ? matches one character except for '/'
+		REQUIRE(Match(U"?", U"a"));
+		REQUIRE(!Match(U"?", U""));
+		REQUIRE(Match(U"a?c", U"abc"));
+		REQUIRE(!Match(U"a?c", U"a/c"));
+	}
+
+	SECTION("Set") {
+		// [set] matches one character from set
+		REQUIRE(Match(U"a[123]z", U"a2z"));
+		REQUIRE(!Match(U"a[123]z", U"az"));
+		REQUIRE(!Match(U"a[123]z", U"a2"));
+
+		// [!set] matches one character not from set
+		REQUIRE(Match(U"a[!123]z", U"ayz"));
+		REQUIRE(Match(U"a[!123]", U"az"));
+		REQUIRE(!Match(U"a[!123]", U"a2"));
+
+		// [b-d] matches one character between b and d
+		REQUIRE(Match(U"a[p-t]z", U"apz"));
+		REQUIRE(Match(U"a[p-t]z", U"asz"));
+		REQUIRE(Match(U"a[p-t]z", U"atz"));
+		REQUIRE(!Match(U"a[p-t]z", U"aaz"));
+		REQUIRE(Match(U"a[!p-t]z", U"aaz"));
+		REQUIRE(Match(U"a[]a]z", U"a]z"));
+		REQUIRE(Match(U"*.[ch]", U"x.c"));
+		REQUIRE(!Match(U"*.[ch]", U"x.o"));
+
+		// Malformed sets
+		REQUIRE(!Match(U"a[", U"ab"));
+		REQUIRE(!Match(U"a[!", U"ab"));
+	}
+
+	SECTION("StarStar") {
+		// ** matches anything including '/'
+		REQUIRE(Match(U"**a", U"a"));
+		REQUIRE(Match(U"**a", U"za"));
+		REQUIRE(Match(U"**a", U"yza"));
+		REQUIRE(!Match(U"**a", U"xyz"));
+		REQUIRE(Match(U"a**z", U"a/z"));
+		REQUIRE(Match(U"a**z", U"a/b/z"));
+		REQUIRE(Match(U"a**/z", U"a/b/z"));
+		REQUIRE(Match(U"a/**/z", U"a/b/z"));
+		REQUIRE(Match(U"a**", U"a/b/z"));
+		REQUIRE(Match(U"lexilla/**/Lex*.[ci]xx", U"lexilla/lexers/LexPython.cxx"));
+		REQUIRE(Match(U"lexilla/*/LexAda*.cxx", U"lexilla/lexers/LexAda.cxx"));
+		REQUIRE(!Match(U"lexilla/*/LexAda*.cxx", U"lexilla/src/lexers/LexAda.cxx"));
+		// A '/' consumed by "**" can not then be needed by a later "*"
+		REQUIRE(Match(U"**a*b", U"a/ab"));
+	}
+
+	SECTION("Alternates") {
+		// {alt1,alt2,...} matches any of the alternatives
+		REQUIRE(Match(U"<{ab}>", U"<ab>"));
+		REQUIRE(Match(U"<{ab,lm,xyz}>", U"<ab>"));
+		REQUIRE(Match(U"<{ab,lm,xyz}>", U"<lm>"));
+		REQUIRE(Match(U"<{ab,lm,xyz}>", U"<xyz>"));
+		REQUIRE(!Match(U"<{ab,lm,xyz}>", U"<rs>"));
+		REQUIRE(Match(U"*.{js,py}", U"x.py"));
+		REQUIRE(!Match(U"*.{js,py}", U"lib/x.py"));
+		REQUIRE(Match(U"<{,a}>", U"<>"));
+		REQUIRE(!Match(U"<{ab", U"<ab"));
+	}
+
+	SECTION("Range") {
+		// {num1..num2} matches any integer in the range
+		REQUIRE(Match(U"{10..19}", U"15"));
+		REQUIRE(Match(U"{10..19}", U"10"));
+		REQUIRE(Match(U"{10..19}", U"19"));
+		REQUIRE(!Match(U"{10..19}", U"20"));
+		REQUIRE(!Match(U"{10..19}", U"ab"));
+		REQUIRE(Match(U"{-19..-10}", U"-15"));
+		REQUIRE(Match(U"{10..19}a", U"15a"));
+		REQUIRE(!Match(U"{..19}", U"15"));
+		REQUIRE(!Match(U"{10..}", U"15"));
+		REQUIRE(Match(U"file{1..3}.txt", U"file2.txt"));
+		REQUIRE(!Match(U"file{1..3}.txt", U"file22.txt"));
+	}
+
+	SECTION("Compiled") {
+		// Every possibility is tried, by both the compiled pattern and PatternMatch
+
+		// Each alternate is tried, not just the first that matches
+		REQUIRE(Match(U"{a,ab}c", U"abc"));
+		REQUIRE(Match(U"a{,b}", U"a"));
+		REQUIRE(Match(U"a*{,b}", U"a"));
+		// An integer ends where its digits end
+		REQUIRE(Match(U"{1..5}-x", U"3-x"));
+		REQUIRE(Match(U"*{1..3}", U"x12"));
+		REQUIRE(!Match(U"*{1..3}", U"x45"));
+		REQUIRE(!Match(U"{1..3}", U"12"));
+
+		// Long patterns fall back to PatternMatch
+		const std::u32string longPattern = std::u32string(100, 'a') + U"*";
+		REQUIRE(Match(longPattern, std::u32string(105, 'a')));
+		REQUIRE(!Match(longPattern, std::u32string(99, 'a')));
+		const std::u32string longAlternates = std::u32string(70, 'a') + U"{b,bc}d{1..5}";
+		REQUIRE(CompiledPattern(longAlternates).Matches(std::u32string(70, 'a') + U"bcd3"));
+		REQUIRE(CompiledPattern(longAlternates).Matches(std::u32string(70, 'a') + U"bd5"));
+		REQUIRE(!CompiledPattern(longAlternates).Matches(std::u32string(70, 'a') + U"bcd35"));
+		REQUIRE(!CompiledPattern(longAlternates).Matches(std::u32string(70, 'a') + U"bcd3x"));
+
+		// Default pattern matches only empty text
+		const CompiledPattern empty;
+		REQUIRE(empty.Matches(U""));
+		REQUIRE(!empty.Matches(U"a"));
+	}
+}
+
+TEST_CASE("MatchWild") {
+
+	SECTION("Wild") {
+		REQUIRE(MatchWild("", "", true));
+		REQUIRE(MatchWild("*", "", true));
+		REQUIRE(MatchWild("*", "a/b", true));
+		REQUIRE(MatchWild("*.cxx", "x.cxx", true));
+		REQUIRE(!MatchWild("*.cxx", "x.cxx.orig", true));
+		REQUIRE(MatchWild("Make*", "Makefile", true));
+		REQUIRE(MatchWild("a*b*c", "a1b234c", true));
+		REQUIRE(MatchWild("a*b*c", "abbc", true));
+		REQUIRE(!MatchWild("a*b*c", "acb", true));
+		REQUIRE(MatchWild("a**c", "ac", true));
+		REQUIRE(MatchWild("*b*", "abc", true));
+		REQUIRE(!MatchWild("*bd*", "abc", true));
+		// '?' matches any one character, even '/'
+		REQUIRE(MatchWild("a?c", "a/c", true));
+		REQUIRE(!MatchWild("a?c", "ac", true));
+		REQUIRE(MatchWild("*?", "a", true));
+		REQUIRE(!MatchWild("*??", "a", true));
+	}
+
+	SECTION("Case") {
+		REQUIRE(!MatchWild("*.CXX", "x.cxx", true));
+		REQUIRE(MatchWild("*.CXX", "x.cxx", false));
+		REQUIRE(MatchWild("MAKE*", "makefile", false));
+	}
+
+	SECTION("Set") {
+		REQUIRE(MatchWildSet("*.cxx;*.h", "x.h", true));
+		REQUIRE(MatchWildSet("*.cxx;*.h", "x.cxx", true));
+		REQUIRE(!MatchWildSet("*.cxx;*.h", "x.c", true));
+		REQUIRE(MatchWildSet("makefile;*.mak", "makefile", true));
+		REQUIRE(!MatchWildSet("", "x", true));
+	}
+}
@@ -0,0 +1,225 @@
+/** @file testPreprocessorIndex.cxx
+ ** Unit Tests for SciTE internal data structures
+ **/
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ScintillaTypes.h"
+
+#include "PreprocessorIndex.h"
+
+#include "catch.hpp"
+
+using namespace std::literals;
+
+namespace {
+
+PreProc KindOfText(std::string_view text) noexcept {
+	if (text.starts_with("#if"))
+		return PreProc::Start;
+	if (text.starts_with("#el"))
+		return PreProc::Middle;
+	if (text.starts_with("#endif"))
+		return PreProc::End;
+	return PreProc::None;
+}
+
+// Lines of a document with an index that follows modifications in the same way as SciTE:
+// each modification is reported then the dirty lines are examined again before use.
+class IndexedLines {
+	std::vector<std::string> lines;
+	PreprocessorIndex index;
+	PreprocessorIndex &Updated() {
+		for (Scintilla::Line line = index.DirtyStart(); line < index.DirtyEnd() && line < LineCount(); line++) {
+			index.SetLine(line, KindOfText(lines[line]));
+		}
+		index.Clean();
+		return index;
+	}
+public:
+	explicit IndexedLines(std::vector<std::string> lines_) : lines(std::move(lines_)) {
+		index.Start(this, "", LineCount());
+		for (Scintilla::Line line = 0; line < LineCount(); line++) {
+			const PreProc kind = KindOfText(lines[line]);
+			if (kind != PreProc::None)
+				index.Add(line, kind);
+		}
+	}
+	Scintilla::Line LineCount() const noexcept {
+		return static_cast<Scintilla::Line>(lines.size());
+	}
+	// Insert whole lines before line as if their text and line ends were typed at its start
+	void Insert(Scintilla::Line line, const std::vector<std::string> &inserted) {
+		lines.insert(lines.begin() + line, inserted.begin(), inserted.end());
+		index.LinesModified(line, static_cast<Scintilla::Line>(inserted.size()));
+	}
+	// Delete count whole lines from line so the line after them moves up to line
+	void Delete(Scintilla::Line line, Scintilla::Line count) {
+		lines.erase(lines.begin() + line, lines.begin() + line + count);
+		index.LinesModified(line, -count);
+	}
+	// Join line with the following count lines by removing the line ends and text between
+	void Join(Scintilla::Line line, Scintilla::Line count, std::string_view text) {
+		lines.erase(lines.begin() + line + 1, lines.begin() + line + 1 + count);
+		lines[line] = text;
+		index.LinesModified(line, -count);
+	}
+	void Change(Scintilla::Line line, std::string_view text) {
+		lines[line] = text;
+		index.LinesModified(line, 0);
+	}
+	Scintilla::Line Next(Scintilla::Line line) {
+		return Updated().Next(line);
+	}
+	Scintilla::Line Previous(Scintilla::Line line) {
+		return Updated().Previous(line);
+	}
+	PreProc KindOfLine(Scintilla::Line line) {
+		return Updated().KindOfLine(line);
+	}
+	// Every search gives the same result as an index built from the current text
+	bool MatchesRebuilt() {
+		IndexedLines rebuilt(lines);
+		for (Scintilla::Line line = -1; line <= LineCount(); line++) {
+			if ((Next(line) != rebuilt.Next(line)) || (Previous(line) != rebuilt.Previous(line)) ||
+				(KindOfLine(line) != rebuilt.KindOfLine(line))) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+}
+
+TEST_CASE("PreprocessorIndex") {
+
+	SECTION("Matching") {
+		IndexedLines il({
+			"#if A",	// 0
+			"a",
+			"#else",	// 2
+			"#ifdef B",	// 3
+			"b",
+			"#endif",	// 5
+			"#endif",	// 6
+		});
+		REQUIRE(il.KindOfLine(0) == PreProc::Start);
+		REQUIRE(il.KindOfLine(1) == PreProc::None);
+		REQUIRE(il.KindOfLine(2) == PreProc::Middle);
+		REQUIRE(il.Next(0) == 2);
+		REQUIRE(il.Next(2) == 6);
+		REQUIRE(il.Next(3) == 5);
+		REQUIRE(il.Previous(6) == 2);
+		REQUIRE(il.Previous(2) == 0);
+		REQUIRE(il.Previous(5) == 3);
+		REQUIRE(il.Next(6) == -1);
+		REQUIRE(il.Previous(0) == -1);
+	}
+
+	SECTION("EditInsideBlock") {
+		IndexedLines il({ "#if A", "a", "#else", "b", "#endif" });
+		il.Change(1, "aa");
+		REQUIRE(il.Next(0) == 2);
+		il.Insert(3, { "c", "d" });
+		REQUIRE(il.Next(2) == 6);
+		REQUIRE(il.Previous(6) == 2);
+		il.Delete(1, 1);
+		REQUIRE(il.Next(0) == 1);
+		REQUIRE(il.MatchesRebuilt());
+	}
+
+	SECTION("AddAndRemoveConditions") {
+		IndexedLines il({ "#if A", "a", "b", "#endif" });
+		il.Change(1, "#else");
+		REQUIRE(il.Next(0) == 1);
+		REQUIRE(il.Previous(3) == 1);
+		il.Insert(2, { "#if B", "#endif" });
+		REQUIRE(il.Next(1) == 5);
+		REQUIRE(il.Next(2) == 3);
+		il.Change(1, "x");
+		REQUIRE(il.Next(0) == 5);
+		REQUIRE(il.MatchesRebuilt());
+	}
+
+	SECTION("EditAcrossBlocks") {
+		IndexedLines il({
+			"#if A",	// 0
+			"a",
+			"#else",	// 2
+			"b",
+			"#endif",	// 4
+			"#if B",	// 5
+			"c",
+			"#endif",	// 7
+		});
+		// Remove the end of the first block and the start of the second
+		il.Delete(4, 2);
+		REQUIRE(il.KindOfLine(4) == PreProc::None);
+		REQUIRE(il.Next(2) == 5);
+		REQUIRE(il.MatchesRebuilt());
+		// Join the #else line through to the line before #endif
+		il.Join(1, 2, "a b");
+		REQUIRE(il.KindOfLine(1) == PreProc::None);
+		REQUIRE(il.Next(0) == 3);
+		REQUIRE(il.MatchesRebuilt());
+		// Split the block by inserting an end and a start across it
+		il.Insert(1, { "#endif", "#if C" });
+		REQUIRE(il.Next(0) == 1);
+		REQUIRE(il.Next(2) == 5);
+		REQUIRE(il.MatchesRebuilt());
+	}
+
+	SECTION("JoinIntoCondition") {
+		IndexedLines il({ "#if A", "a", "#el", "se", "#endif" });
+		REQUIRE(il.Next(0) == 2);
+		// Joining turns #el into #else, still a middle
+		il.Join(2, 1, "#else");
+		REQUIRE(il.Next(0) == 2);
+		REQUIRE(il.Next(2) == 3);
+		// Joining the start with the following lines removes the whole block start
+		il.Join(0, 2, "x");
+		REQUIRE(il.KindOfLine(0) == PreProc::None);
+		REQUIRE(il.Previous(1) == -1);
+		REQUIRE(il.MatchesRebuilt());
+	}
+
+	SECTION("ManyEdits") {
+		std::vector<std::string> lines;
+		for (int i = 0; i < 20; i++) {
+			lines.push_back("#if X");
+			lines.push_back("x");
+			lines.push_back("#else");
+			lines.push_back("y");
+			lines.push_back("#endif");
+		}
+		IndexedLines il(lines);
+		const std::vector<std::string> texts = { "#if Y", "#elif Z", "#endif", "z" };
+		// Deterministic mixture of modifications checked after each one
+		for (int step = 0; step < 200; step++) {
+			const Scintilla::Line line = (step * 37) % il.LineCount();
+			switch (step % 4) {
+			case 0:
+				il.Change(line, texts[step % texts.size()]);
+				break;
+			case 1:
+				il.Insert(line, { texts[(step / 4) % texts.size()], "w" });
+				break;
+			case 2:
+				if (line + 3 < il.LineCount())
+					il.Delete(line, 3);
+				break;
+			default:
+				if (line + 2 < il.LineCount())
+					il.Join(line, 2, texts[(step / 4 + 1) % texts.size()]);
+				break;
+			}
+			REQUIRE(il.MatchesRebuilt());
+		}
+	}
+}
@@ -96,6 +96,7 @@ typedef void *HTHEME;
 #include "Utf8_16.h"
 #include "FileWorker.h"
 #include "MatchMarker.h"
+#include "PreprocessorIndex.h"
 #include "Searcher.h"
 #include "SciTEBase.h"
 #include "UniqueInstance.h"
@@ -18,6 +18,7 @@ DirectorExtension.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	DirectorExtension.h
@@ -54,6 +55,7 @@ SciTEWin.o: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -93,6 +95,7 @@ Sc1.o: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -132,6 +135,7 @@ SciTEWinBar.o: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -167,6 +171,7 @@ SciTEWinDlg.o: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -203,6 +208,7 @@ Strips.o: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -239,12 +245,16 @@ UniqueInstance.o: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
 	../src/StripDefinition.h \
 	Strips.h \
 	../src/SciTEKeys.h
+Compressor.o: \
+	../src/Compressor.cxx \
+	../src/Compressor.h
 Cookie.o: \
 	../src/Cookie.cxx \
 	../src/GUI.h \
@@ -270,6 +280,7 @@ Credits.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 EditorConfig.o: \
@@ -277,6 +288,7 @@ EditorConfig.o: \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h \
 	../src/EditorConfig.h
 ExportHTML.o: \
@@ -299,6 +311,7 @@ ExportHTML.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportPDF.o: \
@@ -321,6 +334,7 @@ ExportPDF.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportRTF.o: \
@@ -343,6 +357,7 @@ ExportRTF.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportTEX.o: \
@@ -365,6 +380,7 @@ ExportTEX.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportXML.o: \
@@ -387,6 +403,7 @@ ExportXML.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 FilePath.o: \
@@ -399,8 +416,10 @@ FileWorker.o: \
 	../../scintilla/include/ILoader.h \
 	../../scintilla/include/Sci_Position.h \
 	../src/GUI.h \
+	../src/StringHelpers.h \
 	../src/FilePath.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h
@@ -422,6 +441,7 @@ LuaExtension.o: \
 	../../scintilla/include/ScintillaTypes.h \
 	../../scintilla/include/ScintillaMessages.h \
 	../../scintilla/include/ScintillaCall.h \
+	../../scintilla/include/ScintillaStructures.h \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
@@ -453,12 +473,23 @@ PathMatch.o: \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h
+PatternMatch.o: \
+	../src/PatternMatch.cxx \
+	../src/GUI.h \
+	../src/StringHelpers.h \
+	../src/PatternMatch.h
+PreprocessorIndex.o: \
+	../src/PreprocessorIndex.cxx \
+	../../scintilla/include/ScintillaTypes.h \
+	../src/PreprocessorIndex.h
 PropSetFile.o: \
 	../src/PropSetFile.cxx \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h \
 	../src/PropSetFile.h \
 	../src/EditorConfig.h
@@ -492,10 +523,12 @@ SciTEBase.o: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/EditorConfig.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
@@ -518,10 +551,12 @@ SciTEBuffers.o: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 SciTEIO.o: \
@@ -542,10 +577,12 @@ SciTEIO.o: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 SciTEProps.o: \
@@ -573,6 +610,7 @@ SciTEProps.o: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/EditorConfig.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
@@ -18,6 +18,7 @@ DirectorExtension.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	DirectorExtension.h
@@ -54,6 +55,7 @@ SciTEWin.obj: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -93,6 +95,7 @@ Sc1.obj: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -132,6 +135,7 @@ SciTEWinBar.obj: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -167,6 +171,7 @@ SciTEWinDlg.obj: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -203,6 +208,7 @@ Strips.obj: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
@@ -239,12 +245,16 @@ UniqueInstance.obj: \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
 	UniqueInstance.h \
 	../src/StripDefinition.h \
 	Strips.h \
 	../src/SciTEKeys.h
+Compressor.obj: \
+	../src/Compressor.cxx \
+	../src/Compressor.h
 Cookie.obj: \
 	../src/Cookie.cxx \
 	../src/GUI.h \
@@ -270,6 +280,7 @@ Credits.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 EditorConfig.obj: \
@@ -277,6 +288,7 @@ EditorConfig.obj: \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h \
 	../src/EditorConfig.h
 ExportHTML.obj: \
@@ -299,6 +311,7 @@ ExportHTML.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportPDF.obj: \
@@ -321,6 +334,7 @@ ExportPDF.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportRTF.obj: \
@@ -343,6 +357,7 @@ ExportRTF.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportTEX.obj: \
@@ -365,6 +380,7 @@ ExportTEX.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 ExportXML.obj: \
@@ -387,6 +403,7 @@ ExportXML.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 FilePath.obj: \
@@ -399,8 +416,10 @@ FileWorker.obj: \
 	../../scintilla/include/ILoader.h \
 	../../scintilla/include/Sci_Position.h \
 	../src/GUI.h \
+	../src/StringHelpers.h \
 	../src/FilePath.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h
@@ -422,6 +441,7 @@ LuaExtension.obj: \
 	../../scintilla/include/ScintillaTypes.h \
 	../../scintilla/include/ScintillaMessages.h \
 	../../scintilla/include/ScintillaCall.h \
+	../../scintilla/include/ScintillaStructures.h \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
@@ -453,12 +473,23 @@ PathMatch.obj: \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h
+PatternMatch.obj: \
+	../src/PatternMatch.cxx \
+	../src/GUI.h \
+	../src/StringHelpers.h \
+	../src/PatternMatch.h
+PreprocessorIndex.obj: \
+	../src/PreprocessorIndex.cxx \
+	../../scintilla/include/ScintillaTypes.h \
+	../src/PreprocessorIndex.h
 PropSetFile.obj: \
 	../src/PropSetFile.cxx \
 	../src/GUI.h \
 	../src/StringHelpers.h \
 	../src/FilePath.h \
+	../src/PatternMatch.h \
 	../src/PathMatch.h \
 	../src/PropSetFile.h \
 	../src/EditorConfig.h
@@ -492,10 +523,12 @@ SciTEBase.obj: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/EditorConfig.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
@@ -518,10 +551,12 @@ SciTEBuffers.obj: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 SciTEIO.obj: \
@@ -542,10 +577,12 @@ SciTEIO.obj: \
 	../src/SciTE.h \
 	../src/JobQueue.h \
 	../src/Cookie.h \
+	../src/Compressor.h \
 	../src/Worker.h \
 	../src/Utf8_16.h \
 	../src/FileWorker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h
 SciTEProps.obj: \
@@ -573,6 +610,7 @@ SciTEProps.obj: \
 	../src/Cookie.h \
 	../src/Worker.h \
 	../src/MatchMarker.h \
+	../src/PreprocessorIndex.h \
 	../src/EditorConfig.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
@@ -61,6 +61,7 @@ CCFLAGS=$(CCFLAGS) $(CXXNDEBUG)
 INCLUDEDIRS=-I../../lexilla/include -I../../lexilla/access -I../../scintilla/include -I../src
 
 SHAREDOBJS=\
+	Compressor.obj \
 	Cookie.obj \
 	Credits.obj \
 	DirectorExtension.obj \
@@ -79,6 +80,8 @@ SHAREDOBJS=\
 	MatchMarker.obj \
 	MultiplexExtension.obj \
 	PathMatch.obj \
+	PatternMatch.obj \
+	PreprocessorIndex.obj \
 	PropSetFile.obj \
 	ScintillaCall.obj \
 	ScintillaWindow.obj \